@@ -4,13 +4,17 @@
 #include <string>
 #include <chrono>
 #include <iomanip>
+#include <cstdint>
+
+// Prices are integer ticks: equal prices compare equal exactly, unlike doubles
+constexpr int64_t TICKS_PER_DOLLAR = 100;
 
 /**
  * Order struct representing a market order in an order book
  */
 struct Order {
     std::string symbol;
-    double price;
+    int64_t price;          // In ticks of 1 / TICKS_PER_DOLLAR
     int quantity;
     bool is_buy;
     long timestamp;
@@ -20,7 +24,8 @@ struct Order {
         std::cout << std::left 
                   << std::setw(6) << symbol << " | " 
                   << std::setw(4) << (is_buy ? "BUY" : "SELL") << " | "
-                  << std::setw(8) << std::fixed << std::setprecision(2) << price << " | " 
+                  << std::setw(8) << std::fixed << std::setprecision(2)
+                  << static_cast<double>(price) / TICKS_PER_DOLLAR << " | " 
                   << std::setw(6) << quantity << " | "
                   << timestamp
                   << std::endl;
@@ -46,15 +51,15 @@ void sort_order_book(std::vector<Order>& orders) {
 int main() {
     // Sample order book data
     std::vector<Order> orders = {
-        {"AAPL", 150.25, 100, true, 1623456789},
-        {"AAPL", 150.50, 200, false, 1623456790},
-        {"AAPL", 150.25, 150, true, 1623456791},
-        {"AAPL", 150.00, 100, false, 1623456792},
-        {"AAPL", 150.50, 300, true, 1623456793},
-        {"AAPL", 149.75, 200, true, 1623456794},
-        {"AAPL", 150.25, 100, false, 1623456795},
-        {"AAPL", 150.00, 250, true, 1623456796},
-        {"AAPL", 150.50, 150, false, 1623456797},
+        {"AAPL", 15025, 100, true, 1623456789},
+        {"AAPL", 15050, 200, false, 1623456790},
+        {"AAPL", 15025, 150, true, 1623456791},
+        {"AAPL", 15000, 100, false, 1623456792},
+        {"AAPL", 15050, 300, true, 1623456793},
+        {"AAPL", 14975, 200, true, 1623456794},
+        {"AAPL", 15025, 100, false, 1623456795},
+        {"AAPL", 15000, 250, true, 1623456796},
+        {"AAPL", 15050, 150, false, 1623456797},
     };
     
     // Print original order book
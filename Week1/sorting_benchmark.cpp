@@ -6,50 +6,30 @@
 #include <functional>
 #include <iomanip>
 #include <string>
+#include <cstdint>
+#include <thread>
 
-// Custom implementation of QuickSort for comparison
-template<typename T, typename Compare>
-void quick_sort(typename std::vector<T>::iterator begin, typename std::vector<T>::iterator end, Compare comp) {
-    if (begin >= end - 1) return;
-    
-    auto pivot = *(begin + (end - begin) / 2);
-    auto middle1 = std::partition(begin, end, [&](const T& elem) {
-        return comp(elem, pivot);
-    });
-    
-    auto middle2 = std::partition(middle1, end, [&](const T& elem) {
-        return !comp(pivot, elem);
-    });
-    
-    quick_sort<T, Compare>(begin, middle1, comp);
-    quick_sort<T, Compare>(middle2, end, comp);
-}
+// The kernels live with the rest of the course's production code
+#include "../demo_solution/include/logger.hpp"
+#include "../demo_solution/include/sorting.hpp"
+#include "../demo_solution/include/thread_pool.hpp"
 
-// Custom implementation of MergeSort for comparison
-template<typename T, typename Compare>
-void merge_sort(typename std::vector<T>::iterator begin, typename std::vector<T>::iterator end, Compare comp) {
-    if (end - begin <= 1) return;
-    
-    auto middle = begin + (end - begin) / 2;
-    merge_sort<T, Compare>(begin, middle, comp);
-    merge_sort<T, Compare>(middle, end, comp);
-    
-    std::vector<T> buffer(end - begin);
-    std::merge(begin, middle, middle, end, buffer.begin(), comp);
-    std::copy(buffer.begin(), buffer.end(), begin);
-}
+using namespace trading;
+
+// Prices are integer ticks, so comparisons are exact integer compares
+constexpr int64_t TICKS_PER_DOLLAR = 100;
 
 // Financial data structure
 struct StockPrice {
     std::string symbol;
-    double price;
+    int64_t price;          // In ticks of 1 / TICKS_PER_DOLLAR
     long timestamp;
     
     // For random generation
     static StockPrice random(std::mt19937& gen) {
         static std::vector<std::string> symbols = {"AAPL", "MSFT", "GOOGL", "AMZN", "FB", "TSLA", "JPM", "V", "JNJ", "WMT"};
         static std::uniform_int_distribution<> symbol_dist(0, symbols.size() - 1);
-        static std::uniform_real_distribution<> price_dist(50.0, 1000.0);
+        static std::uniform_int_distribution<int64_t> price_dist(50 * TICKS_PER_DOLLAR, 1000 * TICKS_PER_DOLLAR);
         static std::uniform_int_distribution<long> time_dist(1600000000, 1630000000);
         
         return {
@@ -105,91 +85,72 @@ double benchmark_sort(std::vector<StockPrice> data, SortFunc sort_func, const st
     return duration.count();
 }
 
+// Run every kernel on one dataset, ordering by the given key
+template<typename Less, typename Key>
+void benchmark_all(const std::vector<StockPrice>& data, Less less, Key key, ThreadPool& pool,
+                   std::vector<StockPrice>& scratch) {
+    benchmark_sort(data, [&](std::vector<StockPrice>& d) {
+        std::sort(d.begin(), d.end(), less);
+    }, "std::sort");
+    
+    benchmark_sort(data, [&](std::vector<StockPrice>& d) {
+        std::stable_sort(d.begin(), d.end(), less);
+    }, "stable_sort");
+    
+    benchmark_sort(data, [&](std::vector<StockPrice>& d) {
+        week1::introsort(d.begin(), d.end(), less);
+    }, "introsort");
+    
+    benchmark_sort(data, [&](std::vector<StockPrice>& d) {
+        week1::merge_sort(d.begin(), d.end(), less, scratch);
+    }, "merge_sort");
+    
+    benchmark_sort(data, [&](std::vector<StockPrice>& d) {
+        week1::radix_sort(d.begin(), d.end(), key, scratch);
+    }, "radix_sort");
+    
+    benchmark_sort(data, [&](std::vector<StockPrice>& d) {
+        week1::parallel_sort(pool, d.begin(), d.end(), less);
+    }, "parallel_sort");
+    
+    std::cout << "---------------------------------------------" << std::endl;
+}
+
 int main() {
     std::cout << "Sorting Algorithm Benchmark for Financial Data" << std::endl;
     std::cout << "=============================================" << std::endl;
     
+    // Keep the pool's lifecycle records out of the results
+    Logger::instance().set_level(LogLevel::WARN);
+    ThreadPool pool(std::max(2u, std::thread::hardware_concurrency()));
+    std::vector<StockPrice> scratch;  // Shared by every merge_sort and radix_sort run
+    
     std::vector<size_t> dataset_sizes = {1000, 10000, 100000, 1000000};
     
+    auto by_price = [](const StockPrice& a, const StockPrice& b) { return a.price < b.price; };
+    auto price_key = [](const StockPrice& s) { return week1::radix_key(s.price); };
+    auto by_time = [](const StockPrice& a, const StockPrice& b) { return a.timestamp < b.timestamp; };
+    auto time_key = [](const StockPrice& s) { return week1::radix_key(s.timestamp); };
+    
     std::cout << std::left << std::setw(15) << "Algorithm" 
               << std::setw(12) << "Data Size" 
               << "Time" << std::endl;
     std::cout << "---------------------------------------------" << std::endl;
     
-    // Test with random data
-    std::cout << "\nRandom Data:" << std::endl;
+    // Test with random data, by price
+    std::cout << "\nRandom Data (by price):" << std::endl;
     for (auto size : dataset_sizes) {
-        auto data = generate_dataset(size);
-        
-        // std::sort
-        auto std_sort_data = data;
-        benchmark_sort(std_sort_data, [](std::vector<StockPrice>& d) {
-            std::sort(d.begin(), d.end(), [](const StockPrice& a, const StockPrice& b) {
-                return a.price < b.price;
-            });
-        }, "std::sort");
-        
-        // Custom QuickSort
-        if (size <= 100000) {  // Skip large datasets for slower algorithms
-            auto quick_sort_data = data;
-            benchmark_sort(quick_sort_data, [](std::vector<StockPrice>& d) {
-                quick_sort<StockPrice>(d.begin(), d.end(), [](const StockPrice& a, const StockPrice& b) {
-                    return a.price < b.price;
-                });
-            }, "QuickSort");
-        }
-        
-        // Custom MergeSort
-        if (size <= 100000) {  // Skip large datasets for slower algorithms
-            auto merge_sort_data = data;
-            benchmark_sort(merge_sort_data, [](std::vector<StockPrice>& d) {
-                merge_sort<StockPrice>(d.begin(), d.end(), [](const StockPrice& a, const StockPrice& b) {
-                    return a.price < b.price;
-                });
-            }, "MergeSort");
-        }
-        
-        std::cout << "---------------------------------------------" << std::endl;
+        benchmark_all(generate_dataset(size), by_price, price_key, pool, scratch);
     }
     
-    // Test with partially sorted data (common in financial time series)
-    std::cout << "\nPartially Sorted Data (70% pre-sorted):" << std::endl;
+    // Test with partially sorted data (common in financial time series), by timestamp
+    std::cout << "\nPartially Sorted Data (70% pre-sorted, by timestamp):" << std::endl;
     for (auto size : dataset_sizes) {
-        auto data = generate_partially_sorted_dataset(size);
-        
-        // std::sort
-        auto std_sort_data = data;
-        benchmark_sort(std_sort_data, [](std::vector<StockPrice>& d) {
-            std::sort(d.begin(), d.end(), [](const StockPrice& a, const StockPrice& b) {
-                return a.timestamp < b.timestamp;
-            });
-        }, "std::sort");
-        
-        // Custom QuickSort
-        if (size <= 100000) {  // Skip large datasets for slower algorithms
-            auto quick_sort_data = data;
-            benchmark_sort(quick_sort_data, [](std::vector<StockPrice>& d) {
-                quick_sort<StockPrice>(d.begin(), d.end(), [](const StockPrice& a, const StockPrice& b) {
-                    return a.timestamp < b.timestamp;
-                });
-            }, "QuickSort");
-        }
-        
-        // Custom MergeSort
-        if (size <= 100000) {  // Skip large datasets for slower algorithms
-            auto merge_sort_data = data;
-            benchmark_sort(merge_sort_data, [](std::vector<StockPrice>& d) {
-                merge_sort<StockPrice>(d.begin(), d.end(), [](const StockPrice& a, const StockPrice& b) {
-                    return a.timestamp < b.timestamp;
-                });
-            }, "MergeSort");
-        }
-        
-        std::cout << "---------------------------------------------" << std::endl;
+        benchmark_all(generate_partially_sorted_dataset(size), by_time, time_key, pool, scratch);
     }
     
     return 0;
 }
 
-// Compile with:
-// g++ -std=c++17 -O3 sorting_benchmark.cpp -o sorting_benchmark 
\ No newline at end of file
+// Built by demo_solution's CMake as sorting_benchmark, or by hand with:
+// g++ -std=c++20 -O3 -pthread sorting_benchmark.cpp ../demo_solution/src/thread_pool.cpp ../demo_solution/src/logger.cpp -o sorting_benchmark
@@ -0,0 +1,334 @@
+#include "../include/benchmark_harness.hpp"
+#include "../include/feed_source.hpp"
+#include "../include/lock_free_queue.hpp"
+#include "../include/logger.hpp"
+#include "../include/market_data_handler.hpp"
+#include "../include/order_level_book.hpp"
+#include "../include/sorting.hpp"
+#include "../include/thread_pool.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace trading;
+
+namespace {
+
+// Work sizes; --quick divides them by 10 for smoke runs
+struct Sizes {
+    size_t queue_items = 200000;
+    size_t pool_tasks = 50000;
+    size_t round_trips = 10000;
+    size_t ticks = 100000;
+    size_t sort_elements = 1 << 20;
+    size_t order_events = 500000;
+};
+
+void pin(const BenchmarkRun& run, size_t thread_index) {
+    int cpu = run.cpu_for(thread_index);
+    if (cpu >= 0) {
+        pin_current_thread(cpu);
+    }
+}
+
+// Producers enqueue their send time; consumers record how long each item waited
+void benchmark_lock_free_queue(BenchmarkHarness& harness, const Sizes& sizes, size_t producers, size_t consumers) {
+    std::string name = std::to_string(producers) + "p" + std::to_string(consumers) + "c";
+    std::string params = "producers=" + std::to_string(producers) + ";consumers=" + std::to_string(consumers) +
+                         ";items=" + std::to_string(sizes.queue_items);
+    harness.run("lock_free_queue", name, params, [&](BenchmarkRun& run) {
+        LockFreeQueue<uint64_t> queue;
+        std::atomic<size_t> consumed(0);
+        const size_t per_producer = sizes.queue_items / producers;
+        const size_t total = per_producer * producers;
+
+        std::vector<std::thread> threads;
+        for (size_t c = 0; c < consumers; ++c) {
+            threads.emplace_back([&, c] {
+                pin(run, c);
+                uint64_t sent;
+                while (consumed.load(std::memory_order_relaxed) < total) {
+                    if (queue.try_dequeue(sent)) {
+                        run.record(TscClock::now() - sent);
+                        consumed.fetch_add(1, std::memory_order_relaxed);
+                    } else {
+                        cpu_relax();
+                    }
+                }
+            });
+        }
+        for (size_t p = 0; p < producers; ++p) {
+            threads.emplace_back([&, p] {
+                pin(run, consumers + p);
+                for (size_t i = 0; i < per_producer; ++i) {
+                    queue.enqueue(TscClock::now());
+                }
+            });
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+        return static_cast<uint64_t>(total);
+    });
+}
+
+// Latency from post() until the task has run, and from submit() until get() returns
+void benchmark_thread_pool(BenchmarkHarness& harness, const Sizes& sizes, size_t threads) {
+    ThreadPool pool(threads);
+    std::string params = "threads=" + std::to_string(threads);
+
+    harness.run("thread_pool", "post_to_complete", params + ";tasks=" + std::to_string(sizes.pool_tasks),
+                [&](BenchmarkRun& run) {
+        std::atomic<size_t> done(0);
+        for (size_t i = 0; i < sizes.pool_tasks; ++i) {
+            uint64_t posted = TscClock::now();
+            pool.post(0, [&run, &done, posted] {
+                run.record(TscClock::now() - posted);
+                done.fetch_add(1, std::memory_order_release);
+            });
+        }
+        while (done.load(std::memory_order_acquire) < sizes.pool_tasks) {
+            std::this_thread::yield();
+        }
+        return static_cast<uint64_t>(sizes.pool_tasks);
+    });
+
+    harness.run("thread_pool", "submit_round_trip", params + ";tasks=" + std::to_string(sizes.round_trips),
+                [&](BenchmarkRun& run) {
+        for (size_t i = 0; i < sizes.round_trips; ++i) {
+            uint64_t submitted = TscClock::now();
+            pool.submit(0, [i] { return i; }).get();
+            run.record(TscClock::now() - submitted);
+        }
+        return static_cast<uint64_t>(sizes.round_trips);
+    });
+}
+
+// Publish timestamped ticks on N exchange feeds and time them until their callback runs
+void benchmark_tick_to_callback(BenchmarkHarness& harness, const Sizes& sizes, size_t exchanges) {
+    const size_t SYMBOLS = 16;
+    std::string params = "exchanges=" + std::to_string(exchanges) + ";book_workers=" + std::to_string(exchanges) +
+                         ";symbols=" + std::to_string(SYMBOLS) + ";ticks=" + std::to_string(sizes.ticks);
+    harness.run("market_data", "tick_to_callback_" + std::to_string(exchanges) + "ex", params,
+                [&](BenchmarkRun& run) {
+        MarketDataHandler handler(SYMBOLS);
+        std::vector<QueueFeedSource*> feeds;
+        for (size_t e = 0; e < exchanges; ++e) {
+            auto feed = std::make_unique<QueueFeedSource>(16384);
+            feeds.push_back(feed.get());
+            handler.add_exchange("EX" + std::to_string(e), std::move(feed), FeedWaitMode::BLOCKING);
+        }
+        std::atomic<uint64_t> delivered(0);
+        std::vector<SymbolId> symbols;
+        for (size_t s = 0; s < SYMBOLS; ++s) {
+            std::string symbol = "SYM" + std::to_string(s);
+            // The tick's timestamp carries its publish time in TSC ticks
+            handler.subscribe_ticks(symbol, [&run, &delivered](const MarketTick& tick) {
+                run.record(TscClock::now() - static_cast<uint64_t>(tick.timestamp.count()));
+                delivered.fetch_add(1, std::memory_order_relaxed);
+            });
+            symbols.push_back(handler.symbol_id(symbol));
+        }
+        handler.start(exchanges);
+        run.start_timer();
+
+        const size_t per_exchange = sizes.ticks / exchanges;
+        std::vector<std::thread> publishers;
+        for (size_t e = 0; e < exchanges; ++e) {
+            publishers.emplace_back([&, e] {
+                pin(run, e);
+                for (size_t i = 0; i < per_exchange; ++i) {
+                    MarketTick tick{};
+                    tick.symbol_id = symbols[(i + e) % SYMBOLS];
+                    tick.bid_price = Price::from_raw(100 * PRICE_SCALE + static_cast<int64_t>(i % 32) * 1000000);
+                    tick.ask_price = tick.bid_price + Price::from_raw(1000000);
+                    tick.volume = 100;
+                    tick.timestamp = std::chrono::nanoseconds(static_cast<int64_t>(TscClock::now()));
+                    while (!feeds[e]->publish(tick)) {
+                        std::this_thread::yield();
+                    }
+                }
+            });
+        }
+        for (auto& publisher : publishers) {
+            publisher.join();
+        }
+
+        // Wait until every tick was delivered or shed by a full ingest ring
+        const uint64_t published = per_exchange * exchanges;
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(30);
+        while (std::chrono::steady_clock::now() < deadline) {
+            if (delivered.load(std::memory_order_relaxed) + handler.get_metrics().total_updates_dropped >= published) {
+                break;
+            }
+            std::this_thread::sleep_for(std::chrono::microseconds(100));
+        }
+        run.stop_timer();
+        handler.stop();
+        return delivered.load(std::memory_order_relaxed);
+    });
+}
+
+// Full-depth feed mix on one L3 book: adds, fills, cancels and modifies around a few thousand resting orders
+void benchmark_order_book(BenchmarkHarness& harness, const Sizes& sizes) {
+    const size_t RESTING = 4096;
+    std::string params = "events=" + std::to_string(sizes.order_events) + ";resting=" + std::to_string(RESTING) +
+                         ";l2_depth=" + std::to_string(DEFAULT_BOOK_DEPTH);
+    week2::OrderBookAllocator pool(RESTING * 4, OrderLevelBook::NODE_SIZE);
+    harness.run("order_level_book", "mixed_events", params, [&](BenchmarkRun& run) {
+        PriceLevelBook l2;
+        OrderLevelBook book(pool, &l2, RESTING);
+        std::mt19937_64 rng(7);
+        std::vector<OrderId> live;
+        live.reserve(RESTING * 2);
+        OrderId next_id = 1;
+        const Price tick = Price::from_raw(PRICE_SCALE / 100);
+        auto random_price = [&](Side side) {
+            int64_t offset = static_cast<int64_t>(rng() % 50);
+            return side == Side::BID ? Price::from_double(99.99) - tick * offset
+                                     : Price::from_double(100.01) + tick * offset;
+        };
+
+        for (size_t i = 0; i < sizes.order_events; ++i) {
+            uint64_t choice = rng() % 100;
+            uint64_t start = TscClock::now();
+            if (live.size() < RESTING || choice < 40) {
+                Side side = rng() % 2 == 0 ? Side::BID : Side::ASK;
+                book.add(next_id, side, random_price(side), static_cast<int>(1 + rng() % 500), std::chrono::nanoseconds(0));
+                live.push_back(next_id++);
+            } else {
+                size_t index = rng() % live.size();
+                OrderId id = live[index];
+                if (choice < 70) {
+                    book.cancel(id);
+                } else if (choice < 85) {
+                    book.execute(id, static_cast<int>(1 + rng() % 500));
+                } else {
+                    const OrderNode* order = book.find(id);
+                    if (order != nullptr) {
+                        book.modify(id, random_price(order->side), order->quantity, std::chrono::nanoseconds(0));
+                    }
+                }
+                if (book.find(id) == nullptr) {
+                    live[index] = live.back();
+                    live.pop_back();
+                }
+            }
+            run.record(TscClock::now() - start);
+        }
+        return static_cast<uint64_t>(sizes.order_events);
+    });
+}
+
+// Sort throughput on uniformly random 64-bit keys
+void benchmark_sorts(BenchmarkHarness& harness, const Sizes& sizes) {
+    std::mt19937_64 rng(42);
+    std::vector<int64_t> input(sizes.sort_elements);
+    for (auto& value : input) {
+        value = static_cast<int64_t>(rng());
+    }
+    std::string params = "elements=" + std::to_string(sizes.sort_elements) + ";data=random";
+    std::vector<int64_t> data;
+    ThreadPool pool(4);
+
+    auto sort_with = [&](const std::string& name, auto&& sort) {
+        harness.run("sorting", name, params, [&](BenchmarkRun& run) {
+            data = input;
+            run.start_timer();
+            sort(data);
+            run.stop_timer();
+            return static_cast<uint64_t>(data.size());
+        });
+    };
+    sort_with("std_sort", [](std::vector<int64_t>& v) { std::sort(v.begin(), v.end()); });
+    sort_with("introsort", [](std::vector<int64_t>& v) { week1::introsort(v.begin(), v.end()); });
+    sort_with("merge_sort", [](std::vector<int64_t>& v) { week1::merge_sort(v.begin(), v.end()); });
+    sort_with("radix_sort", [](std::vector<int64_t>& v) {
+        week1::radix_sort(v.begin(), v.end(), [](int64_t x) { return week1::radix_key(x); });
+    });
+    sort_with("parallel_sort_4t", [&pool](std::vector<int64_t>& v) { week1::parallel_sort(pool, v.begin(), v.end()); });
+}
+
+void usage() {
+    std::cout << "Usage: integrated_performance_test [--json FILE] [--csv FILE] [--repetitions N]\n"
+                 "                                   [--warmup N] [--pin CPU] [--quick]\n";
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    BenchmarkOptions options;
+    Sizes sizes;
+    std::string json_path, csv_path;
+    for (int i = 1; i < argc; ++i) {
+        auto value = [&]() -> const char* {
+            if (i + 1 >= argc) {
+                usage();
+                std::exit(1);
+            }
+            return argv[++i];
+        };
+        if (std::strcmp(argv[i], "--json") == 0) {
+            json_path = value();
+        } else if (std::strcmp(argv[i], "--csv") == 0) {
+            csv_path = value();
+        } else if (std::strcmp(argv[i], "--repetitions") == 0) {
+            options.repetitions = std::strtoul(value(), nullptr, 10);
+        } else if (std::strcmp(argv[i], "--warmup") == 0) {
+            options.warmup = std::strtoul(value(), nullptr, 10);
+        } else if (std::strcmp(argv[i], "--pin") == 0) {
+            options.pin_cpu = std::atoi(value());
+        } else if (std::strcmp(argv[i], "--quick") == 0) {
+            sizes = Sizes{sizes.queue_items / 10, sizes.pool_tasks / 10, sizes.round_trips / 10,
+                          sizes.ticks / 10, sizes.sort_elements / 10, sizes.order_events / 10};
+        } else {
+            usage();
+            return 1;
+        }
+    }
+
+    std::cout << "===== Integrated System Performance Test =====\n";
+    std::cout << options.warmup << " warmup and " << options.repetitions << " measured runs per benchmark"
+              << (options.pin_cpu >= 0 ? ", threads pinned from core " + std::to_string(options.pin_cpu) : "")
+              << "\n\n";
+
+    // Keep the components' lifecycle records out of the results table
+    Logger::instance().set_level(LogLevel::WARN);
+
+    BenchmarkHarness harness(options);
+    const size_t cores = std::max<size_t>(std::thread::hardware_concurrency(), 1);
+
+    benchmark_lock_free_queue(harness, sizes, 1, 1);
+    benchmark_lock_free_queue(harness, sizes, 2, 2);
+    benchmark_lock_free_queue(harness, sizes, 4, 4);
+    benchmark_thread_pool(harness, sizes, std::min<size_t>(cores, 4));
+    for (size_t exchanges : {1, 2, 4}) {
+        benchmark_tick_to_callback(harness, sizes, exchanges);
+    }
+    benchmark_order_book(harness, sizes);
+    benchmark_sorts(harness, sizes);
+
+    harness.write_table(std::cout);
+    if (!json_path.empty()) {
+        std::ofstream out(json_path);
+        harness.write_json(out);
+        std::cout << "\nJSON results written to " << json_path << "\n";
+    }
+    if (!csv_path.empty()) {
+        std::ofstream out(csv_path);
+        harness.write_csv(out);
+        std::cout << "CSV results written to " << csv_path << "\n";
+    }
+
+    std::cout << "\nPerformance test completed!\n";
+    return 0;
+}
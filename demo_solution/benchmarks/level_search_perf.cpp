@@ -0,0 +1,103 @@
+#include "../include/level_search.hpp"
+#include "../include/price_level_book.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <vector>
+
+using namespace trading;
+using namespace std::chrono;
+
+// The array-of-structs bid side before the SoA layout, as the reference walk
+struct AosBidSide {
+    OrderBookEntry levels[MAX_BOOK_DEPTH];
+    size_t size = 0;
+
+    size_t find(Price price) const {
+        size_t pos = 0;
+        while (pos < size && levels[pos].price > price) {
+            ++pos;
+        }
+        return pos < size && levels[pos].price == price ? pos : size;
+    }
+
+    int64_t volume_through(Price limit) const {
+        int64_t total = 0;
+        for (size_t i = 0; i < size && levels[i].price >= limit; ++i) {
+            total += levels[i].volume;
+        }
+        return total;
+    }
+};
+
+// Keeps the optimizer from dropping the measured loops
+volatile int64_t sink;
+
+template<typename Fn>
+double ns_per_query(const std::vector<Price>& queries, size_t rounds, Fn&& fn) {
+    int64_t acc = 0;
+    auto start = steady_clock::now();
+    for (size_t r = 0; r < rounds; ++r) {
+        for (Price query : queries) {
+            acc += fn(query);
+        }
+    }
+    auto elapsed = duration_cast<nanoseconds>(steady_clock::now() - start).count();
+    sink = acc;
+    return static_cast<double>(elapsed) / static_cast<double>(rounds * queries.size());
+}
+
+int main() {
+    std::cout << "===== Book Level Search Performance Test =====\n";
+    std::cout << "Compares the SoA level kernels (" << LEVEL_SEARCH_ISA
+              << ") with the AoS OrderBookEntry walk on a full bid side\n\n";
+
+    const size_t QUERIES = 4096;
+    const size_t ROUNDS = 500;
+    std::mt19937 rng(42);
+
+    std::cout << std::setw(8) << "Depth" << std::setw(12) << "Query"
+              << std::setw(12) << "AoS ns" << std::setw(12) << "SoA ns" << std::setw(10) << "Speedup" << std::endl;
+    std::cout << "------------------------------------------------------" << std::endl;
+
+    for (size_t depth : {size_t{10}, size_t{20}, MAX_BOOK_DEPTH}) {
+        PriceLevelSide<Side::BID> soa(depth);
+        AosBidSide aos;
+        // Levels one cent apart below 100.00
+        for (size_t i = 0; i < depth; ++i) {
+            Price price = Price::from_double(100.0) - Price::from_raw(PRICE_SCALE / 100) * static_cast<int64_t>(i);
+            int volume = static_cast<int>(100 + rng() % 900);
+            soa.apply(price, volume);
+            aos.levels[i] = OrderBookEntry{price, volume};
+        }
+        aos.size = depth;
+
+        // Half the queries hit a level, half fall between levels
+        std::vector<Price> queries;
+        queries.reserve(QUERIES);
+        for (size_t i = 0; i < QUERIES; ++i) {
+            int64_t offset = static_cast<int64_t>(rng() % (depth * 2)) * (PRICE_SCALE / 200);
+            queries.push_back(Price::from_double(100.0) - Price::from_raw(offset));
+        }
+
+        double aos_find = ns_per_query(queries, ROUNDS, [&](Price p) { return static_cast<int64_t>(aos.find(p)); });
+        double soa_find = ns_per_query(queries, ROUNDS, [&](Price p) { return static_cast<int64_t>(soa.find(p)); });
+        double aos_sum = ns_per_query(queries, ROUNDS, [&](Price p) { return aos.volume_through(p); });
+        double soa_sum = ns_per_query(queries, ROUNDS, [&](Price p) { return soa.volume_through(p); });
+
+        std::cout << std::fixed << std::setprecision(2)
+                  << std::setw(8) << depth << std::setw(12) << "find"
+                  << std::setw(12) << aos_find << std::setw(12) << soa_find
+                  << std::setw(9) << aos_find / soa_find << "x" << std::endl;
+        std::cout << std::setw(8) << depth << std::setw(12) << "volume"
+                  << std::setw(12) << aos_sum << std::setw(12) << soa_sum
+                  << std::setw(9) << aos_sum / soa_sum << "x" << std::endl;
+    }
+
+    std::cout << "\nPerformance test completed!\n";
+    return 0;
+}
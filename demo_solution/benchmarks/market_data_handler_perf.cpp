@@ -0,0 +1,275 @@
+#include "../include/capture_replay.hpp"
+#include "../include/logger.hpp"
+#include "../include/market_data_handler.hpp"
+
+#include <algorithm>
+#include <filesystem>
+#include <iostream>
+#include <chrono>
+#include <vector>
+#include <string>
+#include <iomanip>
+#include <random>
+#include <span>
+
+using namespace trading;
+using namespace std::chrono;
+
+constexpr Price CENT = Price::from_raw(PRICE_SCALE / 100);
+
+// Sample market data generator for benchmark
+class MarketDataGenerator {
+private:
+    std::mt19937 rng;
+    std::uniform_real_distribution<double> price_dist;
+    std::uniform_int_distribution<int> volume_dist;
+    std::vector<std::string> symbols;
+    std::vector<std::string> exchanges;
+
+public:
+    MarketDataGenerator() 
+        : rng(42), 
+          price_dist(99.0, 101.0),
+          volume_dist(0, 1000) {
+        // Initialize symbols and exchanges
+        symbols = {"AAPL", "MSFT", "GOOGL", "AMZN", "TSLA", "FB", "BRK.A", "V", "JPM", "JNJ"};
+        exchanges = {"NYSE", "NASDAQ", "LSE"};
+    }
+
+    // Generate a random market update; prices on a cent grid so levels repeat
+    MarketUpdate generate_update() {
+        MarketUpdate update;
+        update.symbol = symbols[rng() % symbols.size()];
+        update.exchange = exchanges[rng() % exchanges.size()];
+        update.bid_price = Price::from_double(static_cast<int>(price_dist(rng) * 100) / 100.0);
+        update.ask_price = update.bid_price + CENT * static_cast<int64_t>(1 + rng() % 5);
+        update.volume = volume_dist(rng);
+        update.timestamp = high_resolution_clock::now().time_since_epoch();
+        return update;
+    }
+
+    // Get available symbols
+    const std::vector<std::string>& get_symbols() const {
+        return symbols;
+    }
+
+    // Get available exchanges
+    const std::vector<std::string>& get_exchanges() const {
+        return exchanges;
+    }
+};
+
+/**
+ * @brief Measure the per-message cost of process_updates() at one batch size.
+ *
+ * @param generator Generator providing the symbols and exchanges
+ * @param updates Updates to feed, cycled until total messages were processed
+ * @param batch_size Number of updates per process_updates() call
+ * @param total Number of messages to process
+ * @return double Nanoseconds per message
+ */
+double run_batch_size(const MarketDataGenerator& generator, const std::vector<MarketUpdate>& updates,
+                      size_t batch_size, size_t total) {
+    MarketDataHandler handler(64, 10);
+    for (const auto& exchange : generator.get_exchanges()) {
+        handler.add_exchange(exchange);
+    }
+    for (const auto& symbol : generator.get_symbols()) {
+        handler.subscribe(symbol, [](const MarketUpdate&) {});
+    }
+
+    std::span<const MarketUpdate> all(updates);
+    size_t processed = 0;
+    size_t offset = 0;
+
+    auto start_time = high_resolution_clock::now();
+    while (processed < total) {
+        if (offset + batch_size > all.size()) {
+            offset = 0;
+        }
+        handler.process_updates(all.subspan(offset, batch_size));
+        offset += batch_size;
+        processed += batch_size;
+    }
+    auto end_time = high_resolution_clock::now();
+
+    return static_cast<double>(duration_cast<nanoseconds>(end_time - start_time).count()) / processed;
+}
+
+/**
+ * @brief Measure the per-message cost of decoding wire messages with process_messages().
+ *
+ * The updates are encoded once up front, as they would arrive from the
+ * network; each call then decodes one batch of them in place.
+ *
+ * @param generator Generator providing the symbols and exchanges
+ * @param updates Updates to encode and feed
+ * @param batch_size Number of messages per process_messages() call
+ * @param total Number of messages to process
+ * @return double Nanoseconds per message
+ */
+double run_wire_batch_size(const MarketDataGenerator& generator, const std::vector<MarketUpdate>& updates,
+                           size_t batch_size, size_t total) {
+    MarketDataHandler handler(64, 10);
+    for (const auto& exchange : generator.get_exchanges()) {
+        handler.add_exchange(exchange);
+    }
+    for (const auto& symbol : generator.get_symbols()) {
+        handler.subscribe(symbol, [](const MarketUpdate&) {});
+    }
+
+    std::vector<std::byte> wire(updates.size() * WireLayout::MARKET_UPDATE_SIZE);
+    for (size_t i = 0; i < updates.size(); ++i) {
+        const MarketUpdate& update = updates[i];
+        MarketTick tick{handler.symbol_id(update.symbol), handler.exchange_id(update.exchange),
+                        update.bid_price, update.ask_price, update.volume, update.timestamp};
+        encode_market_update(tick, i, std::span<std::byte>(wire).subspan(i * WireLayout::MARKET_UPDATE_SIZE));
+    }
+
+    std::span<const std::byte> all(wire);
+    size_t batch_bytes = batch_size * WireLayout::MARKET_UPDATE_SIZE;
+    size_t processed = 0;
+    size_t offset = 0;
+
+    auto start_time = high_resolution_clock::now();
+    while (processed < total) {
+        if (offset + batch_bytes > all.size()) {
+            offset = 0;
+        }
+        offset += handler.process_messages(all.subspan(offset, batch_bytes));
+        processed += batch_size;
+    }
+    auto end_time = high_resolution_clock::now();
+
+    return static_cast<double>(duration_cast<nanoseconds>(end_time - start_time).count()) / processed;
+}
+
+/**
+ * @brief Record updates to a capture file, as an exchange thread would.
+ *
+ * @param generator Generator providing the symbols and exchanges
+ * @param updates Updates to record, cycled until total were written
+ * @param total Number of updates to record
+ * @param path Capture file to write
+ */
+void write_capture(const MarketDataGenerator& generator, const std::vector<MarketUpdate>& updates,
+                   size_t total, const std::string& path) {
+    // Intern names in the generator's order, so IDs match replay_capture()'s SYM<i> slots
+    SymbolRegistry symbols(generator.get_symbols().size());
+    ExchangeRegistry exchanges(generator.get_exchanges().size());
+    for (const auto& symbol : generator.get_symbols()) {
+        symbols.intern(symbol);
+    }
+    for (const auto& exchange : generator.get_exchanges()) {
+        exchanges.intern(exchange);
+    }
+
+    CaptureWriter writer(path);
+    for (size_t i = 0; i < total; ++i) {
+        const MarketUpdate& update = updates[i % updates.size()];
+        MarketTick tick{symbols.find(update.symbol), exchanges.find(update.exchange),
+                        update.bid_price, update.ask_price, update.volume, update.timestamp};
+        writer.append(std::span<const MarketTick>(&tick, 1));
+    }
+}
+
+/**
+ * @brief Measure a flat-out replay of a capture.
+ *
+ * Symbols are subscribed as SYM0, SYM1, ... so each captured symbol ID
+ * has a book, whatever the names were when it was recorded.
+ *
+ * @param capture Capture to replay
+ * @param threads Replay threads
+ * @return double Nanoseconds per message
+ */
+double replay_capture(const CaptureReader& capture, size_t threads) {
+    SymbolId max_symbol = 0;
+    size_t cursor = capture.begin();
+    CaptureReader::Record record;
+    while (capture.next(cursor, record)) {
+        max_symbol = std::max(max_symbol, record.update.symbol_id());
+    }
+
+    MarketDataHandler handler(static_cast<size_t>(max_symbol) + 1, 10);
+    for (SymbolId id = 0; id <= max_symbol; ++id) {
+        handler.subscribe("SYM" + std::to_string(id), [](const MarketUpdate&) {});
+    }
+
+    ReplayOptions options;
+    options.threads = threads;
+    ReplayResult result = CaptureReplayer(capture).run(handler, options);
+    return static_cast<double>(result.elapsed.count()) / static_cast<double>(std::max<uint64_t>(result.updates, 1));
+}
+
+int main(int argc, char** argv) {
+    std::cout << "===== Market Data Handler Batch Performance Test =====\n";
+    std::cout << "This test measures the per-message cost of MarketDataHandler::process_updates()\n";
+    std::cout << "for different batch sizes\n";
+    std::cout << "Usage: market_data_handler_perf [capture-file] replays a recorded session\n\n";
+
+    const size_t TOTAL_MESSAGES = 200000;
+    const size_t BATCH_SIZES[] = {1, 8, 64, 512};
+
+    // Keep the handlers' lifecycle records out of the results table
+    Logger::instance().set_level(LogLevel::WARN);
+
+    MarketDataGenerator generator;
+    std::vector<MarketUpdate> updates;
+    updates.reserve(4096);
+    for (size_t i = 0; i < 4096; ++i) {
+        updates.push_back(generator.generate_update());
+    }
+
+    std::cout << std::setw(12) << "Batch size" << std::setw(16) << "ns/message" 
+              << std::setw(20) << "messages/second" << std::endl;
+    std::cout << "------------------------------------------------" << std::endl;
+
+    for (size_t batch_size : BATCH_SIZES) {
+        double ns_per_message = run_batch_size(generator, updates, batch_size, TOTAL_MESSAGES);
+
+        std::cout << std::setw(12) << batch_size 
+                  << std::setw(16) << std::fixed << std::setprecision(1) << ns_per_message
+                  << std::setw(20) << std::setprecision(0) << 1e9 / ns_per_message << std::endl;
+    }
+
+    std::cout << "\nWire messages decoded in place (process_messages):" << std::endl;
+    std::cout << std::setw(12) << "Batch size" << std::setw(16) << "ns/message" 
+              << std::setw(20) << "messages/second" << std::endl;
+    std::cout << "------------------------------------------------" << std::endl;
+
+    for (size_t batch_size : BATCH_SIZES) {
+        double ns_per_message = run_wire_batch_size(generator, updates, batch_size, TOTAL_MESSAGES);
+
+        std::cout << std::setw(12) << batch_size 
+                  << std::setw(16) << std::fixed << std::setprecision(1) << ns_per_message
+                  << std::setw(20) << std::setprecision(0) << 1e9 / ns_per_message << std::endl;
+    }
+
+    // Replay a recorded session if one was given, else a capture of the generated updates
+    std::string capture_path = argc > 1 ? argv[1]
+        : (std::filesystem::temp_directory_path() / "market_data_handler_perf.cap").string();
+    if (argc <= 1) {
+        write_capture(generator, updates, TOTAL_MESSAGES, capture_path);
+    }
+
+    CaptureReader capture(capture_path);
+    std::cout << "\nFlat-out replay of " << capture.record_count() << " captured updates:" << std::endl;
+    std::cout << std::setw(12) << "Threads" << std::setw(16) << "ns/message" 
+              << std::setw(20) << "messages/second" << std::endl;
+    std::cout << "------------------------------------------------" << std::endl;
+
+    for (size_t threads : {1, 2, 4}) {
+        double ns_per_message = replay_capture(capture, threads);
+
+        std::cout << std::setw(12) << threads 
+                  << std::setw(16) << std::fixed << std::setprecision(1) << ns_per_message
+                  << std::setw(20) << std::setprecision(0) << 1e9 / ns_per_message << std::endl;
+    }
+    if (argc <= 1) {
+        std::filesystem::remove(capture_path);
+    }
+
+    std::cout << "\nPerformance test completed!\n";
+    return 0;
+}
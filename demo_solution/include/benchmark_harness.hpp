@@ -0,0 +1,202 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "instrumented_lock.hpp"
+#include "latency_histogram.hpp"
+#include "thread_placement.hpp"
+
+/**
+ * @file benchmark_harness.hpp
+ * @brief Repeatable benchmark runs with percentile and machine-readable output (Week 3).
+ *
+ * Every benchmark is run a few times unmeasured to warm caches, the
+ * allocator and the branch predictors, then measured over several
+ * repetitions. Time is read with TscClock, both for the length of each
+ * run and for the latency samples a benchmark records itself, and
+ * converted to nanoseconds only when reporting. Results print as a table
+ * and write out as JSON or CSV, so two runs can be diffed by a script.
+ */
+
+namespace trading {
+
+/**
+ * @brief How every benchmark of a harness is run.
+ */
+struct BenchmarkOptions {
+    size_t warmup = 1;       // Unmeasured runs before the measured ones
+    size_t repetitions = 5;  // Measured runs
+    int pin_cpu = -1;        // First core to pin benchmark threads to, -1 leaves them unpinned
+};
+
+/**
+ * @brief One run of a benchmark body.
+ *
+ * The harness times the whole body unless the body brackets the part to
+ * measure with start_timer() and stop_timer(). record() may be called
+ * from any number of threads at once.
+ */
+class BenchmarkRun {
+public:
+    /**
+     * @brief Start a run.
+     *
+     * @param options Options of the harness, for cpu_for()
+     */
+    explicit BenchmarkRun(const BenchmarkOptions& options)
+        : options_(options), latency_(std::make_unique<LatencyHistogram>()),
+          start_(TscClock::now()), stop_(0) {}
+
+    /**
+     * @brief Restart the clock, e.g. after setting up.
+     */
+    void start_timer() {
+        start_ = TscClock::now();
+    }
+
+    /**
+     * @brief Stop the clock, e.g. before tearing down.
+     */
+    void stop_timer() {
+        stop_ = TscClock::now();
+    }
+
+    /**
+     * @brief Record one latency sample.
+     *
+     * @param ticks Latency in TscClock ticks
+     */
+    void record(uint64_t ticks) {
+        latency_->record(ticks);
+    }
+
+    /**
+     * @brief Core for a benchmark thread.
+     *
+     * @param thread_index Index of the thread within the benchmark
+     * @return int Core to pin it to, or -1 if the harness doesn't pin
+     */
+    int cpu_for(size_t thread_index) const;
+
+private:
+    friend class BenchmarkHarness;
+
+    const BenchmarkOptions& options_;
+    std::unique_ptr<LatencyHistogram> latency_;  // Samples in ticks
+    uint64_t start_;
+    uint64_t stop_;  // 0 until stop_timer()
+};
+
+/**
+ * @brief Measured outcome of one benchmark.
+ */
+struct BenchmarkResult {
+    std::string group;               // Component, e.g. "lock_free_queue"
+    std::string name;                // Benchmark, e.g. "1p1c"
+    std::string params;              // Free-form parameters, e.g. "producers=2;consumers=2"
+    size_t repetitions{0};
+    uint64_t operations{0};          // Median per repetition
+    double throughput_median{0.0};   // Operations per second
+    double throughput_min{0.0};
+    double throughput_max{0.0};
+    double elapsed_median_ns{0.0};   // Per repetition
+    LatencySummary latency;          // Samples of every repetition, in microseconds
+};
+
+/**
+ * @brief Runs benchmarks and collects their results.
+ */
+class BenchmarkHarness {
+public:
+    /**
+     * @brief Create a harness.
+     *
+     * Pins the calling thread to options.pin_cpu if that is set.
+     *
+     * @param options Warmup, repetitions and pinning for every benchmark
+     */
+    explicit BenchmarkHarness(const BenchmarkOptions& options = BenchmarkOptions{});
+
+    /**
+     * @brief Run a benchmark: warmup runs, then the measured repetitions.
+     *
+     * @param group Component the benchmark belongs to
+     * @param name Name of the benchmark
+     * @param params Parameters, reported verbatim
+     * @param body Called once per run with a BenchmarkRun&; returns the operations it performed
+     * @return const BenchmarkResult& The result, valid until the next run()
+     */
+    template<typename Body>
+    const BenchmarkResult& run(const std::string& group, const std::string& name,
+                               const std::string& params, Body&& body) {
+        for (size_t i = 0; i < options_.warmup; ++i) {
+            BenchmarkRun run(options_);
+            body(run);
+        }
+
+        std::vector<Measurement> measurements;
+        LatencySnapshot latency;
+        for (size_t i = 0; i < std::max<size_t>(options_.repetitions, 1); ++i) {
+            BenchmarkRun run(options_);
+            uint64_t operations = body(run);
+            uint64_t stop = run.stop_ != 0 ? run.stop_ : TscClock::now();
+            measurements.push_back(Measurement{operations, stop - run.start_});
+            latency.merge(*run.latency_);
+        }
+        return add_result(group, name, params, measurements, latency);
+    }
+
+    /**
+     * @brief Get every result so far, in run order.
+     *
+     * @return const std::vector<BenchmarkResult>& Results
+     */
+    const std::vector<BenchmarkResult>& results() const {
+        return results_;
+    }
+
+    /**
+     * @brief Print the results as an aligned table.
+     *
+     * @param out Stream to print to
+     */
+    void write_table(std::ostream& out) const;
+
+    /**
+     * @brief Write the results as a JSON document.
+     *
+     * Latencies are in nanoseconds, throughputs in operations per second.
+     *
+     * @param out Stream to write to
+     */
+    void write_json(std::ostream& out) const;
+
+    /**
+     * @brief Write the results as CSV, one header row then one row per benchmark.
+     *
+     * @param out Stream to write to
+     */
+    void write_csv(std::ostream& out) const;
+
+private:
+    struct Measurement {
+        uint64_t operations;
+        uint64_t ticks;
+    };
+
+    // Convert one benchmark's repetitions to a result
+    const BenchmarkResult& add_result(const std::string& group, const std::string& name,
+                                      const std::string& params, const std::vector<Measurement>& measurements,
+                                      const LatencySnapshot& latency);
+
+    BenchmarkOptions options_;
+    std::vector<BenchmarkResult> results_;
+};
+
+} // namespace trading
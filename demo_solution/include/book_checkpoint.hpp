@@ -0,0 +1,321 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+
+#include "book_snapshot.hpp"
+#include "price.hpp"
+#include "symbol_registry.hpp"
+
+/**
+ * @file book_checkpoint.hpp
+ * @brief Periodic checkpoints of every book, for a warm restart (Week 3).
+ *
+ * A restarted handler would otherwise start with empty books and wait for
+ * the feeds to rebuild them. A checkpoint file holds the symbol and
+ * exchange registries, every book's snapshot and the capture sequence
+ * number the books are complete up to. MarketDataHandler::restore() maps
+ * it and rebuilds the books, and replaying the capture from that sequence
+ * (ReplayOptions::from_sequence) catches up with the feed.
+ *
+ * File layout (native byte order, every section 64-byte aligned):
+ *
+ *     header     magic "TRDCKPT1", version, capacities, offsets of both buffers
+ *     buffer 0   generation, checksum, sequence, time taken, counts,
+ *                exchange names, then one entry per symbol: name, tick size, snapshot
+ *     buffer 1   same layout
+ *
+ * Checkpoints alternate between the two buffers. A buffer's generation is
+ * cleared before it is rewritten and set last, after its checksum, so a
+ * crash mid-checkpoint leaves the other buffer as the newest valid one.
+ */
+
+namespace trading {
+
+class CaptureWriter;
+class MarketDataHandler;
+
+// Longest symbol or exchange name a checkpoint can hold
+constexpr size_t CHECKPOINT_MAX_NAME = 47;
+
+/**
+ * @brief Checkpoint file layout.
+ */
+struct CheckpointLayout {
+    static constexpr char MAGIC[8] = {'T', 'R', 'D', 'C', 'K', 'P', 'T', '1'};
+    static constexpr uint32_t VERSION = 1;
+
+    struct Header {
+        char magic[8];
+        uint32_t version;
+        uint32_t entry_size;  // sizeof(SymbolEntry)
+        uint32_t max_symbols;
+        uint32_t max_exchanges;
+        uint64_t buffer_offset[2];
+        uint64_t buffer_size;
+    };
+
+    /**
+     * @brief Start of each buffer; generation 0 means the buffer holds no checkpoint.
+     */
+    struct BufferHeader {
+        uint64_t generation;
+        uint64_t checksum;       // FNV-1a over the counts, names and used entry bytes
+        uint64_t sequence;       // First capture sequence number the books may be missing
+        int64_t taken_at;        // System clock, ns since the Unix epoch
+        uint32_t symbol_count;
+        uint32_t exchange_count;
+    };
+
+    struct Name {
+        uint32_t length;
+        char text[CHECKPOINT_MAX_NAME + 1];
+    };
+
+    /**
+     * @brief One symbol; only the used rows of the snapshot are meaningful.
+     */
+    struct SymbolEntry {
+        Name name;
+        uint32_t has_book;
+        int64_t tick_size;  // Price::raw()
+        BookSnapshot snapshot;
+    };
+};
+
+/**
+ * @brief What restore() found in a checkpoint.
+ */
+struct CheckpointInfo {
+    uint64_t generation = 0;
+    uint64_t sequence = 0;                // Replay the capture from here
+    size_t books = 0;                     // Books rebuilt
+    std::chrono::nanoseconds taken_at{0}; // System clock, since the Unix epoch
+    std::chrono::nanoseconds restore_time{0};
+};
+
+/**
+ * @brief Writes checkpoints into a memory-mapped, double-buffered file.
+ *
+ * One checkpoint at a time: begin(), then add_exchange() and add_symbol()
+ * for IDs 0, 1, 2, ... in order, then commit(). Not thread-safe.
+ */
+class CheckpointWriter {
+public:
+    /**
+     * @brief Open or create a checkpoint file.
+     *
+     * A file with the same capacities is kept, so its last checkpoint stays
+     * valid until the next commit(); anything else is replaced.
+     *
+     * @param path File to write
+     * @param max_symbols Symbol IDs a checkpoint can hold
+     * @param max_exchanges Exchange IDs a checkpoint can hold
+     * @param durable true to msync() each checkpoint before it is marked valid
+     * @throws std::runtime_error if the file can't be created or mapped
+     */
+    CheckpointWriter(const std::string& path, size_t max_symbols, size_t max_exchanges, bool durable = false);
+
+    /**
+     * @brief Unmap the file.
+     */
+    ~CheckpointWriter();
+
+    CheckpointWriter(const CheckpointWriter&) = delete;
+    CheckpointWriter& operator=(const CheckpointWriter&) = delete;
+
+    /**
+     * @brief Start a checkpoint in the buffer not holding the newest one.
+     */
+    void begin();
+
+    /**
+     * @brief Add the next exchange.
+     *
+     * @param exchange_id ID of the exchange; must be the next one
+     * @param name Name of the exchange
+     * @return true if added, false if the ID or name doesn't fit
+     */
+    bool add_exchange(ExchangeId exchange_id, std::string_view name);
+
+    /**
+     * @brief Add the next symbol.
+     *
+     * @param symbol_id ID of the symbol; must be the next one
+     * @param name Name of the symbol
+     * @param tick_size Minimum price increment of the symbol
+     * @param has_book Whether the symbol has a book
+     * @return BookSnapshot* Snapshot in the file for the caller to fill if
+     *         has_book, nullptr if the ID or name doesn't fit
+     */
+    BookSnapshot* add_symbol(SymbolId symbol_id, std::string_view name, Price tick_size, bool has_book);
+
+    /**
+     * @brief Seal the checkpoint; from now on it is the newest one.
+     *
+     * @param sequence First capture sequence number the books may be missing
+     * @return true if committed, false if no checkpoint was begun or the sync failed
+     */
+    bool commit(uint64_t sequence);
+
+    /**
+     * @brief Get the generation of the newest committed checkpoint, 0 if none.
+     */
+    uint64_t generation() const {
+        return generation_;
+    }
+
+private:
+    CheckpointLayout::BufferHeader* buffer(size_t index) const;
+
+    std::string path_;
+    size_t max_symbols_;
+    size_t max_exchanges_;
+    bool durable_;
+    size_t size_ = 0;
+    unsigned char* base_ = nullptr;
+    uint64_t generation_ = 0;
+    CheckpointLayout::BufferHeader* current_ = nullptr;  // Buffer being written, between begin() and commit()
+    uint32_t symbol_count_ = 0;
+    uint32_t exchange_count_ = 0;
+};
+
+/**
+ * @brief Read-only view of the newest valid checkpoint in a file.
+ */
+class CheckpointReader {
+public:
+    /**
+     * @brief Map a checkpoint file and pick its newest valid buffer.
+     *
+     * @param path File to read
+     * @throws std::runtime_error if the file can't be mapped, isn't a checkpoint
+     *         file of this build, or holds no complete checkpoint
+     */
+    explicit CheckpointReader(const std::string& path);
+
+    /**
+     * @brief Unmap the file.
+     */
+    ~CheckpointReader();
+
+    CheckpointReader(const CheckpointReader&) = delete;
+    CheckpointReader& operator=(const CheckpointReader&) = delete;
+
+    uint64_t generation() const { return buffer_->generation; }
+    uint64_t sequence() const { return buffer_->sequence; }
+    std::chrono::nanoseconds taken_at() const { return std::chrono::nanoseconds(buffer_->taken_at); }
+    size_t symbol_count() const { return buffer_->symbol_count; }
+    size_t exchange_count() const { return buffer_->exchange_count; }
+
+    /**
+     * @brief Get the name of an exchange (exchange_id < exchange_count()).
+     */
+    std::string_view exchange_name(ExchangeId exchange_id) const;
+
+    /**
+     * @brief Get a symbol's entry (symbol_id < symbol_count()).
+     */
+    const CheckpointLayout::SymbolEntry& symbol(SymbolId symbol_id) const;
+
+private:
+    size_t size_ = 0;
+    const unsigned char* base_ = nullptr;
+    const CheckpointLayout::BufferHeader* buffer_ = nullptr;
+};
+
+/**
+ * @brief How a BookCheckpointer takes checkpoints.
+ */
+struct CheckpointOptions {
+    // Time between checkpoints; zero takes them only through checkpoint_now()
+    std::chrono::milliseconds interval{1000};
+    // The capture the handler records to (set_capture()), for the sequence
+    // numbers to resume from; nullptr records sequence 0
+    const CaptureWriter* capture = nullptr;
+    // Longest wait for the book workers to apply what was queued before a checkpoint
+    std::chrono::milliseconds ingest_timeout{1000};
+    // msync() each checkpoint before marking it valid, to survive a host crash
+    bool durable = false;
+};
+
+/**
+ * @brief Background thread checkpointing a handler's books.
+ *
+ * Books are copied out of their seqlocked snapshots, so the tick path is
+ * never blocked. The handler must outlive the checkpointer.
+ */
+class BookCheckpointer {
+public:
+    /**
+     * @brief Open the checkpoint file and start the checkpoint thread.
+     *
+     * @param handler Handler to checkpoint
+     * @param path Checkpoint file
+     * @param options Interval, capture and durability
+     * @throws std::runtime_error if the file can't be created
+     */
+    BookCheckpointer(MarketDataHandler& handler, const std::string& path,
+                     const CheckpointOptions& options = CheckpointOptions{});
+
+    /**
+     * @brief Stop the checkpoint thread; the last checkpoint stays in the file.
+     */
+    ~BookCheckpointer();
+
+    BookCheckpointer(const BookCheckpointer&) = delete;
+    BookCheckpointer& operator=(const BookCheckpointer&) = delete;
+
+    /**
+     * @brief Take a checkpoint now, on the calling thread.
+     *
+     * @return true if written, false if skipped (see MarketDataHandler::write_checkpoint())
+     */
+    bool checkpoint_now();
+
+    /**
+     * @brief Get the number of checkpoints written.
+     */
+    uint64_t checkpoints() const {
+        return checkpoints_.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Get the number of checkpoints skipped.
+     */
+    uint64_t skipped() const {
+        return skipped_.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Get how long the last checkpoint took.
+     */
+    std::chrono::nanoseconds last_duration() const {
+        return std::chrono::nanoseconds(last_duration_ns_.load(std::memory_order_relaxed));
+    }
+
+private:
+    void run();
+
+    MarketDataHandler& handler_;
+    CheckpointOptions options_;
+    std::mutex writer_mutex_;  // One checkpoint at a time
+    CheckpointWriter writer_;
+    std::atomic<uint64_t> checkpoints_{0};
+    std::atomic<uint64_t> skipped_{0};
+    std::atomic<int64_t> last_duration_ns_{0};
+
+    std::mutex stop_mutex_;
+    std::condition_variable stop_cv_;
+    bool stopping_ = false;
+    std::thread thread_;
+};
+
+} // namespace trading
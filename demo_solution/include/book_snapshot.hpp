@@ -0,0 +1,131 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+#include "price_level_book.hpp"
+#include "symbol_registry.hpp"
+
+/**
+ * @file book_snapshot.hpp
+ * @brief Fixed-layout order book snapshots for lock-free readers (Week 3).
+ *
+ * A BookSnapshot is trivially copyable and never allocates, so the handler
+ * can publish one per book through a SeqLock and readers can copy it out
+ * without locks. Levels are stored as rows of (i-th best bid, i-th best
+ * ask), so the used part of a snapshot is one contiguous prefix and the top
+ * of the book sits within its first cache line.
+ */
+
+namespace trading {
+
+/**
+ * @brief Best bid and ask of one book.
+ *
+ * A side with no levels has volume 0.
+ */
+struct TopOfBook {
+    SymbolId symbol_id = INVALID_SYMBOL_ID;
+    std::chrono::nanoseconds timestamp{0};
+    OrderBookEntry bid{Price(), 0};
+    OrderBookEntry ask{Price(), 0};
+
+    bool has_bid() const { return bid.volume > 0; }
+    bool has_ask() const { return ask.volume > 0; }
+};
+
+/**
+ * @brief Trivially copyable copy of a PriceLevelBook.
+ *
+ * Only the first max(bid_count, ask_count) rows are meaningful; the rest
+ * are left uninitialized so a default-constructed snapshot costs nothing.
+ */
+struct BookSnapshot {
+    /**
+     * @brief Row i of the book: the i-th best bid and the i-th best ask.
+     */
+    struct Level {
+        OrderBookEntry bid;
+        OrderBookEntry ask;
+    };
+
+    SymbolId symbol_id = INVALID_SYMBOL_ID;
+    uint32_t bid_count = 0;
+    uint32_t ask_count = 0;
+    std::chrono::nanoseconds timestamp{0};
+    Level levels[MAX_BOOK_DEPTH];
+
+    /**
+     * @brief Number of leading bytes that hold the header and `rows` rows.
+     *
+     * @param rows Number of level rows
+     * @return size_t Prefix size in bytes
+     */
+    static constexpr size_t bytes_for_rows(size_t rows) {
+        return offsetof(BookSnapshot, levels) + std::min(rows, MAX_BOOK_DEPTH) * sizeof(Level);
+    }
+
+    /**
+     * @brief Fill the snapshot from a book.
+     *
+     * @param id Symbol ID of the book
+     * @param book Book to copy (the caller holds its lock)
+     */
+    void capture(SymbolId id, const PriceLevelBook& book) {
+        symbol_id = id;
+        bid_count = static_cast<uint32_t>(book.bids.size());
+        ask_count = static_cast<uint32_t>(book.asks.size());
+        timestamp = book.timestamp;
+        for (size_t i = 0; i < rows(); ++i) {
+            levels[i].bid = i < bid_count ? book.bids[i] : OrderBookEntry{Price(), 0};
+            levels[i].ask = i < ask_count ? book.asks[i] : OrderBookEntry{Price(), 0};
+        }
+    }
+
+    /**
+     * @brief Get the number of meaningful rows.
+     *
+     * @return size_t max(bid_count, ask_count)
+     */
+    size_t rows() const {
+        return std::max(bid_count, ask_count);
+    }
+
+    /**
+     * @brief Get the size of the meaningful prefix.
+     *
+     * @return size_t Bytes covering the header and rows()
+     */
+    size_t used_bytes() const {
+        return bytes_for_rows(rows());
+    }
+
+    const OrderBookEntry& bid(size_t i) const { return levels[i].bid; }
+    const OrderBookEntry& ask(size_t i) const { return levels[i].ask; }
+
+    /**
+     * @brief Get the best bid and ask.
+     *
+     * @return TopOfBook Row 0, with volume 0 for an empty side
+     */
+    TopOfBook top() const {
+        TopOfBook result;
+        result.symbol_id = symbol_id;
+        result.timestamp = timestamp;
+        if (bid_count > 0) {
+            result.bid = levels[0].bid;
+        }
+        if (ask_count > 0) {
+            result.ask = levels[0].ask;
+        }
+        return result;
+    }
+};
+
+static_assert(std::is_trivially_copyable_v<BookSnapshot>, "BookSnapshot must stay trivially copyable");
+static_assert(std::is_standard_layout_v<BookSnapshot>, "BookSnapshot prefix sizes use offsetof");
+
+} // namespace trading
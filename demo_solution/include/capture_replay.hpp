@@ -0,0 +1,293 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <span>
+#include <string>
+#include <vector>
+
+#include "market_tick.hpp"
+#include "wire_format.hpp"
+
+/**
+ * @file capture_replay.hpp
+ * @brief Market data capture files and an mmap-based replayer (Week 3).
+ *
+ * Synthetic benchmarks measure the random number generator and string
+ * building as much as the handler, and can't be repeated. A capture file
+ * records the real update stream instead, in the wire format of
+ * wire_format.hpp, and the replayer feeds it back to a MarketDataHandler
+ * at recorded pace, N times faster, or flat out.
+ *
+ * File layout (little-endian):
+ *
+ *     header   32 bytes: magic "TRDCAPT1", version (u32), header size (u32),
+ *              capture start on the system clock in ns (i64), reserved (u64)
+ *     records  repeated: receive time in ns since capture start (i64),
+ *              followed by one wire message (length-prefixed)
+ *
+ * Records are only ever appended; a capture cut short by a crash simply
+ * ends at its last complete record.
+ */
+
+namespace trading {
+
+class MarketDataHandler;
+
+/**
+ * @brief Capture file header constants.
+ */
+struct CaptureLayout {
+    static constexpr char MAGIC[8] = {'T', 'R', 'D', 'C', 'A', 'P', 'T', '1'};
+    static constexpr uint32_t VERSION = 1;
+    static constexpr size_t HEADER_SIZE = 32;
+    static constexpr size_t OFFSET_SIZE = 8;  // Receive time in front of each message
+    static constexpr size_t RECORD_SIZE = OFFSET_SIZE + WireLayout::MARKET_UPDATE_SIZE;
+};
+
+/**
+ * @brief Append-only writer of capture files.
+ *
+ * Thread-safe: several exchange threads may share one writer. Each
+ * append() takes the writer's mutex once for a whole batch and copies it
+ * into an in-memory buffer; the file is only written when the buffer
+ * fills up or on flush().
+ */
+class CaptureWriter {
+public:
+    static constexpr size_t DEFAULT_BUFFER_SIZE = 1 << 20;
+
+    /**
+     * @brief Create (or truncate) a capture file.
+     *
+     * @param path File to write
+     * @param buffer_size Bytes buffered before writing to the file
+     * @throws std::runtime_error if the file can't be created
+     */
+    explicit CaptureWriter(const std::string& path, size_t buffer_size = DEFAULT_BUFFER_SIZE);
+
+    /**
+     * @brief Flush and close the file.
+     */
+    ~CaptureWriter();
+
+    CaptureWriter(const CaptureWriter&) = delete;
+    CaptureWriter& operator=(const CaptureWriter&) = delete;
+
+    /**
+     * @brief Record a batch of updates received together.
+     *
+     * Each update gets the next sequence number.
+     *
+     * @param ticks Updates to record, with exchange IDs filled in
+     * @param received When the batch arrived
+     */
+    void append(std::span<const MarketTick> ticks,
+                std::chrono::steady_clock::time_point received = std::chrono::steady_clock::now());
+
+    /**
+     * @brief Write everything buffered to the file.
+     */
+    void flush();
+
+    /**
+     * @brief Get the number of updates recorded.
+     *
+     * @return uint64_t Number of records
+     */
+    uint64_t records() const;
+
+    /**
+     * @brief Check whether a write to the file failed.
+     *
+     * @return true if some records may be missing from the file
+     */
+    bool failed() const;
+
+private:
+    // Write the buffer out; the caller holds mutex_
+    void flush_locked();
+
+    mutable std::mutex mutex_;
+    std::FILE* file_;
+    std::vector<std::byte> buffer_;
+    size_t used_;
+    std::chrono::steady_clock::time_point start_;
+    uint64_t records_;
+    bool failed_;
+};
+
+/**
+ * @brief Read-only memory-mapped capture file.
+ *
+ * The file is mapped once and never copied; records are handed out as
+ * MarketUpdateViews into the mapping. All methods are const and
+ * reentrant, so many threads can read one capture at once.
+ */
+class CaptureReader {
+public:
+    /**
+     * @brief One recorded update.
+     */
+    struct Record {
+        std::chrono::nanoseconds offset;  // Receive time since capture start
+        MarketUpdateView update;
+    };
+
+    /**
+     * @brief Map a capture file and index its extent.
+     *
+     * A corrupt or truncated tail is ignored: the capture ends at the last
+     * complete record before it.
+     *
+     * @param path File to read
+     * @throws std::runtime_error if the file can't be mapped or has no valid header
+     */
+    explicit CaptureReader(const std::string& path);
+
+    /**
+     * @brief Unmap the file.
+     */
+    ~CaptureReader();
+
+    CaptureReader(const CaptureReader&) = delete;
+    CaptureReader& operator=(const CaptureReader&) = delete;
+
+    /**
+     * @brief Position of the first record, for next().
+     *
+     * @return size_t Cursor at the first record
+     */
+    size_t begin() const {
+        return begin_;
+    }
+
+    /**
+     * @brief Read the record at a cursor and advance it.
+     *
+     * Records that are not market updates are skipped.
+     *
+     * @param cursor Position from begin() or a previous next()
+     * @param record Receives the record
+     * @return true if a record was read, false at the end of the capture
+     */
+    bool next(size_t& cursor, Record& record) const;
+
+    /**
+     * @brief Get the number of complete market update records.
+     *
+     * @return size_t Number of records
+     */
+    size_t record_count() const {
+        return record_count_;
+    }
+
+    /**
+     * @brief Get the receive time of the last record.
+     *
+     * @return std::chrono::nanoseconds Duration of the captured session
+     */
+    std::chrono::nanoseconds duration() const {
+        return duration_;
+    }
+
+    /**
+     * @brief Get the capture start on the system clock.
+     *
+     * @return std::chrono::nanoseconds Nanoseconds since the Unix epoch
+     */
+    std::chrono::nanoseconds start_time() const {
+        return start_time_;
+    }
+
+private:
+    // Read the record at cursor if it ends before limit
+    bool read_record(size_t& cursor, Record& record, size_t limit) const;
+
+    const std::byte* data_;
+    size_t size_;          // Mapped bytes
+    size_t begin_;         // First record, after the header
+    size_t end_;           // End of the last complete record
+    size_t record_count_;
+    std::chrono::nanoseconds duration_;
+    std::chrono::nanoseconds start_time_;
+    bool mapped_;
+    std::vector<std::byte> fallback_;  // File contents where mmap is unavailable
+};
+
+/**
+ * @brief How a capture is replayed.
+ */
+struct ReplayOptions {
+    // 1.0 replays at recorded pace, N replays N times faster, 0 replays flat out
+    double speed = 0.0;
+    // Keep the recorded gaps between updates; when false, updates are
+    // spread evenly over the same duration
+    bool preserve_jitter = true;
+    // Replay threads; thread i replays the symbols with symbol_id % threads == i,
+    // so each symbol's updates stay in order
+    size_t threads = 1;
+    // Most updates handed to process_updates() at once
+    size_t batch_size = 64;
+    // Skip records numbered below this, e.g. a restored checkpoint's
+    // CheckpointInfo::sequence; paced replays start at the first record kept
+    uint64_t from_sequence = 0;
+};
+
+/**
+ * @brief Outcome of a replay.
+ */
+struct ReplayResult {
+    uint64_t updates{0};                    // Updates pushed into the handler
+    std::chrono::nanoseconds elapsed{0};    // Wall time of the replay
+    std::chrono::nanoseconds max_lag{0};    // Furthest behind schedule any update was pushed
+};
+
+/**
+ * @brief Pushes a capture into a MarketDataHandler.
+ */
+class CaptureReplayer {
+public:
+    /**
+     * @brief Replay a capture.
+     *
+     * @param capture Capture to replay; must outlive the replayer
+     */
+    explicit CaptureReplayer(const CaptureReader& capture) : capture_(capture) {}
+
+    /**
+     * @brief Replay the whole capture into a handler.
+     *
+     * Blocks until every update was pushed. The symbols must be subscribed
+     * with the IDs they had when the capture was recorded.
+     *
+     * @param handler Handler to feed through process_updates()
+     * @param options Pace, jitter, threads and batch size
+     * @return ReplayResult Updates pushed, wall time and worst lag
+     */
+    ReplayResult run(MarketDataHandler& handler, const ReplayOptions& options = ReplayOptions{}) const;
+
+private:
+    /**
+     * @brief Where a replay starts in the capture.
+     */
+    struct ReplayStart {
+        size_t cursor;                   // First record kept
+        uint64_t index;                  // Its position among all records
+        std::chrono::nanoseconds offset; // Its receive time
+    };
+
+    // Find the first record numbered from_sequence or later
+    ReplayStart find_start(uint64_t from_sequence) const;
+
+    // One replay thread: the records of its symbol partition
+    ReplayResult run_partition(MarketDataHandler& handler, const ReplayOptions& options, size_t partition,
+                               const ReplayStart& first, std::chrono::steady_clock::time_point start) const;
+
+    const CaptureReader& capture_;
+};
+
+} // namespace trading
@@ -0,0 +1,555 @@
+#pragma once
+
+#include <coroutine>
+#include <cstddef>
+#include <exception>
+#include <future>
+#include <mutex>
+#include <optional>
+#include <type_traits>
+#include <utility>
+#include <variant>
+
+#include "logger.hpp"
+#include "mpmc_bounded_queue.hpp"
+#include "order_book_allocator.hpp"
+#include "spin_lock.hpp"
+#include "thread_pool.hpp"
+
+/**
+ * @file coroutine_task.hpp
+ * @brief C++20 coroutines on the ThreadPool (Week 3).
+ *
+ * A strategy written as a coroutine gives its worker back whenever it
+ * waits, instead of blocking it in sleep_for() or future::get(). Many more
+ * strategies than threads can then be in flight on the same pool:
+ * - Task<T>: lazily started coroutine; awaiting one runs it and resumes the
+ *   awaiter through symmetric transfer, with no trip through the pool
+ * - pool.schedule(priority): continue on a pool worker
+ * - handler.next_tick(symbol, pool): suspend until the symbol's next update
+ * - AsyncQueue<T>::pop(pool): suspend until a value is pushed
+ * - Coroutine frames come from size-classed Week 2 slabs, not the heap
+ */
+
+// Slab blocks per frame size class
+#ifndef TRADING_COROUTINE_FRAME_POOL_SIZE
+#define TRADING_COROUTINE_FRAME_POOL_SIZE 1024
+#endif
+
+namespace trading {
+
+/**
+ * @brief Process-wide allocator for coroutine frames.
+ *
+ * One OrderBookAllocator per size class, 128 to 2048 bytes. Frames larger
+ * than the biggest class, or allocated while their class is exhausted,
+ * fall back to ::operator new and are counted. Allocation and release are
+ * lock-free and may happen on different threads.
+ */
+class CoroutineFramePool {
+public:
+    static constexpr size_t SIZE_CLASSES = 5;
+    static constexpr size_t SMALLEST_FRAME = 128;
+    static constexpr size_t LARGEST_FRAME = SMALLEST_FRAME << (SIZE_CLASSES - 1);
+
+    /**
+     * @brief Get the pool shared by every Task.
+     */
+    static CoroutineFramePool& instance();
+
+    /**
+     * @brief Allocate a frame.
+     *
+     * @param size Frame size requested by the compiler
+     * @return void* The frame
+     */
+    void* allocate(size_t size);
+
+    /**
+     * @brief Release a frame.
+     *
+     * @param frame Frame returned by allocate()
+     * @param size The size it was allocated with
+     */
+    void deallocate(void* frame, size_t size);
+
+    /**
+     * @brief Get the number of frames allocated so far.
+     */
+    size_t allocations() const;
+
+    /**
+     * @brief Get the number of frames that didn't come from a slab.
+     */
+    size_t fallbacks() const;
+
+private:
+    CoroutineFramePool();
+
+    static size_t size_class(size_t size);
+
+    std::unique_ptr<week2::OrderBookAllocator> classes_[SIZE_CLASSES];
+    std::atomic<size_t> oversized_{0};
+};
+
+/**
+ * @brief Resume a coroutine on a pool worker, or inline without a pool.
+ *
+ * If the pool has stopped accepting tasks the coroutine is resumed inline,
+ * so it is never lost.
+ *
+ * @param executor Pool to resume on, or nullptr to resume on the calling thread
+ * @param priority Priority of the resumption task
+ * @param handle Coroutine to resume
+ */
+inline void resume_on(ThreadPool* executor, int priority, std::coroutine_handle<> handle) {
+    if (executor != nullptr) {
+        try {
+            executor->post(priority, [handle] { handle.resume(); });
+            return;
+        } catch (const std::runtime_error&) {
+            TRADING_LOG_WARN("Thread pool stopped, resuming coroutine on the calling thread");
+        }
+    }
+    handle.resume();
+}
+
+template<typename T = void>
+class Task;
+
+namespace detail {
+
+/**
+ * @brief What every Task promise shares: lazy start, continuation, pooled frame.
+ */
+struct TaskPromiseBase {
+    /**
+     * @brief Resumes whoever awaited the task, straight from the final suspend point.
+     */
+    struct FinalAwaiter {
+        bool await_ready() const noexcept {
+            return false;
+        }
+
+        template<typename Promise>
+        std::coroutine_handle<> await_suspend(std::coroutine_handle<Promise> handle) noexcept {
+            std::coroutine_handle<> continuation = handle.promise().continuation;
+            return continuation ? continuation : std::noop_coroutine();
+        }
+
+        void await_resume() const noexcept {}
+    };
+
+    std::suspend_always initial_suspend() const noexcept {
+        return {};
+    }
+
+    FinalAwaiter final_suspend() const noexcept {
+        return {};
+    }
+
+    static void* operator new(size_t size) {
+        return CoroutineFramePool::instance().allocate(size);
+    }
+
+    static void operator delete(void* frame, size_t size) {
+        CoroutineFramePool::instance().deallocate(frame, size);
+    }
+
+    std::coroutine_handle<> continuation;
+};
+
+template<typename T>
+struct TaskPromise : TaskPromiseBase {
+    Task<T> get_return_object() noexcept;
+
+    template<typename U>
+    void return_value(U&& value) {
+        result.template emplace<1>(std::forward<U>(value));
+    }
+
+    void unhandled_exception() noexcept {
+        result.template emplace<2>(std::current_exception());
+    }
+
+    T take_result() {
+        if (result.index() == 2) {
+            std::rethrow_exception(std::get<2>(result));
+        }
+        return std::move(std::get<1>(result));
+    }
+
+    std::variant<std::monostate, T, std::exception_ptr> result;
+};
+
+template<>
+struct TaskPromise<void> : TaskPromiseBase {
+    Task<void> get_return_object() noexcept;
+
+    void return_void() noexcept {}
+
+    void unhandled_exception() noexcept {
+        exception = std::current_exception();
+    }
+
+    void take_result() {
+        if (exception) {
+            std::rethrow_exception(exception);
+        }
+    }
+
+    std::exception_ptr exception;
+};
+
+/**
+ * @brief Eagerly started coroutine that destroys itself when it finishes.
+ *
+ * Used to run a Task from non-coroutine code. An exception escaping it
+ * terminates the program, as it would on a std::thread.
+ */
+struct DetachedTask {
+    struct promise_type {
+        DetachedTask get_return_object() const noexcept {
+            return {};
+        }
+
+        std::suspend_never initial_suspend() const noexcept {
+            return {};
+        }
+
+        std::suspend_never final_suspend() const noexcept {
+            return {};
+        }
+
+        void return_void() const noexcept {}
+
+        void unhandled_exception() const noexcept {
+            std::terminate();
+        }
+
+        static void* operator new(size_t size) {
+            return CoroutineFramePool::instance().allocate(size);
+        }
+
+        static void operator delete(void* frame, size_t size) {
+            CoroutineFramePool::instance().deallocate(frame, size);
+        }
+    };
+};
+
+} // namespace detail
+
+/**
+ * @brief A lazily started coroutine producing a T.
+ *
+ * The body starts when the task is awaited, on the awaiting thread, and
+ * the awaiter resumes on whatever thread the body finishes on. Both hops
+ * are symmetric transfers, which optimizing compilers turn into tail
+ * calls, so long loops of synchronously completing awaits don't grow the
+ * stack (unoptimized GCC builds still do). Exceptions propagate to the
+ * awaiter. A Task owns its frame and may be awaited once.
+ *
+ * @tparam T Result type, void for none
+ */
+template<typename T>
+class [[nodiscard]] Task {
+    static_assert(!std::is_reference_v<T>, "Task<T&> is not supported, return a pointer");
+
+public:
+    using promise_type = detail::TaskPromise<T>;
+
+    Task() = default;
+
+    explicit Task(std::coroutine_handle<promise_type> handle) : handle_(handle) {}
+
+    Task(Task&& other) noexcept : handle_(std::exchange(other.handle_, {})) {}
+
+    Task& operator=(Task&& other) noexcept {
+        if (this != &other) {
+            if (handle_) {
+                handle_.destroy();
+            }
+            handle_ = std::exchange(other.handle_, {});
+        }
+        return *this;
+    }
+
+    Task(const Task&) = delete;
+    Task& operator=(const Task&) = delete;
+
+    ~Task() {
+        if (handle_) {
+            handle_.destroy();
+        }
+    }
+
+    /**
+     * @brief Check whether the task has run to completion.
+     */
+    bool done() const {
+        return !handle_ || handle_.done();
+    }
+
+    auto operator co_await() && noexcept {
+        struct Awaiter {
+            std::coroutine_handle<promise_type> handle;
+
+            bool await_ready() const noexcept {
+                return !handle || handle.done();
+            }
+
+            // Symmetric transfer: start the task without growing the stack
+            std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiting) noexcept {
+                handle.promise().continuation = awaiting;
+                return handle;
+            }
+
+            T await_resume() {
+                return handle.promise().take_result();
+            }
+        };
+        return Awaiter{handle_};
+    }
+
+private:
+    std::coroutine_handle<promise_type> handle_;
+};
+
+namespace detail {
+
+template<typename T>
+Task<T> TaskPromise<T>::get_return_object() noexcept {
+    return Task<T>(std::coroutine_handle<TaskPromise<T>>::from_promise(*this));
+}
+
+inline Task<void> TaskPromise<void>::get_return_object() noexcept {
+    return Task<void>(std::coroutine_handle<TaskPromise<void>>::from_promise(*this));
+}
+
+/**
+ * @brief Like ThreadPool::schedule(), but continues inline once the pool has stopped.
+ *
+ * A DetachedTask can't let the pool's exception escape, so it starts on
+ * the calling thread instead, the way resume_on() does.
+ */
+struct ScheduleOrInline {
+    ThreadPool& pool;
+    int priority;
+
+    bool await_ready() const noexcept {
+        return false;
+    }
+
+    bool await_suspend(std::coroutine_handle<> handle) {
+        try {
+            pool.post(priority, [handle] { handle.resume(); });
+            return true;
+        } catch (const std::runtime_error&) {
+            TRADING_LOG_WARN("Thread pool stopped, starting coroutine on the calling thread");
+            return false;
+        }
+    }
+
+    void await_resume() const noexcept {}
+};
+
+inline DetachedTask run_detached(ThreadPool& pool, int priority, Task<void> task) {
+    co_await ScheduleOrInline{pool, priority};
+    co_await std::move(task);
+}
+
+// The promise lives in the frame, not with the waiter: the waiter may
+// return, and destroy what it owns, as soon as the value is set
+template<typename T>
+DetachedTask run_and_fulfil(Task<T> task, std::promise<T> result) {
+    try {
+        if constexpr (std::is_void_v<T>) {
+            co_await std::move(task);
+            result.set_value();
+        } else {
+            result.set_value(co_await std::move(task));
+        }
+    } catch (...) {
+        result.set_exception(std::current_exception());
+    }
+}
+
+} // namespace detail
+
+/**
+ * @brief Start a task on a pool worker and let it run to completion on its own.
+ *
+ * Its frame is freed when it finishes. If the pool has stopped accepting
+ * tasks, the task runs on the calling thread before spawn() returns. An
+ * exception escaping it terminates the program, as with ThreadPool::post().
+ *
+ * @param pool Pool to start on
+ * @param priority Priority of the start
+ * @param task Task to run
+ */
+inline void spawn(ThreadPool& pool, int priority, Task<void> task) {
+    detail::run_detached(pool, priority, std::move(task));
+}
+
+/**
+ * @brief Run a task and block the calling thread until it finishes.
+ *
+ * The task starts on the calling thread; call it from outside the pool
+ * whose workers the task needs, or the wait can deadlock.
+ *
+ * @tparam T Result type
+ * @param task Task to run
+ * @return T The task's result; its exception, if it threw
+ */
+template<typename T>
+T sync_wait(Task<T> task) {
+    std::promise<T> result;
+    std::future<T> done = result.get_future();
+    detail::run_and_fulfil(std::move(task), std::move(result));
+    return done.get();
+}
+
+/**
+ * @brief Bounded MPMC queue whose consumers can co_await the next value.
+ *
+ * try_push() never blocks: it hands the value straight to the oldest
+ * suspended consumer, which resumes on the pool it asked for, or queues
+ * it. Suspended consumers are linked through their awaiters, which live in
+ * their coroutine frames, so waiting allocates nothing.
+ *
+ * @tparam T Type of values, default-constructible and movable
+ */
+template<typename T>
+class AsyncQueue {
+public:
+    /**
+     * @brief Suspends a consumer until a value is available.
+     */
+    class PopAwaiter {
+    public:
+        PopAwaiter(AsyncQueue& queue, ThreadPool* executor, int priority)
+            : queue_(queue), executor_(executor), priority_(priority) {}
+
+        bool await_ready() {
+            return queue_.try_pop(value_);
+        }
+
+        bool await_suspend(std::coroutine_handle<> handle) {
+            handle_ = handle;
+            std::lock_guard<SpinLock> lock(queue_.lock_);
+            // A value may have arrived since await_ready()
+            if (queue_.take(value_)) {
+                return false;
+            }
+            if (queue_.tail_ == nullptr) {
+                queue_.head_ = this;
+            } else {
+                queue_.tail_->next_ = this;
+            }
+            queue_.tail_ = this;
+            ++queue_.waiting_;
+            return true;
+        }
+
+        T await_resume() {
+            return std::move(*value_);
+        }
+
+    private:
+        friend class AsyncQueue;
+
+        AsyncQueue& queue_;
+        ThreadPool* executor_;
+        int priority_;
+        std::coroutine_handle<> handle_;
+        std::optional<T> value_;
+        PopAwaiter* next_ = nullptr;
+    };
+
+    /**
+     * @brief Create a queue.
+     *
+     * @param capacity Minimum number of values held while no consumer waits
+     */
+    explicit AsyncQueue(size_t capacity) : values_(capacity) {}
+
+    AsyncQueue(const AsyncQueue&) = delete;
+    AsyncQueue& operator=(const AsyncQueue&) = delete;
+
+    /**
+     * @brief Hand a value to a waiting consumer, or queue it.
+     *
+     * @param value Value to push
+     * @return true if delivered or queued, false if the queue is full
+     */
+    bool try_push(T value) {
+        PopAwaiter* waiter = nullptr;
+        {
+            std::lock_guard<SpinLock> lock(lock_);
+            if (head_ == nullptr) {
+                return values_.try_enqueue(std::move(value));
+            }
+            waiter = head_;
+            head_ = waiter->next_;
+            if (head_ == nullptr) {
+                tail_ = nullptr;
+            }
+            --waiting_;
+            waiter->value_.emplace(std::move(value));
+        }
+        resume_on(waiter->executor_, waiter->priority_, waiter->handle_);
+        return true;
+    }
+
+    /**
+     * @brief Take a value without waiting.
+     *
+     * @param value Set to the value taken
+     * @return true if a value was taken, false if the queue is empty
+     */
+    bool try_pop(std::optional<T>& value) {
+        std::lock_guard<SpinLock> lock(lock_);
+        return take(value);
+    }
+
+    /**
+     * @brief Await the next value: `T value = co_await queue.pop(pool);`
+     *
+     * Doesn't suspend if a value is queued. Otherwise the coroutine
+     * resumes on executor once a value is pushed for it.
+     *
+     * @param executor Pool to resume on
+     * @param priority Priority of the resumption
+     * @return PopAwaiter Awaitable producing the value
+     */
+    PopAwaiter pop(ThreadPool& executor, int priority = 0) {
+        return PopAwaiter(*this, &executor, priority);
+    }
+
+    /**
+     * @brief Get the number of suspended consumers.
+     */
+    size_t waiting() const {
+        std::lock_guard<SpinLock> lock(lock_);
+        return waiting_;
+    }
+
+private:
+    // Caller holds lock_
+    bool take(std::optional<T>& value) {
+        T taken;
+        if (!values_.try_dequeue(taken)) {
+            return false;
+        }
+        value.emplace(std::move(taken));
+        return true;
+    }
+
+    mutable SpinLock lock_;
+    MpmcBoundedQueue<T> values_;
+    PopAwaiter* head_ = nullptr;  // Oldest suspended consumer
+    PopAwaiter* tail_ = nullptr;
+    size_t waiting_ = 0;
+};
+
+} // namespace trading
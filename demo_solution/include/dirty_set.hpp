@@ -0,0 +1,116 @@
+#pragma once
+
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+/**
+ * @file dirty_set.hpp
+ * @brief Lock-free set of changed indexes, drained in bulk (Week 3).
+ *
+ * One bit per index in an array of atomic words. Producers mark an index
+ * with a single fetch_or; a consumer takes a whole word of marks with one
+ * exchange and visits only the indexes that changed since its last pass.
+ * Marking an index that is already marked costs nothing extra, which is
+ * what makes the set useful for conflation.
+ */
+
+namespace trading {
+
+/**
+ * @brief Fixed-capacity concurrent bitset with a draining consumer.
+ *
+ * Any number of threads may mark(); drain() and empty() may run
+ * concurrently with them. Marks made during a drain are either visited by
+ * it or left for the next one, never lost.
+ */
+class DirtySet {
+public:
+    static constexpr size_t WORD_BITS = 64;
+
+    /**
+     * @brief Create an empty set.
+     *
+     * @param capacity Number of indexes, [0, capacity)
+     */
+    explicit DirtySet(size_t capacity)
+        : word_count_((capacity + WORD_BITS - 1) / WORD_BITS),
+          words_(new std::atomic<uint64_t>[word_count_]) {
+        for (size_t i = 0; i < word_count_; ++i) {
+            words_[i].store(0, std::memory_order_relaxed);
+        }
+    }
+
+    DirtySet(const DirtySet&) = delete;
+    DirtySet& operator=(const DirtySet&) = delete;
+
+    /**
+     * @brief Mark an index as changed.
+     *
+     * Release: a consumer that takes the mark also sees what the producer
+     * wrote before marking.
+     *
+     * @param index Index to mark
+     * @return true if the index was not marked yet
+     */
+    bool mark(size_t index) {
+        uint64_t bit = uint64_t(1) << (index % WORD_BITS);
+        return (words_[index / WORD_BITS].fetch_or(bit, std::memory_order_acq_rel) & bit) == 0;
+    }
+
+    /**
+     * @brief Clear every mark, visiting the marked indexes in ascending order.
+     *
+     * @tparam F Callable as `void(size_t index)`
+     * @param visit Called once per marked index, after its mark is cleared
+     * @return size_t Number of indexes visited
+     */
+    template<typename F>
+    size_t drain(F&& visit) {
+        size_t visited = 0;
+        for (size_t w = 0; w < word_count_; ++w) {
+            if (words_[w].load(std::memory_order_relaxed) == 0) {
+                continue;
+            }
+            uint64_t marks = words_[w].exchange(0, std::memory_order_acq_rel);
+            while (marks != 0) {
+                size_t bit = static_cast<size_t>(std::countr_zero(marks));
+                marks &= marks - 1;
+                visit(w * WORD_BITS + bit);
+                ++visited;
+            }
+        }
+        return visited;
+    }
+
+    /**
+     * @brief Check whether any index is marked.
+     *
+     * @return true if no index is marked
+     */
+    bool empty() const {
+        for (size_t w = 0; w < word_count_; ++w) {
+            if (words_[w].load(std::memory_order_acquire) != 0) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    /**
+     * @brief Get the number of indexes the set can hold.
+     *
+     * @return size_t Capacity rounded up to a whole word
+     */
+    size_t capacity() const {
+        return word_count_ * WORD_BITS;
+    }
+
+private:
+    size_t word_count_;
+    std::unique_ptr<std::atomic<uint64_t>[]> words_;
+};
+
+} // namespace trading
@@ -0,0 +1,169 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+#include <thread>
+
+#include "market_tick.hpp"
+#include "mpmc_bounded_queue.hpp"
+
+/**
+ * @file feed_source.hpp
+ * @brief Pluggable exchange feed interface driven by the exchange threads.
+ *
+ * Each exchange registered with MarketDataHandler::add_exchange() can own a
+ * FeedSource. Its exchange thread pulls ticks from the source in batches,
+ * either by busy-polling (lowest latency, burns a core) or by blocking
+ * receive (sleeps while the feed is quiet), and routes them to the book
+ * processing workers.
+ */
+
+namespace trading {
+
+/**
+ * @brief How an exchange thread waits for data from its feed.
+ */
+enum class FeedWaitMode {
+    BUSY_POLL,  // Spin on poll(); lowest latency, one core per exchange
+    BLOCKING    // Block in receive(); frees the core while the feed is idle
+};
+
+/**
+ * @brief Source of ticks for one exchange (socket decoder, replay file, simulator...).
+ *
+ * Implementations fill in symbol IDs (resolved once through
+ * MarketDataHandler::symbol_id()); the exchange thread stamps the exchange
+ * ID. Both calls are made from the exchange thread only.
+ */
+class FeedSource {
+public:
+    virtual ~FeedSource() = default;
+
+    /**
+     * @brief Return whatever ticks are available right now, without blocking.
+     *
+     * @param ticks Output array with room for max_ticks ticks
+     * @param max_ticks Maximum number of ticks to return
+     * @return size_t Number of ticks written
+     */
+    virtual size_t poll(MarketTick* ticks, size_t max_ticks) = 0;
+
+    /**
+     * @brief Wait up to timeout for ticks to become available.
+     *
+     * The default implementation polls with a yield in between; sources
+     * with a real blocking primitive (a socket, a condition variable)
+     * should override it.
+     *
+     * @param ticks Output array with room for max_ticks ticks
+     * @param max_ticks Maximum number of ticks to return
+     * @param timeout Maximum time to wait
+     * @return size_t Number of ticks written (0 on timeout)
+     */
+    virtual size_t receive(MarketTick* ticks, size_t max_ticks, std::chrono::microseconds timeout) {
+        auto deadline = std::chrono::steady_clock::now() + timeout;
+        do {
+            size_t count = poll(ticks, max_ticks);
+            if (count > 0) {
+                return count;
+            }
+            std::this_thread::yield();
+        } while (std::chrono::steady_clock::now() < deadline);
+        return 0;
+    }
+};
+
+/**
+ * @brief In-process feed fed by publish() from any thread.
+ *
+ * Useful for simulators, tests and for bridging a decoder that runs on its
+ * own thread. Backed by a bounded MPMC queue, so publish() fails instead of
+ * growing when the exchange thread falls behind.
+ */
+class QueueFeedSource : public FeedSource {
+public:
+    /**
+     * @brief Construct a feed.
+     *
+     * @param capacity Number of ticks that can be buffered
+     */
+    explicit QueueFeedSource(size_t capacity) : queue_(capacity) {}
+
+    /**
+     * @brief Publish a tick to the feed.
+     *
+     * @param tick Tick to publish
+     * @return true if buffered, false if the feed buffer is full
+     */
+    bool publish(const MarketTick& tick) {
+        if (!queue_.try_enqueue(tick)) {
+            return false;
+        }
+        wake_receiver();
+        return true;
+    }
+
+    /**
+     * @brief Publish several ticks to the feed.
+     *
+     * @param ticks Pointer to the first tick
+     * @param count Number of ticks
+     * @return size_t Number of ticks buffered (a prefix of ticks)
+     */
+    size_t publish_bulk(const MarketTick* ticks, size_t count) {
+        size_t published = 0;
+        while (published < count) {
+            size_t n = queue_.try_enqueue_bulk(ticks + published, count - published);
+            if (n == 0) {
+                break;
+            }
+            published += n;
+        }
+        if (published > 0) {
+            wake_receiver();
+        }
+        return published;
+    }
+
+    size_t poll(MarketTick* ticks, size_t max_ticks) override {
+        return queue_.try_dequeue_bulk(ticks, max_ticks);
+    }
+
+    size_t receive(MarketTick* ticks, size_t max_ticks, std::chrono::microseconds timeout) override {
+        size_t count = poll(ticks, max_ticks);
+        if (count > 0) {
+            return count;
+        }
+
+        // Pairs with wake_receiver(): either we see the tick or the
+        // publisher sees us waiting and notifies
+        std::unique_lock<std::mutex> lock(mutex_);
+        waiting_.store(true, std::memory_order_seq_cst);
+        condition_.wait_for(lock, timeout, [this] { return !queue_.empty(); });
+        waiting_.store(false, std::memory_order_relaxed);
+        lock.unlock();
+
+        return poll(ticks, max_ticks);
+    }
+
+private:
+    void wake_receiver() {
+        if (waiting_.load(std::memory_order_seq_cst)) {
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+            }
+            condition_.notify_one();
+        }
+    }
+
+    MpmcBoundedQueue<MarketTick> queue_;
+
+    std::mutex mutex_;
+    std::condition_variable condition_;
+    std::atomic<bool> waiting_{false};
+};
+
+} // namespace trading
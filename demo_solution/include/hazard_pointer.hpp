@@ -0,0 +1,226 @@
+#pragma once
+
+#include <atomic>
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <thread>
+#include <utility>
+
+#include "spin_lock.hpp"
+
+/**
+ * @file hazard_pointer.hpp
+ * @brief Hazard pointer based safe memory reclamation (Week 3).
+ *
+ * Lock-free linked structures cannot free a node as soon as it is
+ * unlinked: another thread may have loaded a pointer to it just before and
+ * still be about to dereference it. With hazard pointers each thread
+ * publishes the nodes it is about to touch, and unlinked ("retired") nodes
+ * are only reclaimed once no published hazard refers to them.
+ */
+
+namespace trading {
+
+/**
+ * @brief A hazard pointer domain for one data structure.
+ *
+ * Threads borrow a record of hazard slots for the duration of an operation
+ * through a Guard. Retired nodes are chained through their `retired_next`
+ * member onto a lock-free list, so retiring never allocates. Once enough
+ * nodes have been retired, the retiring thread scans all records and hands
+ * every node that is no longer hazardous to the Reclaimer.
+ *
+ * @tparam Node Node type; must have a `Node* retired_next` member
+ * @tparam Reclaimer Callable invoked as `reclaimer(Node*)` to free a node
+ */
+template<typename Node, typename Reclaimer>
+class HazardPointerDomain {
+public:
+    static constexpr size_t MAX_RECORDS = 64;
+    static constexpr size_t SLOTS_PER_RECORD = 2;
+    static constexpr size_t SCAN_THRESHOLD = 2 * MAX_RECORDS * SLOTS_PER_RECORD;
+
+private:
+    /**
+     * @brief Hazard slots owned by one thread at a time, padded to a cache line.
+     */
+    struct alignas(64) Record {
+        std::atomic<bool> in_use{false};
+        std::atomic<Node*> hazards[SLOTS_PER_RECORD] = {};
+    };
+
+public:
+    /**
+     * @brief RAII ownership of one hazard record.
+     */
+    class Guard {
+    public:
+        explicit Guard(HazardPointerDomain& domain)
+            : record_(domain.acquire_record()) {}
+
+        ~Guard() {
+            for (auto& hazard : record_->hazards) {
+                hazard.store(nullptr, std::memory_order_release);
+            }
+            record_->in_use.store(false, std::memory_order_release);
+        }
+
+        Guard(const Guard&) = delete;
+        Guard& operator=(const Guard&) = delete;
+
+        /**
+         * @brief Load a pointer and publish it as hazardous.
+         *
+         * Loops until the published value matches the source, so the node
+         * cannot have been retired between the load and the publication.
+         *
+         * @param slot Hazard slot to use (< SLOTS_PER_RECORD)
+         * @param source Atomic pointer to protect
+         * @return Node* The protected pointer
+         */
+        Node* protect(size_t slot, const std::atomic<Node*>& source) {
+            Node* p = source.load(std::memory_order_relaxed);
+            while (true) {
+                record_->hazards[slot].store(p, std::memory_order_seq_cst);
+                Node* again = source.load(std::memory_order_seq_cst);
+                if (again == p) {
+                    return p;
+                }
+                p = again;
+            }
+        }
+
+        /**
+         * @brief Publish an already loaded pointer as hazardous.
+         *
+         * The caller must re-validate the pointer after this call.
+         */
+        void set(size_t slot, Node* p) {
+            record_->hazards[slot].store(p, std::memory_order_seq_cst);
+        }
+
+        /**
+         * @brief Clear a hazard slot.
+         */
+        void clear(size_t slot) {
+            record_->hazards[slot].store(nullptr, std::memory_order_release);
+        }
+
+    private:
+        Record* record_;
+    };
+
+    explicit HazardPointerDomain(Reclaimer reclaimer = Reclaimer())
+        : reclaimer_(std::move(reclaimer)) {}
+
+    /**
+     * @brief Reclaim everything still retired.
+     *
+     * The owning data structure must guarantee no thread is still
+     * operating on it.
+     */
+    ~HazardPointerDomain() {
+        Node* node = retired_head_.exchange(nullptr, std::memory_order_acquire);
+        while (node != nullptr) {
+            Node* next = node->retired_next;
+            reclaimer_(node);
+            node = next;
+        }
+    }
+
+    HazardPointerDomain(const HazardPointerDomain&) = delete;
+    HazardPointerDomain& operator=(const HazardPointerDomain&) = delete;
+
+    /**
+     * @brief Hand over an unlinked node for deferred reclamation.
+     *
+     * @param node Node that is no longer reachable from the data structure
+     */
+    void retire(Node* node) {
+        push_retired(node);
+        if (retired_count_.fetch_add(1, std::memory_order_relaxed) + 1 >= SCAN_THRESHOLD) {
+            scan();
+        }
+    }
+
+    /**
+     * @brief Get the number of retired nodes not yet reclaimed.
+     */
+    size_t retired_count() const {
+        return retired_count_.load(std::memory_order_relaxed);
+    }
+
+private:
+    Record* acquire_record() {
+        // Start where this thread last found a free record
+        thread_local size_t hint = std::hash<std::thread::id>{}(std::this_thread::get_id());
+        while (true) {
+            for (size_t i = 0; i < MAX_RECORDS; ++i) {
+                Record& record = records_[(hint + i) % MAX_RECORDS];
+                if (!record.in_use.load(std::memory_order_relaxed) &&
+                    !record.in_use.exchange(true, std::memory_order_acquire)) {
+                    hint = (hint + i) % MAX_RECORDS;
+                    return &record;
+                }
+            }
+            // More concurrent operations than records - wait for one to finish
+            std::this_thread::yield();
+        }
+    }
+
+    void push_retired(Node* node) {
+        Node* head = retired_head_.load(std::memory_order_relaxed);
+        do {
+            node->retired_next = head;
+        } while (!retired_head_.compare_exchange_weak(head, node, std::memory_order_release,
+                                                      std::memory_order_relaxed));
+    }
+
+    void scan() {
+        // One scanner at a time; others keep retiring meanwhile
+        if (!scan_lock_.try_lock()) {
+            return;
+        }
+
+        Node* list = retired_head_.exchange(nullptr, std::memory_order_acquire);
+
+        // Snapshot every published hazard
+        Node* hazards[MAX_RECORDS * SLOTS_PER_RECORD];
+        size_t hazard_count = 0;
+        for (auto& record : records_) {
+            for (auto& hazard : record.hazards) {
+                Node* p = hazard.load(std::memory_order_seq_cst);
+                if (p != nullptr) {
+                    hazards[hazard_count++] = p;
+                }
+            }
+        }
+        std::sort(hazards, hazards + hazard_count);
+
+        // Reclaim what no one protects, keep the rest for a later scan
+        size_t reclaimed = 0;
+        while (list != nullptr) {
+            Node* next = list->retired_next;
+            if (std::binary_search(hazards, hazards + hazard_count, list)) {
+                push_retired(list);
+            } else {
+                reclaimer_(list);
+                ++reclaimed;
+            }
+            list = next;
+        }
+        retired_count_.fetch_sub(reclaimed, std::memory_order_relaxed);
+
+        scan_lock_.unlock();
+    }
+
+    Record records_[MAX_RECORDS];
+    Reclaimer reclaimer_;
+
+    alignas(64) std::atomic<Node*> retired_head_{nullptr};
+    std::atomic<size_t> retired_count_{0};
+    SpinLock scan_lock_;
+};
+
+} // namespace trading
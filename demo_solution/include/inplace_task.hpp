@@ -0,0 +1,136 @@
+#pragma once
+
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+/**
+ * @file inplace_task.hpp
+ * @brief Move-only callable with a fixed inline buffer (Week 3).
+ *
+ * std::function may heap-allocate its target and requires it to be
+ * copyable. InplaceTask stores the callable inside the task object itself,
+ * never allocates, and accepts move-only targets such as
+ * std::packaged_task. Callables that don't fit are rejected at compile
+ * time rather than silently boxed.
+ */
+
+namespace trading {
+
+/**
+ * @brief Type-erased `void()` callable stored in a BUFFER_SIZE inline buffer.
+ */
+class InplaceTask {
+public:
+    static constexpr size_t BUFFER_SIZE = 64;
+
+    /**
+     * @brief Whether a callable of type F can be stored inline.
+     */
+    template<typename F>
+    static constexpr bool fits =
+        sizeof(F) <= BUFFER_SIZE &&
+        alignof(F) <= alignof(std::max_align_t) &&
+        std::is_nothrow_move_constructible<F>::value;
+
+    InplaceTask() noexcept : ops_(nullptr) {}
+
+    /**
+     * @brief Store a callable inline.
+     *
+     * @tparam F Callable type, invocable as `void()`
+     * @param f Callable to store
+     */
+    template<typename F,
+             typename Fn = std::decay_t<F>,
+             typename = std::enable_if_t<!std::is_same<Fn, InplaceTask>::value>>
+    InplaceTask(F&& f) : ops_(&OpsFor<Fn>::ops) {
+        static_assert(fits<Fn>,
+                      "Callable too large for InplaceTask: capture less, or capture a pointer to the state");
+        static_assert(std::is_invocable<Fn&>::value, "InplaceTask requires a callable taking no arguments");
+        new (buffer_) Fn(std::forward<F>(f));
+    }
+
+    InplaceTask(InplaceTask&& other) noexcept : ops_(other.ops_) {
+        if (ops_ != nullptr) {
+            ops_->move(other.buffer_, buffer_);
+            other.ops_ = nullptr;
+        }
+    }
+
+    InplaceTask& operator=(InplaceTask&& other) noexcept {
+        if (this != &other) {
+            reset();
+            ops_ = other.ops_;
+            if (ops_ != nullptr) {
+                ops_->move(other.buffer_, buffer_);
+                other.ops_ = nullptr;
+            }
+        }
+        return *this;
+    }
+
+    InplaceTask(const InplaceTask&) = delete;
+    InplaceTask& operator=(const InplaceTask&) = delete;
+
+    ~InplaceTask() {
+        reset();
+    }
+
+    /**
+     * @brief Invoke the stored callable.
+     */
+    void operator()() {
+        ops_->invoke(buffer_);
+    }
+
+    /**
+     * @brief Check whether a callable is stored.
+     */
+    explicit operator bool() const noexcept {
+        return ops_ != nullptr;
+    }
+
+    /**
+     * @brief Destroy the stored callable, leaving the task empty.
+     */
+    void reset() noexcept {
+        if (ops_ != nullptr) {
+            ops_->destroy(buffer_);
+            ops_ = nullptr;
+        }
+    }
+
+private:
+    // Per-type operations, one static table per stored callable type
+    struct Ops {
+        void (*invoke)(void* self);
+        void (*move)(void* from, void* to) noexcept;
+        void (*destroy)(void* self) noexcept;
+    };
+
+    template<typename Fn>
+    struct OpsFor {
+        static void invoke(void* self) {
+            (*std::launder(static_cast<Fn*>(self)))();
+        }
+
+        static void move(void* from, void* to) noexcept {
+            Fn* source = std::launder(static_cast<Fn*>(from));
+            new (to) Fn(std::move(*source));
+            source->~Fn();
+        }
+
+        static void destroy(void* self) noexcept {
+            std::launder(static_cast<Fn*>(self))->~Fn();
+        }
+
+        static constexpr Ops ops = {&invoke, &move, &destroy};
+    };
+
+    alignas(std::max_align_t) unsigned char buffer_[BUFFER_SIZE];
+    const Ops* ops_;
+};
+
+} // namespace trading
@@ -0,0 +1,243 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <shared_mutex>
+#include <span>
+#include <string>
+
+#include "latency_histogram.hpp"
+#include "spin_lock.hpp"
+
+/**
+ * @file instrumented_lock.hpp
+ * @brief Lock wrappers that measure real contention (Week 3).
+ *
+ * Every acquisition tries try_lock() first. Only when that fails is the
+ * acquisition counted as contended, and the time until the lock is finally
+ * obtained is measured with the TSC and booked as wait time. Exclusive
+ * holds also feed a hold-time histogram. With TRADING_LOCK_INSTRUMENTATION
+ * set to 0 the wrappers forward straight to the underlying lock.
+ */
+
+// 1: count contention and measure wait/hold times, 0: plain locks
+#ifndef TRADING_LOCK_INSTRUMENTATION
+#define TRADING_LOCK_INSTRUMENTATION 1
+#endif
+
+namespace trading {
+
+constexpr bool LOCK_INSTRUMENTATION = TRADING_LOCK_INSTRUMENTATION != 0;
+
+/**
+ * @brief Cheap cycle counter for timing lock waits and holds.
+ *
+ * Reads the TSC on x86 (a few ns, no serialization) and falls back to
+ * steady_clock elsewhere. Ticks are converted to nanoseconds only when
+ * reporting, calibrated against steady_clock from the first report on.
+ */
+class TscClock {
+public:
+    static uint64_t now() {
+#if defined(__x86_64__) || defined(__i386__)
+        return __rdtsc();
+#else
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count());
+#endif
+    }
+
+    /**
+     * @brief Nanoseconds per tick, measured since the first call.
+     *
+     * @return double Conversion factor from ticks to nanoseconds
+     */
+    static double ns_per_tick() {
+        static const Anchor anchor;
+
+        // Make sure the calibration interval is long enough to be meaningful
+        auto steady = std::chrono::steady_clock::now();
+        while (steady - anchor.steady < std::chrono::milliseconds(1)) {
+            cpu_relax();
+            steady = std::chrono::steady_clock::now();
+        }
+        uint64_t ticks = now() - anchor.ticks;
+        double ns = std::chrono::duration<double, std::nano>(steady - anchor.steady).count();
+        return ticks == 0 ? 1.0 : ns / static_cast<double>(ticks);
+    }
+
+private:
+    struct Anchor {
+        uint64_t ticks = now();
+        std::chrono::steady_clock::time_point steady = std::chrono::steady_clock::now();
+    };
+};
+
+/**
+ * @brief Report for one lock (or a group of lock stripes).
+ */
+struct LockStatsResult {
+    std::string name;
+    uint64_t acquisitions{0};  // Exclusive and shared
+    uint64_t contentions{0};   // Acquisitions whose try_lock failed
+    uint64_t wait_time_ns{0};  // Time spent blocked after a failed try_lock
+    LatencySummary hold_time;  // Exclusive holds only
+};
+
+/**
+ * @brief Live counters of one lock; updated with relaxed atomics.
+ */
+struct LockStats {
+    std::atomic<uint64_t> acquisitions{0};
+    std::atomic<uint64_t> contentions{0};
+    std::atomic<uint64_t> wait_ticks{0};
+    LatencyHistogram hold_ticks;
+
+    /**
+     * @brief Merge the stats of several locks into one report.
+     *
+     * @param name Name for the report
+     * @param stats Locks to merge
+     * @return LockStatsResult Counts and times in nanoseconds/microseconds
+     */
+    static LockStatsResult summarize(std::string name, std::span<const LockStats* const> stats) {
+        LockStatsResult result;
+        result.name = std::move(name);
+
+        uint64_t wait_ticks = 0;
+        LatencySnapshot hold;
+        for (const LockStats* lock : stats) {
+            result.acquisitions += lock->acquisitions.load(std::memory_order_relaxed);
+            result.contentions += lock->contentions.load(std::memory_order_relaxed);
+            wait_ticks += lock->wait_ticks.load(std::memory_order_relaxed);
+            hold.merge(lock->hold_ticks);
+        }
+        if (result.acquisitions == 0) {
+            return result;
+        }
+
+        // The histogram counted ticks; rescale its summary to real time
+        double scale = TscClock::ns_per_tick();
+        result.wait_time_ns = static_cast<uint64_t>(static_cast<double>(wait_ticks) * scale);
+        result.hold_time = hold.summary();
+        result.hold_time.mean_us *= scale;
+        result.hold_time.p50_us *= scale;
+        result.hold_time.p99_us *= scale;
+        result.hold_time.p999_us *= scale;
+        result.hold_time.max_us *= scale;
+        return result;
+    }
+
+    /**
+     * @brief Report a single lock.
+     *
+     * @param name Name for the report
+     * @return LockStatsResult Counts and times
+     */
+    LockStatsResult summarize(std::string name) const {
+        const LockStats* self = this;
+        return summarize(std::move(name), std::span<const LockStats* const>(&self, 1));
+    }
+};
+
+/**
+ * @brief Lockable wrapper that records contention, wait and hold times.
+ *
+ * Satisfies Lockable (and SharedLockable when Mutex does), so it works with
+ * std::lock_guard, std::unique_lock, std::shared_lock and
+ * std::condition_variable_any.
+ *
+ * @tparam Mutex Underlying lock type
+ */
+template<typename Mutex>
+class InstrumentedLock {
+public:
+    InstrumentedLock() = default;
+    InstrumentedLock(const InstrumentedLock&) = delete;
+    InstrumentedLock& operator=(const InstrumentedLock&) = delete;
+
+    void lock() {
+        if constexpr (LOCK_INSTRUMENTATION) {
+            if (!mutex_.try_lock()) {
+                uint64_t start = TscClock::now();
+                mutex_.lock();
+                stats_.contentions.fetch_add(1, std::memory_order_relaxed);
+                stats_.wait_ticks.fetch_add(TscClock::now() - start, std::memory_order_relaxed);
+            }
+            stats_.acquisitions.fetch_add(1, std::memory_order_relaxed);
+            acquired_at_ = TscClock::now();
+        } else {
+            mutex_.lock();
+        }
+    }
+
+    bool try_lock() {
+        // A failed try_lock by the caller is a choice, not contention
+        if (!mutex_.try_lock()) {
+            return false;
+        }
+        if constexpr (LOCK_INSTRUMENTATION) {
+            stats_.acquisitions.fetch_add(1, std::memory_order_relaxed);
+            acquired_at_ = TscClock::now();
+        }
+        return true;
+    }
+
+    void unlock() {
+        if constexpr (LOCK_INSTRUMENTATION) {
+            // Still holding the lock, so the histogram is only touched by its owner
+            stats_.hold_ticks.record(TscClock::now() - acquired_at_);
+        }
+        mutex_.unlock();
+    }
+
+    void lock_shared() requires requires(Mutex& m) { m.lock_shared(); } {
+        if constexpr (LOCK_INSTRUMENTATION) {
+            if (!mutex_.try_lock_shared()) {
+                uint64_t start = TscClock::now();
+                mutex_.lock_shared();
+                stats_.contentions.fetch_add(1, std::memory_order_relaxed);
+                stats_.wait_ticks.fetch_add(TscClock::now() - start, std::memory_order_relaxed);
+            }
+            stats_.acquisitions.fetch_add(1, std::memory_order_relaxed);
+        } else {
+            mutex_.lock_shared();
+        }
+    }
+
+    bool try_lock_shared() requires requires(Mutex& m) { m.try_lock_shared(); } {
+        if (!mutex_.try_lock_shared()) {
+            return false;
+        }
+        if constexpr (LOCK_INSTRUMENTATION) {
+            stats_.acquisitions.fetch_add(1, std::memory_order_relaxed);
+        }
+        return true;
+    }
+
+    void unlock_shared() requires requires(Mutex& m) { m.unlock_shared(); } {
+        mutex_.unlock_shared();
+    }
+
+    /**
+     * @brief Get the lock's live statistics.
+     *
+     * @return const LockStats& Counters and hold-time histogram
+     */
+    const LockStats& stats() const {
+        return stats_;
+    }
+
+private:
+    Mutex mutex_;
+    uint64_t acquired_at_ = 0;  // Written and read by the exclusive owner only
+    LockStats stats_;
+};
+
+using InstrumentedMutex = InstrumentedLock<std::mutex>;
+using InstrumentedSharedMutex = InstrumentedLock<std::shared_mutex>;
+using InstrumentedSpinLock = InstrumentedLock<SpinLock>;
+
+} // namespace trading
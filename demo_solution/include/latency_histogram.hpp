@@ -0,0 +1,277 @@
+#pragma once
+
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+/**
+ * @file latency_histogram.hpp
+ * @brief Lock-free log-linear (HDR-style) latency histogram (Week 3).
+ *
+ * Recording a sample is a handful of relaxed atomic adds into a fixed
+ * bucket array: no lock, no allocation, no sorting. Buckets are linear
+ * within each power of two, so every recorded value is reproduced within
+ * 1 / SUB_BUCKET_COUNT (about 3%) relative error from 1 ns up to about a
+ * minute. Histograms kept per thread merge by adding their buckets.
+ */
+
+namespace trading {
+
+/**
+ * @brief Percentiles of a latency distribution, in microseconds.
+ */
+struct LatencySummary {
+    uint64_t count{0};
+    double mean_us{0.0};
+    double p50_us{0.0};
+    double p99_us{0.0};
+    double p999_us{0.0};
+    double max_us{0.0};
+};
+
+/**
+ * @brief Bucket layout shared by LatencyHistogram and LatencySnapshot.
+ *
+ * Values below 2 * SUB_BUCKET_COUNT get one bucket each. Above that,
+ * every power of two [2^k, 2^(k+1)) is split into SUB_BUCKET_COUNT equal
+ * buckets.
+ */
+struct LatencyBuckets {
+    static constexpr unsigned SUB_BUCKET_BITS = 5;
+    static constexpr uint64_t SUB_BUCKET_COUNT = uint64_t(1) << SUB_BUCKET_BITS;
+    static constexpr unsigned VALUE_BITS = 36;  // Largest tracked value ~68.7 s in ns
+    static constexpr uint64_t MAX_VALUE = (uint64_t(1) << VALUE_BITS) - 1;
+    static constexpr size_t BUCKET_COUNT =
+        2 * SUB_BUCKET_COUNT + (VALUE_BITS - SUB_BUCKET_BITS - 1) * SUB_BUCKET_COUNT;
+
+    /**
+     * @brief Map a value onto its bucket; values above MAX_VALUE share the last one.
+     *
+     * @param value Value in nanoseconds
+     * @return size_t Bucket index
+     */
+    static size_t index(uint64_t value) {
+        if (value > MAX_VALUE) {
+            value = MAX_VALUE;
+        }
+        if (value < 2 * SUB_BUCKET_COUNT) {
+            return static_cast<size_t>(value);
+        }
+        unsigned msb = static_cast<unsigned>(std::bit_width(value)) - 1;
+        unsigned shift = msb - SUB_BUCKET_BITS;
+        return static_cast<size_t>(2 * SUB_BUCKET_COUNT + (shift - 1) * SUB_BUCKET_COUNT +
+                                   ((value >> shift) - SUB_BUCKET_COUNT));
+    }
+
+    /**
+     * @brief Largest value that maps onto a bucket.
+     *
+     * @param index Bucket index
+     * @return uint64_t Highest equivalent value in nanoseconds
+     */
+    static uint64_t highest_value(size_t index) {
+        if (index < 2 * SUB_BUCKET_COUNT) {
+            return index;
+        }
+        uint64_t shift = (index - 2 * SUB_BUCKET_COUNT) / SUB_BUCKET_COUNT + 1;
+        uint64_t sub = (index - 2 * SUB_BUCKET_COUNT) % SUB_BUCKET_COUNT + SUB_BUCKET_COUNT;
+        return ((sub + 1) << shift) - 1;
+    }
+};
+
+class LatencyHistogram;
+
+/**
+ * @brief Plain (non-atomic) copy of one or more histograms, for reporting.
+ */
+class LatencySnapshot {
+public:
+    LatencySnapshot() : counts_(LatencyBuckets::BUCKET_COUNT, 0) {}
+
+    /**
+     * @brief Add a live histogram's samples to the snapshot.
+     *
+     * Safe while the histogram is being recorded into; samples recorded
+     * concurrently may or may not be included.
+     *
+     * @param histogram Histogram to merge
+     */
+    void merge(const LatencyHistogram& histogram);
+
+    /**
+     * @brief Value at a percentile, reported as its bucket's highest value.
+     *
+     * @param percentile Percentile in [0, 100]
+     * @return uint64_t Latency in nanoseconds (0 if empty)
+     */
+    uint64_t value_at_percentile(double percentile) const {
+        if (count_ == 0) {
+            return 0;
+        }
+        uint64_t rank = static_cast<uint64_t>(percentile / 100.0 * static_cast<double>(count_) + 0.5);
+        if (rank == 0) {
+            rank = 1;
+        }
+        uint64_t seen = 0;
+        for (size_t i = 0; i < counts_.size(); ++i) {
+            seen += counts_[i];
+            if (seen >= rank) {
+                uint64_t value = LatencyBuckets::highest_value(i);
+                return value < max_ ? value : max_;
+            }
+        }
+        return max_;
+    }
+
+    /**
+     * @brief Get the number of samples.
+     *
+     * @return uint64_t Number of samples
+     */
+    uint64_t count() const {
+        return count_;
+    }
+
+    /**
+     * @brief Get the smallest sample.
+     *
+     * @return uint64_t Minimum in nanoseconds (0 if empty)
+     */
+    uint64_t min() const {
+        return count_ == 0 ? 0 : min_;
+    }
+
+    /**
+     * @brief Get the largest sample (exact, not bucketed).
+     *
+     * @return uint64_t Maximum in nanoseconds
+     */
+    uint64_t max() const {
+        return max_;
+    }
+
+    /**
+     * @brief Get the mean of the samples.
+     *
+     * @return double Mean in nanoseconds (0 if empty)
+     */
+    double mean() const {
+        return count_ == 0 ? 0.0 : static_cast<double>(sum_) / static_cast<double>(count_);
+    }
+
+    /**
+     * @brief Summarize as p50/p99/p99.9/max.
+     *
+     * @return LatencySummary Summary in microseconds
+     */
+    LatencySummary summary() const {
+        LatencySummary result;
+        result.count = count_;
+        result.mean_us = mean() / 1000.0;
+        result.p50_us = value_at_percentile(50.0) / 1000.0;
+        result.p99_us = value_at_percentile(99.0) / 1000.0;
+        result.p999_us = value_at_percentile(99.9) / 1000.0;
+        result.max_us = max_ / 1000.0;
+        return result;
+    }
+
+private:
+    std::vector<uint64_t> counts_;
+    uint64_t count_{0};
+    uint64_t sum_{0};
+    uint64_t min_{std::numeric_limits<uint64_t>::max()};
+    uint64_t max_{0};
+};
+
+/**
+ * @brief Lock-free latency histogram.
+ *
+ * Any number of threads may record concurrently, but each thread (or
+ * shard) should have its own histogram so the bucket counters stay in
+ * that core's cache; merge them with LatencySnapshot::merge() when
+ * reporting.
+ */
+class LatencyHistogram {
+public:
+    LatencyHistogram() : counts_(new std::atomic<uint64_t>[LatencyBuckets::BUCKET_COUNT]) {
+        for (size_t i = 0; i < LatencyBuckets::BUCKET_COUNT; ++i) {
+            counts_[i].store(0, std::memory_order_relaxed);
+        }
+    }
+
+    ~LatencyHistogram() {
+        delete[] counts_;
+    }
+
+    LatencyHistogram(const LatencyHistogram&) = delete;
+    LatencyHistogram& operator=(const LatencyHistogram&) = delete;
+
+    /**
+     * @brief Record samples of one value.
+     *
+     * @param value_ns Latency in nanoseconds
+     * @param count Number of samples with this value (e.g. the per-update
+     *        average of a batch, recorded once for the whole batch)
+     */
+    void record(uint64_t value_ns, uint64_t count = 1) {
+        counts_[LatencyBuckets::index(value_ns)].fetch_add(count, std::memory_order_relaxed);
+        count_.fetch_add(count, std::memory_order_relaxed);
+        sum_.fetch_add(value_ns * count, std::memory_order_relaxed);
+
+        uint64_t current = max_.load(std::memory_order_relaxed);
+        while (value_ns > current &&
+               !max_.compare_exchange_weak(current, value_ns, std::memory_order_relaxed)) {
+        }
+        current = min_.load(std::memory_order_relaxed);
+        while (value_ns < current &&
+               !min_.compare_exchange_weak(current, value_ns, std::memory_order_relaxed)) {
+        }
+    }
+
+    /**
+     * @brief Get the number of samples recorded.
+     *
+     * @return uint64_t Number of samples
+     */
+    uint64_t count() const {
+        return count_.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Copy the histogram into a snapshot.
+     *
+     * @return LatencySnapshot Snapshot with this histogram's samples
+     */
+    LatencySnapshot snapshot() const {
+        LatencySnapshot result;
+        result.merge(*this);
+        return result;
+    }
+
+private:
+    friend class LatencySnapshot;
+
+    std::atomic<uint64_t>* counts_;
+    std::atomic<uint64_t> count_{0};
+    std::atomic<uint64_t> sum_{0};
+    std::atomic<uint64_t> min_{std::numeric_limits<uint64_t>::max()};
+    std::atomic<uint64_t> max_{0};
+};
+
+inline void LatencySnapshot::merge(const LatencyHistogram& histogram) {
+    for (size_t i = 0; i < counts_.size(); ++i) {
+        counts_[i] += histogram.counts_[i].load(std::memory_order_relaxed);
+    }
+    count_ += histogram.count_.load(std::memory_order_relaxed);
+    sum_ += histogram.sum_.load(std::memory_order_relaxed);
+
+    uint64_t min = histogram.min_.load(std::memory_order_relaxed);
+    uint64_t max = histogram.max_.load(std::memory_order_relaxed);
+    min_ = min < min_ ? min : min_;
+    max_ = max > max_ ? max : max_;
+}
+
+} // namespace trading
@@ -0,0 +1,189 @@
+#pragma once
+
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+
+#if defined(__AVX2__) || defined(__SSE4_2__)
+#include <immintrin.h>
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#endif
+
+/**
+ * @file level_search.hpp
+ * @brief SIMD search and sum kernels over struct-of-arrays book levels (Week 3).
+ *
+ * A book side keeps its prices in one contiguous int64 array, sorted
+ * best first. Because the array is sorted, the insert position of a price
+ * is simply the number of levels that rank ahead of it, and that count is
+ * a vector compare plus a popcount. Each step covers LEVEL_SEARCH_LANES
+ * prices: two compares of 4 with AVX2, four compares of 2 with SSE4.2 or
+ * NEON. The scan stops at the first step that is not all matches.
+ *
+ * The implementation is chosen at compile time: AVX2, then SSE4.2, then
+ * AArch64 NEON, then a scalar loop. Configure with
+ * -DTRADING_ENABLE_NATIVE=ON to build for the host's instruction set.
+ *
+ * Callers pad the price array to a multiple of LEVEL_SEARCH_LANES with a
+ * value that never matches (see PriceLevelSide), so no step needs a tail.
+ */
+
+namespace trading {
+
+constexpr size_t LEVEL_SEARCH_LANES = 8;  // Prices examined per step
+
+#if defined(__AVX2__)
+constexpr const char* LEVEL_SEARCH_ISA = "AVX2";
+#elif defined(__SSE4_2__)
+constexpr const char* LEVEL_SEARCH_ISA = "SSE4.2";
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+constexpr const char* LEVEL_SEARCH_ISA = "NEON";
+#else
+constexpr const char* LEVEL_SEARCH_ISA = "scalar";
+#endif
+
+/**
+ * @brief Count the leading prices greater than a value.
+ *
+ * @param prices Prices sorted descending, padded to a multiple of LEVEL_SEARCH_LANES
+ * @param size Number of real prices
+ * @param value Value to compare against
+ * @return size_t Number of prices > value, which is where value would be inserted
+ */
+inline size_t count_greater(const int64_t* prices, size_t size, int64_t value) {
+    size_t count = 0;
+#if defined(__AVX2__)
+    const __m256i needle = _mm256_set1_epi64x(value);
+    for (size_t i = 0; i < size; i += LEVEL_SEARCH_LANES) {
+        __m256i lo = _mm256_cmpgt_epi64(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(prices + i)), needle);
+        __m256i hi = _mm256_cmpgt_epi64(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(prices + i + 4)), needle);
+        unsigned mask = static_cast<unsigned>(_mm256_movemask_pd(_mm256_castsi256_pd(lo)))
+                      | static_cast<unsigned>(_mm256_movemask_pd(_mm256_castsi256_pd(hi))) << 4;
+        count += static_cast<size_t>(std::popcount(mask));
+        if (mask != 0xFF) {
+            break;
+        }
+    }
+#elif defined(__SSE4_2__)
+    const __m128i needle = _mm_set1_epi64x(value);
+    for (size_t i = 0; i < size; i += LEVEL_SEARCH_LANES) {
+        unsigned mask = 0;
+        for (size_t j = 0; j < LEVEL_SEARCH_LANES; j += 2) {
+            __m128i gt = _mm_cmpgt_epi64(_mm_loadu_si128(reinterpret_cast<const __m128i*>(prices + i + j)), needle);
+            mask |= static_cast<unsigned>(_mm_movemask_pd(_mm_castsi128_pd(gt))) << j;
+        }
+        count += static_cast<size_t>(std::popcount(mask));
+        if (mask != 0xFF) {
+            break;
+        }
+    }
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+    const int64x2_t needle = vdupq_n_s64(value);
+    for (size_t i = 0; i < size; i += LEVEL_SEARCH_LANES) {
+        // Each matching lane is all ones, i.e. -1: subtracting counts it
+        int64x2_t hits = vdupq_n_s64(0);
+        for (size_t j = 0; j < LEVEL_SEARCH_LANES; j += 2) {
+            hits = vsubq_s64(hits, vreinterpretq_s64_u64(vcgtq_s64(vld1q_s64(prices + i + j), needle)));
+        }
+        size_t step = static_cast<size_t>(vaddvq_s64(hits));
+        count += step;
+        if (step != LEVEL_SEARCH_LANES) {
+            break;
+        }
+    }
+#else
+    while (count < size && prices[count] > value) {
+        ++count;
+    }
+#endif
+    return count < size ? count : size;
+}
+
+/**
+ * @brief Count the leading prices less than a value.
+ *
+ * @param prices Prices sorted ascending, padded to a multiple of LEVEL_SEARCH_LANES
+ * @param size Number of real prices
+ * @param value Value to compare against
+ * @return size_t Number of prices < value, which is where value would be inserted
+ */
+inline size_t count_less(const int64_t* prices, size_t size, int64_t value) {
+    size_t count = 0;
+#if defined(__AVX2__)
+    const __m256i needle = _mm256_set1_epi64x(value);
+    for (size_t i = 0; i < size; i += LEVEL_SEARCH_LANES) {
+        __m256i lo = _mm256_cmpgt_epi64(needle, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(prices + i)));
+        __m256i hi = _mm256_cmpgt_epi64(needle, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(prices + i + 4)));
+        unsigned mask = static_cast<unsigned>(_mm256_movemask_pd(_mm256_castsi256_pd(lo)))
+                      | static_cast<unsigned>(_mm256_movemask_pd(_mm256_castsi256_pd(hi))) << 4;
+        count += static_cast<size_t>(std::popcount(mask));
+        if (mask != 0xFF) {
+            break;
+        }
+    }
+#elif defined(__SSE4_2__)
+    const __m128i needle = _mm_set1_epi64x(value);
+    for (size_t i = 0; i < size; i += LEVEL_SEARCH_LANES) {
+        unsigned mask = 0;
+        for (size_t j = 0; j < LEVEL_SEARCH_LANES; j += 2) {
+            __m128i lt = _mm_cmpgt_epi64(needle, _mm_loadu_si128(reinterpret_cast<const __m128i*>(prices + i + j)));
+            mask |= static_cast<unsigned>(_mm_movemask_pd(_mm_castsi128_pd(lt))) << j;
+        }
+        count += static_cast<size_t>(std::popcount(mask));
+        if (mask != 0xFF) {
+            break;
+        }
+    }
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+    const int64x2_t needle = vdupq_n_s64(value);
+    for (size_t i = 0; i < size; i += LEVEL_SEARCH_LANES) {
+        int64x2_t hits = vdupq_n_s64(0);
+        for (size_t j = 0; j < LEVEL_SEARCH_LANES; j += 2) {
+            hits = vsubq_s64(hits, vreinterpretq_s64_u64(vcltq_s64(vld1q_s64(prices + i + j), needle)));
+        }
+        size_t step = static_cast<size_t>(vaddvq_s64(hits));
+        count += step;
+        if (step != LEVEL_SEARCH_LANES) {
+            break;
+        }
+    }
+#else
+    while (count < size && prices[count] < value) {
+        ++count;
+    }
+#endif
+    return count < size ? count : size;
+}
+
+/**
+ * @brief Sum the first volumes of a side.
+ *
+ * @param volumes Volumes, best level first, padded to a multiple of LEVEL_SEARCH_LANES
+ * @param count Number of leading volumes to add
+ * @return int64_t Their sum, without int32 overflow
+ */
+inline int64_t sum_volumes(const int32_t* volumes, size_t count) {
+#if defined(__AVX2__)
+    // Widen to 64-bit lanes so deep books can't overflow
+    __m256i sum = _mm256_setzero_si256();
+    const __m256i lane = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+    for (size_t i = 0; i < count; i += LEVEL_SEARCH_LANES) {
+        __m256i keep = _mm256_cmpgt_epi32(_mm256_set1_epi32(static_cast<int>(count - i)), lane);
+        __m256i v = _mm256_and_si256(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(volumes + i)), keep);
+        sum = _mm256_add_epi64(sum, _mm256_cvtepi32_epi64(_mm256_castsi256_si128(v)));
+        sum = _mm256_add_epi64(sum, _mm256_cvtepi32_epi64(_mm256_extracti128_si256(v, 1)));
+    }
+    alignas(32) int64_t lanes[4];
+    _mm256_store_si256(reinterpret_cast<__m256i*>(lanes), sum);
+    return lanes[0] + lanes[1] + lanes[2] + lanes[3];
+#else
+    int64_t total = 0;
+    for (size_t i = 0; i < count; ++i) {
+        total += volumes[i];
+    }
+    return total;
+#endif
+}
+
+} // namespace trading
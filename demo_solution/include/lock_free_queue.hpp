@@ -2,229 +2,373 @@
 
 #include <atomic>
 #include <memory>
-#include <iostream>
+#include <new>
+#include <utility>
+
+#include "hazard_pointer.hpp"
+#include "logger.hpp"
 
 /**
  * @file lock_free_queue.hpp
  * @brief Lock-free queue implementation for high-performance messaging (Week 3).
- * 
+ *
  * This file demonstrates concurrent programming optimizations from Week 3.
  * Key optimizations include:
  * - Lock-free algorithm to minimize contention
  * - Memory ordering optimizations
  * - Cache-friendly data structures
+ * - Hazard pointers for safe node reclamation with many consumers
+ *
+ * See mpmc_bounded_queue.hpp for a bounded variant that never allocates.
  */
 
 namespace trading {
 
 /**
  * @brief A lock-free queue implementation for high-performance concurrent access.
- * 
+ *
  * This class represents the Week 3 implementation of a lock-free queue
  * that allows multiple threads to safely push and pop elements without
  * explicit locking. Key features include:
- * 1. Wait-free enqueue operations
- * 2. Lock-free dequeue operations
- * 3. ABA problem prevention
- * 4. Memory reclamation for removed nodes
- * 
+ * 1. Lock-free enqueue and dequeue (Michael-Scott algorithm)
+ * 2. ABA problem prevention: a node is never reused while any thread
+ *    still holds a hazard pointer to it
+ * 3. Memory reclamation for removed nodes through hazard pointers, so a
+ *    concurrent dequeuer can never touch a freed node
+ * 4. Bulk operations that amortize the atomic operations per element
+ *
+ * Elements are stored inline in the nodes, and nodes are obtained from
+ * `Allocator`, so passing a week2::PoolAllocator keeps enqueue/dequeue off
+ * the system allocator.
+ *
  * @tparam T Type of elements stored in the queue
+ * @tparam Allocator Allocator used for nodes
  */
-template<typename T>
+template<typename T, typename Allocator = std::allocator<T>>
 class LockFreeQueue {
 private:
     /**
      * @brief Node structure for the lock-free queue.
+     *
+     * The value is constructed in place on enqueue and moved out by the
+     * single dequeuer that wins the head CAS. The dummy node at the head
+     * never holds a live value.
      */
     struct Node {
-        std::shared_ptr<T> data;
+        alignas(T) unsigned char storage[sizeof(T)];
         std::atomic<Node*> next;
-        
-        Node() : next(nullptr) {}
+        Node* retired_next; // Link in the hazard pointer retired list
+
+        Node() : next(nullptr), retired_next(nullptr) {}
+
+        T* value() {
+            return std::launder(reinterpret_cast<T*>(storage));
+        }
+    };
+
+    using NodeAllocator = typename std::allocator_traits<Allocator>::template rebind_alloc<Node>;
+    using NodeTraits = std::allocator_traits<NodeAllocator>;
+
+    /**
+     * @brief Returns retired nodes to the node allocator.
+     */
+    struct NodeReclaimer {
+        LockFreeQueue* queue;
+
+        void operator()(Node* node) const {
+            queue->delete_node(node);
+        }
     };
-    
-    // Head and tail pointers
-    std::atomic<Node*> head_;
-    std::atomic<Node*> tail_;
-    
+
+    // Allocator for nodes
+    NodeAllocator node_allocator_;
+
+    // Head and tail pointers, on separate cache lines
+    alignas(64) std::atomic<Node*> head_;
+    alignas(64) std::atomic<Node*> tail_;
+
     // Statistics for monitoring
-    std::atomic<size_t> size_;
+    alignas(64) std::atomic<size_t> size_;
     std::atomic<size_t> total_enqueued_;
     std::atomic<size_t> total_dequeued_;
-    
-    // Logging control
+
+    // Logging control: emit a DEBUG record for every operation
     bool verbose_logging_;
-    
+
+    // Safe memory reclamation (declared last: reclaims before the allocator goes away)
+    HazardPointerDomain<Node, NodeReclaimer> hazards_;
+
     // Deleted copy and assignment operators
     LockFreeQueue(const LockFreeQueue&) = delete;
     LockFreeQueue& operator=(const LockFreeQueue&) = delete;
-    
+
 public:
     /**
      * @brief Construct a new Lock Free Queue.
-     * 
-     * @param verbose_logging Whether to log detailed operations (default: false)
+     *
+     * @param verbose_logging Whether to log every operation at LogLevel::DEBUG (default: false)
+     * @param allocator Allocator for nodes
      */
-    LockFreeQueue(bool verbose_logging = false) 
-        : size_(0), total_enqueued_(0), total_dequeued_(0), verbose_logging_(verbose_logging) {
+    LockFreeQueue(bool verbose_logging = false, const Allocator& allocator = Allocator())
+        : node_allocator_(allocator),
+          size_(0), total_enqueued_(0), total_dequeued_(0), verbose_logging_(verbose_logging),
+          hazards_(NodeReclaimer{this}) {
         // Create a dummy node as the initial head and tail
-        Node* dummy = new Node();
+        Node* dummy = new_node();
         head_.store(dummy);
         tail_.store(dummy);
-        
-        std::cout << "Week 3 optimization: Created lock-free queue with dummy node" << std::endl;
+
+        TRADING_LOG_INFO("Week 3 optimization: Created lock-free queue with dummy node");
     }
-    
+
     /**
      * @brief Destroy the Lock Free Queue.
      */
     ~LockFreeQueue() {
-        // Free remaining nodes
-        while (Node* old_head = head_.load()) {
-            head_.store(old_head->next);
-            delete old_head;
+        // Free remaining nodes; every node after the dummy holds a live value
+        Node* dummy = head_.load();
+        Node* node = dummy->next.load();
+        delete_node(dummy);
+        while (node != nullptr) {
+            Node* next = node->next.load();
+            node->value()->~T();
+            delete_node(node);
+            node = next;
         }
-        
-        std::cout << "Week 3 optimization: Destroyed lock-free queue, processed " 
-                  << total_enqueued_.load() << " enqueues and " 
-                  << total_dequeued_.load() << " dequeues" << std::endl;
+
+        TRADING_LOG_INFO("Week 3 optimization: Destroyed lock-free queue, processed {} enqueues and {} dequeues",
+                         total_enqueued_.load(), total_dequeued_.load());
     }
-    
+
     /**
      * @brief Enqueue an element to the queue.
-     * 
+     *
      * @param value Value to enqueue
      */
     void enqueue(T value) {
-        // Create a new node
-        std::shared_ptr<T> new_data = std::make_shared<T>(std::move(value));
-        Node* new_node = new Node();
-        new_node->data = new_data;
-        
-        // Add the new node to the queue
-        while (true) {
-            Node* old_tail = tail_.load();
-            Node* next = old_tail->next.load();
-            
-            // Check if tail is consistent
-            if (old_tail == tail_.load()) {
-                if (next == nullptr) {
-                    // Try to link the new node at the end of the list
-                    if (old_tail->next.compare_exchange_weak(next, new_node)) {
-                        // Enqueue operation successful, advance tail
-                        tail_.compare_exchange_strong(old_tail, new_node);
-                        size_.fetch_add(1, std::memory_order_relaxed);
-                        total_enqueued_.fetch_add(1, std::memory_order_relaxed);
-                        
-                        if (verbose_logging_) {
-                            std::cout << "Week 3 optimization: Successfully enqueued item to lock-free queue (size: " 
-                                      << size_.load() << ")" << std::endl;
-                        }
-                        return;
-                    }
-                } else {
-                    // Tail is falling behind, help advance it
-                    tail_.compare_exchange_strong(old_tail, next);
-                }
-            }
+        Node* node = new_node();
+        new (node->storage) T(std::move(value));
+        link_chain(node, node);
+        record_enqueued(1);
+    }
+
+    /**
+     * @brief Enqueue several elements with a single link operation.
+     *
+     * The elements are chained together privately and then appended with
+     * one CAS, so they appear in the queue contiguously and in order.
+     * The queue is unbounded, so this always succeeds.
+     *
+     * @param items Pointer to the first element to enqueue
+     * @param count Number of elements
+     * @return size_t Number of elements enqueued (always count)
+     */
+    size_t try_enqueue_bulk(const T* items, size_t count) {
+        if (count == 0) {
+            return 0;
+        }
+
+        Node* first = new_node();
+        new (first->storage) T(items[0]);
+        Node* last = first;
+        for (size_t i = 1; i < count; ++i) {
+            Node* node = new_node();
+            new (node->storage) T(items[i]);
+            last->next.store(node, std::memory_order_relaxed);
+            last = node;
         }
+
+        link_chain(first, last);
+        record_enqueued(count);
+        return count;
     }
-    
+
     /**
      * @brief Try to dequeue an element from the queue.
-     * 
+     *
      * @param value Reference to store the dequeued value
      * @return true if dequeue was successful, false if the queue was empty
      */
     bool try_dequeue(T& value) {
-        while (true) {
-            Node* old_head = head_.load();
-            Node* old_tail = tail_.load();
-            Node* next = old_head->next.load();
-            
-            // Check if head is consistent
-            if (old_head == head_.load()) {
-                // Is queue empty?
-                if (old_head == old_tail) {
-                    if (next == nullptr) {
-                        // Queue is empty
-                        return false;
-                    }
-                    // Tail is falling behind, help advance it
-                    tail_.compare_exchange_strong(old_tail, next);
-                } else {
-                    // Read the value before CAS, otherwise another thread might free the next node
-                    if (next != nullptr) {
-                        value = *(next->data);
-                        
-                        // Try to swing the head to the next node
-                        if (head_.compare_exchange_weak(old_head, next)) {
-                            // Dequeue operation successful
-                            size_.fetch_sub(1, std::memory_order_relaxed);
-                            total_dequeued_.fetch_add(1, std::memory_order_relaxed);
-                            
-                            // Free the old dummy node
-                            delete old_head;
-                            
-                            if (verbose_logging_) {
-                                std::cout << "Week 3 optimization: Successfully dequeued item from lock-free queue (size: " 
-                                          << size_.load() << ")" << std::endl;
-                            }
-                            return true;
-                        }
-                    } else {
-                        // If next is nullptr, the queue is empty
-                        return false;
-                    }
-                }
-            }
+        typename HazardPointerDomain<Node, NodeReclaimer>::Guard guard(hazards_);
+        if (!dequeue_one(guard, value)) {
+            return false;
+        }
+        record_dequeued(1);
+        return true;
+    }
+
+    /**
+     * @brief Dequeue up to max_count elements.
+     *
+     * Borrows a hazard record once for the whole batch and publishes the
+     * statistics once.
+     *
+     * @param items Output array with room for max_count elements
+     * @param max_count Maximum number of elements to dequeue
+     * @return size_t Number of elements dequeued
+     */
+    size_t try_dequeue_bulk(T* items, size_t max_count) {
+        typename HazardPointerDomain<Node, NodeReclaimer>::Guard guard(hazards_);
+        size_t count = 0;
+        while (count < max_count && dequeue_one(guard, items[count])) {
+            ++count;
+        }
+        if (count > 0) {
+            record_dequeued(count);
         }
+        return count;
     }
-    
+
     /**
      * @brief Get the current size of the queue.
-     * 
+     *
      * @return size_t Number of elements in the queue
      */
     size_t size() const {
         return size_.load(std::memory_order_relaxed);
     }
-    
+
     /**
      * @brief Check if the queue is empty.
-     * 
+     *
      * @return true if the queue is empty
      */
     bool empty() const {
         return size() == 0;
     }
-    
+
     /**
      * @brief Get the total number of elements that have been enqueued.
-     * 
+     *
      * @return size_t Total enqueued elements count
      */
     size_t total_enqueued() const {
         return total_enqueued_.load(std::memory_order_relaxed);
     }
-    
+
     /**
      * @brief Get the total number of elements that have been dequeued.
-     * 
+     *
      * @return size_t Total dequeued elements count
      */
     size_t total_dequeued() const {
         return total_dequeued_.load(std::memory_order_relaxed);
     }
-    
+
     /**
      * @brief Set verbose logging mode
-     * 
+     *
+     * Verbose records are logged at LogLevel::DEBUG, so they also need a
+     * TRADING_LOG_LEVEL and runtime level that let DEBUG through.
+     *
      * @param verbose Whether to enable verbose logging
      */
     void set_verbose_logging(bool verbose) {
         verbose_logging_ = verbose;
     }
+
+private:
+    // Append the chain first..last (already linked internally) at the tail
+    void link_chain(Node* first, Node* last) {
+        typename HazardPointerDomain<Node, NodeReclaimer>::Guard guard(hazards_);
+
+        while (true) {
+            // Protect the tail so it can't be reclaimed while we link to it
+            Node* old_tail = guard.protect(0, tail_);
+            Node* next = old_tail->next.load(std::memory_order_acquire);
+
+            // Check if tail is consistent
+            if (old_tail != tail_.load(std::memory_order_acquire)) {
+                continue;
+            }
+
+            if (next == nullptr) {
+                // Try to link the chain at the end of the list
+                if (old_tail->next.compare_exchange_weak(next, first, std::memory_order_release,
+                                                         std::memory_order_relaxed)) {
+                    // Enqueue operation successful, advance tail
+                    tail_.compare_exchange_strong(old_tail, last, std::memory_order_release,
+                                                  std::memory_order_relaxed);
+                    return;
+                }
+            } else {
+                // Tail is falling behind, help advance it
+                tail_.compare_exchange_strong(old_tail, next, std::memory_order_release,
+                                              std::memory_order_relaxed);
+            }
+        }
+    }
+
+    // Dequeue one element using an already borrowed hazard record
+    bool dequeue_one(typename HazardPointerDomain<Node, NodeReclaimer>::Guard& guard, T& value) {
+        while (true) {
+            // Protect head, then its successor, re-validating head each time
+            Node* old_head = guard.protect(0, head_);
+            Node* old_tail = tail_.load(std::memory_order_acquire);
+            Node* next = old_head->next.load(std::memory_order_acquire);
+            guard.set(1, next);
+            if (old_head != head_.load(std::memory_order_acquire)) {
+                continue;
+            }
+
+            if (next == nullptr) {
+                // Queue is empty
+                return false;
+            }
+
+            if (old_head == old_tail) {
+                // Tail is falling behind, help advance it
+                tail_.compare_exchange_strong(old_tail, next, std::memory_order_release,
+                                              std::memory_order_relaxed);
+                continue;
+            }
+
+            // Try to swing the head to the next node
+            if (head_.compare_exchange_weak(old_head, next, std::memory_order_acq_rel,
+                                            std::memory_order_relaxed)) {
+                // We won: the value in next is ours, and next is still
+                // protected by our hazard pointer while we move it out
+                T* slot = next->value();
+                value = std::move(*slot);
+                slot->~T();
+                guard.clear(1);
+
+                // The old dummy is unlinked; free it once no one references it
+                hazards_.retire(old_head);
+                return true;
+            }
+        }
+    }
+
+    void record_enqueued(size_t count) {
+        size_.fetch_add(count, std::memory_order_relaxed);
+        total_enqueued_.fetch_add(count, std::memory_order_relaxed);
+
+        TRADING_LOG_IF(verbose_logging_, LogLevel::DEBUG,
+                       "Week 3 optimization: Successfully enqueued {} item(s) to lock-free queue (size: {})",
+                       count, size_.load());
+    }
+
+    void record_dequeued(size_t count) {
+        size_.fetch_sub(count, std::memory_order_relaxed);
+        total_dequeued_.fetch_add(count, std::memory_order_relaxed);
+
+        TRADING_LOG_IF(verbose_logging_, LogLevel::DEBUG,
+                       "Week 3 optimization: Successfully dequeued {} item(s) from lock-free queue (size: {})",
+                       count, size_.load());
+    }
+
+    Node* new_node() {
+        Node* node = NodeTraits::allocate(node_allocator_, 1);
+        NodeTraits::construct(node_allocator_, node);
+        return node;
+    }
+
+    void delete_node(Node* node) {
+        NodeTraits::destroy(node_allocator_, node);
+        NodeTraits::deallocate(node_allocator_, node, 1);
+    }
 };
 
-} // namespace trading 
\ No newline at end of file
+} // namespace trading
@@ -0,0 +1,333 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#include "spsc_ring_buffer.hpp"
+
+/**
+ * @file logger.hpp
+ * @brief Asynchronous, compile-time-filtered logging (Week 3).
+ *
+ * Console output with std::endl flushes a synchronized stream on every
+ * line, which costs far more than processing a tick. The logger moves all
+ * of that off the calling thread:
+ * - Levels below TRADING_LOG_LEVEL are removed at compile time; their
+ *   arguments are not even evaluated
+ * - An enabled record is a format pointer plus raw arguments, copied into
+ *   a per-thread SPSC ring with no lock, allocation or formatting
+ * - A background thread drains the rings, formats "{}" placeholders and
+ *   writes the lines to the sink
+ * When a thread's ring is full the record is dropped and counted rather
+ * than blocking the caller.
+ */
+
+// Lowest level compiled in: 0 TRACE, 1 DEBUG, 2 INFO, 3 WARN, 4 ERROR, 5 OFF
+#ifndef TRADING_LOG_LEVEL
+#define TRADING_LOG_LEVEL 2
+#endif
+
+// Records buffered per producing thread (power of two)
+#ifndef TRADING_LOG_RING_CAPACITY
+#define TRADING_LOG_RING_CAPACITY 1024
+#endif
+
+namespace trading {
+
+/**
+ * @brief Severity of a log record.
+ */
+enum class LogLevel : uint8_t {
+    TRACE = 0,  // Per-message detail on the hot path
+    DEBUG = 1,  // Per-batch or per-operation detail (the old "verbose" output)
+    INFO = 2,   // Lifecycle: construction, start/stop, final statistics
+    WARN = 3,
+    ERROR = 4,
+    OFF = 5
+};
+
+constexpr LogLevel COMPILED_LOG_LEVEL = static_cast<LogLevel>(TRADING_LOG_LEVEL);
+constexpr size_t LOG_RING_CAPACITY = TRADING_LOG_RING_CAPACITY;
+
+/**
+ * @brief Whether records of a level survive compile-time filtering.
+ *
+ * @param level Record level
+ * @return true if TRADING_LOG_LEVEL lets the level through
+ */
+constexpr bool log_compiled_in(LogLevel level) {
+    return level >= COMPILED_LOG_LEVEL && level != LogLevel::OFF;
+}
+
+/**
+ * @brief Static description of one log statement; its address is the format id.
+ */
+struct LogFormat {
+    LogLevel level;
+    const char* text;  // Message with "{}" placeholders
+};
+
+/**
+ * @brief One captured argument, stored by value.
+ *
+ * Strings are copied so the record does not depend on the caller's
+ * buffers outliving it. Paths and names up to STRING_CAPACITY - 1
+ * characters fit; longer strings are cut and end in "...".
+ */
+struct LogArg {
+    static constexpr size_t STRING_CAPACITY = 64;
+
+    enum class Type : uint8_t { INT, UINT, DOUBLE, STRING };
+
+    Type type;
+    union {
+        int64_t i;
+        uint64_t u;
+        double d;
+        char s[STRING_CAPACITY];
+    };
+};
+
+/**
+ * @brief Binary log record as it travels through a thread's ring.
+ */
+struct LogRecord {
+    static constexpr size_t MAX_ARGS = 4;
+
+    const LogFormat* format;
+    int64_t timestamp_ns;  // steady_clock, used to merge the threads' rings
+    uint8_t arg_count;
+    LogArg args[MAX_ARGS];
+};
+
+static_assert(std::is_trivially_copyable_v<LogRecord>, "LogRecord must be copyable as raw bytes");
+
+/**
+ * @brief Process-wide asynchronous logger.
+ *
+ * Use it through the TRADING_LOG_* macros. Every thread that logs gets
+ * its own ring on first use; the rings outlive their threads until the
+ * background thread has drained them.
+ */
+class Logger {
+public:
+    // Receives one formatted line (without trailing newline)
+    using Sink = std::function<void(LogLevel level, std::string_view line)>;
+
+    /**
+     * @brief Get the logger, starting its background thread on first use.
+     *
+     * @return Logger& The process-wide logger
+     */
+    static Logger& instance();
+
+    Logger(const Logger&) = delete;
+    Logger& operator=(const Logger&) = delete;
+
+    /**
+     * @brief Check the runtime level; the compile-time filter is applied by the macros.
+     *
+     * @param level Record level
+     * @return true if records of this level should be captured
+     */
+    bool should_log(LogLevel level) const {
+        return level >= level_.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Set the lowest level emitted at runtime (default INFO).
+     *
+     * Levels compiled out by TRADING_LOG_LEVEL stay out regardless.
+     *
+     * @param level New runtime level
+     */
+    void set_level(LogLevel level) {
+        level_.store(level, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Get the runtime level.
+     *
+     * @return LogLevel Lowest level currently emitted
+     */
+    LogLevel level() const {
+        return level_.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Replace the sink that formatted lines are written to.
+     *
+     * The sink is only ever called from the background thread, without
+     * the logger's flush lock, so it may log or call flush() (which then
+     * returns at once). It must not call set_sink(). Pass nullptr to
+     * restore the default sink (stdout). Waits for a batch the old sink is
+     * writing to finish.
+     *
+     * @param sink New sink
+     */
+    void set_sink(Sink sink);
+
+    /**
+     * @brief Capture a record into the calling thread's ring.
+     *
+     * @tparam Args Argument types (integers, floating point, strings)
+     * @param format Static format of the log statement
+     * @param args Values for the "{}" placeholders, in order
+     */
+    template<typename... Args>
+    void log(const LogFormat& format, const Args&... args) {
+        static_assert(sizeof...(Args) <= LogRecord::MAX_ARGS, "Too many arguments for one log record");
+
+        LogRecord record;
+        record.format = &format;
+        record.timestamp_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+        record.arg_count = static_cast<uint8_t>(sizeof...(Args));
+        [[maybe_unused]] size_t index = 0;
+        (capture(record.args[index++], args), ...);
+        submit(record);
+    }
+
+    /**
+     * @brief Block until every record captured before the call is written.
+     *
+     * Called from the sink, it returns at once: the background thread
+     * can't wait for itself.
+     */
+    void flush();
+
+    /**
+     * @brief Get the number of records dropped because a thread's ring was full.
+     *
+     * @return uint64_t Number of dropped records
+     */
+    uint64_t dropped_records() const {
+        return dropped_records_.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Format a record's message (the background thread's work).
+     *
+     * @param record Captured record
+     * @return std::string Message with placeholders substituted
+     */
+    static std::string format(const LogRecord& record);
+
+private:
+    using Ring = SpscRingBuffer<LogRecord, LOG_RING_CAPACITY>;
+
+    /**
+     * @brief A producing thread's ring; retired when its thread exits.
+     */
+    struct ThreadRing {
+        Ring ring;
+        std::atomic<bool> retired{false};
+    };
+
+    Logger();
+    ~Logger();
+
+    template<typename T>
+    static void capture(LogArg& arg, const T& value) {
+        if constexpr (std::is_floating_point_v<T>) {
+            arg.type = LogArg::Type::DOUBLE;
+            arg.d = static_cast<double>(value);
+        } else if constexpr (std::is_integral_v<T> && std::is_signed_v<T>) {
+            arg.type = LogArg::Type::INT;
+            arg.i = static_cast<int64_t>(value);
+        } else if constexpr (std::is_integral_v<T>) {
+            arg.type = LogArg::Type::UINT;
+            arg.u = static_cast<uint64_t>(value);
+        } else if constexpr (std::is_enum_v<T>) {
+            arg.type = LogArg::Type::INT;
+            arg.i = static_cast<int64_t>(value);
+        } else {
+            capture_string(arg, std::string_view(value));
+        }
+    }
+
+    static void capture_string(LogArg& arg, std::string_view value) {
+        constexpr size_t MAX_LENGTH = LogArg::STRING_CAPACITY - 1;
+        arg.type = LogArg::Type::STRING;
+        if (value.size() <= MAX_LENGTH) {
+            std::memcpy(arg.s, value.data(), value.size());
+            arg.s[value.size()] = '\0';
+            return;
+        }
+        // Mark the cut so a shortened path or name can't pass for the real one
+        std::memcpy(arg.s, value.data(), MAX_LENGTH - 3);
+        std::memcpy(arg.s + MAX_LENGTH - 3, "...", 4);
+    }
+
+    // Push a record into the calling thread's ring (registering it on first use)
+    void submit(const LogRecord& record);
+
+    // Get the calling thread's ring
+    ThreadRing& thread_ring();
+
+    // Background thread: drain, merge by timestamp, format, write
+    void writer_function();
+
+    // Drain every ring once; returns the number of records written
+    size_t drain(std::vector<LogRecord>& batch);
+
+    std::atomic<LogLevel> level_;
+    std::atomic<uint64_t> dropped_records_;
+
+    // Rings of all threads that have logged, including exited ones not yet drained
+    std::mutex rings_mutex_;
+    std::vector<std::shared_ptr<ThreadRing>> rings_;
+
+    // Held while the sink writes a batch, so set_sink() waits for it
+    std::mutex sink_mutex_;
+    Sink sink_;
+    bool sink_is_stdout_;  // Only the default sink needs stdout flushed
+
+    // Flush handshake with the background thread
+    std::mutex writer_mutex_;
+    std::condition_variable writer_condition_;
+    uint64_t flush_requested_;
+    uint64_t flush_completed_;
+    bool stop_;
+
+    std::thread writer_;
+};
+
+} // namespace trading
+
+/**
+ * @brief Log a record of a level if it passes both filters.
+ *
+ * Below TRADING_LOG_LEVEL the statement compiles to nothing. condition is
+ * checked before the runtime level, so per-object switches such as
+ * ThreadPool's verbose flag cost one branch when off.
+ */
+#define TRADING_LOG_IF(condition, level, format_text, ...)                                     \
+    do {                                                                                       \
+        if constexpr (::trading::log_compiled_in(level)) {                                     \
+            if ((condition) && ::trading::Logger::instance().should_log(level)) {              \
+                static constexpr ::trading::LogFormat trading_log_format{level, format_text};  \
+                ::trading::Logger::instance().log(trading_log_format __VA_OPT__(,) __VA_ARGS__); \
+            }                                                                                  \
+        }                                                                                      \
+    } while (0)
+
+#define TRADING_LOG(level, ...) TRADING_LOG_IF(true, level, __VA_ARGS__)
+
+#define TRADING_LOG_TRACE(...) TRADING_LOG(::trading::LogLevel::TRACE, __VA_ARGS__)
+#define TRADING_LOG_DEBUG(...) TRADING_LOG(::trading::LogLevel::DEBUG, __VA_ARGS__)
+#define TRADING_LOG_INFO(...) TRADING_LOG(::trading::LogLevel::INFO, __VA_ARGS__)
+#define TRADING_LOG_WARN(...) TRADING_LOG(::trading::LogLevel::WARN, __VA_ARGS__)
+#define TRADING_LOG_ERROR(...) TRADING_LOG(::trading::LogLevel::ERROR, __VA_ARGS__)
@@ -4,57 +4,87 @@
 #include <unordered_map>
 #include <vector>
 #include <mutex>
-#include <shared_mutex> // Week 3 optimization: Reader-writer lock
 #include <atomic>      // Week 3 optimization: Lock-free counters
 #include <functional>
 #include <chrono>
 #include <thread>
 #include <memory>
+#include <span>
+#include <type_traits>
+#include "book_snapshot.hpp"
+#include "coroutine_task.hpp"
+#include "dirty_set.hpp"
+#include "feed_source.hpp"
+#include "instrumented_lock.hpp"
+#include "latency_histogram.hpp"
+#include "market_tick.hpp"
 #include "order_book_allocator.hpp"
+#include "order_level_book.hpp"
+#include "price_level_book.hpp"
+#include "rate_counter.hpp"
+#include "seqlock.hpp"
+#include "spin_lock.hpp"
+#include "spsc_ring_buffer.hpp"
+#include "symbol_registry.hpp"
+#include "thread_pool.hpp"
+#include "thread_placement.hpp"
+#include "wire_format.hpp"
 
 /**
  * @file market_data_handler.hpp
  * @brief Market data handler implementation that integrates optimizations from Weeks 1-3.
  * 
  * This file demonstrates integration of:
- * - Week 1: Optimized sorting algorithms for order book maintenance
+ * - Week 1: Sorted price levels, maintained incrementally per update
  * - Week 2: Custom memory allocators for efficient order book memory management
  * - Week 3: Thread-safe components using reader-writer locks and atomic operations
  */
 
+// Default number of lock stripes guarding the order books
+#ifndef TRADING_BOOK_LOCK_SHARDS
+#define TRADING_BOOK_LOCK_SHARDS 16
+#endif
+
+// Maximum number of exchanges that can be registered
+#ifndef TRADING_MAX_EXCHANGES
+#define TRADING_MAX_EXCHANGES 64
+#endif
+
+// Ticks buffered between one exchange thread and one book worker (power of two)
+#ifndef TRADING_INGEST_QUEUE_CAPACITY
+#define TRADING_INGEST_QUEUE_CAPACITY 4096
+#endif
+
+// Pool blocks for resting orders and their price levels, shared by all symbols
+#ifndef TRADING_MAX_ORDERS
+#define TRADING_MAX_ORDERS 65536
+#endif
+
+// Updates an ASYNC subscription can have waiting for its callback (power of two)
+#ifndef TRADING_CALLBACK_STRAND_CAPACITY
+#define TRADING_CALLBACK_STRAND_CAPACITY 1024
+#endif
+
 namespace trading {
 
-// Forward declaration of Week2 OrderBookAllocator
-namespace week2 {
-    class OrderBookAllocator;
-}
+class CaptureWriter;
+class CheckpointWriter;
+class ShmBookPublisher;
+struct CheckpointInfo;
 
-/**
- * @brief Structure representing an entry in the order book.
- * 
- * Using a simple struct for cache-friendly memory layout.
- * This is an optimization for high-frequency trading systems.
- */
-struct OrderBookEntry {
-    double price;
-    int volume;
-    
-    // Needed for sorting
-    bool operator<(const OrderBookEntry& other) const {
-        return price < other.price;
-    }
-    
-    bool operator>(const OrderBookEntry& other) const {
-        return price > other.price;
-    }
-};
+constexpr size_t DEFAULT_BOOK_LOCK_SHARDS = TRADING_BOOK_LOCK_SHARDS;
+constexpr size_t MAX_EXCHANGES = TRADING_MAX_EXCHANGES;
+constexpr size_t INGEST_QUEUE_CAPACITY = TRADING_INGEST_QUEUE_CAPACITY;
+constexpr size_t CALLBACK_STRAND_CAPACITY = TRADING_CALLBACK_STRAND_CAPACITY;
 
 /**
  * @brief Structure representing an order book for a financial instrument.
  * 
- * Maintained with sorting algorithms from Week 1 and memory management from Week 2.
- * The bids and asks are separate vectors to allow for efficient processing of
- * each side of the book independently.
+ * This is the snapshot returned by get_order_book(). Internally the handler
+ * maintains each book incrementally as a PriceLevelBook; the bids and asks
+ * are copied out into separate vectors, best price first. Readers that
+ * poll at high frequency should use get_book_snapshot() or top_of_book(),
+ * which do not allocate.
  */
 struct OrderBook {
     std::string symbol;
@@ -73,22 +103,68 @@ struct OrderBook {
 struct MarketUpdate {
     std::string symbol;
     std::string exchange;
-    double bid_price;
-    double ask_price;
+    Price bid_price;
+    Price ask_price;
     int volume;
     std::chrono::nanoseconds timestamp;
 };
 
+/**
+ * @brief Latency histograms and message rate of one exchange, as seen by one shard.
+ */
+struct ExchangeLatencyRecorder {
+    LatencyHistogram queue_wait;   // Ingest ring: exchange thread push to book worker pop
+    LatencyHistogram book_update;  // Applying an update to its book, lock acquisition included
+    LatencyHistogram callback;     // Subscriber callback, for updates that have one
+    MessageRateCounter messages;   // Updates applied
+};
+
+/**
+ * @brief One recording thread's slice of the latency metrics.
+ * 
+ * Only its thread writes to it. Recorders are created on an exchange's
+ * first update through the shard (a CAS, no lock) and live as long as
+ * the handler.
+ */
+struct alignas(CACHE_LINE_SIZE) MetricsShard {
+    MetricsShard() = default;
+    MetricsShard(const MetricsShard&) = delete;
+    MetricsShard& operator=(const MetricsShard&) = delete;
+    
+    ~MetricsShard() {
+        for (auto& recorder : exchanges) {
+            delete recorder.load(std::memory_order_relaxed);
+        }
+    }
+    
+    // Get (creating if needed) the recorder of an exchange
+    ExchangeLatencyRecorder& recorder(ExchangeId exchange_id) {
+        ExchangeLatencyRecorder* existing = exchanges[exchange_id].load(std::memory_order_acquire);
+        if (existing != nullptr) {
+            return *existing;
+        }
+        auto* created = new ExchangeLatencyRecorder();
+        if (!exchanges[exchange_id].compare_exchange_strong(existing, created, std::memory_order_acq_rel)) {
+            delete created;
+            return *existing;
+        }
+        return *created;
+    }
+    
+    std::atomic<ExchangeLatencyRecorder*> exchanges[MAX_EXCHANGES];
+};
+
 /**
  * @brief Structure containing metrics about market data processing.
  * 
  * Uses atomic variables for thread-safe access without locking.
  * This is a key Week 3 optimization for maintaining metrics without
- * affecting the critical path of market data processing.
+ * affecting the critical path of market data processing. Latencies go
+ * into per-thread histogram shards and are only merged by get_metrics().
  */
 struct MarketDataMetrics {
     // Default constructor
-    MarketDataMetrics() = default;
+    MarketDataMetrics() : instance_id(next_instance_id()) {}
     
     // Delete copy constructor and assignment operator to prevent copying atomic members
     MarketDataMetrics(const MarketDataMetrics&) = delete;
@@ -97,12 +173,34 @@ struct MarketDataMetrics {
     // Atomic counters for lock-free updates - Week 3 optimization
     std::atomic<uint64_t> total_updates_processed{0};
     std::atomic<uint64_t> total_updates_dropped{0};
-    std::atomic<uint64_t> lock_contentions{0};
-    std::atomic<uint64_t> lock_wait_time_ns{0};
+    std::atomic<uint64_t> total_callbacks_dropped{0};
+    std::atomic<uint64_t> total_updates_conflated{0};
     
-    // Maps require mutex protection since they're not atomic
-    std::unordered_map<std::string, double> avg_latency_us;   // Average latency in microseconds by exchange
-    std::unordered_map<std::string, double> throughput_mps;   // Throughput in messages per second by exchange
+    // Per-thread latency histograms and rate counters, indexed by ExchangeId
+    // within a shard. A thread registers its shard on its first record; the
+    // shards outlive their threads until the handler is destroyed
+    mutable std::mutex shards_mutex;
+    mutable std::vector<std::unique_ptr<MetricsShard>> shards;
+    
+    // Identifies these metrics to the threads' shard caches; unlike an
+    // address, it is never reused by a later handler
+    const uint64_t instance_id;
+    
+private:
+    static uint64_t next_instance_id() {
+        static std::atomic<uint64_t> next{1};
+        return next.fetch_add(1, std::memory_order_relaxed);
+    }
+};
+
+/**
+ * @brief Merged latency distributions and message rate of one exchange.
+ */
+struct ExchangeLatencyStats {
+    LatencySummary queue_wait;
+    LatencySummary book_update;
+    LatencySummary callback;
+    double throughput_mps{0.0};  // Updates per second over the last second
 };
 
 /**
@@ -114,26 +212,71 @@ struct MarketDataMetrics {
 struct MarketDataMetricsResult {
     uint64_t total_updates_processed{0};
     uint64_t total_updates_dropped{0};
-    uint64_t lock_contentions{0};
-    uint64_t lock_wait_time_ns{0};
-    std::unordered_map<std::string, double> avg_latency_us;
+    uint64_t total_callbacks_dropped{0};  // ASYNC callbacks skipped because their strand was full
+    uint64_t total_updates_conflated{0};  // CONFLATED updates replaced by a newer one before delivery
+    uint64_t lock_contentions{0};   // Failed try_locks over all of the handler's locks
+    uint64_t lock_wait_time_ns{0};  // Time blocked after those failures
+    std::vector<LockStatsResult> locks;  // Per lock; the book stripes are merged into one entry
+    std::unordered_map<std::string, double> avg_latency_us;  // Mean book update + callback time
     std::unordered_map<std::string, double> throughput_mps;
+    std::unordered_map<std::string, ExchangeLatencyStats> latency;
 };
 
 // Type for market data callback
 using MarketDataCallback = std::function<void(const MarketUpdate&)>;
 
+// Type for ID-keyed market data callback
+using MarketTickCallback = std::function<void(const MarketTick&)>;
+
+/**
+ * @brief Where a subscription's callback runs.
+ */
+enum class CallbackDispatch {
+    INLINE,    // On the thread that applied the update, after its locks are released
+    ASYNC,     // On the callback pool, through the symbol's strand
+    CONFLATED  // On the callback pool, latest state only: updates that arrive
+               // before delivery replace the pending one
+};
+
+/**
+ * @brief Where the handler's threads run, per role.
+ * 
+ * Exchange thread placement is indexed by ExchangeId and named
+ * "<name>-<exchange>" ("md-NYSE" by default); busy_spin makes every feed
+ * busy-poll whatever its FeedWaitMode. Book worker placement is indexed by
+ * worker and named "<name>-<worker>" ("book-0" by default); busy_spin stops
+ * idle workers from backing off into sleeps, and numa_node binds the book
+ * and order slabs to that node. Strategy workers are a ThreadPool; place
+ * them with its ThreadPlacement constructor.
+ */
+struct MarketDataPlacement {
+    ThreadPlacement exchanges;
+    ThreadPlacement book_workers;
+};
+
 /**
  * @brief Thread-safe market data handler implementation.
  * 
  * This class integrates optimizations from all three weeks:
- * - Week 1: Uses optimized sorting algorithms for order book maintenance
+ * - Week 1: Keeps price levels sorted incrementally instead of re-sorting
  * - Week 2: Uses custom allocators for efficient memory management
  * - Week 3: Implements thread-safe components with multiple optimization strategies:
  *   - Reader-writer locks for concurrent read access
- *   - Fine-grained locking to minimize contention
+ *   - Lock striping: books are guarded by N spinlock shards, so updates to
+ *     unrelated symbols proceed in parallel
+ *   - Interned symbol/exchange IDs: books, callbacks and metrics live in
+ *     flat arrays indexed by ID, so the tick path does no string hashing
  *   - Lock-free metrics with atomic variables
- *   - Per-exchange threading for parallel processing
+ *   - Seqlock-published book snapshots, so readers never take a lock
+ *   - Optional asynchronous callbacks on a ThreadPool through per-symbol
+ *     strands, so slow subscribers don't stall the book update thread
+ *   - Optional conflated delivery: one latest-state slot per symbol and a
+ *     dirty set, bounding memory and latency for slow subscribers
+ *   - Coroutines can co_await a symbol's next update (next_tick()) without
+ *     holding a thread or registering a callback
+ *   - Per-exchange threading for parallel processing: each exchange thread
+ *     drives its FeedSource and routes ticks over SPSC rings to a fixed set
+ *     of book workers, a symbol always going to the same worker
  */
 class MarketDataHandler {
 public:
@@ -141,8 +284,11 @@ public:
      * @brief Constructs a new Market Data Handler.
      * 
      * @param max_symbols Maximum number of symbols to support (for pre-allocation)
+     * @param book_depth Number of price levels kept per side (clamped to [1, MAX_BOOK_DEPTH])
+     * @param num_lock_shards Number of lock stripes for the books (rounded up to a power of two)
      */
-    explicit MarketDataHandler(size_t max_symbols);
+    explicit MarketDataHandler(size_t max_symbols, size_t book_depth = DEFAULT_BOOK_DEPTH,
+                               size_t num_lock_shards = DEFAULT_BOOK_LOCK_SHARDS);
     
     /**
      * @brief Destroys the Market Data Handler, cleaning up resources.
@@ -160,22 +306,112 @@ public:
      */
     bool add_exchange(const std::string& exchange_name);
     
+    /**
+     * @brief Add an exchange fed by a FeedSource.
+     * 
+     * Once start() is called, the exchange thread pulls ticks from the
+     * source and routes them to the book workers. Exchanges added while
+     * running are picked up by the next start().
+     * 
+     * @param exchange_name Name of the exchange
+     * @param source Feed to drive from the exchange thread
+     * @param wait_mode Whether the thread busy-polls or blocks on the feed
+     * @return true if added successfully, false if already exists
+     */
+    bool add_exchange(const std::string& exchange_name, std::unique_ptr<FeedSource> source,
+                      FeedWaitMode wait_mode = FeedWaitMode::BLOCKING);
+    
     /**
      * @brief Subscribe to market data for a symbol.
      * 
-     * Registers a callback for market updates for the specified symbol.
-     * Thread-safe operation protected by books_mutex_ (writer lock).
+     * Registers a callback for market updates for the specified symbol,
+     * replacing any previous one. The symbol is interned on first
+     * subscription; use symbol_id() to get its ID for the ID-based API.
+     * Serialized by books_mutex_.
+     * 
+     * ASYNC callbacks run on the pool given to set_callback_pool(), one at
+     * a time and in update order per symbol, in parallel across symbols.
+     * CONFLATED callbacks also run on the pool, but only see the latest
+     * update of each symbol that changed since its last delivery; the
+     * updates skipped are counted in total_updates_conflated.
+     * 
+     * @param symbol Symbol to subscribe to
+     * @param callback Callback function to call on updates
+     * @param dispatch Run the callback inline, on the callback pool, or
+     *        conflated on the callback pool
+     * @return true if subscribed successfully, false if at capacity or
+     *         ASYNC/CONFLATED without a callback pool
+     */
+    bool subscribe(const std::string& symbol, MarketDataCallback callback,
+                   CallbackDispatch dispatch = CallbackDispatch::INLINE);
+    
+    /**
+     * @brief Subscribe to ID-keyed market data for a symbol.
+     * 
+     * Same as subscribe(), but the callback receives the MarketTick directly
+     * instead of a MarketUpdate rebuilt with symbol and exchange names.
      * 
      * @param symbol Symbol to subscribe to
      * @param callback Callback function to call on updates
-     * @return true if subscribed successfully, false if at capacity
+     * @param dispatch Run the callback inline, on the callback pool, or
+     *        conflated on the callback pool
+     * @return true if subscribed successfully, false if at capacity or
+     *         ASYNC/CONFLATED without a callback pool
      */
-    bool subscribe(const std::string& symbol, MarketDataCallback callback);
+    bool subscribe_ticks(const std::string& symbol, MarketTickCallback callback,
+                         CallbackDispatch dispatch = CallbackDispatch::INLINE);
+    
+    /**
+     * @brief Set the pool that runs ASYNC and CONFLATED callbacks.
+     * 
+     * Can be set once, before the first such subscription. The pool must
+     * outlive the handler, whose destructor waits for pending callbacks.
+     * 
+     * @param pool Thread pool for callbacks
+     * @param priority Priority of the callback tasks on the pool
+     * @return true if set, false if a callback pool was already set
+     */
+    bool set_callback_pool(ThreadPool& pool, int priority = 0);
+    
+    /**
+     * @brief Record every update the exchange threads receive.
+     * 
+     * Batches are appended to the capture, with their exchange IDs filled
+     * in, before they are routed to the book workers. Updates pushed
+     * through process_update() are not recorded. Must be called while the
+     * handler is stopped; the writer must outlive the capture.
+     * 
+     * @param capture Capture to append to, or nullptr to stop recording
+     * @return true if set, false if the handler is running
+     */
+    bool set_capture(CaptureWriter* capture);
+    
+    /**
+     * @brief Also publish every book into a shared memory segment.
+     * 
+     * Books that already exist are published right away; from then on each
+     * book is republished after every change, like the in-process snapshot.
+     * May be called while running. Once this returns with a different
+     * publisher or nullptr, the previous publisher is no longer used and may
+     * be destroyed.
+     * 
+     * @param publisher Segment to publish to, or nullptr to stop publishing
+     */
+    void set_shm_publisher(ShmBookPublisher* publisher);
+    
+    /**
+     * @brief Wait until every ASYNC callback queued so far has run, and
+     *        every pending CONFLATED update has been delivered.
+     * 
+     * Must not be called from an ASYNC or CONFLATED callback.
+     */
+    void flush_callbacks();
     
     /**
      * @brief Unsubscribe from market data for a symbol.
      * 
-     * Thread-safe operation protected by books_mutex_ (writer lock).
+     * The order book is kept; only the callback is removed. ASYNC
+     * callbacks already queued still run. Serialized by books_mutex_.
      * 
      * @param symbol Symbol to unsubscribe from
      * @return true if unsubscribed successfully, false if not found
@@ -185,73 +421,584 @@ public:
     /**
      * @brief Process a market update.
      * 
-     * Updates the order book and calls the registered callback.
-     * Uses a reader-writer lock pattern for efficient concurrent access.
-     * Implements the Week 1 sorting optimization for order book entries.
+     * Thin wrapper over process_update(const MarketTick&): resolves the
+     * symbol and exchange names to IDs first. Updates for symbols that
+     * were never subscribed are dropped; exchanges never registered with
+     * add_exchange() are not counted in the per-exchange metrics.
      * 
      * @param update Market update to process
      */
     void process_update(const MarketUpdate& update);
     
+    /**
+     * @brief Process an ID-keyed market update.
+     * 
+     * Updates the order book and calls the registered callback (or queues
+     * it on the symbol's strand for an ASYNC subscription).
+     * Takes only the lock stripe that owns the symbol, so only updates to
+     * the same stripe serialize. The bid and ask levels are merged into the
+     * book in place; a volume of zero removes the level.
+     * 
+     * @param tick Market update to process
+     */
+    void process_update(const MarketTick& tick);
+    
+    /**
+     * @brief Process a market update straight from a wire message.
+     * 
+     * The view's fields are decoded in place, with no copy of the message
+     * and no strings; see wire_format.hpp.
+     * 
+     * @param view Validated MARKET_UPDATE message
+     */
+    void process_update(const MarketUpdateView& view);
+    
+    /**
+     * @brief Process every complete wire message in a receive buffer as one batch.
+     * 
+     * Decodes with WireDecoder and hands the updates to
+     * process_updates(std::span<const MarketTick>). A partial message at
+     * the end is left unconsumed; decoding stops at a malformed message.
+     * 
+     * @param buffer Received bytes
+     * @return size_t Bytes consumed; the caller keeps the rest for the next read
+     */
+    size_t process_messages(std::span<const std::byte> buffer);
+    
+    /**
+     * @brief Process a batch of market updates.
+     * 
+     * Resolves names like process_update(const MarketUpdate&), then hands
+     * the batch to process_updates(std::span<const MarketTick>).
+     * 
+     * @param updates Market updates to process, in arrival order
+     */
+    void process_updates(std::span<const MarketUpdate> updates);
+    
+    /**
+     * @brief Process a batch of ID-keyed market updates.
+     * 
+     * Groups the batch by symbol and takes each book's lock stripe once per
+     * group, applying that symbol's levels in arrival order. The clock is
+     * read once per batch and metrics are published once per batch.
+     * Callbacks run after all locks are released, in arrival order; ASYNC
+     * ones are queued to their strands in arrival order per symbol.
+     * 
+     * @param ticks Market updates to process, in arrival order
+     */
+    void process_updates(std::span<const MarketTick> ticks);
+    
+    /**
+     * @brief Suspends a coroutine until the next update of one symbol.
+     */
+    class TickAwaiter {
+    public:
+        TickAwaiter(MarketDataHandler& handler, SymbolId symbol_id, ThreadPool* executor, int priority)
+            : handler_(handler), requested_(symbol_id), executor_(executor), priority_(priority) {
+            tick_.symbol_id = INVALID_SYMBOL_ID;
+        }
+        
+        bool await_ready() const noexcept {
+            return false;
+        }
+        
+        bool await_suspend(std::coroutine_handle<> handle);
+        
+        MarketTick await_resume() const noexcept {
+            return tick_;
+        }
+        
+    private:
+        friend class MarketDataHandler;
+        
+        MarketDataHandler& handler_;
+        SymbolId requested_;
+        ThreadPool* executor_;
+        int priority_;
+        std::coroutine_handle<> handle_;
+        MarketTick tick_{};
+        TickAwaiter* next_ = nullptr; // Next waiter on the same symbol
+    };
+    
+    /**
+     * @brief Await the next update of a symbol: `MarketTick tick = co_await handler.next_tick(id, pool);`
+     * 
+     * The coroutine is registered under the symbol's lock stripe and
+     * resumed on executor by the first update processed after that, through
+     * either process_update() or process_updates() (which hand over the
+     * last update of the symbol's group). Nothing is allocated and no
+     * callback is needed. A symbol without a book resumes at once with
+     * symbol_id INVALID_SYMBOL_ID. Waiting coroutines must be woken before
+     * the handler is destroyed.
+     * 
+     * @param symbol_id Symbol to wait for
+     * @param executor Pool to resume the coroutine on
+     * @param priority Priority of the resumption
+     * @return TickAwaiter Awaitable producing the update
+     */
+    TickAwaiter next_tick(SymbolId symbol_id, ThreadPool& executor, int priority = 0) {
+        return TickAwaiter(*this, symbol_id, &executor, priority);
+    }
+    
+    /**
+     * @brief Process an order-level (L3) message.
+     * 
+     * The symbol's first order event gives it an OrderLevelBook, which
+     * tracks every resting order in price-time priority and keeps the
+     * symbol's L2 book in step level by level. Snapshots are published as
+     * for process_update(); subscribers are not called, since an order
+     * event carries no bid/ask tick. A symbol should be fed either order
+     * events or aggregated updates, not both.
+     * Order nodes come from a pool of TRADING_MAX_ORDERS blocks, created
+     * on first use; past that they fall back to the heap.
+     * 
+     * @param event Order event, keyed by interned symbol and exchange IDs
+     * @return true if the order book changed, false if the symbol is not
+     *         subscribed or the event doesn't match a resting order
+     */
+    bool process_order(const OrderEvent& event);
+    
     /**
      * @brief Get the order book for a symbol.
      * 
-     * Thread-safe operation protected by books_mutex_ (reader lock).
+     * Lock-free: copies the book's published snapshot, then builds the
+     * vectors. Prefer get_book_snapshot() on hot paths.
      * 
      * @param symbol Symbol to get order book for
      * @return OrderBook Current state of the order book
      */
     OrderBook get_order_book(const std::string& symbol) const;
     
+    /**
+     * @brief Get the order book for a symbol ID.
+     * 
+     * @param symbol_id Symbol ID to get order book for
+     * @return OrderBook Current state of the order book (empty if unknown)
+     */
+    OrderBook get_order_book(SymbolId symbol_id) const;
+    
+    /**
+     * @brief Copy a book's latest snapshot without locking or allocating.
+     * 
+     * Reads the seqlock-published snapshot: never torn, never blocks the
+     * tick path, and retries only if an update lands during the copy.
+     * Only the rows up to the handler's book depth are copied.
+     * 
+     * @param symbol_id Symbol ID to read
+     * @param snapshot Receives the book
+     * @return true if the symbol has a book, false if unknown
+     */
+    bool get_book_snapshot(SymbolId symbol_id, BookSnapshot& snapshot) const;
+    
+    /**
+     * @brief Read only the best bid and ask of a book.
+     * 
+     * Like get_book_snapshot(), but copies just the snapshot header and
+     * its first row, which share the seqlock's first cache line.
+     * 
+     * @param symbol_id Symbol ID to read
+     * @return TopOfBook Best bid and ask (symbol_id INVALID_SYMBOL_ID if unknown)
+     */
+    TopOfBook top_of_book(SymbolId symbol_id) const;
+    
+    /**
+     * @brief Read only the best bid and ask of a book by name.
+     * 
+     * @param symbol Symbol to read
+     * @return TopOfBook Best bid and ask (symbol_id INVALID_SYMBOL_ID if unknown)
+     */
+    TopOfBook top_of_book(const std::string& symbol) const;
+    
+    /**
+     * @brief Set a symbol's tick size, its minimum price increment.
+     * 
+     * Book prices are compared exactly, so a feed that sends prices in
+     * floating point should convert them with to_price(), which rounds
+     * onto this grid. The default is DEFAULT_TICK_SIZE (no extra rounding).
+     * 
+     * @param symbol Subscribed symbol
+     * @param tick_size Tick size, which must be positive
+     * @return true if set, false if the symbol is unknown or the tick size isn't positive
+     */
+    bool set_tick_size(const std::string& symbol, Price tick_size);
+    
+    /**
+     * @brief Get a symbol's tick size.
+     * 
+     * @param symbol_id Symbol ID
+     * @return Price Tick size (DEFAULT_TICK_SIZE if unknown or never set)
+     */
+    Price tick_size(SymbolId symbol_id) const;
+    
+    /**
+     * @brief Convert a floating-point price at the API edge.
+     * 
+     * @param symbol_id Symbol the price belongs to
+     * @param price Price in currency units
+     * @return Price The price rounded to the symbol's tick size
+     */
+    Price to_price(SymbolId symbol_id, double price) const {
+        return Price::from_double(price, tick_size(symbol_id));
+    }
+    
+    /**
+     * @brief Get the ID of a subscribed symbol.
+     * 
+     * @param symbol Symbol name
+     * @return SymbolId The ID, or INVALID_SYMBOL_ID if never subscribed
+     */
+    SymbolId symbol_id(const std::string& symbol) const;
+    
+    /**
+     * @brief Get the ID of a registered exchange.
+     * 
+     * @param exchange_name Exchange name
+     * @return ExchangeId The ID, or INVALID_EXCHANGE_ID if unknown
+     */
+    ExchangeId exchange_id(const std::string& exchange_name) const;
+    
+    /**
+     * @brief Convert an ID-keyed tick back to a named MarketUpdate.
+     * 
+     * @param tick Tick to convert
+     * @return MarketUpdate The same update with symbol and exchange names
+     */
+    MarketUpdate to_market_update(const MarketTick& tick) const;
+    
     /**
      * @brief Get metrics about market data processing.
      * 
+     * Merges the per-thread latency histograms into p50/p99/p99.9/max per
+     * exchange. The tick path never waits for this.
+     * 
      * @return MarketDataMetricsResult Current metrics
      */
     MarketDataMetricsResult get_metrics() const;
     
+    /**
+     * @brief Get the number of symbols the handler was sized for.
+     */
+    size_t max_symbols() const {
+        return max_symbols_;
+    }
+    
+    /**
+     * @brief Write a checkpoint of every book and both registries.
+     * 
+     * Books are copied from their seqlocked snapshots, so the tick path is
+     * never blocked. The checkpoint's sequence is the capture's record
+     * count taken first; while running, the book workers are then given up
+     * to ingest_timeout to apply everything queued by then, so the books
+     * hold every update numbered below the sequence. May be called from
+     * any thread, one checkpoint per writer at a time.
+     * 
+     * @param writer Checkpoint file to write
+     * @param capture The capture passed to set_capture(), or nullptr for sequence 0
+     * @param ingest_timeout Longest wait for the book workers
+     * @return true if written, false if the workers fell behind or a name doesn't fit
+     */
+    bool write_checkpoint(CheckpointWriter& writer, const CaptureWriter* capture = nullptr,
+                          std::chrono::milliseconds ingest_timeout = std::chrono::seconds(1));
+    
+    /**
+     * @brief Rebuild the books from the newest checkpoint in a file.
+     * 
+     * Registers the checkpoint's exchanges and symbols under their recorded
+     * IDs and replaces their price-level books, so replaying the capture
+     * from CheckpointInfo::sequence (ReplayOptions::from_sequence) catches
+     * up. Symbols and exchanges already registered must have the same IDs
+     * as in the checkpoint. Subscriptions, callbacks and order-level books
+     * are not part of a checkpoint. Must be called while stopped.
+     * 
+     * @param path Checkpoint file
+     * @param info Receives the checkpoint's generation, sequence and timing, if not null
+     * @return true if restored, false if running, the file has no valid
+     *         checkpoint, or the IDs don't match
+     */
+    bool restore(const std::string& path, CheckpointInfo* info = nullptr);
+    
+    /**
+     * @brief Get the Week 2 allocator that backs the order books.
+     * 
+     * @return const week2::OrderBookAllocator& Allocator with its allocation statistics
+     */
+    const week2::OrderBookAllocator& order_book_allocator() const {
+        return *order_book_allocator_;
+    }
+    
+    /**
+     * @brief Get the Week 2 pool that backs the order-level books.
+     * 
+     * @return const week2::OrderBookAllocator* The pool, or nullptr before the first order event
+     */
+    const week2::OrderBookAllocator* order_pool() const {
+        return order_pool_ready_.load(std::memory_order_acquire) ? order_pool_.get() : nullptr;
+    }
+    
     /**
      * @brief Start processing market data.
      * 
-     * Starts a thread for each registered exchange.
+     * Starts a thread for each registered exchange and num_book_workers
+     * book processing workers. The exchange threads route each tick to
+     * worker `symbol_id % num_book_workers` over a bounded SPSC ring, so
+     * every book has a single writer; ticks that find their ring full are
+     * counted in total_updates_dropped.
      * Thread-safe operation protected by exchanges_mutex_.
+     * 
+     * @param num_book_workers Number of book processing workers (at least 1)
+     */
+    void start(size_t num_book_workers = 1);
+    
+    /**
+     * @brief Start processing market data with placed threads.
+     * 
+     * Same as start(num_book_workers), with the exchange threads and book
+     * workers named, pinned and bound as placement says. The placement
+     * stays in effect for later start() calls without one.
+     * 
+     * @param num_book_workers Number of book processing workers (at least 1)
+     * @param placement Placement of the exchange threads and book workers
      */
-    void start();
+    void start(size_t num_book_workers, const MarketDataPlacement& placement);
     
     /**
      * @brief Stop processing market data.
      * 
-     * Stops all exchange threads gracefully.
+     * Stops all exchange threads gracefully, then lets the book workers
+     * drain what was already routed to them.
      * Thread-safe operation protected by exchanges_mutex_.
      */
     void stop();
     
 private:
+    /**
+     * @brief Immutable subscription; replaced as a whole by subscribe().
+     */
+    struct Subscription {
+        MarketTickCallback callback;
+        CallbackDispatch dispatch;
+    };
+    
+    /**
+     * @brief Serializes a symbol's ASYNC callbacks.
+     * 
+     * Updates are pushed under the symbol's lock stripe, so the ring has
+     * one producer at a time. At most one drain task is scheduled on the
+     * pool at a time (`scheduled`), so it also has a single consumer.
+     */
+    struct CallbackStrand {
+        struct Pending {
+            std::shared_ptr<const Subscription> subscription; // Keeps a replaced callback alive
+            MarketTick tick;
+        };
+        
+        SpscRingBuffer<Pending, CALLBACK_STRAND_CAPACITY> queue;
+        std::atomic<bool> scheduled{false};
+    };
+    
+    /**
+     * @brief Latest update of a symbol with a CONFLATED subscription.
+     * 
+     * Written under the symbol's lock stripe, read by the conflation task.
+     */
+    struct ConflatedState {
+        SeqLock<MarketTick> latest;
+        uint64_t delivered_version = 0; // Conflation task only: skips re-delivery
+    };
+    
+    // Scratch buffers of one process_updates() call (defined in the .cpp)
+    struct BatchScratch;
+    
+    /**
+     * @brief Dense per-symbol storage, indexed by SymbolId.
+     * 
+     * The book pointer is published once by subscribe() and never changes
+     * afterwards. The subscription pointer is swapped under the symbol's
+     * lock stripe; the tick path pins it under the stripe it already holds
+     * for the book update. The strand is created by the symbol's first ASYNC
+     * subscription and lives as long as the handler, as does the
+     * conflated state created by the first CONFLATED one. The snapshot is
+     * rewritten under the stripe after every change to the book, so the
+     * stripe also makes it single-writer.
+     */
+    struct BookSlot {
+        std::atomic<PriceLevelBook*> book{nullptr};
+        std::shared_ptr<const Subscription> subscription;
+        std::unique_ptr<CallbackStrand> strand;
+        std::unique_ptr<ConflatedState> conflated;
+        SeqLock<BookSnapshot> snapshot;
+        std::atomic<int64_t> tick_size{DEFAULT_TICK_SIZE.raw()}; // Price::raw()
+        std::unique_ptr<OrderLevelBook> orders; // Created by the first order event, under the stripe
+        TickAwaiter* tick_waiters = nullptr;    // Coroutines awaiting the next update, under the stripe
+    };
+    
+    /**
+     * @brief One lock stripe, padded to a cache line to avoid false sharing.
+     */
+    struct alignas(CACHE_LINE_SIZE) BookLockShard {
+        InstrumentedSpinLock lock;
+    };
+    
+    /**
+     * @brief A routed tick and when its exchange thread pushed it.
+     */
+    struct QueuedTick {
+        MarketTick tick;
+        std::chrono::steady_clock::time_point enqueued;
+    };
+    
+    // Bounded handoff from one exchange thread to one book worker
+    using IngestQueue = SpscRingBuffer<QueuedTick, INGEST_QUEUE_CAPACITY>;
+    
+    /**
+     * @brief An ingest ring and how much of it its worker has applied.
+     */
+    struct IngestRing {
+        IngestQueue queue;
+        alignas(CACHE_LINE_SIZE) std::atomic<uint64_t> applied{0}; // Ticks applied to books, written by the worker
+    };
+    
+    /**
+     * @brief One registered exchange and its ingest state.
+     */
+    struct ExchangeFeed {
+        ExchangeId id = INVALID_EXCHANGE_ID;
+        std::unique_ptr<FeedSource> source; // nullptr: updates arrive via process_update()
+        FeedWaitMode wait_mode = FeedWaitMode::BLOCKING;
+        std::thread thread;
+        std::vector<std::unique_ptr<IngestRing>> queues; // One per book worker, built by start()
+    };
+    
+    // Register an exchange (shared by both add_exchange overloads)
+    bool add_exchange_impl(const std::string& exchange_name, std::unique_ptr<FeedSource> source,
+                           FeedWaitMode wait_mode);
+    
+    // Start the exchange threads and book workers; the caller holds exchanges_mutex_
+    void start_locked(size_t num_book_workers);
+    
     // Thread function for exchange processing
-    void exchange_thread_func(const std::string& exchange_name);
+    void exchange_thread_func(ExchangeFeed* feed);
+    
+    // Thread function for a book processing worker
+    void book_worker_func(size_t index, std::vector<IngestRing*> queues);
+    
+    // Wait until the book workers applied everything queued so far; true if stopped
+    bool wait_for_ingest(std::chrono::steady_clock::time_point deadline);
+    
+    // Create a symbol's book if it has none; the caller holds books_mutex_
+    PriceLevelBook* create_book(SymbolId symbol_id, const std::string& symbol);
+    
+    // Register a tick callback for a symbol (shared by both subscribe overloads)
+    bool subscribe_impl(const std::string& symbol, std::shared_ptr<const Subscription> subscription);
+    
+    // Queue an ASYNC callback on a symbol's strand; the caller holds its stripe
+    void enqueue_callback(const BookSlot& slot, const std::shared_ptr<const Subscription>& subscription,
+                          const MarketTick& tick);
+    
+    // Make sure a drain task is scheduled for a strand with queued callbacks
+    void schedule_strand(CallbackStrand* strand);
+    
+    // Register a coroutine for its symbol's next update; false if the symbol has no book
+    bool add_tick_waiter(TickAwaiter& waiter);
+    
+    // Hand a tick to a symbol's waiters and detach them; the caller holds its stripe
+    static TickAwaiter* take_tick_waiters(BookSlot& slot, const MarketTick& tick);
+    
+    // Resume waiters detached by take_tick_waiters(), after the stripe is released
+    static void wake_tick_waiters(TickAwaiter* waiters);
+    
+    // Post a strand's drain task to the callback pool
+    void post_strand(CallbackStrand* strand);
+    
+    // Callback pool task: run a batch of a strand's callbacks
+    void run_strand(CallbackStrand* strand);
+    
+    // Store a CONFLATED symbol's latest update and mark it dirty; the caller
+    // holds its stripe. replaced counts updates of the same batch it
+    // supersedes. Returns true if the symbol was not dirty yet.
+    bool conflate_update(BookSlot& slot, SymbolId symbol_id, const MarketTick& tick, uint64_t replaced);
+    
+    // Make sure the conflation task is scheduled
+    void schedule_conflation();
     
-    // Update metrics with processing time
-    void update_metrics(const std::string& exchange, std::chrono::nanoseconds processing_time);
+    // Post the conflation task to the callback pool
+    void post_conflation();
+    
+    // Callback pool task: deliver the latest update of every dirty symbol
+    void run_conflation();
+    
+    // Lock stripe owning a symbol
+    InstrumentedSpinLock& book_lock(SymbolId symbol_id) const {
+        return book_locks_[symbol_id & lock_shard_mask_].lock;
+    }
+    
+    // Publish a book's current state to readers; the caller holds its stripe
+    void publish_snapshot(SymbolId symbol_id, const PriceLevelBook& book);
+    
+    // Calling thread's metrics shard
+    MetricsShard& metrics_shard() const;
+    
+    // Record count updates of an exchange with the given per-update book and
+    // callback times into the calling thread's shard (lock-free)
+    void record_latency(ExchangeId exchange_id, uint64_t count, uint64_t callbacks,
+                        std::chrono::nanoseconds book_time, std::chrono::nanoseconds callback_time,
+                        std::chrono::steady_clock::time_point now);
+    
+    // Record how long count ticks of an exchange waited in an ingest ring (lock-free)
+    void record_queue_wait(ExchangeId exchange_id, uint64_t count, std::chrono::nanoseconds wait_time);
     
     // Configuration
     size_t max_symbols_;
+    size_t book_depth_;
     
-    // Exchange threads
-    std::unordered_map<std::string, std::thread> exchange_threads_;
-    std::mutex exchanges_mutex_;
+    // Exchange threads and their feeds
+    std::unordered_map<std::string, ExchangeFeed> exchange_feeds_;
+    InstrumentedMutex exchanges_mutex_;
     std::atomic<bool> running_;
     
-    // Order books and callbacks
-    mutable std::shared_mutex books_mutex_; // Week 3 optimization: Reader-writer lock
-    std::unordered_map<std::string, OrderBook> order_books_;
-    std::unordered_map<std::string, MarketDataCallback> callbacks_;
+    // Book processing workers fed by the exchange threads
+    std::vector<std::thread> book_workers_;
+    std::atomic<bool> workers_running_;
+    
+    // Where exchange threads and book workers run; changed only while stopped
+    MarketDataPlacement placement_;
+    std::atomic<int> book_numa_node_{-1}; // Copy of placement_.book_workers.numa_node for the order pool
+    
+    // Symbol and exchange interning
+    SymbolRegistry symbols_;
+    ExchangeRegistry exchanges_;
+    
+    // Order books and callbacks, indexed by SymbolId
+    InstrumentedMutex books_mutex_; // Serializes subscribe/unsubscribe; not used on the tick path
+    std::vector<BookSlot> books_;
+    mutable std::vector<BookLockShard> book_locks_; // Week 3 optimization: Lock striping
+    size_t lock_shard_mask_;
+    
+    // ASYNC callback dispatch; the pool is set once, before any strand exists
+    ThreadPool* callback_pool_ = nullptr;
+    int callback_priority_ = 0;
+    std::atomic<size_t> pending_strands_{0}; // Strand and conflation tasks posted but not finished
+    
+    // Recording of the feed-driven update stream; changed only while stopped
+    CaptureWriter* capture_ = nullptr;
+    
+    // Shared memory copy of the books; read under the stripes by publish_snapshot()
+    std::atomic<ShmBookPublisher*> shm_publisher_{nullptr};
+    
+    // CONFLATED delivery: symbols whose latest update hasn't been delivered
+    DirtySet conflated_symbols_;
+    std::atomic<bool> conflation_scheduled_{false};
     
     // Metrics
     MarketDataMetrics metrics_;
-    mutable std::mutex metrics_mutex_;
     
-    // Week 2 memory management
+    // Week 2 memory management: slab of max_symbols PriceLevelBook blocks
     std::shared_ptr<week2::OrderBookAllocator> order_book_allocator_;
+    
+    // Week 2 memory management: order nodes and levels of the order-level books
+    std::once_flag order_pool_once_;
+    std::unique_ptr<week2::OrderBookAllocator> order_pool_;
+    std::atomic<bool> order_pool_ready_{false};
 };
 
 } // namespace trading 
\ No newline at end of file
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <chrono>
+#include <type_traits>
+#include "price.hpp"
+#include "symbol_registry.hpp"
+
+/**
+ * @file market_tick.hpp
+ * @brief ID-keyed market update shared by the handler and the feed sources.
+ */
+
+namespace trading {
+
+/**
+ * @brief ID-keyed counterpart of MarketUpdate used on the tick path.
+ * 
+ * Symbol and exchange are interned IDs handed out by subscribe() and
+ * add_exchange(), so the struct is trivially copyable and processing it
+ * needs no string hashing or heap-backed strings.
+ */
+struct MarketTick {
+    SymbolId symbol_id;
+    ExchangeId exchange_id;
+    Price bid_price;
+    Price ask_price;
+    int volume;
+    std::chrono::nanoseconds timestamp;
+};
+
+static_assert(std::is_trivially_copyable_v<MarketTick>, "MarketTick must stay trivially copyable");
+
+} // namespace trading
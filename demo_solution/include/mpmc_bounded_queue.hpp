@@ -0,0 +1,301 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <utility>
+
+/**
+ * @file mpmc_bounded_queue.hpp
+ * @brief Bounded multi-producer/multi-consumer queue (Week 3).
+ *
+ * A fixed ring of cells, each carrying a sequence number that tells
+ * producers and consumers whose turn it is (Vyukov's bounded MPMC queue):
+ * - No allocation after construction and no memory reclamation problem
+ * - One CAS per operation on the enqueue or dequeue position
+ * - Bulk operations claim several consecutive cells with a single CAS
+ * - A full queue is reported to the caller instead of growing, which gives
+ *   natural backpressure for signal and order traffic
+ */
+
+namespace trading {
+
+/**
+ * @brief Lock-free bounded MPMC queue.
+ *
+ * Any number of threads may enqueue and dequeue concurrently. The capacity
+ * is fixed at construction and rounded up to a power of two.
+ *
+ * @tparam T Type of elements stored in the queue
+ */
+template<typename T>
+class MpmcBoundedQueue {
+    static constexpr size_t CACHE_LINE = 64;
+
+    /**
+     * @brief One ring slot.
+     *
+     * sequence == position: free for the producer claiming `position`.
+     * sequence == position + 1: holds the element for the consumer claiming `position`.
+     */
+    struct Cell {
+        std::atomic<size_t> sequence;
+        alignas(T) unsigned char storage[sizeof(T)];
+
+        T* value() {
+            return std::launder(reinterpret_cast<T*>(storage));
+        }
+    };
+
+public:
+    /**
+     * @brief Construct a queue.
+     *
+     * @param capacity Minimum number of elements the queue can hold
+     */
+    explicit MpmcBoundedQueue(size_t capacity)
+        : capacity_(round_up_to_power_of_two(capacity < 2 ? 2 : capacity)),
+          mask_(capacity_ - 1),
+          cells_(new Cell[capacity_]) {
+        for (size_t i = 0; i < capacity_; ++i) {
+            cells_[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    ~MpmcBoundedQueue() {
+        // Destroy elements that were never consumed
+        size_t end = enqueue_pos_.load(std::memory_order_relaxed);
+        for (size_t pos = dequeue_pos_.load(std::memory_order_relaxed); pos != end; ++pos) {
+            cells_[pos & mask_].value()->~T();
+        }
+    }
+
+    MpmcBoundedQueue(const MpmcBoundedQueue&) = delete;
+    MpmcBoundedQueue& operator=(const MpmcBoundedQueue&) = delete;
+
+    /**
+     * @brief Try to add an element.
+     *
+     * @param value Value to add
+     * @return true if the element was added, false if the queue is full
+     */
+    bool try_enqueue(const T& value) {
+        return emplace(value);
+    }
+
+    /**
+     * @brief Try to add an element by moving it.
+     *
+     * @param value Value to add
+     * @return true if the element was added, false if the queue is full
+     */
+    bool try_enqueue(T&& value) {
+        return emplace(std::move(value));
+    }
+
+    /**
+     * @brief Try to construct an element in place.
+     *
+     * @param args Constructor arguments for T
+     * @return true if the element was added, false if the queue is full
+     */
+    template<typename... Args>
+    bool emplace(Args&&... args) {
+        size_t pos = enqueue_pos_.load(std::memory_order_relaxed);
+        while (true) {
+            Cell& cell = cells_[pos & mask_];
+            size_t seq = cell.sequence.load(std::memory_order_acquire);
+            intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+            if (diff == 0) {
+                if (enqueue_pos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    new (cell.storage) T(std::forward<Args>(args)...);
+                    cell.sequence.store(pos + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if (diff < 0) {
+                // The cell still holds an element from the previous lap
+                return false;
+            } else {
+                pos = enqueue_pos_.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    /**
+     * @brief Try to remove an element.
+     *
+     * @param value Reference to store the removed element
+     * @return true if an element was removed, false if the queue is empty
+     */
+    bool try_dequeue(T& value) {
+        size_t pos = dequeue_pos_.load(std::memory_order_relaxed);
+        while (true) {
+            Cell& cell = cells_[pos & mask_];
+            size_t seq = cell.sequence.load(std::memory_order_acquire);
+            intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos + 1);
+            if (diff == 0) {
+                if (dequeue_pos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    consume(cell, pos, value);
+                    return true;
+                }
+            } else if (diff < 0) {
+                // The producer for this cell hasn't finished yet
+                return false;
+            } else {
+                pos = dequeue_pos_.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    /**
+     * @brief Add up to count elements with a single position CAS.
+     *
+     * Claims the longest run of consecutive free cells (at most count) and
+     * fills them in order. Fewer than count elements are added when the
+     * queue is nearly full.
+     *
+     * @param items Pointer to the first element to add
+     * @param count Number of elements
+     * @return size_t Number of elements added (a prefix of items)
+     */
+    size_t try_enqueue_bulk(const T* items, size_t count) {
+        size_t pos = enqueue_pos_.load(std::memory_order_relaxed);
+        while (count > 0) {
+            size_t run = 0;
+            while (run < count &&
+                   cells_[(pos + run) & mask_].sequence.load(std::memory_order_acquire) == pos + run) {
+                ++run;
+            }
+
+            if (run == 0) {
+                Cell& cell = cells_[pos & mask_];
+                size_t seq = cell.sequence.load(std::memory_order_acquire);
+                if (static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos) < 0) {
+                    return 0; // Full
+                }
+                pos = enqueue_pos_.load(std::memory_order_relaxed);
+                continue;
+            }
+
+            if (enqueue_pos_.compare_exchange_weak(pos, pos + run, std::memory_order_relaxed)) {
+                for (size_t i = 0; i < run; ++i) {
+                    Cell& cell = cells_[(pos + i) & mask_];
+                    new (cell.storage) T(items[i]);
+                    cell.sequence.store(pos + i + 1, std::memory_order_release);
+                }
+                return run;
+            }
+        }
+        return 0;
+    }
+
+    /**
+     * @brief Remove up to max_count elements with a single position CAS.
+     *
+     * @param items Output array with room for max_count elements
+     * @param max_count Maximum number of elements to remove
+     * @return size_t Number of elements removed
+     */
+    size_t try_dequeue_bulk(T* items, size_t max_count) {
+        size_t pos = dequeue_pos_.load(std::memory_order_relaxed);
+        while (max_count > 0) {
+            size_t run = 0;
+            while (run < max_count &&
+                   cells_[(pos + run) & mask_].sequence.load(std::memory_order_acquire) == pos + run + 1) {
+                ++run;
+            }
+
+            if (run == 0) {
+                Cell& cell = cells_[pos & mask_];
+                size_t seq = cell.sequence.load(std::memory_order_acquire);
+                if (static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos + 1) < 0) {
+                    return 0; // Empty
+                }
+                pos = dequeue_pos_.load(std::memory_order_relaxed);
+                continue;
+            }
+
+            if (dequeue_pos_.compare_exchange_weak(pos, pos + run, std::memory_order_relaxed)) {
+                for (size_t i = 0; i < run; ++i) {
+                    consume(cells_[(pos + i) & mask_], pos + i, items[i]);
+                }
+                return run;
+            }
+        }
+        return 0;
+    }
+
+    /**
+     * @brief Get the approximate number of elements.
+     *
+     * @return size_t Number of elements in the queue
+     */
+    size_t size() const {
+        size_t enq = enqueue_pos_.load(std::memory_order_relaxed);
+        size_t deq = dequeue_pos_.load(std::memory_order_relaxed);
+        return enq > deq ? enq - deq : 0;
+    }
+
+    /**
+     * @brief Check if the queue is empty.
+     *
+     * @return true if the queue is empty
+     */
+    bool empty() const {
+        return size() == 0;
+    }
+
+    /**
+     * @brief Get the number of cells.
+     */
+    size_t capacity() const {
+        return capacity_;
+    }
+
+    /**
+     * @brief Get the total number of elements that have been enqueued.
+     *
+     * @return size_t Total enqueued elements count
+     */
+    size_t total_enqueued() const {
+        return enqueue_pos_.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Get the total number of elements that have been dequeued.
+     *
+     * @return size_t Total dequeued elements count
+     */
+    size_t total_dequeued() const {
+        return dequeue_pos_.load(std::memory_order_relaxed);
+    }
+
+private:
+    static size_t round_up_to_power_of_two(size_t n) {
+        size_t power = 1;
+        while (power < n) {
+            power <<= 1;
+        }
+        return power;
+    }
+
+    // Move the element out and hand the cell to the producer of the next lap
+    void consume(Cell& cell, size_t pos, T& value) {
+        T* slot = cell.value();
+        value = std::move(*slot);
+        slot->~T();
+        cell.sequence.store(pos + capacity_, std::memory_order_release);
+    }
+
+    const size_t capacity_;
+    const size_t mask_;
+    std::unique_ptr<Cell[]> cells_;
+
+    // Producer and consumer positions on separate cache lines
+    alignas(CACHE_LINE) std::atomic<size_t> enqueue_pos_{0};
+    alignas(CACHE_LINE) std::atomic<size_t> dequeue_pos_{0};
+};
+
+} // namespace trading
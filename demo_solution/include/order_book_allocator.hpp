@@ -1,118 +1,345 @@
 #pragma once
 
-#include <iostream>
+#include <atomic>
 #include <cstddef>
+#include <cstdint>
 #include <memory>
+#include <new>
+
+#if defined(__linux__)
+#include <sys/mman.h>
+#endif
+
+#include "logger.hpp"
+#include "thread_placement.hpp"
 
 /**
  * @file order_book_allocator.hpp
- * @brief Custom memory allocator for OrderBook objects from Week 2.
- * 
- * This file demonstrates memory management optimizations from Week 2.
- * In a real implementation, this would include:
- * - Memory pooling to reduce fragmentation
- * - NUMA-aware allocation for multi-socket systems
- * - Lock-free memory allocation for concurrent access
+ * @brief Fixed-size slab allocator for order books and queue nodes (Week 2).
+ *
+ * This file demonstrates memory management optimizations from Week 2:
+ * - One preallocated slab, optionally backed by huge pages
+ * - Fixed-size, cache-line-aligned blocks (no fragmentation)
+ * - O(1) lock-free free list for concurrent allocate/deallocate
+ * - A standard allocator adapter so containers and queues can use the pool
  */
 
 namespace trading {
 namespace week2 {
 
 /**
- * @brief Custom memory allocator for OrderBook objects.
+ * @brief Fixed-size block pool backed by a single preallocated slab.
  *
  * This class represents the Week 2 homework implementation of a specialized
- * memory allocator for financial data structures. In a real implementation,
- * this would provide significant performance benefits through:
- * 1. Pre-allocation of memory pools
- * 2. Cache-friendly memory layout
- * 3. Reduced system calls for memory allocation
- * 4. Minimized fragmentation
+ * memory allocator for financial data structures:
+ * 1. All memory is reserved up front, so steady-state allocation never
+ *    calls into the system allocator
+ * 2. Blocks are rounded up to whole cache lines and cache-line aligned
+ * 3. The free list is a lock-free stack of block indexes; a version tag
+ *    packed next to the head index prevents the ABA problem
+ * 4. Requests larger than a block, or made while the pool is exhausted,
+ *    fall back to aligned ::operator new and are counted separately
  */
 class OrderBookAllocator {
 public:
+    static constexpr size_t BLOCK_ALIGNMENT = 64;
+    static constexpr size_t DEFAULT_BLOCK_SIZE = 256;
+
     /**
      * @brief Constructs a new OrderBookAllocator with specified capacity.
-     * 
-     * @param max_orders Maximum number of orders to support
+     *
+     * @param max_orders Number of blocks to preallocate
+     * @param block_size Size of each block in bytes (rounded up to BLOCK_ALIGNMENT)
+     * @param use_huge_pages Try to back the slab with huge pages (Linux only, falls back silently)
      */
-    explicit OrderBookAllocator(size_t max_orders) : max_orders_(max_orders) {
-        std::cout << "Week 2 optimization: Initializing OrderBookAllocator with capacity for " 
-                  << max_orders << " orders" << std::endl;
-        // In a real implementation, we would pre-allocate memory pools here
+    explicit OrderBookAllocator(size_t max_orders, size_t block_size = DEFAULT_BLOCK_SIZE,
+                                bool use_huge_pages = false)
+        : max_orders_(max_orders == 0 ? 1 : max_orders),
+          block_size_((block_size + BLOCK_ALIGNMENT - 1) / BLOCK_ALIGNMENT * BLOCK_ALIGNMENT),
+          slab_(nullptr),
+          slab_bytes_(0),
+          huge_pages_(false),
+          next_(new std::atomic<uint32_t>[max_orders_]) {
+        if (block_size_ == 0) {
+            block_size_ = BLOCK_ALIGNMENT;
+        }
+
+        reserve_slab(use_huge_pages);
+
+        // Thread every block onto the free list: block i -> block i + 1
+        for (size_t i = 0; i < max_orders_; ++i) {
+            next_[i].store(i + 1 < max_orders_ ? static_cast<uint32_t>(i + 1) : NIL,
+                           std::memory_order_relaxed);
+        }
+        free_head_.store(pack(0, 0), std::memory_order_release);
+
+        TRADING_LOG_INFO("Week 2 optimization: Initializing OrderBookAllocator with {} blocks of {} bytes{}",
+                         max_orders_, block_size_, huge_pages_ ? " (huge pages)" : "");
     }
-    
+
+    /**
+     * @brief Releases the slab. Blocks still in use become invalid.
+     */
+    ~OrderBookAllocator() {
+#if defined(__linux__)
+        munmap(slab_, slab_bytes_);
+#else
+        ::operator delete(slab_, std::align_val_t(BLOCK_ALIGNMENT));
+#endif
+    }
+
+    OrderBookAllocator(const OrderBookAllocator&) = delete;
+    OrderBookAllocator& operator=(const OrderBookAllocator&) = delete;
+
     /**
      * @brief Allocates memory of the specified size.
-     * 
+     *
+     * O(1) and lock-free when the request fits in a block and the pool
+     * is not exhausted.
+     *
      * @param size Size of memory to allocate in bytes
-     * @return void* Pointer to allocated memory
+     * @return void* Pointer to allocated memory (aligned to BLOCK_ALIGNMENT)
      */
     void* allocate(size_t size) {
-        // For demonstration purposes, we use operator new
-        // In a real Week 2 implementation, this would allocate from a memory pool
-        allocation_count_++;
-        total_allocated_ += size;
-        
-        // In a real implementation, we would use a custom memory pool
-        void* ptr = ::operator new(size);
-        
-        // Log allocation for demonstration purposes
-        std::cout << "Week 2 optimization: Allocated " << size << " bytes (total: " 
-                  << total_allocated_ << " bytes in " << allocation_count_ << " allocations)" << std::endl;
-        
-        return ptr;
-    }
-    
+        allocation_count_.fetch_add(1, std::memory_order_relaxed);
+        total_allocated_.fetch_add(size, std::memory_order_relaxed);
+
+        if (size <= block_size_) {
+            uint64_t head = free_head_.load(std::memory_order_acquire);
+            while (index_of(head) != NIL) {
+                uint32_t index = index_of(head);
+                uint32_t next = next_[index].load(std::memory_order_relaxed);
+                if (free_head_.compare_exchange_weak(head, pack(next, tag_of(head) + 1),
+                                                     std::memory_order_acquire,
+                                                     std::memory_order_acquire)) {
+                    return block_address(index);
+                }
+            }
+        }
+
+        // Oversized request or pool exhausted
+        fallback_count_.fetch_add(1, std::memory_order_relaxed);
+        return ::operator new(size, std::align_val_t(BLOCK_ALIGNMENT));
+    }
+
     /**
      * @brief Deallocates previously allocated memory.
-     * 
+     *
      * @param ptr Pointer to memory to deallocate
      */
     void deallocate(void* ptr) {
-        deallocation_count_++;
-        // For demonstration purposes, we use operator delete
-        // In a real Week 2 implementation, this would return memory to the pool
-        ::operator delete(ptr);
-        
-        // Log deallocation for demonstration purposes
-        std::cout << "Week 2 optimization: Deallocated memory (total deallocations: " 
-                  << deallocation_count_ << ")" << std::endl;
-    }
-    
+        if (ptr == nullptr) {
+            return;
+        }
+        deallocation_count_.fetch_add(1, std::memory_order_relaxed);
+
+        if (!owns(ptr)) {
+            ::operator delete(ptr, std::align_val_t(BLOCK_ALIGNMENT));
+            return;
+        }
+
+        // Push the block back onto the free list
+        uint32_t index = static_cast<uint32_t>(
+            (static_cast<char*>(ptr) - static_cast<char*>(slab_)) / block_size_);
+        uint64_t head = free_head_.load(std::memory_order_relaxed);
+        do {
+            next_[index].store(index_of(head), std::memory_order_relaxed);
+        } while (!free_head_.compare_exchange_weak(head, pack(index, tag_of(head) + 1),
+                                                   std::memory_order_release,
+                                                   std::memory_order_relaxed));
+    }
+
+    /**
+     * @brief Checks whether a pointer lies inside the slab.
+     */
+    bool owns(const void* ptr) const {
+        const char* p = static_cast<const char*>(ptr);
+        const char* begin = static_cast<const char*>(slab_);
+        return p >= begin && p < begin + max_orders_ * block_size_;
+    }
+
     /**
      * @brief Gets the number of allocations made.
-     * 
+     *
      * @return size_t Number of allocations
      */
     size_t get_allocation_count() const {
-        return allocation_count_;
+        return allocation_count_.load(std::memory_order_relaxed);
     }
-    
+
     /**
      * @brief Gets the number of deallocations made.
-     * 
+     *
      * @return size_t Number of deallocations
      */
     size_t get_deallocation_count() const {
-        return deallocation_count_;
+        return deallocation_count_.load(std::memory_order_relaxed);
     }
-    
+
     /**
      * @brief Gets the total number of bytes allocated.
-     * 
+     *
      * @return size_t Total bytes allocated
      */
     size_t get_total_allocated() const {
-        return total_allocated_;
+        return total_allocated_.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Gets the number of allocations served by the system allocator.
+     *
+     * Non-zero in steady state means the pool is undersized or a request
+     * is larger than block_size().
+     *
+     * @return size_t Number of fallback allocations
+     */
+    size_t get_fallback_count() const {
+        return fallback_count_.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Gets the size of each block in bytes.
+     */
+    size_t block_size() const {
+        return block_size_;
+    }
+
+    /**
+     * @brief Gets the number of blocks in the slab.
+     */
+    size_t capacity() const {
+        return max_orders_;
+    }
+
+    /**
+     * @brief Checks whether the slab ended up backed by huge pages.
+     */
+    bool uses_huge_pages() const {
+        return huge_pages_;
+    }
+
+    /**
+     * @brief Binds the slab to a NUMA node.
+     *
+     * Best called before the blocks are first used: untouched pages are then
+     * allocated on the node, touched ones have to be migrated.
+     *
+     * @param node Node the slab's users run on
+     * @return true if bound, false if the node doesn't exist or binding isn't supported or allowed
+     */
+    bool bind_to_numa_node(int node) {
+        bool bound = bind_memory_to_numa_node(slab_, slab_bytes_, node);
+        if (bound) {
+            TRADING_LOG_INFO("Week 3 optimization: Bound a {} byte slab to NUMA node {}", slab_bytes_, node);
+        }
+        return bound;
+    }
+
+private:
+    static constexpr uint32_t NIL = UINT32_MAX;
+
+    // Free list head: low 32 bits block index, high 32 bits ABA tag
+    static uint64_t pack(uint32_t index, uint32_t tag) {
+        return (static_cast<uint64_t>(tag) << 32) | index;
+    }
+    static uint32_t index_of(uint64_t head) { return static_cast<uint32_t>(head); }
+    static uint32_t tag_of(uint64_t head) { return static_cast<uint32_t>(head >> 32); }
+
+    void* block_address(uint32_t index) const {
+        return static_cast<char*>(slab_) + static_cast<size_t>(index) * block_size_;
+    }
+
+    void reserve_slab(bool use_huge_pages) {
+        size_t bytes = max_orders_ * block_size_;
+#if defined(__linux__) && defined(MAP_HUGETLB)
+        if (use_huge_pages) {
+            const size_t huge_page = 2 * 1024 * 1024;
+            size_t huge_bytes = (bytes + huge_page - 1) / huge_page * huge_page;
+            void* p = mmap(nullptr, huge_bytes, PROT_READ | PROT_WRITE,
+                           MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+            if (p != MAP_FAILED) {
+                slab_ = p;
+                slab_bytes_ = huge_bytes;
+                huge_pages_ = true;
+                return;
+            }
+        }
+#else
+        static_cast<void>(use_huge_pages);
+#endif
+#if defined(__linux__)
+        void* p = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (p == MAP_FAILED) {
+            throw std::bad_alloc();
+        }
+        slab_ = p;
+#else
+        slab_ = ::operator new(bytes, std::align_val_t(BLOCK_ALIGNMENT));
+#endif
+        slab_bytes_ = bytes;
+    }
+
+    size_t max_orders_;          // Number of blocks in the slab
+    size_t block_size_;          // Size of each block in bytes
+    void* slab_;                 // Start of the preallocated slab
+    size_t slab_bytes_;          // Mapped size of the slab
+    bool huge_pages_;            // Whether the slab is huge-page backed
+
+    std::unique_ptr<std::atomic<uint32_t>[]> next_; // Free list links, indexed by block
+    alignas(BLOCK_ALIGNMENT) std::atomic<uint64_t> free_head_{0};
+
+    // Statistics
+    alignas(BLOCK_ALIGNMENT) std::atomic<size_t> allocation_count_{0};   // Number of allocations made
+    std::atomic<size_t> deallocation_count_{0}; // Number of deallocations made
+    std::atomic<size_t> total_allocated_{0};    // Total bytes allocated
+    std::atomic<size_t> fallback_count_{0};     // Allocations served by ::operator new
+};
+
+/**
+ * @brief Standard allocator adapter over an OrderBookAllocator pool.
+ *
+ * Lets standard containers and the lock-free queue draw their nodes from
+ * the slab. Single objects that fit in a block come from the pool; larger
+ * requests transparently use the pool's fallback path. The pool must
+ * outlive every container using the adapter.
+ *
+ * @tparam T Value type
+ */
+template<typename T>
+class PoolAllocator {
+public:
+    using value_type = T;
+
+    explicit PoolAllocator(OrderBookAllocator* pool) noexcept : pool_(pool) {}
+
+    template<typename U>
+    PoolAllocator(const PoolAllocator<U>& other) noexcept : pool_(other.pool()) {}
+
+    T* allocate(size_t n) {
+        return static_cast<T*>(pool_->allocate(n * sizeof(T)));
     }
-    
+
+    void deallocate(T* ptr, size_t) noexcept {
+        pool_->deallocate(ptr);
+    }
+
+    OrderBookAllocator* pool() const noexcept {
+        return pool_;
+    }
+
 private:
-    size_t max_orders_;          // Maximum number of orders to support
-    size_t allocation_count_ = 0; // Number of allocations made
-    size_t deallocation_count_ = 0; // Number of deallocations made
-    size_t total_allocated_ = 0; // Total bytes allocated
+    OrderBookAllocator* pool_;
 };
 
+template<typename T, typename U>
+bool operator==(const PoolAllocator<T>& a, const PoolAllocator<U>& b) noexcept {
+    return a.pool() == b.pool();
+}
+
+template<typename T, typename U>
+bool operator!=(const PoolAllocator<T>& a, const PoolAllocator<U>& b) noexcept {
+    return !(a == b);
+}
+
 } // namespace week2
-} // namespace trading 
\ No newline at end of file
+} // namespace trading
@@ -0,0 +1,430 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "order_book_allocator.hpp"
+#include "price.hpp"
+#include "price_level_book.hpp"
+#include "symbol_registry.hpp"
+
+/**
+ * @file order_level_book.hpp
+ * @brief Order-by-order (L3) book with price-time priority (Week 3).
+ *
+ * Full-depth feeds send one message per order rather than per price
+ * level, so the book must absorb each add, modify, cancel and execution
+ * in constant time instead of re-sorting a vector of orders:
+ * - Every price level holds its resting orders in an intrusive doubly
+ *   linked FIFO, oldest first, so time priority is the list order
+ * - Open-addressing hash tables map order IDs to order nodes and prices
+ *   to levels, so no operation searches
+ * - Order nodes, levels and the nodes of the per-side price index all come
+ *   from a Week 2 OrderBookAllocator pool
+ * - Each level keeps its aggregated volume, and an attached PriceLevelBook
+ *   is updated level by level as orders change, so the L2 book and its
+ *   snapshots stay as cheap as with an aggregated feed
+ *
+ * Creating or emptying a level also updates the sorted price index, which
+ * costs O(log levels); everything else is O(1).
+ */
+
+namespace trading {
+
+using OrderId = uint64_t;
+
+/**
+ * @brief Kind of an order-level feed message.
+ */
+enum class OrderEventType : uint8_t {
+    ADD,      // New order at the back of its price level
+    MODIFY,   // New price and/or quantity; anything but a size-down loses priority
+    CANCEL,   // Order removed
+    EXECUTE   // Order (partially) filled; keeps its priority
+};
+
+/**
+ * @brief One order-level (L3) feed message.
+ */
+struct OrderEvent {
+    SymbolId symbol_id;
+    ExchangeId exchange_id;
+    OrderEventType type;
+    Side side;           // ADD only; other events use the side of the resting order
+    OrderId order_id;
+    Price price;         // ADD and MODIFY
+    int quantity;        // ADD and MODIFY: resting quantity, EXECUTE: quantity filled
+    std::chrono::nanoseconds timestamp;
+};
+
+static_assert(std::is_trivially_copyable_v<OrderEvent>, "OrderEvent must stay trivially copyable");
+
+struct OrderLevel;
+
+/**
+ * @brief One resting order; a node of its level's FIFO.
+ */
+struct OrderNode {
+    OrderId id;
+    Price price;
+    std::chrono::nanoseconds timestamp;  // Time priority: set on add and on priority-losing modifies
+    OrderNode* prev;                     // Older order at the same level
+    OrderNode* next;                     // Newer order at the same level
+    OrderLevel* level;
+    int quantity;
+    Side side;
+};
+
+/**
+ * @brief One price level: its orders in time priority and their total.
+ */
+struct OrderLevel {
+    Price price;
+    int64_t volume;        // Sum of the resting quantities
+    uint32_t order_count;
+    OrderNode* head;       // Oldest order, first to fill
+    OrderNode* tail;       // Newest order
+};
+
+namespace detail {
+
+/**
+ * @brief Open-addressing hash table from 64-bit keys to non-null pointers.
+ *
+ * Linear probing over a power-of-two slot array, kept at most half full.
+ * Erase shifts the following entries back instead of leaving tombstones,
+ * so lookups never slow down as orders come and go.
+ *
+ * @tparam V Pointee type
+ */
+template<typename V>
+class FlatPointerMap {
+public:
+    /**
+     * @brief Create an empty table.
+     *
+     * @param capacity Entries to make room for before the first rehash
+     */
+    explicit FlatPointerMap(size_t capacity = 64) {
+        size_t slots = 16;
+        while (slots < capacity * 2) {
+            slots *= 2;
+        }
+        slots_.assign(slots, Slot{0, nullptr});
+        mask_ = slots - 1;
+    }
+
+    /**
+     * @brief Look up a key.
+     *
+     * @param key Key to find
+     * @return V* The value, or nullptr if the key is absent
+     */
+    V* find(uint64_t key) const {
+        for (size_t i = hash(key) & mask_;; i = (i + 1) & mask_) {
+            const Slot& slot = slots_[i];
+            if (slot.value == nullptr || slot.key == key) {
+                return slot.value;
+            }
+        }
+    }
+
+    /**
+     * @brief Insert a key that is not present yet.
+     *
+     * @param key Key to insert
+     * @param value Non-null value
+     * @return true if inserted, false if the key was already present
+     */
+    bool insert(uint64_t key, V* value) {
+        if ((size_ + 1) * 2 > slots_.size()) {
+            rehash(slots_.size() * 2);
+        }
+        size_t i = hash(key) & mask_;
+        while (slots_[i].value != nullptr) {
+            if (slots_[i].key == key) {
+                return false;
+            }
+            i = (i + 1) & mask_;
+        }
+        slots_[i] = Slot{key, value};
+        ++size_;
+        return true;
+    }
+
+    /**
+     * @brief Remove a key.
+     *
+     * @param key Key to remove
+     * @return V* The removed value, or nullptr if the key was absent
+     */
+    V* erase(uint64_t key) {
+        size_t i = hash(key) & mask_;
+        while (slots_[i].value != nullptr && slots_[i].key != key) {
+            i = (i + 1) & mask_;
+        }
+        V* removed = slots_[i].value;
+        if (removed == nullptr) {
+            return nullptr;
+        }
+
+        // Backward-shift: pull later entries of the probe run into the hole
+        size_t hole = i;
+        for (size_t j = (i + 1) & mask_; slots_[j].value != nullptr; j = (j + 1) & mask_) {
+            size_t home = hash(slots_[j].key) & mask_;
+            // Move j unless its home lies cyclically in (hole, j]
+            if (((j - home) & mask_) >= ((j - hole) & mask_)) {
+                slots_[hole] = slots_[j];
+                hole = j;
+            }
+        }
+        slots_[hole] = Slot{0, nullptr};
+        --size_;
+        return removed;
+    }
+
+    /**
+     * @brief Remove every entry, keeping the slot array.
+     */
+    void clear() {
+        std::fill(slots_.begin(), slots_.end(), Slot{0, nullptr});
+        size_ = 0;
+    }
+
+    size_t size() const { return size_; }
+
+    /**
+     * @brief Call a function with every value, in no particular order.
+     *
+     * @param f Called as f(V*)
+     */
+    template<typename F>
+    void for_each(F&& f) const {
+        for (const Slot& slot : slots_) {
+            if (slot.value != nullptr) {
+                f(slot.value);
+            }
+        }
+    }
+
+private:
+    struct Slot {
+        uint64_t key;
+        V* value;  // nullptr: empty
+    };
+
+    // splitmix64 finalizer: sequential order IDs and tick-spaced prices spread over all slots
+    static uint64_t hash(uint64_t key) {
+        key ^= key >> 30;
+        key *= 0xbf58476d1ce4e5b9ULL;
+        key ^= key >> 27;
+        key *= 0x94d049bb133111ebULL;
+        return key ^ (key >> 31);
+    }
+
+    void rehash(size_t slots) {
+        std::vector<Slot> old(slots, Slot{0, nullptr});
+        old.swap(slots_);
+        mask_ = slots - 1;
+        for (const Slot& slot : old) {
+            if (slot.value != nullptr) {
+                size_t i = hash(slot.key) & mask_;
+                while (slots_[i].value != nullptr) {
+                    i = (i + 1) & mask_;
+                }
+                slots_[i] = slot;
+            }
+        }
+    }
+
+    std::vector<Slot> slots_;
+    size_t mask_ = 0;
+    size_t size_ = 0;
+};
+
+} // namespace detail
+
+/**
+ * @brief Order-by-order book for a single instrument.
+ *
+ * Not thread-safe: the owner serializes access, as MarketDataHandler does
+ * with the symbol's lock stripe. The pool must outlive the book.
+ */
+class OrderLevelBook {
+public:
+    // Pool block size that fits an order node, a level and a price index node
+    static constexpr size_t NODE_SIZE = 64;
+
+    /**
+     * @brief Create an empty book.
+     *
+     * @param pool Pool for order nodes, levels and index nodes; blocks of at least NODE_SIZE bytes
+     * @param l2 Aggregated book to keep up to date, or nullptr
+     * @param expected_orders Resting orders to size the order ID table for
+     */
+    explicit OrderLevelBook(week2::OrderBookAllocator& pool, PriceLevelBook* l2 = nullptr,
+                            size_t expected_orders = 1024);
+
+    /**
+     * @brief Return every order and level to the pool.
+     */
+    ~OrderLevelBook();
+
+    OrderLevelBook(const OrderLevelBook&) = delete;
+    OrderLevelBook& operator=(const OrderLevelBook&) = delete;
+
+    /**
+     * @brief Add an order at the back of its price level.
+     *
+     * @param id Order ID, unique among resting orders
+     * @param side Side of the order
+     * @param price Limit price
+     * @param quantity Quantity; must be positive
+     * @param timestamp Time of the order
+     * @return true if added, false if the ID is already resting or the quantity isn't positive
+     */
+    bool add(OrderId id, Side side, Price price, int quantity, std::chrono::nanoseconds timestamp);
+
+    /**
+     * @brief Change an order's price and/or quantity.
+     *
+     * Reducing the quantity at the same price keeps the order's place in
+     * the queue. Any other change moves it to the back of its (new) level,
+     * as exchanges do. A quantity of zero or less cancels it.
+     *
+     * @param id Order to change
+     * @param price New price
+     * @param quantity New resting quantity
+     * @param timestamp Time of the change
+     * @return true if changed, false if the order is unknown
+     */
+    bool modify(OrderId id, Price price, int quantity, std::chrono::nanoseconds timestamp);
+
+    /**
+     * @brief Remove an order.
+     *
+     * @param id Order to cancel
+     * @return true if removed, false if the order is unknown
+     */
+    bool cancel(OrderId id);
+
+    /**
+     * @brief Fill part or all of an order.
+     *
+     * @param id Order that traded
+     * @param quantity Quantity filled; the order is removed once nothing is left
+     * @return true if applied, false if the order is unknown or the quantity isn't positive
+     */
+    bool execute(OrderId id, int quantity);
+
+    /**
+     * @brief Apply a feed message.
+     *
+     * @param event Message to apply; its symbol and exchange are not checked
+     * @return true if the book changed
+     */
+    bool apply(const OrderEvent& event);
+
+    /**
+     * @brief Remove every order.
+     */
+    void clear();
+
+    /**
+     * @brief Look up a resting order.
+     *
+     * @param id Order ID
+     * @return const OrderNode* The order, or nullptr if it isn't resting
+     */
+    const OrderNode* find(OrderId id) const {
+        return orders_.find(id);
+    }
+
+    /**
+     * @brief Look up a price level.
+     *
+     * @param side Side of the book
+     * @param price Price of the level
+     * @return const OrderLevel* The level, or nullptr if no order rests there
+     */
+    const OrderLevel* level(Side side, Price price) const {
+        return side == Side::BID ? bids_.by_price.find(key(price)) : asks_.by_price.find(key(price));
+    }
+
+    /**
+     * @brief Get the best level of a side.
+     *
+     * @param side Side of the book
+     * @return const OrderLevel* Highest bid or lowest ask, or nullptr if the side is empty
+     */
+    const OrderLevel* best(Side side) const {
+        if (side == Side::BID) {
+            return bids_.levels.empty() ? nullptr : bids_.levels.begin()->second;
+        }
+        return asks_.levels.empty() ? nullptr : asks_.levels.begin()->second;
+    }
+
+    /**
+     * @brief Copy the aggregated levels of a side, best first.
+     *
+     * @param side Side of the book
+     * @param levels Receives up to max_levels levels
+     * @param max_levels Capacity of levels
+     * @return size_t Number of levels written
+     */
+    size_t top_levels(Side side, OrderBookEntry* levels, size_t max_levels) const;
+
+    size_t order_count() const { return orders_.size(); }
+    size_t level_count(Side side) const {
+        return side == Side::BID ? bids_.levels.size() : asks_.levels.size();
+    }
+
+private:
+    using LevelAllocator = week2::PoolAllocator<std::pair<const Price, OrderLevel*>>;
+
+    // Price index and level lookup of one side
+    template<typename Compare>
+    struct SideIndex {
+        explicit SideIndex(week2::OrderBookAllocator& pool) : levels(Compare{}, LevelAllocator(&pool)) {}
+
+        std::map<Price, OrderLevel*, Compare, LevelAllocator> levels;  // Best price first
+        detail::FlatPointerMap<OrderLevel> by_price;                   // Keyed by Price::raw()
+    };
+    using BidIndex = SideIndex<std::greater<Price>>;
+    using AskIndex = SideIndex<std::less<Price>>;
+
+    static uint64_t key(Price price) {
+        return static_cast<uint64_t>(price.raw());
+    }
+
+    // Find or create the level of a price and append an order to its FIFO
+    template<Side S, typename Index>
+    void link(Index& index, OrderNode* order);
+
+    // Take an order out of its level, dropping the level once empty
+    template<Side S, typename Index>
+    void unlink(Index& index, OrderNode* order);
+
+    // Dispatch on the order's side
+    void link(OrderNode* order);
+    void unlink(OrderNode* order);
+
+    // Mirror a level's new volume into the attached L2 book
+    template<Side S, typename Index>
+    void sync_level(Index& index, Price price, int64_t volume);
+
+    week2::OrderBookAllocator& pool_;
+    PriceLevelBook* l2_;
+    detail::FlatPointerMap<OrderNode> orders_;
+    BidIndex bids_;
+    AskIndex asks_;
+};
+
+} // namespace trading
@@ -0,0 +1,109 @@
+#pragma once
+
+#include <cmath>
+#include <compare>
+#include <cstdint>
+#include <type_traits>
+
+/**
+ * @file price.hpp
+ * @brief Fixed-point integer price type (Week 3).
+ *
+ * Prices are integers counting units of 1 / PRICE_SCALE (1e-8), the same
+ * fixed point the wire format carries. Two equal prices are therefore the
+ * same bits, book levels compare with integer instructions, and a decoded
+ * wire price needs no conversion at all. Doubles appear only at the API
+ * edge: from_double() when a price enters the system and to_double() when
+ * it is shown or fed to floating-point analytics.
+ *
+ * Each symbol can also have a tick size, its minimum price increment.
+ * from_double(price, tick_size) rounds onto that grid, so feeds that send
+ * 100.10000000000001 and 100.1 land on the same level.
+ */
+
+namespace trading {
+
+constexpr int64_t PRICE_SCALE = 100000000;  // Price units per currency unit
+
+/**
+ * @brief Strongly typed fixed-point price.
+ *
+ * Trivially copyable and 8 bytes; there are no implicit conversions from
+ * or to floating point.
+ */
+class Price {
+public:
+    constexpr Price() = default;
+
+    /**
+     * @brief Wrap a raw count of price units.
+     *
+     * @param raw Price in units of 1 / PRICE_SCALE
+     * @return Price The price
+     */
+    static constexpr Price from_raw(int64_t raw) {
+        Price price;
+        price.raw_ = raw;
+        return price;
+    }
+
+    /**
+     * @brief Convert a floating-point price, rounding to the nearest unit.
+     *
+     * @param price Price in currency units
+     * @return Price The price
+     */
+    static Price from_double(double price) {
+        return from_raw(static_cast<int64_t>(std::llround(price * static_cast<double>(PRICE_SCALE))));
+    }
+
+    /**
+     * @brief Convert a floating-point price, rounding to the nearest tick.
+     *
+     * @param price Price in currency units
+     * @param tick_size Minimum price increment; a non-positive tick rounds to the unit
+     * @return Price A multiple of tick_size
+     */
+    static Price from_double(double price, Price tick_size) {
+        if (tick_size.raw_ <= 1) {
+            return from_double(price);
+        }
+        double ticks = price * static_cast<double>(PRICE_SCALE) / static_cast<double>(tick_size.raw_);
+        return from_raw(static_cast<int64_t>(std::llround(ticks)) * tick_size.raw_);
+    }
+
+    /**
+     * @brief Get the raw count of price units.
+     *
+     * @return int64_t Price in units of 1 / PRICE_SCALE
+     */
+    constexpr int64_t raw() const {
+        return raw_;
+    }
+
+    /**
+     * @brief Convert to floating point for display or analytics.
+     *
+     * @return double Price in currency units
+     */
+    double to_double() const {
+        return static_cast<double>(raw_) / static_cast<double>(PRICE_SCALE);
+    }
+
+    constexpr auto operator<=>(const Price&) const = default;
+
+    constexpr Price operator+(Price other) const { return from_raw(raw_ + other.raw_); }
+    constexpr Price operator-(Price other) const { return from_raw(raw_ - other.raw_); }
+    constexpr Price operator*(int64_t ticks) const { return from_raw(raw_ * ticks); }
+
+private:
+    int64_t raw_ = 0;
+};
+
+static_assert(sizeof(Price) == sizeof(int64_t), "Price must stay a bare int64");
+static_assert(std::is_trivially_copyable_v<Price>, "Price must stay trivially copyable");
+
+// Default tick size: one price unit, so prices are only rounded to PRICE_SCALE
+constexpr Price DEFAULT_TICK_SIZE = Price::from_raw(1);
+
+} // namespace trading
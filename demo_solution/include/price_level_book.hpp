@@ -0,0 +1,283 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <chrono>
+#include <string>
+#include <algorithm>
+#include <iterator>
+#include <limits>
+#include <type_traits>
+#include "level_search.hpp"
+#include "price.hpp"
+
+/**
+ * @file price_level_book.hpp
+ * @brief Incremental fixed-capacity L2 order book storage.
+ *
+ * Replaces the "append, re-sort, truncate" maintenance of the order book
+ * with in-place level updates:
+ * - Fixed-capacity, cache-line-aligned level arrays (no heap traffic per tick)
+ * - Price levels are merged, so each price appears at most once per side
+ * - Insert/update/delete is a short search plus a small memmove
+ * - Prices and volumes are stored as separate arrays for SIMD search
+ */
+
+// Compile-time upper bound on the configurable book depth
+#ifndef TRADING_MAX_BOOK_DEPTH
+#define TRADING_MAX_BOOK_DEPTH 32
+#endif
+
+namespace trading {
+
+constexpr size_t CACHE_LINE_SIZE = 64;
+constexpr size_t MAX_BOOK_DEPTH = TRADING_MAX_BOOK_DEPTH;
+constexpr size_t DEFAULT_BOOK_DEPTH = 10;
+
+static_assert(MAX_BOOK_DEPTH > 0, "TRADING_MAX_BOOK_DEPTH must be positive");
+
+/**
+ * @brief Structure representing an entry in the order book.
+ *
+ * Using a simple struct for cache-friendly memory layout.
+ * This is an optimization for high-frequency trading systems.
+ * The fixed-point price makes level matching and ordering integer compares.
+ */
+struct OrderBookEntry {
+    Price price;
+    int volume;
+
+    // Needed for sorting
+    bool operator<(const OrderBookEntry& other) const {
+        return price < other.price;
+    }
+
+    bool operator>(const OrderBookEntry& other) const {
+        return price > other.price;
+    }
+};
+
+static_assert(std::is_trivially_copyable_v<OrderBookEntry>, "Levels are moved with memmove");
+
+/**
+ * @brief Side of the order book.
+ */
+enum class Side {
+    BID,
+    ASK
+};
+
+/**
+ * @brief One side of an L2 order book kept sorted by price.
+ *
+ * Levels live in fixed inline arrays so that updating the book never
+ * allocates. Bids are kept in descending order and asks in ascending order,
+ * so index 0 is always the best price. Only the best `depth` levels are
+ * retained; inserting a better level pushes the worst one out.
+ *
+ * Storage is struct-of-arrays: one contiguous array of raw prices and one
+ * of volumes. A price search then reads only prices, 8 to a cache line,
+ * and runs on the SIMD kernels of level_search.hpp. Slots past size()
+ * hold a price that ranks behind every real one, so the kernels can read
+ * whole vectors without masking the tail.
+ *
+ * @tparam S Side of the book (determines the sort direction)
+ */
+template<Side S>
+class alignas(CACHE_LINE_SIZE) PriceLevelSide {
+public:
+    // Slots per array: MAX_BOOK_DEPTH rounded up to whole SIMD steps
+    static constexpr size_t CAPACITY =
+        (MAX_BOOK_DEPTH + LEVEL_SEARCH_LANES - 1) / LEVEL_SEARCH_LANES * LEVEL_SEARCH_LANES;
+
+    /**
+     * @brief Construct an empty side.
+     *
+     * @param depth Number of levels to retain (clamped to [1, MAX_BOOK_DEPTH])
+     */
+    explicit PriceLevelSide(size_t depth = DEFAULT_BOOK_DEPTH)
+        : size_(0),
+          depth_(static_cast<uint32_t>(std::clamp<size_t>(depth, 1, MAX_BOOK_DEPTH))) {
+        std::fill(std::begin(prices_), std::end(prices_), EMPTY_PRICE);
+        std::fill(std::begin(volumes_), std::end(volumes_), 0);
+    }
+
+    /**
+     * @brief Insert, update or delete the level at a price.
+     *
+     * A positive volume inserts a new level or replaces the volume of an
+     * existing one; a zero or negative volume deletes the level.
+     *
+     * @param price Price of the level
+     * @param volume New aggregated volume at the level
+     * @return true if the side changed, false if the update fell outside the retained depth
+     */
+    bool apply(Price price, int volume) {
+        size_t pos = find_position(price.raw());
+
+        if (pos < size_ && prices_[pos] == price.raw()) {
+            if (volume > 0) {
+                volumes_[pos] = volume;
+            } else {
+                // Delete: close the gap and restore the padding behind the last level
+                size_t to_move = size_ - pos - 1;
+                std::memmove(&prices_[pos], &prices_[pos + 1], to_move * sizeof(int64_t));
+                std::memmove(&volumes_[pos], &volumes_[pos + 1], to_move * sizeof(int32_t));
+                --size_;
+                prices_[size_] = EMPTY_PRICE;
+                volumes_[size_] = 0;
+            }
+            return true;
+        }
+
+        // Deleting a level we don't have, or inserting below the retained depth
+        if (volume <= 0 || pos >= depth_) {
+            return false;
+        }
+
+        // Insert: shift worse levels down by one, dropping the last if full
+        size_t to_move = std::min<size_t>(size_, depth_ - 1) - pos;
+        std::memmove(&prices_[pos + 1], &prices_[pos], to_move * sizeof(int64_t));
+        std::memmove(&volumes_[pos + 1], &volumes_[pos], to_move * sizeof(int32_t));
+        prices_[pos] = price.raw();
+        volumes_[pos] = volume;
+        if (size_ < depth_) {
+            ++size_;
+        }
+        return true;
+    }
+
+    /**
+     * @brief Remove all levels.
+     */
+    void clear() {
+        std::fill(prices_, prices_ + size_, EMPTY_PRICE);
+        std::fill(volumes_, volumes_ + size_, 0);
+        size_ = 0;
+    }
+
+    /**
+     * @brief Find the level at a price.
+     *
+     * @param price Price to look up
+     * @return size_t Index of the level, or size() if there is none
+     */
+    size_t find(Price price) const {
+        size_t pos = find_position(price.raw());
+        return pos < size_ && prices_[pos] == price.raw() ? pos : size_;
+    }
+
+    /**
+     * @brief Total volume at prices at or better than a limit.
+     *
+     * This is the volume a marketable order limited at `limit` could reach.
+     *
+     * @param limit Worst price to include
+     * @return int64_t Summed volume
+     */
+    int64_t volume_through(Price limit) const {
+        // Levels at or better than `limit` are those before the insert position of the next worse price
+        int64_t raw = limit.raw();
+        size_t count;
+        if constexpr (S == Side::BID) {
+            count = raw == EMPTY_PRICE ? size_ : count_greater(prices_, size_, raw - 1);
+        } else {
+            count = raw == EMPTY_PRICE ? size_ : count_less(prices_, size_, raw + 1);
+        }
+        return sum_volumes(volumes_, count);
+    }
+
+    /**
+     * @brief Total volume of the best levels.
+     *
+     * @param levels Number of levels to include (clamped to size())
+     * @return int64_t Summed volume
+     */
+    int64_t total_volume(size_t levels) const {
+        return sum_volumes(volumes_, std::min<size_t>(levels, size_));
+    }
+
+    /**
+     * @brief Volume-weighted average price of the best levels.
+     *
+     * The price x volume products stay scalar: 64-bit integer multiplies
+     * and int64-to-double conversions have no AVX2 or SSE4 instruction.
+     *
+     * @param levels Number of levels to include (clamped to size())
+     * @return double VWAP in currency units, or 0.0 if the side is empty
+     */
+    double vwap(size_t levels) const {
+        size_t count = std::min<size_t>(levels, size_);
+        double notional = 0.0;
+        int64_t total = 0;
+        for (size_t i = 0; i < count; ++i) {
+            notional += static_cast<double>(prices_[i]) * volumes_[i];
+            total += volumes_[i];
+        }
+        return total > 0 ? notional / static_cast<double>(total) / static_cast<double>(PRICE_SCALE) : 0.0;
+    }
+
+    size_t size() const { return size_; }
+    size_t depth() const { return depth_; }
+    bool empty() const { return size_ == 0; }
+
+    OrderBookEntry operator[](size_t i) const { return OrderBookEntry{Price::from_raw(prices_[i]), volumes_[i]}; }
+    Price price(size_t i) const { return Price::from_raw(prices_[i]); }
+    int volume(size_t i) const { return volumes_[i]; }
+
+private:
+    // Padding price: ranks behind every real price on this side
+    static constexpr int64_t EMPTY_PRICE =
+        S == Side::BID ? std::numeric_limits<int64_t>::min() : std::numeric_limits<int64_t>::max();
+
+    // First index whose price does not rank ahead of `price`
+    size_t find_position(int64_t price) const {
+        if constexpr (S == Side::BID) {
+            return count_greater(prices_, size_, price);
+        } else {
+            return count_less(prices_, size_, price);
+        }
+    }
+
+    alignas(CACHE_LINE_SIZE) int64_t prices_[CAPACITY];  // Price::raw(), best first
+    alignas(CACHE_LINE_SIZE) int32_t volumes_[CAPACITY];
+    uint32_t size_;
+    uint32_t depth_;
+};
+
+/**
+ * @brief Incrementally maintained L2 book for a single instrument.
+ */
+struct PriceLevelBook {
+    explicit PriceLevelBook(size_t depth = DEFAULT_BOOK_DEPTH)
+        : timestamp(0), bids(depth), asks(depth) {}
+
+    std::string symbol;
+    std::chrono::nanoseconds timestamp;
+    PriceLevelSide<Side::BID> bids; // Best (highest) bid first
+    PriceLevelSide<Side::ASK> asks; // Best (lowest) ask first
+
+    /**
+     * @brief Mid price weighted by the depth of each side.
+     *
+     * Each side's VWAP over its best `levels` levels is weighted by the
+     * other side's volume, so the mid leans towards the thinner side,
+     * where the price is more likely to move.
+     *
+     * @param levels Number of levels per side to include
+     * @return double Weighted mid in currency units, or 0.0 if either side is empty
+     */
+    double depth_weighted_mid(size_t levels) const {
+        int64_t bid_volume = bids.total_volume(levels);
+        int64_t ask_volume = asks.total_volume(levels);
+        if (bid_volume <= 0 || ask_volume <= 0) {
+            return 0.0;
+        }
+        return (bids.vwap(levels) * static_cast<double>(ask_volume) +
+                asks.vwap(levels) * static_cast<double>(bid_volume)) /
+               static_cast<double>(bid_volume + ask_volume);
+    }
+};
+
+} // namespace trading
@@ -0,0 +1,89 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @file rate_counter.hpp
+ * @brief Lock-free windowed message-rate counter (Week 3).
+ *
+ * Counts go into a small ring of time slots keyed by slot epoch; the rate
+ * is the sum of the slots inside the window divided by the time the window
+ * covers. Recording is one relaxed load and one relaxed add in steady
+ * state; a slot is reset when the clock moves into it.
+ */
+
+namespace trading {
+
+/**
+ * @brief Messages per second over a sliding window of WINDOW_SLOTS slots.
+ *
+ * Meant to be written by one thread (or shard); concurrent writers are
+ * safe but may lose counts at slot boundaries. Readers may run at any time.
+ */
+class MessageRateCounter {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    static constexpr size_t SLOT_COUNT = 16;     // Ring size, must exceed WINDOW_SLOTS
+    static constexpr size_t WINDOW_SLOTS = 10;   // Slots covered by rate()
+    static constexpr std::chrono::nanoseconds SLOT_WIDTH = std::chrono::milliseconds(100);
+
+    /**
+     * @brief Count messages at a point in time.
+     *
+     * @param count Number of messages
+     * @param now Time of the messages
+     */
+    void record(uint64_t count, Clock::time_point now = Clock::now()) {
+        uint64_t epoch = epoch_of(now);
+        Slot& slot = slots_[epoch % SLOT_COUNT];
+        if (slot.epoch.load(std::memory_order_relaxed) != epoch) {
+            // First message of a new slot: forget what it counted a ring ago
+            slot.count.store(0, std::memory_order_relaxed);
+            slot.epoch.store(epoch, std::memory_order_release);
+        }
+        slot.count.fetch_add(count, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Get the message rate over the last window.
+     *
+     * @param now Time to measure up to
+     * @return double Messages per second
+     */
+    double rate(Clock::time_point now = Clock::now()) const {
+        uint64_t epoch = epoch_of(now);
+        uint64_t total = 0;
+        for (size_t i = 0; i < WINDOW_SLOTS && i <= epoch; ++i) {
+            const Slot& slot = slots_[(epoch - i) % SLOT_COUNT];
+            if (slot.epoch.load(std::memory_order_acquire) == epoch - i) {
+                total += slot.count.load(std::memory_order_relaxed);
+            }
+        }
+
+        return static_cast<double>(total) / window_seconds(now);
+    }
+
+private:
+    struct Slot {
+        std::atomic<uint64_t> epoch{UINT64_MAX};
+        std::atomic<uint64_t> count{0};
+    };
+
+    static uint64_t epoch_of(Clock::time_point time) {
+        return static_cast<uint64_t>(time.time_since_epoch() / SLOT_WIDTH);
+    }
+
+    // Full slots behind us plus the elapsed part of the current one
+    static double window_seconds(Clock::time_point now) {
+        auto into_slot = now.time_since_epoch() % SLOT_WIDTH;
+        return std::chrono::duration<double>((WINDOW_SLOTS - 1) * SLOT_WIDTH + into_slot).count();
+    }
+
+    Slot slots_[SLOT_COUNT];
+};
+
+} // namespace trading
@@ -0,0 +1,137 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+#include "spin_lock.hpp"
+
+/**
+ * @file seqlock.hpp
+ * @brief Sequence lock publishing a trivially copyable value (Week 3).
+ *
+ * The writer bumps a sequence counter to odd, writes the value and bumps it
+ * back to even. Readers copy the value without taking any lock and retry
+ * if the counter was odd or changed while they copied. Readers never make
+ * the writer wait, and a read costs a copy plus two loads of the counter.
+ *
+ * The value is stored as atomic words rather than raw bytes, so a copy
+ * racing with the writer is a well-defined (if torn) read that the
+ * sequence check then throws away. Words are written with release and read
+ * with acquire instead of using fences: a reader that sees any new word is
+ * then guaranteed to see the sequence move. On x86 these are plain moves.
+ */
+
+namespace trading {
+
+/**
+ * @brief Single-writer, multi-reader seqlock around a value of type T.
+ *
+ * Concurrent writers must be serialized by the caller. Both store() and
+ * load() can be limited to a prefix of T, so a value with a fixed maximum
+ * size but a smaller used part only copies what is used.
+ *
+ * @tparam T Trivially copyable value type
+ */
+template<typename T>
+class alignas(64) SeqLock {
+    static_assert(std::is_trivially_copyable_v<T>, "SeqLock values are copied as raw words");
+
+public:
+    static constexpr size_t WORD_COUNT = (sizeof(T) + sizeof(uint64_t) - 1) / sizeof(uint64_t);
+
+    SeqLock() {
+        for (auto& word : words_) {
+            word.store(0, std::memory_order_relaxed);
+        }
+    }
+
+    SeqLock(const SeqLock&) = delete;
+    SeqLock& operator=(const SeqLock&) = delete;
+
+    /**
+     * @brief Publish a new value (or its first bytes).
+     *
+     * Bytes of the stored value past `bytes` keep their previous contents.
+     *
+     * @param value Value to publish
+     * @param bytes Number of leading bytes to write (at most sizeof(T))
+     */
+    void store(const T& value, size_t bytes = sizeof(T)) {
+        uint64_t sequence = sequence_.load(std::memory_order_relaxed);
+        sequence_.store(sequence + 1, std::memory_order_relaxed);
+
+        const auto* source = reinterpret_cast<const unsigned char*>(&value);
+        size_t words = word_count(bytes);
+        for (size_t i = 0; i < words; ++i) {
+            uint64_t word = 0;
+            std::memcpy(&word, source + i * sizeof(uint64_t), chunk(bytes, i));
+            // Release: a reader that sees this word also sees the odd sequence
+            words_[i].store(word, std::memory_order_release);
+        }
+
+        sequence_.store(sequence + 2, std::memory_order_release);
+    }
+
+    /**
+     * @brief Copy out a consistent value (or its first bytes).
+     *
+     * Spins while a write is in progress and retries until no write
+     * overlapped the copy. Bytes of `value` past `bytes` are left untouched.
+     *
+     * @param value Receives the value
+     * @param bytes Number of leading bytes to read (at most sizeof(T))
+     * @return uint64_t Version of the value read (even; 0 if never stored)
+     */
+    uint64_t load(T& value, size_t bytes = sizeof(T)) const {
+        auto* target = reinterpret_cast<unsigned char*>(&value);
+        size_t words = word_count(bytes);
+        for (;;) {
+            uint64_t before = sequence_.load(std::memory_order_acquire);
+            if (before & 1) {
+                cpu_relax();
+                continue;
+            }
+
+            for (size_t i = 0; i < words; ++i) {
+                uint64_t word = words_[i].load(std::memory_order_acquire);
+                std::memcpy(target + i * sizeof(uint64_t), &word, chunk(bytes, i));
+            }
+
+            // The acquire loads above keep this check after the copy
+            if (sequence_.load(std::memory_order_relaxed) == before) {
+                return before;
+            }
+        }
+    }
+
+    /**
+     * @brief Get the current version; it changes on every store().
+     *
+     * @return uint64_t Sequence counter (odd while a store is in progress)
+     */
+    uint64_t version() const {
+        return sequence_.load(std::memory_order_acquire);
+    }
+
+private:
+    // Words covering the first `bytes` bytes
+    static size_t word_count(size_t bytes) {
+        bytes = bytes < sizeof(T) ? bytes : sizeof(T);
+        return (bytes + sizeof(uint64_t) - 1) / sizeof(uint64_t);
+    }
+
+    // Bytes of word i that fall inside the first `bytes` bytes
+    static size_t chunk(size_t bytes, size_t i) {
+        bytes = bytes < sizeof(T) ? bytes : sizeof(T);
+        size_t remaining = bytes - i * sizeof(uint64_t);
+        return remaining < sizeof(uint64_t) ? remaining : sizeof(uint64_t);
+    }
+
+    std::atomic<uint64_t> sequence_{0};
+    std::atomic<uint64_t> words_[WORD_COUNT];
+};
+
+} // namespace trading
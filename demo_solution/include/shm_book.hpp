@@ -0,0 +1,321 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+#include "book_snapshot.hpp"
+#include "seqlock.hpp"
+#include "symbol_registry.hpp"
+
+/**
+ * @file shm_book.hpp
+ * @brief Order book snapshots published in POSIX shared memory (Week 3).
+ *
+ * One feed handler per host publishes every book into a named shared
+ * memory segment; strategy processes map it and read books without
+ * running a handler of their own. The segment holds the same seqlocked
+ * BookSnapshot the handler publishes in-process, so a read is a copy out
+ * of the mapping: no syscalls, no locks, and the publisher never waits.
+ *
+ * Segment layout (all offsets from the start, native byte order):
+ *
+ *     header      magic "TRDSHMB1", version, sizes and offsets of the rest
+ *     directory   max_symbols entries: symbol name, set once per symbol
+ *     books       max_symbols SeqLock<BookSnapshot>, indexed by SymbolId
+ *     channels    max_consumers notification rings, page-aligned
+ *
+ * Publisher and readers must be built from the same headers; a reader
+ * rejects a segment whose version or slot size doesn't match its own.
+ * A restarted publisher creates a fresh segment under the same name, so
+ * readers of the old one have to reopen it.
+ */
+
+// Notification channels a segment offers to consumers
+#ifndef TRADING_SHM_MAX_CONSUMERS
+#define TRADING_SHM_MAX_CONSUMERS 8
+#endif
+
+// Update notifications buffered per consumer (rounded up to a power of two)
+#ifndef TRADING_SHM_NOTIFY_CAPACITY
+#define TRADING_SHM_NOTIFY_CAPACITY 4096
+#endif
+
+namespace trading {
+
+constexpr size_t SHM_MAX_CONSUMERS = TRADING_SHM_MAX_CONSUMERS;
+constexpr size_t SHM_NOTIFY_CAPACITY = TRADING_SHM_NOTIFY_CAPACITY;
+
+// Longest symbol name the directory can hold
+constexpr size_t SHM_MAX_SYMBOL_NAME = 55;
+
+/**
+ * @brief Shared memory segment layout.
+ *
+ * Everything in the segment is trivially destructible and only uses
+ * lock-free atomics, so it works across processes and at any address.
+ */
+struct ShmBookLayout {
+    static constexpr char MAGIC[8] = {'T', 'R', 'D', 'S', 'H', 'M', 'B', '1'};
+    static constexpr uint32_t VERSION = 1;
+
+    /**
+     * @brief Segment header; ready is set last, once everything is built.
+     */
+    struct Header {
+        char magic[8];
+        uint32_t version;
+        uint32_t slot_size;  // sizeof(SeqLock<BookSnapshot>)
+        uint32_t max_symbols;
+        uint32_t max_consumers;
+        uint32_t notify_capacity;
+        int32_t publisher_pid;
+        uint64_t directory_offset;
+        uint64_t books_offset;
+        uint64_t channels_offset;
+        uint64_t channel_stride;
+        uint64_t total_size;
+        std::atomic<uint32_t> ready;
+    };
+
+    /**
+     * @brief Directory entry of one symbol.
+     *
+     * The name is written once, before length is published; length 0
+     * means the symbol was never published.
+     */
+    struct SymbolEntry {
+        std::atomic<uint32_t> length;
+        char name[SHM_MAX_SYMBOL_NAME + 1];
+    };
+
+    /**
+     * @brief One notification: a symbol whose book changed.
+     *
+     * Cells follow Vyukov's bounded queue: sequence == position means free
+     * for the producer claiming `position`, position + 1 means full.
+     */
+    struct Cell {
+        std::atomic<uint64_t> sequence;
+        std::atomic<uint32_t> symbol_id;
+    };
+
+    /**
+     * @brief Notification channel of one consumer; its cells follow it.
+     *
+     * Book workers publishing different symbols may push concurrently, so
+     * the producer side claims cells by CAS. One process consumes.
+     */
+    struct Channel {
+        std::atomic<int32_t> owner_pid;  // 0 when free
+        std::atomic<uint64_t> dropped;
+        alignas(64) std::atomic<uint64_t> tail;  // Next position producers claim
+        alignas(64) std::atomic<uint64_t> head;  // Next position the consumer reads
+    };
+
+    static_assert(std::atomic<uint32_t>::is_always_lock_free && std::atomic<int32_t>::is_always_lock_free &&
+                  std::atomic<uint64_t>::is_always_lock_free,
+                  "Shared memory atomics must be address-free");
+};
+
+/**
+ * @brief Publishes books into a named shared memory segment.
+ *
+ * Creates the segment on construction, replacing any left behind by a
+ * publisher that has exited, and removes it on destruction. A segment
+ * whose publisher is still running is never replaced. publish() may be called
+ * concurrently for different symbols, but calls for one symbol must be
+ * serialized (the handler's lock stripes do that).
+ */
+class ShmBookPublisher {
+public:
+    /**
+     * @brief Create the segment.
+     *
+     * @param name Segment name, e.g. "/trading_books" (the leading '/' is optional)
+     * @param max_symbols Symbol IDs the segment can hold
+     * @param max_consumers Notification channels offered to readers
+     * @param notify_capacity Notifications buffered per channel
+     * @throws std::runtime_error if the segment can't be created, or a
+     *         running publisher already owns the name
+     */
+    ShmBookPublisher(const std::string& name, size_t max_symbols,
+                     size_t max_consumers = SHM_MAX_CONSUMERS,
+                     size_t notify_capacity = SHM_NOTIFY_CAPACITY);
+
+    /**
+     * @brief Unmap and remove the segment.
+     *
+     * Readers that still have it mapped keep reading the last books.
+     */
+    ~ShmBookPublisher();
+
+    ShmBookPublisher(const ShmBookPublisher&) = delete;
+    ShmBookPublisher& operator=(const ShmBookPublisher&) = delete;
+
+    /**
+     * @brief Publish a book and notify the attached consumers.
+     *
+     * The first publish of a symbol also lists its name in the directory.
+     * Only the used rows of the snapshot are written.
+     *
+     * @param symbol_id Symbol ID of the book
+     * @param symbol Name of the symbol
+     * @param snapshot Current state of the book
+     * @return true if published, false if the ID or name doesn't fit the segment
+     */
+    bool publish(SymbolId symbol_id, std::string_view symbol, const BookSnapshot& snapshot);
+
+    /**
+     * @brief Get the segment name, with its leading '/'.
+     */
+    const std::string& name() const {
+        return name_;
+    }
+
+    /**
+     * @brief Get the number of symbol IDs the segment holds.
+     */
+    size_t max_symbols() const {
+        return max_symbols_;
+    }
+
+    /**
+     * @brief Get the number of readers attached for notifications.
+     */
+    size_t consumers() const;
+
+    /**
+     * @brief Get the number of notifications dropped on full channels.
+     */
+    uint64_t notifications_dropped() const;
+
+private:
+    ShmBookLayout::Channel* channel(size_t index) const;
+
+    std::string name_;
+    size_t max_symbols_;
+    size_t max_consumers_;
+    size_t notify_mask_;
+    size_t channel_stride_;
+    size_t size_ = 0;
+    unsigned char* base_ = nullptr;
+    ShmBookLayout::SymbolEntry* directory_ = nullptr;
+    SeqLock<BookSnapshot>* books_ = nullptr;
+    unsigned char* channels_ = nullptr;
+};
+
+/**
+ * @brief Reads books from a publisher's segment, in any process.
+ *
+ * The directory and books are mapped read-only. A reader that asks for
+ * notifications also maps the channels and claims one of them; a channel
+ * left claimed by a process that died is taken over. Reads may be made
+ * from any thread; poll_update() from one thread at a time.
+ */
+class ShmBookReader {
+public:
+    /**
+     * @brief Map a publisher's segment.
+     *
+     * @param name Segment name given to the publisher
+     * @param notifications true to claim a notification channel
+     * @throws std::runtime_error if the segment doesn't exist, isn't a book
+     *         segment of this build, or has no free channel
+     */
+    explicit ShmBookReader(const std::string& name, bool notifications = false);
+
+    /**
+     * @brief Release the channel and unmap the segment.
+     */
+    ~ShmBookReader();
+
+    ShmBookReader(const ShmBookReader&) = delete;
+    ShmBookReader& operator=(const ShmBookReader&) = delete;
+
+    /**
+     * @brief Look up a symbol in the directory.
+     *
+     * A linear scan; look symbols up once and keep their IDs.
+     *
+     * @param symbol Name of the symbol
+     * @return SymbolId Its ID, or INVALID_SYMBOL_ID if it was never published
+     */
+    SymbolId find_symbol(std::string_view symbol) const;
+
+    /**
+     * @brief Get the name of a published symbol.
+     *
+     * @param symbol_id Symbol ID
+     * @return std::string_view Name in the mapping, empty if never published
+     */
+    std::string_view symbol_name(SymbolId symbol_id) const;
+
+    /**
+     * @brief Copy a book out of the segment.
+     *
+     * @param symbol_id Symbol ID
+     * @param snapshot Receives the book
+     * @return true if copied, false if the symbol was never published
+     */
+    bool read_snapshot(SymbolId symbol_id, BookSnapshot& snapshot) const;
+
+    /**
+     * @brief Read the best bid and ask, copying only the first row.
+     *
+     * @param symbol_id Symbol ID
+     * @return TopOfBook Best levels, empty if the symbol was never published
+     */
+    TopOfBook top_of_book(SymbolId symbol_id) const;
+
+    /**
+     * @brief Get a book's version; it changes on every publish.
+     *
+     * @param symbol_id Symbol ID
+     * @return uint64_t Seqlock sequence, 0 if never published
+     */
+    uint64_t version(SymbolId symbol_id) const;
+
+    /**
+     * @brief Take the next update notification.
+     *
+     * Notifications carry only the symbol; read its book for the data. After
+     * updates_dropped() grows, re-read every book of interest.
+     *
+     * @param symbol_id Receives the symbol whose book changed
+     * @return true if taken, false if none is pending or notifications are off
+     */
+    bool poll_update(SymbolId& symbol_id);
+
+    /**
+     * @brief Get the number of notifications dropped because the channel was full.
+     */
+    uint64_t updates_dropped() const;
+
+    /**
+     * @brief Get the number of symbol IDs the segment holds.
+     */
+    size_t max_symbols() const {
+        return max_symbols_;
+    }
+
+private:
+    const ShmBookLayout::SymbolEntry* entry(SymbolId symbol_id) const;
+    bool claim_channel(const ShmBookLayout::Header& header);
+    void unmap();
+
+    size_t max_symbols_ = 0;
+    size_t notify_mask_ = 0;
+    size_t size_ = 0;
+    size_t channels_size_ = 0;
+    const unsigned char* base_ = nullptr;
+    const ShmBookLayout::SymbolEntry* directory_ = nullptr;
+    const SeqLock<BookSnapshot>* books_ = nullptr;
+    unsigned char* channels_ = nullptr;  // Mapping of every channel, if notifications are on
+    ShmBookLayout::Channel* channel_ = nullptr;
+    uint64_t dropped_base_ = 0;  // Channel drops before we claimed it
+};
+
+} // namespace trading
@@ -0,0 +1,535 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <future>
+#include <iterator>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "thread_pool.hpp"
+
+/**
+ * @file sorting.hpp
+ * @brief Production sorting kernels (Week 1).
+ *
+ * - introsort(): pattern-defeating quicksort. Median-of-3 (ninther on large
+ *   ranges) pivots, insertion sort below a cutoff, heapsort once too many
+ *   partitions came out unbalanced, linear time on sorted input, and a
+ *   sorted-prefix fast path for series that are mostly in order already.
+ * - merge_sort(): stable bottom-up merge sort that ping-pongs between the
+ *   data and one scratch buffer, instead of allocating at every level.
+ * - radix_sort(): stable LSD radix sort on an unsigned integer key, such
+ *   as a fixed-point price or a timestamp; passes whose digit is the same
+ *   for every element are skipped.
+ * - parallel_sort(): sorts chunks with introsort on a ThreadPool, then
+ *   merges them pairwise in parallel rounds through one scratch buffer.
+ *
+ * All kernels take random-access iterators. merge_sort(), radix_sort() and
+ * parallel_sort() need a default-constructible value type for their buffer.
+ */
+
+namespace trading {
+namespace week1 {
+
+constexpr ptrdiff_t INSERTION_SORT_THRESHOLD = 24;  // Insertion sort below this size
+constexpr ptrdiff_t NINTHER_THRESHOLD = 128;        // Pseudo-median of 9 above this size
+constexpr size_t PARTIAL_INSERTION_SORT_LIMIT = 8;  // Moves before giving up on "nearly sorted"
+constexpr ptrdiff_t MERGE_RUN_SIZE = 32;            // merge_sort() starts from runs this long
+constexpr size_t PARALLEL_SORT_MIN_CHUNK = 1 << 14; // Smaller chunks aren't worth a task
+
+namespace detail {
+
+// Straight insertion sort of a small range
+template<typename It, typename Compare>
+void insertion_sort(It begin, It end, Compare& comp) {
+    if (begin == end) {
+        return;
+    }
+    for (It cur = begin + 1; cur != end; ++cur) {
+        if (comp(*cur, *(cur - 1))) {
+            auto value = std::move(*cur);
+            It sift = cur;
+            do {
+                *sift = std::move(*(sift - 1));
+                --sift;
+            } while (sift != begin && comp(value, *(sift - 1)));
+            *sift = std::move(value);
+        }
+    }
+}
+
+// Insertion sort that gives up after PARTIAL_INSERTION_SORT_LIMIT moves.
+// Returns true if the range ended up sorted.
+template<typename It, typename Compare>
+bool partial_insertion_sort(It begin, It end, Compare& comp) {
+    if (begin == end) {
+        return true;
+    }
+    size_t moves = 0;
+    for (It cur = begin + 1; cur != end; ++cur) {
+        if (comp(*cur, *(cur - 1))) {
+            auto value = std::move(*cur);
+            It sift = cur;
+            do {
+                *sift = std::move(*(sift - 1));
+                --sift;
+            } while (sift != begin && comp(value, *(sift - 1)));
+            *sift = std::move(value);
+
+            moves += static_cast<size_t>(cur - sift);
+            if (moves > PARTIAL_INSERTION_SORT_LIMIT) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+template<typename It, typename Compare>
+void sort2(It a, It b, Compare& comp) {
+    if (comp(*b, *a)) {
+        std::iter_swap(a, b);
+    }
+}
+
+template<typename It, typename Compare>
+void sort3(It a, It b, It c, Compare& comp) {
+    sort2(a, b, comp);
+    sort2(b, c, comp);
+    sort2(a, b, comp);
+}
+
+// Partition around the pivot at *begin: smaller elements to its left, the
+// rest to its right. Returns the pivot's final position and whether the
+// range was already partitioned. Needs an element >= pivot after begin,
+// which pivot selection guarantees.
+template<typename It, typename Compare>
+std::pair<It, bool> partition_right(It begin, It end, Compare& comp) {
+    auto pivot = std::move(*begin);
+    It first = begin;
+    It last = end;
+
+    while (comp(*++first, pivot)) {
+    }
+    if (first - 1 == begin) {
+        while (first < last && !comp(*--last, pivot)) {
+        }
+    } else {
+        while (!comp(*--last, pivot)) {
+        }
+    }
+
+    bool already_partitioned = first >= last;
+    while (first < last) {
+        std::iter_swap(first, last);
+        while (comp(*++first, pivot)) {
+        }
+        while (!comp(*--last, pivot)) {
+        }
+    }
+
+    It pivot_pos = first - 1;
+    *begin = std::move(*pivot_pos);
+    *pivot_pos = std::move(pivot);
+    return {pivot_pos, already_partitioned};
+}
+
+// Partition with elements equal to the pivot at *begin going left. Used
+// when the pivot equals the element before the range, so every equal
+// element is already in place and only the right part needs sorting.
+template<typename It, typename Compare>
+It partition_left(It begin, It end, Compare& comp) {
+    auto pivot = std::move(*begin);
+    It first = begin;
+    It last = end;
+
+    while (comp(pivot, *--last)) {
+    }
+    if (last + 1 == end) {
+        while (first < last && !comp(pivot, *++first)) {
+        }
+    } else {
+        while (!comp(pivot, *++first)) {
+        }
+    }
+
+    while (first < last) {
+        std::iter_swap(first, last);
+        while (comp(pivot, *--last)) {
+        }
+        while (!comp(pivot, *++first)) {
+        }
+    }
+
+    It pivot_pos = last;
+    *begin = std::move(*pivot_pos);
+    *pivot_pos = std::move(pivot);
+    return pivot_pos;
+}
+
+// Swap a few elements around to break up the pattern behind a bad pivot
+template<typename It>
+void break_patterns(It begin, It end) {
+    ptrdiff_t size = end - begin;
+    if (size < INSERTION_SORT_THRESHOLD) {
+        return;
+    }
+    ptrdiff_t quarter = size / 4;
+    std::iter_swap(begin, begin + quarter);
+    std::iter_swap(end - 1, end - quarter);
+    if (size > NINTHER_THRESHOLD) {
+        std::iter_swap(begin + 1, begin + (quarter + 1));
+        std::iter_swap(begin + 2, begin + (quarter + 2));
+        std::iter_swap(end - 2, end - (quarter + 1));
+        std::iter_swap(end - 3, end - (quarter + 2));
+    }
+}
+
+// Pattern-defeating quicksort loop. leftmost is false when the element
+// before begin is known to be <= every element of the range.
+template<typename It, typename Compare>
+void introsort_loop(It begin, It end, Compare& comp, int bad_allowed, bool leftmost) {
+    for (;;) {
+        ptrdiff_t size = end - begin;
+        if (size < INSERTION_SORT_THRESHOLD) {
+            insertion_sort(begin, end, comp);
+            return;
+        }
+
+        // Median of 3 (or pseudo-median of 9) ends up at *begin
+        ptrdiff_t half = size / 2;
+        if (size > NINTHER_THRESHOLD) {
+            sort3(begin, begin + half, end - 1, comp);
+            sort3(begin + 1, begin + (half - 1), end - 2, comp);
+            sort3(begin + 2, begin + (half + 1), end - 3, comp);
+            sort3(begin + (half - 1), begin + half, begin + (half + 1), comp);
+            std::iter_swap(begin, begin + half);
+        } else {
+            sort3(begin + half, begin, end - 1, comp);
+        }
+
+        // Pivot equal to the predecessor: a run of equal keys, put them all left
+        if (!leftmost && !comp(*(begin - 1), *begin)) {
+            begin = partition_left(begin, end, comp) + 1;
+            continue;
+        }
+
+        auto [pivot_pos, already_partitioned] = partition_right(begin, end, comp);
+        ptrdiff_t left_size = pivot_pos - begin;
+        ptrdiff_t right_size = end - (pivot_pos + 1);
+
+        if (left_size < size / 8 || right_size < size / 8) {
+            // Too many bad pivots: finish with guaranteed O(n log n)
+            if (--bad_allowed == 0) {
+                std::make_heap(begin, end, comp);
+                std::sort_heap(begin, end, comp);
+                return;
+            }
+            break_patterns(begin, pivot_pos);
+            break_patterns(pivot_pos + 1, end);
+        } else if (already_partitioned &&
+                   partial_insertion_sort(begin, pivot_pos, comp) &&
+                   partial_insertion_sort(pivot_pos + 1, end, comp)) {
+            // Nothing moved: the range was (nearly) sorted
+            return;
+        }
+
+        introsort_loop(begin, pivot_pos, comp, bad_allowed, leftmost);
+        begin = pivot_pos + 1;
+        leftmost = false;
+    }
+}
+
+// One bottom-up merge pass over runs of width from src into dst
+template<typename Src, typename Dst, typename Compare>
+void merge_pass(Src src, Dst dst, ptrdiff_t size, ptrdiff_t width, Compare& comp) {
+    for (ptrdiff_t lo = 0; lo < size; lo += 2 * width) {
+        ptrdiff_t mid = std::min(lo + width, size);
+        ptrdiff_t hi = std::min(lo + 2 * width, size);
+        if (mid == hi || !comp(src[mid], src[mid - 1])) {
+            // Runs already in order (common on nearly-sorted data)
+            std::move(src + lo, src + hi, dst + lo);
+        } else {
+            std::merge(std::make_move_iterator(src + lo), std::make_move_iterator(src + mid),
+                       std::make_move_iterator(src + mid), std::make_move_iterator(src + hi),
+                       dst + lo, comp);
+        }
+    }
+}
+
+} // namespace detail
+
+/**
+ * @brief Sort a range with pattern-defeating quicksort (not stable).
+ *
+ * O(n log n) worst case. If the range starts with a sorted run covering
+ * at least half of it, only the rest is sorted and then merged in.
+ *
+ * @param begin First element
+ * @param end One past the last element
+ * @param comp Strict weak ordering
+ */
+template<typename It, typename Compare = std::less<>>
+void introsort(It begin, It end, Compare comp = Compare{}) {
+    ptrdiff_t size = end - begin;
+    if (size < 2) {
+        return;
+    }
+
+    // Sorted-prefix fast path; on random data the scan stops within a few elements
+    It run_end = std::is_sorted_until(begin, end, comp);
+    if (run_end == end) {
+        return;
+    }
+    if (run_end - begin >= size / 2) {
+        detail::introsort_loop(run_end, end, comp, static_cast<int>(std::bit_width(static_cast<size_t>(end - run_end))),
+                               true);
+        std::inplace_merge(begin, run_end, end, comp);
+        return;
+    }
+
+    detail::introsort_loop(begin, end, comp, static_cast<int>(std::bit_width(static_cast<size_t>(size))), true);
+}
+
+/**
+ * @brief Stable merge sort through a caller-owned scratch buffer.
+ *
+ * The buffer is grown to the range size if needed and can be reused
+ * across calls, so repeated sorts allocate nothing.
+ *
+ * @param begin First element
+ * @param end One past the last element
+ * @param comp Strict weak ordering
+ * @param scratch Buffer for the merge passes
+ */
+template<typename It, typename Compare>
+void merge_sort(It begin, It end, Compare comp, std::vector<typename std::iterator_traits<It>::value_type>& scratch) {
+    ptrdiff_t size = end - begin;
+    if (size < 2) {
+        return;
+    }
+    if (scratch.size() < static_cast<size_t>(size)) {
+        scratch.resize(static_cast<size_t>(size));
+    }
+
+    for (ptrdiff_t lo = 0; lo < size; lo += MERGE_RUN_SIZE) {
+        detail::insertion_sort(begin + lo, begin + std::min(lo + MERGE_RUN_SIZE, size), comp);
+    }
+
+    // Each pass moves everything to the other buffer, so there are no copies back
+    auto buffer = scratch.begin();
+    bool in_scratch = false;
+    for (ptrdiff_t width = MERGE_RUN_SIZE; width < size; width *= 2) {
+        if (in_scratch) {
+            detail::merge_pass(buffer, begin, size, width, comp);
+        } else {
+            detail::merge_pass(begin, buffer, size, width, comp);
+        }
+        in_scratch = !in_scratch;
+    }
+    if (in_scratch) {
+        std::move(buffer, buffer + size, begin);
+    }
+}
+
+/**
+ * @brief Stable merge sort with one scratch buffer for the whole sort.
+ *
+ * @param begin First element
+ * @param end One past the last element
+ * @param comp Strict weak ordering
+ */
+template<typename It, typename Compare = std::less<>>
+void merge_sort(It begin, It end, Compare comp = Compare{}) {
+    std::vector<typename std::iterator_traits<It>::value_type> scratch;
+    merge_sort(begin, end, comp, scratch);
+}
+
+/**
+ * @brief Map a signed key to an unsigned one with the same order.
+ *
+ * @param key Signed key, e.g. Price::raw() or a timestamp
+ * @return uint64_t Key for radix_sort()
+ */
+constexpr uint64_t radix_key(int64_t key) {
+    return static_cast<uint64_t>(key) ^ (uint64_t(1) << 63);
+}
+
+/**
+ * @brief Stable LSD radix sort on an unsigned integer key.
+ *
+ * One byte per pass, with all histograms built in a single read of the
+ * data. Passes where every key has the same byte are skipped, so keys
+ * spanning a narrow range (prices near one level, timestamps within a
+ * session) cost only the passes over the bytes that actually vary. Stable, so sorting
+ * by a secondary key and then by the primary one orders by both:
+ *
+ *     radix_sort(b, e, [](const StockPrice& s) { return radix_key(s.timestamp); }, scratch);
+ *     radix_sort(b, e, [](const StockPrice& s) { return radix_key(s.price); }, scratch);
+ *
+ * @param begin First element
+ * @param end One past the last element
+ * @param key Callable returning an unsigned integer key for an element
+ * @param scratch Buffer the passes scatter into; grown as needed, reusable
+ */
+template<typename It, typename Key>
+void radix_sort(It begin, It end, Key key, std::vector<typename std::iterator_traits<It>::value_type>& scratch) {
+    using KeyType = std::decay_t<decltype(key(*begin))>;
+    static_assert(std::is_unsigned_v<KeyType>, "radix_sort keys must be unsigned; see radix_key()");
+    constexpr size_t PASSES = sizeof(KeyType);
+    constexpr size_t BUCKETS = 256;
+
+    const size_t size = static_cast<size_t>(end - begin);
+    if (size < 2) {
+        return;
+    }
+    if (scratch.size() < size) {
+        scratch.resize(size);
+    }
+
+    // Every pass's histogram from one read of the keys
+    std::array<size_t, PASSES * BUCKETS> counts{};
+    for (It it = begin; it != end; ++it) {
+        KeyType k = key(*it);
+        for (size_t pass = 0; pass < PASSES; ++pass) {
+            ++counts[pass * BUCKETS + ((k >> (8 * pass)) & 0xFF)];
+        }
+    }
+
+    auto buffer = scratch.begin();
+    bool in_scratch = false;
+    auto scatter = [&](auto src, auto dst, size_t pass) {
+        size_t* offsets = &counts[pass * BUCKETS];
+        size_t total = 0;
+        for (size_t b = 0; b < BUCKETS; ++b) {
+            size_t count = offsets[b];
+            offsets[b] = total;
+            total += count;
+        }
+        for (size_t i = 0; i < size; ++i) {
+            size_t digit = (key(src[i]) >> (8 * pass)) & 0xFF;
+            dst[offsets[digit]++] = std::move(src[i]);
+        }
+    };
+
+    for (size_t pass = 0; pass < PASSES; ++pass) {
+        const size_t* histogram = &counts[pass * BUCKETS];
+        if (std::find(histogram, histogram + BUCKETS, size) != histogram + BUCKETS) {
+            continue;  // Every key has the same digit: this pass would not move anything
+        }
+        if (in_scratch) {
+            scatter(buffer, begin, pass);
+        } else {
+            scatter(begin, buffer, pass);
+        }
+        in_scratch = !in_scratch;
+    }
+    if (in_scratch) {
+        std::move(buffer, buffer + static_cast<ptrdiff_t>(size), begin);
+    }
+}
+
+/**
+ * @brief Stable LSD radix sort with a scratch buffer for the whole sort.
+ *
+ * @param begin First element
+ * @param end One past the last element
+ * @param key Callable returning an unsigned integer key for an element
+ */
+template<typename It, typename Key>
+void radix_sort(It begin, It end, Key key) {
+    std::vector<typename std::iterator_traits<It>::value_type> scratch;
+    radix_sort(begin, end, key, scratch);
+}
+
+/**
+ * @brief Sort a large range on a thread pool (not stable).
+ *
+ * The range is cut into a power-of-two number of chunks, at least one per
+ * pool thread, each at least PARALLEL_SORT_MIN_CHUNK long. Chunks are
+ * sorted with introsort() as pool tasks, then merged pairwise, each round
+ * in parallel, ping-ponging through one scratch buffer. Small ranges are
+ * sorted on the calling thread.
+ *
+ * Blocks until sorted, so it must not be called from a task of the same
+ * pool. Exceptions thrown by comp are rethrown after the running round.
+ *
+ * @param pool Pool to run the chunk sorts and merges on
+ * @param begin First element
+ * @param end One past the last element
+ * @param comp Strict weak ordering; copied into every task
+ * @param priority Priority of the sort's tasks on the pool
+ */
+template<typename It, typename Compare = std::less<>>
+void parallel_sort(ThreadPool& pool, It begin, It end, Compare comp = Compare{}, int priority = 0) {
+    using Value = typename std::iterator_traits<It>::value_type;
+    const size_t size = static_cast<size_t>(end - begin);
+
+    size_t chunks = std::bit_ceil(std::max<size_t>(pool.size(), 1));
+    while (chunks > 1 && size / chunks < PARALLEL_SORT_MIN_CHUNK) {
+        chunks /= 2;
+    }
+    if (chunks <= 1) {
+        introsort(begin, end, comp);
+        return;
+    }
+
+    auto bound = [size, chunks](size_t i) {
+        return static_cast<ptrdiff_t>(size / chunks * i + std::min(i, size % chunks));
+    };
+    // Every task of a round finishes before get() can rethrow, so none outlives scratch
+    auto wait_all = [](std::vector<std::future<void>>& futures) {
+        for (auto& future : futures) {
+            future.wait();
+        }
+        std::vector<std::future<void>> round = std::move(futures);
+        futures.clear();
+        for (auto& future : round) {
+            future.get();
+        }
+    };
+
+    std::vector<std::future<void>> futures;
+    futures.reserve(chunks);
+    for (size_t i = 0; i < chunks; ++i) {
+        futures.push_back(pool.submit(priority, [begin, comp, lo = bound(i), hi = bound(i + 1)] {
+            introsort(begin + lo, begin + hi, comp);
+        }));
+    }
+    wait_all(futures);
+
+    std::vector<Value> scratch(size);
+    auto buffer = scratch.begin();
+    bool in_scratch = false;
+    for (size_t width = 1; width < chunks; width *= 2) {
+        for (size_t i = 0; i < chunks; i += 2 * width) {
+            ptrdiff_t lo = bound(i);
+            ptrdiff_t mid = bound(i + width);
+            ptrdiff_t hi = bound(std::min(i + 2 * width, chunks));
+            auto merge = [comp, lo, mid, hi](auto src, auto dst) mutable {
+                std::merge(std::make_move_iterator(src + lo), std::make_move_iterator(src + mid),
+                           std::make_move_iterator(src + mid), std::make_move_iterator(src + hi),
+                           dst + lo, comp);
+            };
+            if (in_scratch) {
+                futures.push_back(pool.submit(priority, [merge, buffer, begin]() mutable { merge(buffer, begin); }));
+            } else {
+                futures.push_back(pool.submit(priority, [merge, buffer, begin]() mutable { merge(begin, buffer); }));
+            }
+        }
+        wait_all(futures);
+        in_scratch = !in_scratch;
+    }
+    if (in_scratch) {
+        std::move(buffer, buffer + static_cast<ptrdiff_t>(size), begin);
+    }
+}
+
+} // namespace week1
+} // namespace trading
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <atomic>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+/**
+ * @file spin_lock.hpp
+ * @brief Lightweight spinlock for very short critical sections (Week 3).
+ *
+ * Used where the protected work is a handful of instructions (e.g. updating
+ * one order book) and the cost of parking a thread in the kernel would
+ * exceed the cost of the critical section itself.
+ */
+
+namespace trading {
+
+/**
+ * @brief Hint to the CPU that we are in a spin-wait loop.
+ *
+ * Reduces power and frees pipeline resources for the sibling hyper-thread.
+ */
+inline void cpu_relax() {
+#if defined(__x86_64__) || defined(__i386__)
+    _mm_pause();
+#elif defined(__aarch64__)
+    asm volatile("yield" ::: "memory");
+#endif
+}
+
+/**
+ * @brief Test-and-test-and-set spinlock.
+ *
+ * Satisfies the standard Lockable requirements, so it works with
+ * std::lock_guard and std::unique_lock. Waiters spin on a plain load so the
+ * cache line stays shared until the lock is released.
+ */
+class SpinLock {
+public:
+    SpinLock() = default;
+    SpinLock(const SpinLock&) = delete;
+    SpinLock& operator=(const SpinLock&) = delete;
+
+    void lock() {
+        while (locked_.exchange(true, std::memory_order_acquire)) {
+            while (locked_.load(std::memory_order_relaxed)) {
+                cpu_relax();
+            }
+        }
+    }
+
+    bool try_lock() {
+        return !locked_.load(std::memory_order_relaxed) &&
+               !locked_.exchange(true, std::memory_order_acquire);
+    }
+
+    void unlock() {
+        locked_.store(false, std::memory_order_release);
+    }
+
+private:
+    std::atomic<bool> locked_{false};
+};
+
+} // namespace trading
@@ -0,0 +1,219 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <utility>
+#include <type_traits>
+
+/**
+ * @file spsc_ring_buffer.hpp
+ * @brief Bounded single-producer/single-consumer ring buffer (Week 3).
+ *
+ * The cheapest possible handoff between exactly two threads, e.g. an
+ * exchange feed thread and a book processing thread:
+ * - No allocation after construction, elements are constructed in place
+ * - One relaxed load and one release store per operation, no CAS
+ * - Producer and consumer indexes live on separate cache lines, and each
+ *   side caches the other's index so it rarely touches the shared line
+ */
+
+namespace trading {
+
+/**
+ * @brief Lock-free bounded SPSC queue with power-of-two capacity.
+ *
+ * Exactly one thread may call the producer side (try_push/emplace) and
+ * exactly one thread the consumer side (try_pop/try_pop_bulk). Indexes grow
+ * monotonically and are masked into the slot array, so they double as the
+ * total_enqueued()/total_dequeued() statistics.
+ *
+ * @tparam T Type of elements stored in the buffer
+ * @tparam Capacity Number of slots, must be a power of two
+ */
+template<typename T, size_t Capacity>
+class SpscRingBuffer {
+    static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0,
+                  "SpscRingBuffer capacity must be a power of two");
+
+    static constexpr size_t CACHE_LINE = 64;
+    static constexpr size_t MASK = Capacity - 1;
+
+    // Raw storage for one element
+    struct Slot {
+        alignas(T) unsigned char storage[sizeof(T)];
+    };
+
+public:
+    SpscRingBuffer() : slots_(new Slot[Capacity]) {}
+
+    ~SpscRingBuffer() {
+        // Destroy elements that were never consumed
+        size_t head = head_.load(std::memory_order_relaxed);
+        size_t tail = tail_.load(std::memory_order_relaxed);
+        for (; head != tail; ++head) {
+            element(head)->~T();
+        }
+    }
+
+    SpscRingBuffer(const SpscRingBuffer&) = delete;
+    SpscRingBuffer& operator=(const SpscRingBuffer&) = delete;
+
+    /**
+     * @brief Construct an element in place at the back (producer only).
+     *
+     * @param args Constructor arguments for T
+     * @return true if the element was added, false if the buffer is full
+     */
+    template<typename... Args>
+    bool emplace(Args&&... args) {
+        size_t tail = tail_.load(std::memory_order_relaxed);
+        if (tail - cached_head_ == Capacity) {
+            // Looks full - refresh our view of the consumer
+            cached_head_ = head_.load(std::memory_order_acquire);
+            if (tail - cached_head_ == Capacity) {
+                return false;
+            }
+        }
+
+        new (element(tail)) T(std::forward<Args>(args)...);
+        tail_.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * @brief Copy an element to the back (producer only).
+     *
+     * @param value Value to add
+     * @return true if the element was added, false if the buffer is full
+     */
+    bool try_push(const T& value) {
+        return emplace(value);
+    }
+
+    /**
+     * @brief Move an element to the back (producer only).
+     *
+     * @param value Value to add
+     * @return true if the element was added, false if the buffer is full
+     */
+    bool try_push(T&& value) {
+        return emplace(std::move(value));
+    }
+
+    /**
+     * @brief Remove the front element (consumer only).
+     *
+     * @param value Reference to store the removed element
+     * @return true if an element was removed, false if the buffer is empty
+     */
+    bool try_pop(T& value) {
+        size_t head = head_.load(std::memory_order_relaxed);
+        if (head == cached_tail_) {
+            // Looks empty - refresh our view of the producer
+            cached_tail_ = tail_.load(std::memory_order_acquire);
+            if (head == cached_tail_) {
+                return false;
+            }
+        }
+
+        T* slot = element(head);
+        value = std::move(*slot);
+        slot->~T();
+        head_.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * @brief Remove up to max_count elements from the front (consumer only).
+     *
+     * One acquire of the producer index and one release of the consumer
+     * index for the whole batch.
+     *
+     * @param values Array to move the removed elements into
+     * @param max_count Maximum number of elements to remove
+     * @return size_t Number of elements removed, 0 if the buffer is empty
+     */
+    size_t try_pop_bulk(T* values, size_t max_count) {
+        size_t head = head_.load(std::memory_order_relaxed);
+        if (cached_tail_ - head < max_count) {
+            cached_tail_ = tail_.load(std::memory_order_acquire);
+        }
+        size_t count = std::min(cached_tail_ - head, max_count);
+        for (size_t i = 0; i < count; ++i) {
+            T* slot = element(head + i);
+            values[i] = std::move(*slot);
+            slot->~T();
+        }
+        if (count > 0) {
+            head_.store(head + count, std::memory_order_release);
+        }
+        return count;
+    }
+
+    /**
+     * @brief Get the current number of elements.
+     *
+     * Exact when called from the producer or consumer thread, approximate
+     * from anywhere else.
+     *
+     * @return size_t Number of elements in the buffer
+     */
+    size_t size() const {
+        return tail_.load(std::memory_order_acquire) - head_.load(std::memory_order_acquire);
+    }
+
+    /**
+     * @brief Check if the buffer is empty.
+     *
+     * @return true if the buffer is empty
+     */
+    bool empty() const {
+        return size() == 0;
+    }
+
+    /**
+     * @brief Get the number of slots.
+     */
+    static constexpr size_t capacity() {
+        return Capacity;
+    }
+
+    /**
+     * @brief Get the total number of elements that have been enqueued.
+     *
+     * @return size_t Total enqueued elements count
+     */
+    size_t total_enqueued() const {
+        return tail_.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Get the total number of elements that have been dequeued.
+     *
+     * @return size_t Total dequeued elements count
+     */
+    size_t total_dequeued() const {
+        return head_.load(std::memory_order_relaxed);
+    }
+
+private:
+    T* element(size_t index) {
+        return std::launder(reinterpret_cast<T*>(slots_[index & MASK].storage));
+    }
+
+    // Consumer-owned line: read index plus cached producer index
+    alignas(CACHE_LINE) std::atomic<size_t> head_{0};
+    size_t cached_tail_{0};
+
+    // Producer-owned line: write index plus cached consumer index
+    alignas(CACHE_LINE) std::atomic<size_t> tail_{0};
+    size_t cached_head_{0};
+
+    // Slot storage, allocated once
+    alignas(CACHE_LINE) std::unique_ptr<Slot[]> slots_;
+};
+
+} // namespace trading
@@ -0,0 +1,285 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+#include "instrumented_lock.hpp"
+#include "latency_histogram.hpp"
+#include "market_tick.hpp"
+#include "price_level_book.hpp"
+#include "spsc_ring_buffer.hpp"
+
+/**
+ * @file strategy_signal.hpp
+ * @brief Allocation-free trading signals from strategies to execution (Week 3).
+ *
+ * A strategy writes fixed-size Signal records straight into its own
+ * preallocated SPSC ring. The execution stage drains every ring in
+ * batches. Nothing on the way allocates, formats text or takes a lock.
+ * Text is produced only by format_signal(), for logs and drop copies,
+ * after the signal has been handled.
+ */
+
+// Signals buffered between one strategy and the execution stage (power of two)
+#ifndef TRADING_SIGNAL_RING_CAPACITY
+#define TRADING_SIGNAL_RING_CAPACITY 1024
+#endif
+
+namespace trading {
+
+constexpr size_t SIGNAL_RING_CAPACITY = TRADING_SIGNAL_RING_CAPACITY;
+
+// Signals the execution stage takes from one strategy per batch
+constexpr size_t SIGNAL_BATCH_SIZE = 64;
+
+using StrategyId = uint16_t;
+
+/**
+ * @brief One order intent of a strategy.
+ *
+ * received_tsc is the TscClock reading when the tick that triggered the
+ * signal arrived. It anchors the tick-to-signal and tick-to-execution
+ * latencies. source_timestamp is the tick's own timestamp, carried through
+ * for audit and drop copies.
+ */
+struct Signal {
+    Price price;
+    std::chrono::nanoseconds source_timestamp{0};
+    uint64_t received_tsc = 0;
+    SymbolId symbol_id = INVALID_SYMBOL_ID;
+    int32_t quantity = 0;
+    StrategyId strategy_id = 0;
+    Side side = Side::BID;  // BID buys, ASK sells
+};
+
+static_assert(std::is_trivially_copyable_v<Signal>, "Signal must stay trivially copyable");
+
+/**
+ * @brief Output ring of one strategy.
+ *
+ * One producer at a time: a strategy is evaluated by one thread at a time,
+ * which may be a different pool worker on each tick as long as the
+ * evaluations are ordered (e.g. by waiting on the previous one). One
+ * consumer: the execution stage.
+ */
+class SignalChannel {
+public:
+    /**
+     * @brief Create the channel of a strategy.
+     *
+     * @param strategy_id Strategy writing to the channel
+     * @param ns_per_tick TscClock calibration; 0 measures it (about 1 ms, once per process)
+     */
+    explicit SignalChannel(StrategyId strategy_id, double ns_per_tick = 0.0)
+        : strategy_id_(strategy_id), ns_per_tick_(ns_per_tick > 0.0 ? ns_per_tick : TscClock::ns_per_tick()),
+          ring_(std::make_unique<Ring>()) {}
+
+    /**
+     * @brief Publish a signal (producer only).
+     *
+     * Stamps the strategy ID and records the tick-to-signal latency.
+     *
+     * @param signal Signal to publish
+     * @return true if queued, false if the ring is full and the signal was dropped
+     */
+    bool publish(Signal signal) {
+        signal.strategy_id = strategy_id_;
+        uint64_t now = TscClock::now();
+        tick_to_signal_.record(to_ns(now - signal.received_tsc));
+        if (!ring_->try_push(signal)) {
+            dropped_.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        return true;
+    }
+
+    /**
+     * @brief Publish a signal built from the tick that triggered it (producer only).
+     *
+     * @param tick Tick the strategy reacted to
+     * @param received_tsc TscClock reading when the tick arrived
+     * @param side BID to buy, ASK to sell
+     * @param price Limit price
+     * @param quantity Order quantity
+     * @return true if queued, false if the ring is full and the signal was dropped
+     */
+    bool emit(const MarketTick& tick, uint64_t received_tsc, Side side, Price price, int32_t quantity) {
+        Signal signal;
+        signal.price = price;
+        signal.source_timestamp = tick.timestamp;
+        signal.received_tsc = received_tsc;
+        signal.symbol_id = tick.symbol_id;
+        signal.quantity = quantity;
+        signal.side = side;
+        return publish(signal);
+    }
+
+    /**
+     * @brief Take up to max_count signals (consumer only).
+     *
+     * @param signals Array to copy the signals into
+     * @param max_count Maximum number of signals
+     * @return size_t Number of signals taken
+     */
+    size_t take(Signal* signals, size_t max_count) {
+        return ring_->try_pop_bulk(signals, max_count);
+    }
+
+    /**
+     * @brief Get the strategy writing to this channel.
+     */
+    StrategyId strategy_id() const {
+        return strategy_id_;
+    }
+
+    /**
+     * @brief Get the number of signals published, including dropped ones.
+     */
+    uint64_t published() const {
+        return ring_->total_enqueued() + dropped();
+    }
+
+    /**
+     * @brief Get the number of signals dropped on a full ring.
+     */
+    uint64_t dropped() const {
+        return dropped_.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Get the tick-to-signal latency histogram.
+     *
+     * @return const LatencyHistogram& Latencies in nanoseconds
+     */
+    const LatencyHistogram& tick_to_signal() const {
+        return tick_to_signal_;
+    }
+
+    /**
+     * @brief Convert TscClock ticks to nanoseconds.
+     *
+     * @param ticks Elapsed ticks
+     * @return uint64_t Elapsed nanoseconds
+     */
+    uint64_t to_ns(uint64_t ticks) const {
+        return static_cast<uint64_t>(static_cast<double>(ticks) * ns_per_tick_);
+    }
+
+private:
+    using Ring = SpscRingBuffer<Signal, SIGNAL_RING_CAPACITY>;
+
+    StrategyId strategy_id_;
+    double ns_per_tick_;
+    std::unique_ptr<Ring> ring_;
+    LatencyHistogram tick_to_signal_;  // Written by the producer only
+    std::atomic<uint64_t> dropped_{0};
+};
+
+/**
+ * @brief Execution stage: drains every strategy's channel in batches.
+ *
+ * Channels are added before the strategies start. drain() is called from
+ * one thread, the execution thread.
+ */
+class SignalRouter {
+public:
+    SignalRouter() : ns_per_tick_(TscClock::ns_per_tick()) {}
+
+    /**
+     * @brief Create the channel of a strategy.
+     *
+     * @param strategy_id Strategy writing to the channel
+     * @return SignalChannel& The channel, valid as long as the router
+     */
+    SignalChannel& add_strategy(StrategyId strategy_id) {
+        channels_.push_back(std::make_unique<SignalChannel>(strategy_id, ns_per_tick_));
+        return *channels_.back();
+    }
+
+    /**
+     * @brief Hand the queued signals to the execution handler.
+     *
+     * Visits every channel once and takes what it holds in batches of up to
+     * SIGNAL_BATCH_SIZE, at most one ring's worth, so a strategy that
+     * keeps publishing can't hold up the others. Each batch's
+     * tick-to-execution latency is recorded before handler sees it.
+     *
+     * @tparam Handler Callable as `void(std::span<const Signal>)`
+     * @param handler Execution handler
+     * @return size_t Number of signals handled
+     */
+    template<typename Handler>
+    size_t drain(Handler&& handler) {
+        Signal batch[SIGNAL_BATCH_SIZE];
+        size_t handled = 0;
+        for (auto& channel : channels_) {
+            size_t taken = 0;
+            size_t count;
+            while (taken < SIGNAL_RING_CAPACITY && (count = channel->take(batch, SIGNAL_BATCH_SIZE)) > 0) {
+                uint64_t now = TscClock::now();
+                for (size_t i = 0; i < count; ++i) {
+                    tick_to_execution_.record(channel->to_ns(now - batch[i].received_tsc));
+                }
+                handler(std::span<const Signal>(batch, count));
+                taken += count;
+            }
+            handled += taken;
+        }
+        return handled;
+    }
+
+    /**
+     * @brief Get the channels, in the order they were added.
+     */
+    const std::vector<std::unique_ptr<SignalChannel>>& channels() const {
+        return channels_;
+    }
+
+    /**
+     * @brief Get the tick-to-signal latency over every strategy.
+     *
+     * @return LatencySummary Summary in microseconds
+     */
+    LatencySummary tick_to_signal() const {
+        LatencySnapshot merged;
+        for (const auto& channel : channels_) {
+            merged.merge(channel->tick_to_signal());
+        }
+        return merged.summary();
+    }
+
+    /**
+     * @brief Get the latency from tick arrival to the execution handler.
+     *
+     * @return LatencySummary Summary in microseconds
+     */
+    LatencySummary tick_to_execution() const {
+        return tick_to_execution_.snapshot().summary();
+    }
+
+private:
+    double ns_per_tick_;
+    std::vector<std::unique_ptr<SignalChannel>> channels_;
+    LatencyHistogram tick_to_execution_;  // Written by the execution thread only
+};
+
+/**
+ * @brief Format a signal as text, for logs and drop copies.
+ *
+ * Allocates; keep it off the tick-to-order path.
+ *
+ * @param signal Signal to format
+ * @param strategy Name of the strategy
+ * @param symbol Name of the symbol
+ * @return std::string e.g. "SIGNAL:Alpha:AAPL:BUY 100@189.25"
+ */
+std::string format_signal(const Signal& signal, std::string_view strategy, std::string_view symbol);
+
+} // namespace trading
@@ -0,0 +1,154 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+#include <algorithm>
+
+#include "instrumented_lock.hpp"
+
+/**
+ * @file symbol_registry.hpp
+ * @brief Interning of symbol and exchange names into small dense IDs.
+ *
+ * Names are hashed once, at subscribe/add_exchange time. After that the
+ * tick path works purely on integer IDs, which index flat arrays of order
+ * books, callbacks and metrics directly.
+ */
+
+namespace trading {
+
+using SymbolId = uint32_t;
+using ExchangeId = uint16_t;
+
+constexpr SymbolId INVALID_SYMBOL_ID = std::numeric_limits<SymbolId>::max();
+constexpr ExchangeId INVALID_EXCHANGE_ID = std::numeric_limits<ExchangeId>::max();
+
+/**
+ * @brief Thread-safe, append-only mapping between names and dense IDs.
+ *
+ * IDs are handed out sequentially from 0 and are never reused, so they can
+ * be used directly as array indexes. Name lookups by ID are lock-free;
+ * lookups by name take a shared lock and are meant for the control plane
+ * and for the string-based convenience API.
+ *
+ * @tparam Id Unsigned integer type of the IDs
+ */
+template<typename Id>
+class NameRegistry {
+public:
+    static constexpr Id INVALID_ID = std::numeric_limits<Id>::max();
+
+    /**
+     * @brief Construct a registry with a fixed capacity.
+     *
+     * @param capacity Maximum number of names that can be registered
+     */
+    explicit NameRegistry(size_t capacity)
+        : capacity_(std::min<size_t>(capacity, INVALID_ID)),
+          names_(new std::string[capacity_]),
+          size_(0) {
+        ids_.reserve(capacity_);
+    }
+
+    NameRegistry(const NameRegistry&) = delete;
+    NameRegistry& operator=(const NameRegistry&) = delete;
+
+    /**
+     * @brief Get the ID for a name, registering it if it is new.
+     *
+     * @param name Name to intern
+     * @return Id The name's ID, or INVALID_ID if the registry is full
+     */
+    Id intern(const std::string& name) {
+        Id existing = find(name);
+        if (existing != INVALID_ID) {
+            return existing;
+        }
+
+        std::unique_lock<InstrumentedSharedMutex> lock(mutex_);
+
+        // Check again, another thread may have registered it meanwhile
+        auto it = ids_.find(name);
+        if (it != ids_.end()) {
+            return it->second;
+        }
+
+        size_t id = size_.load(std::memory_order_relaxed);
+        if (id >= capacity_) {
+            return INVALID_ID;
+        }
+
+        names_[id] = name;
+        ids_.emplace(name, static_cast<Id>(id));
+
+        // Publish the name before the ID becomes visible to name()
+        size_.store(id + 1, std::memory_order_release);
+        return static_cast<Id>(id);
+    }
+
+    /**
+     * @brief Look up the ID of a registered name.
+     *
+     * @param name Name to look up
+     * @return Id The name's ID, or INVALID_ID if it isn't registered
+     */
+    Id find(const std::string& name) const {
+        std::shared_lock<InstrumentedSharedMutex> lock(mutex_);
+        auto it = ids_.find(name);
+        return it == ids_.end() ? INVALID_ID : it->second;
+    }
+
+    /**
+     * @brief Get the name for an ID.
+     *
+     * @param id ID to look up
+     * @return const std::string& The name, or an empty string for unknown IDs
+     */
+    const std::string& name(Id id) const {
+        static const std::string empty;
+        if (static_cast<size_t>(id) >= size_.load(std::memory_order_acquire)) {
+            return empty;
+        }
+        return names_[id];
+    }
+
+    /**
+     * @brief Get the number of registered names.
+     */
+    size_t size() const {
+        return size_.load(std::memory_order_acquire);
+    }
+
+    /**
+     * @brief Get the maximum number of names.
+     */
+    size_t capacity() const {
+        return capacity_;
+    }
+
+    /**
+     * @brief Get contention statistics of the name lookup lock.
+     */
+    const LockStats& lock_stats() const {
+        return mutex_.stats();
+    }
+
+private:
+    size_t capacity_;
+    std::unique_ptr<std::string[]> names_; // Indexed by ID, never reallocated
+    std::atomic<size_t> size_;
+
+    mutable InstrumentedSharedMutex mutex_;
+    std::unordered_map<std::string, Id> ids_;
+};
+
+using SymbolRegistry = NameRegistry<SymbolId>;
+using ExchangeRegistry = NameRegistry<ExchangeId>;
+
+} // namespace trading
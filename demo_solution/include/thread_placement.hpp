@@ -0,0 +1,139 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+/**
+ * @file thread_placement.hpp
+ * @brief Where threads run and where their memory lives (Week 3).
+ *
+ * Threads that are left to the scheduler migrate between cores, lose their
+ * L1/L2 contents on every move and end up sharing caches with unrelated
+ * work. On multi-socket hosts they may also run far from the memory they
+ * use. These helpers pin threads to cores, name them for profilers and
+ * bind memory to a NUMA node. They are Linux-only; elsewhere they report
+ * failure and change nothing.
+ */
+
+namespace trading {
+
+/**
+ * @brief Placement of one role's threads, e.g. the exchange threads or a pool's workers.
+ *
+ * A default ThreadPlacement leaves threads unpinned, blocking when idle and
+ * named after their role.
+ */
+struct ThreadPlacement {
+    std::string name;        // Thread name prefix ("strat" names workers "strat-0", ...); empty uses the role's default
+    std::vector<int> cpus;   // Cores to pin to, thread i gets cpus[i % cpus.size()]; empty leaves threads unpinned
+    bool busy_spin = false;  // Idle threads spin instead of sleeping; meant for threads pinned to isolated cores
+    int numa_node = -1;      // Node to bind the role's memory to, -1 keeps first-touch placement
+
+    /**
+     * @brief Core for one thread of the role.
+     *
+     * @param thread_index Index of the thread within the role
+     * @return int Core to pin it to, or -1 if the role isn't pinned
+     */
+    int cpu_for(size_t thread_index) const {
+        return cpus.empty() ? -1 : cpus[thread_index % cpus.size()];
+    }
+};
+
+/**
+ * @brief Pin the calling thread to one core.
+ *
+ * @param cpu Core index
+ * @return true if pinned, false if the core doesn't exist or pinning isn't supported
+ */
+bool pin_current_thread(int cpu);
+
+/**
+ * @brief Name the calling thread, as shown by top, perf and debuggers.
+ *
+ * Linux keeps at most 15 characters; longer names are truncated.
+ *
+ * @param name Thread name
+ * @return true if named, false if naming isn't supported
+ */
+bool set_current_thread_name(const std::string& name);
+
+/**
+ * @brief Get the calling thread's name.
+ *
+ * @return std::string The name, or an empty string if it can't be read
+ */
+std::string current_thread_name();
+
+/**
+ * @brief Name and pin the calling thread as thread thread_index of a role.
+ *
+ * @param placement Placement of the role
+ * @param thread_index Index of the thread within the role
+ * @param name Full thread name, e.g. "md-NYSE"
+ * @return true if the thread is where the placement asked, false if pinning failed
+ */
+bool place_current_thread(const ThreadPlacement& placement, size_t thread_index, const std::string& name);
+
+/**
+ * @brief Get the core the calling thread is running on.
+ *
+ * @return int Core index, or -1 if unknown
+ */
+int current_cpu();
+
+/**
+ * @brief Parse a kernel CPU list such as "0-3,8,10-11".
+ *
+ * This is the format of isolcpus=, taskset -c and the sysfs cpulist files.
+ *
+ * @param list CPU list
+ * @return std::vector<int> Cores in ascending order, empty if the list is empty or malformed
+ */
+std::vector<int> parse_cpu_list(const std::string& list);
+
+/**
+ * @brief Get the cores isolated from the scheduler (isolcpus=).
+ *
+ * @return std::vector<int> Isolated cores, empty if there are none or they can't be read
+ */
+std::vector<int> isolated_cpus();
+
+/**
+ * @brief Get the number of NUMA nodes.
+ *
+ * @return size_t Number of nodes, 1 if the topology can't be read
+ */
+size_t numa_node_count();
+
+/**
+ * @brief Get the NUMA node a core belongs to.
+ *
+ * @param cpu Core index
+ * @return int Node index, or -1 if unknown
+ */
+int numa_node_of_cpu(int cpu);
+
+/**
+ * @brief Get the cores of a NUMA node.
+ *
+ * @param node Node index
+ * @return std::vector<int> Cores of the node, empty if unknown
+ */
+std::vector<int> numa_node_cpus(int node);
+
+/**
+ * @brief Bind a range of memory to a NUMA node.
+ *
+ * Pages not touched yet are allocated on the node, pages already touched
+ * are migrated to it. The range is widened to whole pages.
+ *
+ * @param address Start of the range
+ * @param bytes Length of the range
+ * @param node Node index
+ * @return true if bound, false if the node doesn't exist or binding isn't supported or allowed
+ */
+bool bind_memory_to_numa_node(void* address, size_t bytes, int node);
+
+} // namespace trading
@@ -1,39 +1,150 @@
 #pragma once
 
+#include <algorithm>
 #include <vector>
-#include <queue>
 #include <thread>
 #include <mutex>
 #include <condition_variable>
+#include <coroutine>
 #include <functional>
 #include <future>
+#include <memory>
 #include <atomic>
-#include <iostream>
+#include <chrono>
+#include <stdexcept>
+#include <tuple>
 #include <type_traits>  // for std::invoke_result
 
+#include "inplace_task.hpp"
+#include "instrumented_lock.hpp"
+#include "lock_free_queue.hpp"
+#include "logger.hpp"
+#include "order_book_allocator.hpp"
+#include "thread_placement.hpp"
+#include "work_stealing_deque.hpp"
+
 /**
  * @file thread_pool.hpp
- * @brief Priority-based thread pool implementation (Week 3).
- * 
- * This file demonstrates thread management optimizations from Week 3.
- * In a real implementation, this would include:
- * - Work stealing
- * - NUMA-awareness
- * - Cache-optimized task scheduling
+ * @brief Priority-based work-stealing thread pool implementation (Week 3).
+ *
+ * This file demonstrates thread management optimizations from Week 3:
+ * - Work stealing: every worker owns Chase-Lev deques, idle workers steal
+ * - A lock-free global injection queue for submits from outside the pool
+ * - Cache-optimized task scheduling: tasks spawned by a task stay on the
+ *   spawning worker's deque and run LIFO while their data is still hot
+ * - Allocation-free submission: tasks are InplaceTasks living in a slab,
+ *   and post() creates no future at all
+ * - Thread placement: workers can be named, pinned to cores, busy-spin
+ *   when idle, and have their task slab bound to a NUMA node
+ * - Elastic sizing: a pool can grow toward a maximum while tasks wait too
+ *   long in its queues, and retire workers that stay idle
+ * - Deadline scheduling: tasks may carry a deadline, run earliest deadline
+ *   first within their band, gain urgency as they wait, and are dropped or
+ *   flagged when they would start on data that has gone stale
+ * - Coroutine executor: `co_await pool.schedule(priority)` moves a
+ *   coroutine onto a worker (see coroutine_task.hpp)
  */
 
 namespace trading {
 
+/**
+ * @brief When an elastic ThreadPool grows and shrinks.
+ *
+ * Every interval the pool compares the average queue wait of the tasks
+ * picked up since the last check with target_wait. Above it, with work
+ * still queued and no worker idle, one worker is added. Below a quarter of
+ * it, with a worker parked for a whole cooldown, one worker is retired and
+ * the cooldown starts over. Waits in between change nothing, so the pool
+ * doesn't thrash around the target.
+ */
+struct PoolScalingPolicy {
+    std::chrono::microseconds target_wait{100};  // Queue wait above which the pool grows
+    std::chrono::milliseconds cooldown{1000};    // Idle time before each retirement
+    std::chrono::milliseconds interval{5};       // Check period; 0 leaves it to adjust_thread_count() calls
+};
+
+/**
+ * @brief What a worker does with a task whose deadline passed before it started.
+ */
+enum class StaleAction {
+    DROP,         // Discard it unrun; a submitted task's future throws std::future_errc::broken_promise
+    RUN_FLAGGED   // Run it anyway, with ThreadPool::current_task_is_stale() returning true
+};
+
+/**
+ * @brief Latest time at which a task is still worth starting.
+ *
+ * For work driven by market data the deadline is the tick's arrival plus
+ * the staleness the strategy tolerates: evaluating a 5 ms old tick wastes
+ * a core and produces signals on prices that are gone.
+ */
+struct TaskDeadline {
+    uint64_t tsc = 0;                          // TscClock reading of the deadline, 0 for none
+    StaleAction on_stale = StaleAction::DROP;
+
+    /**
+     * @brief Deadline at a fixed staleness after an event.
+     *
+     * @param max_staleness How long after since_tsc the task may still start
+     * @param since_tsc TscClock reading of the event, e.g. when the tick arrived
+     * @param on_stale What to do if the task starts later
+     * @return TaskDeadline The deadline
+     */
+    static TaskDeadline within(std::chrono::nanoseconds max_staleness, uint64_t since_tsc = TscClock::now(),
+                               StaleAction on_stale = StaleAction::DROP) {
+        static const double ns_per_tick = TscClock::ns_per_tick();
+        auto ticks = static_cast<uint64_t>(static_cast<double>(std::max<int64_t>(max_staleness.count(), 0)) /
+                                           ns_per_tick);
+        return TaskDeadline{since_tsc + ticks, on_stale};
+    }
+};
+
+/**
+ * @brief Point-in-time statistics of a ThreadPool.
+ */
+struct ThreadPoolStats {
+    size_t threads = 0;                   // Workers the pool runs now
+    size_t max_threads = 0;               // Workers it may grow to
+    uint64_t tasks_completed = 0;
+    uint64_t tasks_stolen = 0;
+    uint64_t threads_started = 0;         // Including the initial workers
+    uint64_t threads_retired = 0;
+    double avg_wait_time_us = 0.0;        // Queue wait of every task picked up so far
+    std::vector<uint64_t> tasks_per_thread; // Tasks run by each worker slot, any thread that held it
+    uint64_t deadline_tasks = 0;          // Tasks submitted with a deadline
+    uint64_t deadline_misses = 0;         // Deadline tasks that finished after their deadline
+    uint64_t stale_drops = 0;             // Deadline passed before they started, dropped unrun
+    uint64_t stale_runs = 0;              // Deadline passed before they started, run flagged
+    uint64_t aged_tasks = 0;              // Deadline tasks picked up while aged above their own band
+};
+
 /**
  * @brief A priority-based thread pool for parallel task execution.
- * 
+ *
  * This class represents the Week 3 implementation of a thread pool
  * that allows tasks to be submitted with different priorities.
  * Critical features include:
  * 1. Priority-based task scheduling
- * 2. Thread-safe task submission and execution
- * 3. Graceful shutdown
- * 4. Support for tasks with return values
+ * 2. Thread-safe task submission and execution without a global lock
+ * 3. Work stealing for load balancing
+ * 4. Graceful shutdown
+ * 5. Support for tasks with return values
+ *
+ * Priorities are mapped onto PRIORITY_BANDS classes (see priority_band()).
+ * Each band has its own injection queue and its own deque per worker, and
+ * workers always look for work in higher bands first. Within a band an
+ * owner runs its own tasks LIFO and thieves take them FIFO.
+ *
+ * Task objects and injection queue nodes are carved out of a Week 2 slab
+ * (task_allocator()), so in steady state post() never touches the system
+ * allocator and submit() only allocates the future's shared state.
+ *
+ * Tasks given a TaskDeadline (post_with_deadline(), submit_with_deadline())
+ * are kept apart, in one earliest-deadline-first heap per band. A band's
+ * deadline tasks run before its plain ones, which have no deadline at all.
+ * A deadline task competes one band higher for every aging step it has
+ * waited (set_deadline_aging()), so sustained high-priority load can't
+ * starve it. Plain tasks keep strict bands.
  */
 class ThreadPool {
 public:
@@ -42,58 +153,146 @@ public:
      */
     struct Task {
         int priority;  // Higher number = higher priority
-        std::function<void()> func;
-        
-        // Comparison operator for priority queue
+        InplaceTask func;
+        uint64_t enqueued = 0;  // TscClock ticks when scheduled, for the queue wait
+        uint64_t deadline = 0;  // TscClock ticks after which the task is stale, 0 for none
+        StaleAction on_stale = StaleAction::DROP;
+
+        // Comparison operator for priority ordering
         bool operator<(const Task& other) const {
             return priority < other.priority;
         }
     };
-    
+
+    // Number of priority classes; priorities are clamped into [0, PRIORITY_BANDS)
+    static constexpr size_t PRIORITY_BANDS = 4;
+
+    // Slab blocks reserved for tasks and injection queue nodes
+    static constexpr size_t DEFAULT_TASK_POOL_SIZE = 8192;
+
+    // Wait that lifts a deadline task by one band
+    static constexpr std::chrono::microseconds DEFAULT_AGING_STEP{1000};
+
     /**
-     * @brief Construct a new Thread Pool.
-     * 
-     * @param num_threads Number of worker threads
-     * @param verbose_logging Whether to log detailed operations (default: false)
-     */
-    explicit ThreadPool(size_t num_threads, bool verbose_logging = false)
-        : stop_(false), active_tasks_(0), total_tasks_completed_(0), verbose_logging_(verbose_logging) {
-        
-        std::cout << "Week 3 optimization: Creating thread pool with " 
-                  << num_threads << " threads" << std::endl;
-        
-        for (size_t i = 0; i < num_threads; ++i) {
-            workers_.emplace_back([this, i] {
-                worker_function(i);
-            });
+     * @brief Map a task priority onto its scheduling band.
+     *
+     * @param priority Task priority (higher number = higher priority)
+     * @return size_t Band index, PRIORITY_BANDS - 1 being the most urgent
+     */
+    static size_t priority_band(int priority) {
+        if (priority <= 0) {
+            return 0;
         }
+        return static_cast<size_t>(priority) >= PRIORITY_BANDS ? PRIORITY_BANDS - 1
+                                                               : static_cast<size_t>(priority);
     }
-    
+
+    /**
+     * @brief Construct a new Thread Pool.
+     *
+     * @param num_threads Number of worker threads
+     * @param verbose_logging Whether to log every task at LogLevel::DEBUG (default: false)
+     * @param task_pool_size Number of slab blocks for in-flight tasks; beyond
+     *        that tasks fall back to the system allocator
+     */
+    explicit ThreadPool(size_t num_threads, bool verbose_logging = false,
+                        size_t task_pool_size = DEFAULT_TASK_POOL_SIZE);
+
+    /**
+     * @brief Construct a new Thread Pool with placed workers.
+     *
+     * Worker i is named "<placement.name>-i" ("pool-i" by default) and pinned
+     * to placement.cpu_for(i). With placement.busy_spin idle workers spin
+     * on their core instead of sleeping, so a task is picked up without a
+     * wake-up; give them cores of their own. placement.numa_node binds the
+     * task slab to that node.
+     *
+     * @param num_threads Number of worker threads
+     * @param placement Names, cores, idle policy and NUMA node of the workers
+     * @param verbose_logging Whether to log every task at LogLevel::DEBUG (default: false)
+     * @param task_pool_size Number of slab blocks for in-flight tasks
+     */
+    ThreadPool(size_t num_threads, ThreadPlacement placement, bool verbose_logging = false,
+               size_t task_pool_size = DEFAULT_TASK_POOL_SIZE);
+
+    /**
+     * @brief Construct an elastic Thread Pool.
+     *
+     * Starts initial_threads workers and, unless policy.interval is 0,
+     * a monitor thread ("<placement.name>-ctl") that calls
+     * adjust_thread_count() every interval. The pool never shrinks on its
+     * own below initial_threads. Deques for max_threads workers are made
+     * up front, so growing only starts a thread.
+     *
+     * @param initial_threads Workers to start with, and the floor for retiring idle ones
+     * @param max_threads Workers the pool may grow to (at least initial_threads)
+     * @param policy Queue wait target, retirement cooldown and check interval
+     * @param placement Names, cores, idle policy and NUMA node of the workers
+     * @param verbose_logging Whether to log every task at LogLevel::DEBUG (default: false)
+     * @param task_pool_size Number of slab blocks for in-flight tasks
+     */
+    ThreadPool(size_t initial_threads, size_t max_threads, const PoolScalingPolicy& policy,
+               ThreadPlacement placement = ThreadPlacement{}, bool verbose_logging = false,
+               size_t task_pool_size = DEFAULT_TASK_POOL_SIZE);
+
     /**
      * @brief Destroy the Thread Pool, stopping all threads.
+     *
+     * Tasks already submitted are run before the workers exit.
      */
-    ~ThreadPool() {
-        {
-            std::lock_guard<std::mutex> lock(queue_mutex_);
-            stop_ = true;
-        }
-        
-        condition_.notify_all();
-        
-        std::cout << "Week 3 optimization: Stopping thread pool, joining all threads" << std::endl;
-        for (std::thread& worker : workers_) {
-            if (worker.joinable()) {
-                worker.join();
-            }
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    /**
+     * @brief Post a fire-and-forget task with a priority.
+     *
+     * No future and no allocation: the callable is stored inline in a
+     * pooled task. Callables larger than InplaceTask::BUFFER_SIZE fail to
+     * compile. An exception escaping the callable terminates the program,
+     * as it would on a std::thread.
+     *
+     * @tparam F Function type, invocable as `void()`
+     * @param priority Task priority (higher number = higher priority)
+     * @param f Function to execute
+     */
+    template<class F>
+    void post(int priority, F&& f) {
+        post_with_deadline(priority, TaskDeadline{}, std::forward<F>(f));
+    }
+
+    /**
+     * @brief Post a fire-and-forget task that is only worth starting before a deadline.
+     *
+     * @tparam F Function type, invocable as `void()`
+     * @param priority Task priority (higher number = higher priority)
+     * @param deadline Latest start and what to do when it is missed; a zero deadline posts a plain task
+     * @param f Function to execute
+     */
+    template<class F>
+    void post_with_deadline(int priority, const TaskDeadline& deadline, F&& f) {
+        static_assert(InplaceTask::fits<std::decay_t<F>>,
+                      "Callable too large for ThreadPool::post: capture less, or use submit()");
+
+        // Don't allow enqueuing after stopping the pool
+        if (stop_.load(std::memory_order_acquire)) {
+            throw std::runtime_error("Cannot submit task to stopped ThreadPool");
         }
-        
-        std::cout << "Thread pool completed " << total_tasks_completed_.load() 
-                  << " tasks in total" << std::endl;
+
+        schedule_task(new_task(priority, InplaceTask(std::forward<F>(f)), deadline));
+
+        TRADING_LOG_IF(verbose_logging_, LogLevel::DEBUG,
+                       "Week 3 optimization: Posted task with priority {} to thread pool", priority);
     }
-    
+
     /**
      * @brief Submit a task to the thread pool with a priority.
-     * 
+     *
+     * The callable and its arguments are moved into the future's shared
+     * state, which is the only allocation; the pooled task just holds the
+     * packaged_task. Use post() when no result is needed.
+     *
      * @tparam F Function type
      * @tparam Args Argument types
      * @param priority Task priority (higher number = higher priority)
@@ -102,151 +301,385 @@ public:
      * @return std::future<typename std::invoke_result<F, Args...>::type> Future result
      */
     template<class F, class... Args>
-    auto submit(int priority, F&& f, Args&&... args) 
+    auto submit(int priority, F&& f, Args&&... args)
         -> std::future<typename std::invoke_result<F, Args...>::type> {
-        
+        return submit_with_deadline(priority, TaskDeadline{}, std::forward<F>(f), std::forward<Args>(args)...);
+    }
+
+    /**
+     * @brief Submit a task that is only worth starting before a deadline.
+     *
+     * If the deadline passes before a worker starts the task and
+     * deadline.on_stale is StaleAction::DROP, the task never runs and the
+     * future throws std::future_error (broken_promise) from get().
+     *
+     * @tparam F Function type
+     * @tparam Args Argument types
+     * @param priority Task priority (higher number = higher priority)
+     * @param deadline Latest start and what to do when it is missed; a zero deadline submits a plain task
+     * @param f Function to execute
+     * @param args Arguments to pass to the function
+     * @return std::future<typename std::invoke_result<F, Args...>::type> Future result
+     */
+    template<class F, class... Args>
+    auto submit_with_deadline(int priority, const TaskDeadline& deadline, F&& f, Args&&... args)
+        -> std::future<typename std::invoke_result<F, Args...>::type> {
+
         using return_type = typename std::invoke_result<F, Args...>::type;
-        
-        // Create a shared pointer to the packaged task
-        auto task = std::make_shared<std::packaged_task<return_type()>>(
-            std::bind(std::forward<F>(f), std::forward<Args>(args)...)
-        );
-        
-        // Get future result before enqueuing
-        std::future<return_type> result = task->get_future();
-        
-        // Add task to the queue
-        {
-            std::lock_guard<std::mutex> lock(queue_mutex_);
-            
-            // Don't allow enqueuing after stopping the pool
-            if (stop_) {
-                throw std::runtime_error("Cannot submit task to stopped ThreadPool");
-            }
-            
-            // Wrap the packaged task in a void function
-            tasks_.push(Task{
-                priority,
-                [task]() { (*task)(); }
+
+        // Don't allow enqueuing after stopping the pool
+        if (stop_.load(std::memory_order_acquire)) {
+            throw std::runtime_error("Cannot submit task to stopped ThreadPool");
+        }
+
+        // Bind the arguments by value; the task runs once, so hand them over as rvalues
+        std::packaged_task<return_type()> task(
+            [func = std::forward<F>(f),
+             bound = std::make_tuple(std::forward<Args>(args)...)]() mutable -> return_type {
+                return std::apply(std::move(func), std::move(bound));
             });
-            
-            active_tasks_.fetch_add(1, std::memory_order_relaxed);
+
+        // Get future result before enqueuing
+        std::future<return_type> result = task.get_future();
+
+        schedule_task(new_task(priority, InplaceTask(std::move(task)), deadline));
+
+        TRADING_LOG_IF(verbose_logging_, LogLevel::DEBUG,
+                       "Week 3 optimization: Submitted task with priority {} to thread pool", priority);
+
+        return result;
+    }
+
+    /**
+     * @brief Awaitable that resumes the awaiting coroutine on a pool worker.
+     */
+    struct ScheduleAwaiter {
+        ThreadPool& pool;
+        int priority;
+
+        bool await_ready() const noexcept {
+            return false;
         }
-        
-        // Notify one worker thread
-        condition_.notify_one();
-        
-        if (verbose_logging_) {
-            std::cout << "Week 3 optimization: Submitted task with priority " 
-                    << priority << " to thread pool" << std::endl;
+
+        void await_suspend(std::coroutine_handle<> handle) {
+            pool.post(priority, [handle] { handle.resume(); });
         }
-        
-        return result;
+
+        void await_resume() const noexcept {}
+    };
+
+    /**
+     * @brief Continue the calling coroutine on a pool worker: `co_await pool.schedule(priority);`
+     *
+     * The resumption is an ordinary posted task of that priority, so it
+     * competes with the pool's other work; no thread is held meanwhile.
+     *
+     * @param priority Priority of the resumption (higher number = higher priority)
+     * @return ScheduleAwaiter Awaitable; throws std::runtime_error if the pool has stopped
+     */
+    ScheduleAwaiter schedule(int priority) {
+        return ScheduleAwaiter{*this, priority};
     }
-    
+
     /**
      * @brief Get the number of worker threads.
-     * 
-     * @return size_t Number of worker threads
+     *
+     * @return size_t Number of workers the pool is running, or about to run after resize()
      */
     size_t size() const {
+        return target_threads_.load(std::memory_order_acquire);
+    }
+
+    /**
+     * @brief Get the number of workers the pool may grow to.
+     *
+     * @return size_t Maximum number of worker threads
+     */
+    size_t max_threads() const {
         return workers_.size();
     }
-    
+
+    /**
+     * @brief Change the number of worker threads.
+     *
+     * Growing starts threads on free worker slots. Shrinking retires the
+     * highest-numbered workers once they finish their current task; tasks
+     * left on their deques move to the injection queues. Returns without
+     * waiting for the retirements.
+     *
+     * @param new_size Number of workers, clamped to [1, max_threads()]
+     */
+    void resize(size_t new_size);
+
+    /**
+     * @brief Grow or shrink the pool by one worker according to its PoolScalingPolicy.
+     *
+     * The monitor thread calls this every policy interval; call it yourself
+     * when the interval is 0.
+     */
+    void adjust_thread_count();
+
+    /**
+     * @brief Get counters and per-worker statistics.
+     *
+     * @return ThreadPoolStats Statistics at the time of the call
+     */
+    ThreadPoolStats get_stats() const;
+
+    /**
+     * @brief Set how long a deadline task waits before it competes one band higher.
+     *
+     * @param step Aging step; zero disables aging
+     */
+    void set_deadline_aging(std::chrono::microseconds step);
+
+    /**
+     * @brief Check whether the task running on the calling worker started after its deadline.
+     *
+     * Only true inside a task posted or submitted with StaleAction::RUN_FLAGGED
+     * that was picked up late, e.g. so a strategy can skip sending orders.
+     *
+     * @return true if the current task is stale
+     */
+    static bool current_task_is_stale() {
+        return current_task_stale_;
+    }
+
     /**
      * @brief Get the number of active tasks.
-     * 
+     *
      * @return size_t Number of active tasks
      */
     size_t active_tasks() const {
         return active_tasks_.load(std::memory_order_relaxed);
     }
-    
+
     /**
      * @brief Get the total number of completed tasks.
-     * 
+     *
      * @return size_t Number of completed tasks
      */
     size_t total_tasks_completed() const {
         return total_tasks_completed_.load(std::memory_order_relaxed);
     }
-    
+
+    /**
+     * @brief Get the number of tasks a worker took from another worker's deque.
+     *
+     * @return size_t Number of stolen tasks
+     */
+    size_t total_tasks_stolen() const {
+        return total_tasks_stolen_.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Get contention and hold-time statistics of the sleep/wake mutex.
+     *
+     * @return LockStatsResult Statistics of queue_mutex_
+     */
+    LockStatsResult queue_lock_stats() const {
+        return queue_mutex_.stats().summarize("queue_mutex");
+    }
+
+    /**
+     * @brief Get where the workers run.
+     *
+     * @return const ThreadPlacement& Placement given at construction
+     */
+    const ThreadPlacement& placement() const {
+        return placement_;
+    }
+
+    /**
+     * @brief Get the slab that tasks and injection queue nodes come from.
+     *
+     * @return const week2::OrderBookAllocator& The task allocator
+     */
+    const week2::OrderBookAllocator& task_allocator() const {
+        return task_allocator_;
+    }
+
     /**
      * @brief Set verbose logging mode
-     * 
+     *
+     * Verbose records are logged at LogLevel::DEBUG, so they also need a
+     * TRADING_LOG_LEVEL and runtime level that let DEBUG through.
+     *
      * @param verbose Whether to enable verbose logging
      */
     void set_verbose_logging(bool verbose) {
         verbose_logging_ = verbose;
     }
-    
+
 private:
+    /**
+     * @brief Per-worker state: one deque per priority band.
+     */
+    struct alignas(64) Worker {
+        WorkStealingDeque<Task*> deques[PRIORITY_BANDS];
+        std::thread thread;
+        bool retired = false;  // Thread has left, or never started; guarded by scaling_mutex_
+
+        // Written only by the thread holding the slot
+        std::atomic<uint64_t> tasks_run{0};
+        std::atomic<uint64_t> wait_ticks{0};  // Queue wait of the tasks it picked up
+    };
+
+    using InjectionQueue = LockFreeQueue<Task*, week2::PoolAllocator<Task*>>;
+
+    /**
+     * @brief Construct a task in a slab block.
+     *
+     * @param priority Task priority
+     * @param func Callable to run
+     * @param deadline Deadline of the task, zero for none
+     * @return Task* The new task
+     */
+    Task* new_task(int priority, InplaceTask&& func, const TaskDeadline& deadline);
+
+    /**
+     * @brief Destroy a task and return its block to the slab.
+     *
+     * @param task Task created by new_task()
+     */
+    void delete_task(Task* task);
+
+    /**
+     * @brief Queue a task and wake a sleeping worker if there is one.
+     *
+     * @param task Task created by new_task(), owned by the pool from now on
+     */
+    void schedule_task(Task* task);
+
     /**
      * @brief Worker thread function.
-     * 
+     *
      * @param id Worker thread ID
      */
-    void worker_function(size_t id) {
-        if (verbose_logging_) {
-            std::cout << "Week 3 optimization: Thread pool worker " << id << " started" << std::endl;
-        }
-        
-        while (true) {
-            Task task;
-            
-            {
-                std::unique_lock<std::mutex> lock(queue_mutex_);
-                
-                // Wait for a task or stop signal
-                condition_.wait(lock, [this] {
-                    return stop_ || !tasks_.empty();
-                });
-                
-                // If stopping and no tasks, exit
-                if (stop_ && tasks_.empty()) {
-                    if (verbose_logging_) {
-                        std::cout << "Week 3 optimization: Thread pool worker " << id << " stopping" << std::endl;
-                    }
-                    break;
-                }
-                
-                // Get task from queue
-                task = tasks_.top();
-                tasks_.pop();
-            }
-            
-            // Execute the task
-            if (verbose_logging_) {
-                std::cout << "Week 3 optimization: Thread pool worker " << id 
-                        << " executing task with priority " << task.priority << std::endl;
-            }
-            
-            // Execute the task
-            task.func();
-            
-            // Update counters
-            active_tasks_.fetch_sub(1, std::memory_order_relaxed);
-            total_tasks_completed_.fetch_add(1, std::memory_order_relaxed);
-        }
-    }
-    
-    // Worker threads
-    std::vector<std::thread> workers_;
-    
-    // Task queue (priority queue)
-    std::priority_queue<Task> tasks_;
-    
-    // Synchronization
-    std::mutex queue_mutex_;
-    std::condition_variable condition_;
-    bool stop_;
-    
+    void worker_function(size_t id);
+
+    /**
+     * @brief Find the next task for a worker, most urgent band first.
+     *
+     * @param id Worker thread ID
+     * @return Task* The task, or nullptr if no work was found
+     */
+    Task* find_task(size_t id);
+
+    /**
+     * @brief Try to steal a task of one band from the other workers.
+     *
+     * @param thief ID of the stealing worker
+     * @param band Priority band to steal from
+     * @return Task* The stolen task, or nullptr if every victim was empty
+     */
+    Task* try_steal_task(size_t thief, size_t band);
+
+    /**
+     * @brief Find the deadline queue to serve next; the caller holds deadline_lock_.
+     *
+     * The head of each band's heap competes in its band plus one per aging
+     * step waited. The highest band wins, then the earliest deadline.
+     *
+     * @param now TscClock reading
+     * @param effective_band Set to the winner's band after aging
+     * @return size_t Band of the winning queue, PRIORITY_BANDS if all are empty
+     */
+    size_t best_deadline_queue(uint64_t now, size_t& effective_band) const;
+
+    /**
+     * @brief Get the band the most urgent deadline task competes in.
+     *
+     * @return size_t Band after aging, PRIORITY_BANDS if no deadline task is queued
+     */
+    size_t deadline_band();
+
+    /**
+     * @brief Take the most urgent deadline task.
+     *
+     * @return Task* The task, or nullptr if none is queued
+     */
+    Task* pop_deadline_task();
+
+    /**
+     * @brief Leave the pool if the worker is above the target size.
+     *
+     * @param id Worker thread ID
+     * @return true if the worker retired and must exit
+     */
+    bool try_retire(size_t id);
+
+    /**
+     * @brief Start a thread on a free worker slot; the caller holds scaling_mutex_.
+     *
+     * @param id Worker slot
+     */
+    void start_worker(size_t id);
+
+    // resize() body; the caller holds scaling_mutex_
+    void resize_locked(size_t new_size);
+
+    // Monitor thread function: adjust_thread_count() every policy interval
+    void monitor_function();
+
+    // Slab for tasks and injection queue nodes (outlives both)
+    week2::OrderBookAllocator task_allocator_;
+
+    // Worker threads, each with its own deques
+    std::vector<std::unique_ptr<Worker>> workers_;
+
+    // Global injection queues for tasks submitted from outside the pool
+    std::unique_ptr<InjectionQueue> injection_[PRIORITY_BANDS];
+
+    // Deadline tasks: an earliest-deadline-first heap per band, from anywhere in or out of the pool
+    InstrumentedSpinLock deadline_lock_;
+    std::vector<Task*> deadline_queues_[PRIORITY_BANDS];
+    std::atomic<size_t> deadline_queued_;  // Tasks in the heaps, so workers skip the lock when 0
+    std::atomic<uint64_t> aging_ticks_;    // Wait that lifts a deadline task one band, 0 for never
+
+    // Names, cores and idle policy of the workers
+    ThreadPlacement placement_;
+
+    // Elastic sizing: workers [0, target_threads_) run. Starting and joining
+    // workers, and the adjust_thread_count() state, are guarded by scaling_mutex_
+    PoolScalingPolicy policy_;
+    size_t min_threads_;
+    std::atomic<size_t> target_threads_;
+    std::atomic<size_t> slots_used_;  // High-water mark of started slots; thieves look no further
+    std::mutex scaling_mutex_;
+    uint64_t last_wait_ticks_ = 0;
+    uint64_t last_tasks_run_ = 0;
+    std::chrono::steady_clock::time_point idle_since_{};  // Epoch while not idle
+    std::atomic<uint64_t> threads_started_;
+    std::atomic<uint64_t> threads_retired_;
+    std::thread monitor_;
+    std::mutex monitor_mutex_;
+    std::condition_variable monitor_condition_;
+
+    // Sleeping and waking idle workers
+    InstrumentedMutex queue_mutex_;
+    std::condition_variable_any condition_;
+    std::atomic<bool> stop_;
+    std::atomic<size_t> queued_tasks_;      // Tasks pushed but not yet picked up
+    std::atomic<size_t> sleeping_workers_;  // Workers blocked on condition_
+
     // Metrics
     std::atomic<size_t> active_tasks_;
     std::atomic<size_t> total_tasks_completed_;
-    
-    // Logging control
+    std::atomic<size_t> total_tasks_stolen_;
+    std::atomic<uint64_t> deadline_tasks_;
+    std::atomic<uint64_t> deadline_misses_;
+    std::atomic<uint64_t> stale_drops_;
+    std::atomic<uint64_t> stale_runs_;
+    std::atomic<uint64_t> aged_tasks_;
+
+    // Logging control: emit a DEBUG record for every task
     bool verbose_logging_;
+
+    // Pool and worker index of the calling thread, if it is a pool worker
+    static thread_local ThreadPool* current_pool_;
+    static thread_local size_t current_worker_;
+    static thread_local bool current_task_stale_;
 };
 
-} // namespace trading 
\ No newline at end of file
+} // namespace trading
@@ -0,0 +1,283 @@
+#pragma once
+
+#include <bit>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <span>
+#include <type_traits>
+
+#include "market_tick.hpp"
+#include "price.hpp"
+
+/**
+ * @file wire_format.hpp
+ * @brief Fixed-layout binary market data messages and a zero-copy decoder (Week 3).
+ *
+ * A MarketUpdate carries two std::strings, so building one per message
+ * costs heap allocations before the handler even sees it. On the wire an
+ * update is instead a packed 48-byte record: interned symbol and exchange
+ * IDs, fixed-point prices, volume, a nanosecond timestamp and a sequence
+ * number, every field naturally aligned and little-endian. MarketUpdateView
+ * reads the fields straight out of the receive buffer, so decoding copies
+ * nothing and allocates nothing.
+ *
+ * Layout of WireMessageType::MARKET_UPDATE, version 1:
+ *
+ *     offset  size  field
+ *          0     2  length       total message size in bytes (48)
+ *          2     1  version      WIRE_VERSION
+ *          3     1  type         WireMessageType
+ *          4     4  symbol_id    SymbolId
+ *          8     2  exchange_id  ExchangeId
+ *         10     2  flags        reserved, 0
+ *         12     4  volume       int32
+ *         16     8  bid_price    int64, Price::raw()
+ *         24     8  ask_price    int64, Price::raw()
+ *         32     8  timestamp    int64 nanoseconds
+ *         40     8  sequence     uint64, per-feed message number
+ *
+ * Readers skip messages of unknown type by their length, so new message
+ * types can be added without breaking old decoders.
+ */
+
+namespace trading {
+
+constexpr uint8_t WIRE_VERSION = 1;
+constexpr int64_t WIRE_PRICE_SCALE = PRICE_SCALE;  // Price::raw() goes on the wire as is
+
+/**
+ * @brief Message types of the wire format.
+ */
+enum class WireMessageType : uint8_t {
+    MARKET_UPDATE = 1
+};
+
+/**
+ * @brief Field offsets and sizes of the wire format.
+ */
+struct WireLayout {
+    static constexpr size_t HEADER_SIZE = 4;  // length, version, type
+
+    static constexpr size_t LENGTH = 0;
+    static constexpr size_t VERSION = 2;
+    static constexpr size_t TYPE = 3;
+    static constexpr size_t SYMBOL_ID = 4;
+    static constexpr size_t EXCHANGE_ID = 8;
+    static constexpr size_t FLAGS = 10;
+    static constexpr size_t VOLUME = 12;
+    static constexpr size_t BID_PRICE = 16;
+    static constexpr size_t ASK_PRICE = 24;
+    static constexpr size_t TIMESTAMP = 32;
+    static constexpr size_t SEQUENCE = 40;
+
+    static constexpr size_t MARKET_UPDATE_SIZE = 48;
+};
+
+/**
+ * @brief Read a little-endian integer from unaligned memory.
+ *
+ * @tparam T Integer type
+ * @param data Address of the first byte
+ * @return T The value in host byte order
+ */
+template<typename T>
+inline T load_little_endian(const std::byte* data) {
+    static_assert(std::is_integral_v<T>, "Wire fields are integers");
+    T value;
+    std::memcpy(&value, data, sizeof(T));
+    if constexpr (std::endian::native == std::endian::big) {
+        using U = std::make_unsigned_t<T>;
+        U bits = static_cast<U>(value);
+        U swapped = 0;
+        for (size_t i = 0; i < sizeof(T); ++i) {
+            swapped = static_cast<U>((swapped << 8) | ((bits >> (8 * i)) & 0xFF));
+        }
+        value = static_cast<T>(swapped);
+    }
+    return value;
+}
+
+/**
+ * @brief Write an integer to unaligned memory in little-endian order.
+ *
+ * @tparam T Integer type
+ * @param data Address of the first byte
+ * @param value Value in host byte order
+ */
+template<typename T>
+inline void store_little_endian(std::byte* data, T value) {
+    static_assert(std::is_integral_v<T>, "Wire fields are integers");
+    if constexpr (std::endian::native == std::endian::big) {
+        using U = std::make_unsigned_t<T>;
+        U bits = static_cast<U>(value);
+        for (size_t i = 0; i < sizeof(T); ++i) {
+            data[i] = static_cast<std::byte>((bits >> (8 * i)) & 0xFF);
+        }
+    } else {
+        std::memcpy(data, &value, sizeof(T));
+    }
+}
+
+/**
+ * @brief Read-only view of one MARKET_UPDATE message inside a buffer.
+ *
+ * Holds only a pointer: fields are decoded from the buffer on access, so
+ * the buffer must outlive the view. The pointer needs no alignment.
+ */
+class MarketUpdateView {
+public:
+    MarketUpdateView() = default;
+
+    /**
+     * @brief View a message that has already been validated (see WireDecoder).
+     *
+     * @param data First byte of the message
+     */
+    explicit MarketUpdateView(const std::byte* data) : data_(data) {}
+
+    SymbolId symbol_id() const { return field<uint32_t>(WireLayout::SYMBOL_ID); }
+    ExchangeId exchange_id() const { return field<uint16_t>(WireLayout::EXCHANGE_ID); }
+    uint16_t flags() const { return field<uint16_t>(WireLayout::FLAGS); }
+    int volume() const { return field<int32_t>(WireLayout::VOLUME); }
+    int64_t bid_price_raw() const { return field<int64_t>(WireLayout::BID_PRICE); }
+    int64_t ask_price_raw() const { return field<int64_t>(WireLayout::ASK_PRICE); }
+    Price bid_price() const { return Price::from_raw(bid_price_raw()); }
+    Price ask_price() const { return Price::from_raw(ask_price_raw()); }
+    uint64_t sequence() const { return field<uint64_t>(WireLayout::SEQUENCE); }
+
+    std::chrono::nanoseconds timestamp() const {
+        return std::chrono::nanoseconds(field<int64_t>(WireLayout::TIMESTAMP));
+    }
+
+    /**
+     * @brief Decode into the handler's ID-keyed update.
+     *
+     * @return MarketTick The message's fields
+     */
+    MarketTick to_tick() const {
+        return MarketTick{symbol_id(), exchange_id(), bid_price(), ask_price(), volume(), timestamp()};
+    }
+
+    /**
+     * @brief Get the message bytes.
+     *
+     * @return const std::byte* First byte of the message
+     */
+    const std::byte* data() const {
+        return data_;
+    }
+
+private:
+    template<typename T>
+    T field(size_t offset) const {
+        return load_little_endian<T>(data_ + offset);
+    }
+
+    const std::byte* data_ = nullptr;
+};
+
+/**
+ * @brief Encode a market update.
+ *
+ * @param tick Update to encode
+ * @param sequence Message sequence number
+ * @param out Destination buffer
+ * @return size_t Bytes written (WireLayout::MARKET_UPDATE_SIZE), or 0 if out is too small
+ */
+inline size_t encode_market_update(const MarketTick& tick, uint64_t sequence, std::span<std::byte> out) {
+    if (out.size() < WireLayout::MARKET_UPDATE_SIZE) {
+        return 0;
+    }
+
+    std::byte* data = out.data();
+    store_little_endian<uint16_t>(data + WireLayout::LENGTH, WireLayout::MARKET_UPDATE_SIZE);
+    data[WireLayout::VERSION] = static_cast<std::byte>(WIRE_VERSION);
+    data[WireLayout::TYPE] = static_cast<std::byte>(WireMessageType::MARKET_UPDATE);
+    store_little_endian<uint32_t>(data + WireLayout::SYMBOL_ID, tick.symbol_id);
+    store_little_endian<uint16_t>(data + WireLayout::EXCHANGE_ID, tick.exchange_id);
+    store_little_endian<uint16_t>(data + WireLayout::FLAGS, 0);
+    store_little_endian<int32_t>(data + WireLayout::VOLUME, tick.volume);
+    store_little_endian<int64_t>(data + WireLayout::BID_PRICE, tick.bid_price.raw());
+    store_little_endian<int64_t>(data + WireLayout::ASK_PRICE, tick.ask_price.raw());
+    store_little_endian<int64_t>(data + WireLayout::TIMESTAMP, tick.timestamp.count());
+    store_little_endian<uint64_t>(data + WireLayout::SEQUENCE, sequence);
+    return WireLayout::MARKET_UPDATE_SIZE;
+}
+
+/**
+ * @brief Walks the messages of a receive buffer without copying them.
+ *
+ * Messages of other types are skipped by their length. Decoding stops at
+ * the first malformed message (bad length or version) or at a truncated
+ * tail, which is left for the caller to complete with the next read.
+ */
+class WireDecoder {
+public:
+    /**
+     * @brief Why the decoder stopped.
+     */
+    enum class Status {
+        OK,         // A message was decoded
+        END,        // The buffer is used up, possibly with a partial message left
+        MALFORMED   // The next message has an invalid header
+    };
+
+    /**
+     * @brief Decode messages from a buffer.
+     *
+     * @param buffer Received bytes; must outlive the decoder and its views
+     */
+    explicit WireDecoder(std::span<const std::byte> buffer) : buffer_(buffer), offset_(0) {}
+
+    /**
+     * @brief Decode the next market update.
+     *
+     * @param view Receives a view of the message on OK
+     * @return Status OK, END or MALFORMED
+     */
+    Status next(MarketUpdateView& view) {
+        while (buffer_.size() - offset_ >= WireLayout::HEADER_SIZE) {
+            const std::byte* data = buffer_.data() + offset_;
+            uint16_t length = load_little_endian<uint16_t>(data + WireLayout::LENGTH);
+            auto version = static_cast<uint8_t>(data[WireLayout::VERSION]);
+            auto type = static_cast<WireMessageType>(data[WireLayout::TYPE]);
+
+            if (length < WireLayout::HEADER_SIZE || version != WIRE_VERSION) {
+                return Status::MALFORMED;
+            }
+            if (buffer_.size() - offset_ < length) {
+                return Status::END;
+            }
+            if (type != WireMessageType::MARKET_UPDATE) {
+                offset_ += length;
+                continue;
+            }
+            if (length < WireLayout::MARKET_UPDATE_SIZE) {
+                return Status::MALFORMED;
+            }
+
+            // Newer minor revisions may append fields; length covers them
+            view = MarketUpdateView(data);
+            offset_ += length;
+            return Status::OK;
+        }
+        return Status::END;
+    }
+
+    /**
+     * @brief Get the number of bytes consumed so far.
+     *
+     * @return size_t Offset of the first byte not yet decoded
+     */
+    size_t consumed() const {
+        return offset_;
+    }
+
+private:
+    std::span<const std::byte> buffer_;
+    size_t offset_;
+};
+
+} // namespace trading
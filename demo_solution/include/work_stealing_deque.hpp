@@ -0,0 +1,186 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+/**
+ * @file work_stealing_deque.hpp
+ * @brief Chase-Lev work-stealing deque (Week 3).
+ *
+ * Each thread pool worker owns one deque per priority band:
+ * - The owner pushes and pops at the bottom (LIFO, cache-hot work first)
+ *   without any CAS except when racing a thief for the last element
+ * - Idle workers steal from the top (FIFO, oldest work first) with one CAS
+ * - The ring grows on demand; retired rings are kept until the deque is
+ *   destroyed because a thief may still be reading from them
+ *
+ * Memory orderings follow Le, Pop, Cohen and Zappa Nardelli, "Correct and
+ * Efficient Work-Stealing for Weak Memory Models" (PPoPP 2013).
+ */
+
+namespace trading {
+
+/**
+ * @brief Single-owner, multi-thief deque of trivially copyable items.
+ *
+ * @tparam T Item type (typically a task pointer)
+ */
+template<typename T>
+class WorkStealingDeque {
+    static_assert(std::is_trivially_copyable<T>::value,
+                  "WorkStealingDeque items must be trivially copyable");
+
+    /**
+     * @brief Power-of-two ring of atomic slots.
+     */
+    struct Ring {
+        explicit Ring(size_t capacity)
+            : mask(capacity - 1), slots(new std::atomic<T>[capacity]) {}
+
+        size_t capacity() const { return mask + 1; }
+
+        T load(int64_t index) const {
+            return slots[static_cast<size_t>(index) & mask].load(std::memory_order_relaxed);
+        }
+
+        void store(int64_t index, T value) {
+            slots[static_cast<size_t>(index) & mask].store(value, std::memory_order_relaxed);
+        }
+
+        size_t mask;
+        std::unique_ptr<std::atomic<T>[]> slots;
+    };
+
+public:
+    static constexpr size_t DEFAULT_CAPACITY = 256;
+
+    /**
+     * @brief Construct an empty deque.
+     *
+     * @param capacity Initial ring capacity (rounded up to a power of two)
+     */
+    explicit WorkStealingDeque(size_t capacity = DEFAULT_CAPACITY) {
+        size_t power = 2;
+        while (power < capacity) {
+            power <<= 1;
+        }
+        rings_.emplace_back(new Ring(power));
+        ring_.store(rings_.back().get(), std::memory_order_relaxed);
+    }
+
+    WorkStealingDeque(const WorkStealingDeque&) = delete;
+    WorkStealingDeque& operator=(const WorkStealingDeque&) = delete;
+
+    /**
+     * @brief Push an item at the bottom (owner only).
+     *
+     * @param item Item to push
+     */
+    void push(T item) {
+        int64_t bottom = bottom_.load(std::memory_order_relaxed);
+        int64_t top = top_.load(std::memory_order_acquire);
+        Ring* ring = ring_.load(std::memory_order_relaxed);
+
+        if (bottom - top >= static_cast<int64_t>(ring->capacity())) {
+            ring = grow(ring, top, bottom);
+        }
+
+        ring->store(bottom, item);
+        // Release store rather than the paper's release fence: same cost, and
+        // visible to race detectors that don't model standalone fences
+        bottom_.store(bottom + 1, std::memory_order_release);
+    }
+
+    /**
+     * @brief Pop the most recently pushed item (owner only).
+     *
+     * @param item Reference to store the popped item
+     * @return true if an item was popped, false if the deque is empty
+     */
+    bool pop(T& item) {
+        int64_t bottom = bottom_.load(std::memory_order_relaxed) - 1;
+        Ring* ring = ring_.load(std::memory_order_relaxed);
+        bottom_.store(bottom, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        int64_t top = top_.load(std::memory_order_relaxed);
+
+        if (top > bottom) {
+            // Empty
+            bottom_.store(bottom + 1, std::memory_order_relaxed);
+            return false;
+        }
+
+        item = ring->load(bottom);
+        if (top == bottom) {
+            // Last item: race any thief for it
+            bool won = top_.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst,
+                                                    std::memory_order_relaxed);
+            bottom_.store(bottom + 1, std::memory_order_relaxed);
+            return won;
+        }
+        return true;
+    }
+
+    /**
+     * @brief Steal the oldest item (any thread).
+     *
+     * @param item Reference to store the stolen item
+     * @return true if an item was stolen, false if the deque was empty or
+     *         another thread won the race
+     */
+    bool steal(T& item) {
+        int64_t top = top_.load(std::memory_order_acquire);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        int64_t bottom = bottom_.load(std::memory_order_acquire);
+
+        if (top >= bottom) {
+            return false;
+        }
+
+        Ring* ring = ring_.load(std::memory_order_acquire);
+        item = ring->load(top);
+        return top_.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst,
+                                            std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Get the approximate number of items.
+     */
+    size_t size() const {
+        int64_t bottom = bottom_.load(std::memory_order_relaxed);
+        int64_t top = top_.load(std::memory_order_relaxed);
+        return bottom > top ? static_cast<size_t>(bottom - top) : 0;
+    }
+
+    /**
+     * @brief Check whether the deque looks empty.
+     */
+    bool empty() const {
+        return size() == 0;
+    }
+
+private:
+    // Double the ring (owner only); the old ring stays alive for thieves
+    Ring* grow(Ring* old_ring, int64_t top, int64_t bottom) {
+        Ring* ring = new Ring(old_ring->capacity() * 2);
+        for (int64_t i = top; i < bottom; ++i) {
+            ring->store(i, old_ring->load(i));
+        }
+        rings_.emplace_back(ring);
+        ring_.store(ring, std::memory_order_release);
+        return ring;
+    }
+
+    // Thieves and owner on separate cache lines
+    alignas(64) std::atomic<int64_t> top_{0};
+    alignas(64) std::atomic<int64_t> bottom_{0};
+    std::atomic<Ring*> ring_{nullptr};
+
+    std::vector<std::unique_ptr<Ring>> rings_; // Owner-only; current ring is rings_.back()
+};
+
+} // namespace trading
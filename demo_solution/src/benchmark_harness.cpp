@@ -0,0 +1,175 @@
+#include "../include/benchmark_harness.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <iomanip>
+#include <thread>
+
+namespace trading {
+
+namespace {
+
+// Quote a string for JSON
+std::string json_string(const std::string& value) {
+    std::string quoted = "\"";
+    for (char c : value) {
+        switch (c) {
+            case '"': quoted += "\\\""; break;
+            case '\\': quoted += "\\\\"; break;
+            case '\n': quoted += "\\n"; break;
+            case '\t': quoted += "\\t"; break;
+            default:
+                if (static_cast<unsigned char>(c) < 0x20) {
+                    char escaped[8];
+                    std::snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+                    quoted += escaped;
+                } else {
+                    quoted += c;
+                }
+        }
+    }
+    return quoted + "\"";
+}
+
+// Quote a CSV field if it needs it
+std::string csv_field(const std::string& value) {
+    if (value.find_first_of(",\"\n") == std::string::npos) {
+        return value;
+    }
+    std::string quoted = "\"";
+    for (char c : value) {
+        quoted += c;
+        if (c == '"') {
+            quoted += '"';
+        }
+    }
+    return quoted + "\"";
+}
+
+template<typename T>
+T median(std::vector<T> values) {
+    std::sort(values.begin(), values.end());
+    return values[values.size() / 2];
+}
+
+} // namespace
+
+// Spread benchmark threads over consecutive cores from pin_cpu
+int BenchmarkRun::cpu_for(size_t thread_index) const {
+    if (options_.pin_cpu < 0) {
+        return -1;
+    }
+    size_t cores = std::max<size_t>(std::thread::hardware_concurrency(), 1);
+    return static_cast<int>((static_cast<size_t>(options_.pin_cpu) + thread_index) % cores);
+}
+
+BenchmarkHarness::BenchmarkHarness(const BenchmarkOptions& options) : options_(options) {
+    if (options_.pin_cpu >= 0 && !pin_current_thread(options_.pin_cpu)) {
+        options_.pin_cpu = -1;
+    }
+}
+
+// Median operations, throughput spread and tick-to-ns conversion of one benchmark
+const BenchmarkResult& BenchmarkHarness::add_result(const std::string& group, const std::string& name,
+                                                    const std::string& params,
+                                                    const std::vector<Measurement>& measurements,
+                                                    const LatencySnapshot& latency) {
+    double ns_per_tick = TscClock::ns_per_tick();
+
+    BenchmarkResult result;
+    result.group = group;
+    result.name = name;
+    result.params = params;
+    result.repetitions = measurements.size();
+
+    std::vector<uint64_t> operations;
+    std::vector<double> elapsed;
+    std::vector<double> throughput;
+    for (const Measurement& m : measurements) {
+        double ns = std::max(static_cast<double>(m.ticks) * ns_per_tick, 1.0);
+        operations.push_back(m.operations);
+        elapsed.push_back(ns);
+        throughput.push_back(static_cast<double>(m.operations) * 1e9 / ns);
+    }
+    result.operations = median(operations);
+    result.elapsed_median_ns = median(elapsed);
+    result.throughput_median = median(throughput);
+    result.throughput_min = *std::min_element(throughput.begin(), throughput.end());
+    result.throughput_max = *std::max_element(throughput.begin(), throughput.end());
+
+    // The histograms counted ticks; rescale their summary to real time
+    result.latency = latency.summary();
+    result.latency.mean_us *= ns_per_tick;
+    result.latency.p50_us *= ns_per_tick;
+    result.latency.p99_us *= ns_per_tick;
+    result.latency.p999_us *= ns_per_tick;
+    result.latency.max_us *= ns_per_tick;
+
+    results_.push_back(std::move(result));
+    return results_.back();
+}
+
+void BenchmarkHarness::write_table(std::ostream& out) const {
+    std::ios::fmtflags flags = out.flags();
+    out << std::left << std::setw(18) << "Group" << std::setw(26) << "Benchmark" << std::right
+        << std::setw(14) << "ops/s" << std::setw(10) << "+/-%"
+        << std::setw(11) << "p50 ns" << std::setw(11) << "p99 ns" << std::setw(11) << "p99.9 ns"
+        << std::setw(12) << "max ns" << "\n";
+    out << std::string(113, '-') << "\n";
+    for (const BenchmarkResult& r : results_) {
+        double spread = r.throughput_median > 0.0
+            ? 50.0 * (r.throughput_max - r.throughput_min) / r.throughput_median : 0.0;
+        out << std::left << std::setw(18) << r.group << std::setw(26) << r.name << std::right
+            << std::fixed << std::setprecision(0) << std::setw(14) << r.throughput_median
+            << std::setprecision(1) << std::setw(10) << spread;
+        if (r.latency.count > 0) {
+            out << std::setprecision(0)
+                << std::setw(11) << r.latency.p50_us * 1000.0 << std::setw(11) << r.latency.p99_us * 1000.0
+                << std::setw(11) << r.latency.p999_us * 1000.0 << std::setw(12) << r.latency.max_us * 1000.0;
+        } else {
+            out << std::setw(11) << "-" << std::setw(11) << "-" << std::setw(11) << "-" << std::setw(12) << "-";
+        }
+        out << "\n";
+    }
+    out.flags(flags);
+}
+
+void BenchmarkHarness::write_json(std::ostream& out) const {
+    std::ios::fmtflags flags = out.flags();
+    out << std::fixed << std::setprecision(1);
+    out << "{\n  \"warmup\": " << options_.warmup << ",\n  \"repetitions\": " << options_.repetitions
+        << ",\n  \"pin_cpu\": " << options_.pin_cpu << ",\n  \"benchmarks\": [";
+    for (size_t i = 0; i < results_.size(); ++i) {
+        const BenchmarkResult& r = results_[i];
+        out << (i == 0 ? "\n" : ",\n")
+            << "    {\"group\": " << json_string(r.group) << ", \"name\": " << json_string(r.name)
+            << ", \"params\": " << json_string(r.params)
+            << ", \"repetitions\": " << r.repetitions << ", \"operations\": " << r.operations
+            << ", \"elapsed_ns\": " << r.elapsed_median_ns
+            << ", \"throughput\": {\"median\": " << r.throughput_median << ", \"min\": " << r.throughput_min
+            << ", \"max\": " << r.throughput_max << "}"
+            << ", \"latency_ns\": {\"count\": " << r.latency.count << ", \"mean\": " << r.latency.mean_us * 1000.0
+            << ", \"p50\": " << r.latency.p50_us * 1000.0 << ", \"p99\": " << r.latency.p99_us * 1000.0
+            << ", \"p999\": " << r.latency.p999_us * 1000.0 << ", \"max\": " << r.latency.max_us * 1000.0 << "}}";
+    }
+    out << "\n  ]\n}\n";
+    out.flags(flags);
+}
+
+void BenchmarkHarness::write_csv(std::ostream& out) const {
+    std::ios::fmtflags flags = out.flags();
+    out << std::fixed << std::setprecision(1);
+    out << "group,name,params,repetitions,operations,elapsed_ns,throughput_median,throughput_min,"
+           "throughput_max,latency_count,latency_mean_ns,latency_p50_ns,latency_p99_ns,latency_p999_ns,"
+           "latency_max_ns\n";
+    for (const BenchmarkResult& r : results_) {
+        out << csv_field(r.group) << ',' << csv_field(r.name) << ',' << csv_field(r.params) << ','
+            << r.repetitions << ',' << r.operations << ',' << r.elapsed_median_ns << ','
+            << r.throughput_median << ',' << r.throughput_min << ',' << r.throughput_max << ','
+            << r.latency.count << ',' << r.latency.mean_us * 1000.0 << ',' << r.latency.p50_us * 1000.0 << ','
+            << r.latency.p99_us * 1000.0 << ',' << r.latency.p999_us * 1000.0 << ','
+            << r.latency.max_us * 1000.0 << "\n";
+    }
+    out.flags(flags);
+}
+
+} // namespace trading
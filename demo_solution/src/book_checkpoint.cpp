@@ -0,0 +1,388 @@
+#include "../include/book_checkpoint.hpp"
+#include "../include/logger.hpp"
+#include "../include/market_data_handler.hpp"
+#include "../include/thread_placement.hpp"
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define TRADING_CHECKPOINT_MMAP 1
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#else
+#define TRADING_CHECKPOINT_MMAP 0
+#endif
+
+namespace trading {
+
+namespace {
+
+constexpr size_t CACHE_LINE = 64;
+
+// Buffers start on a page so each one can be msync()ed on its own
+// (a multiple of every common page size)
+constexpr size_t BUFFER_ALIGNMENT = 16384;
+
+constexpr uint64_t FNV_OFFSET_BASIS = 14695981039346656037ull;
+constexpr uint64_t FNV_PRIME = 1099511628211ull;
+
+size_t align_up(size_t value, size_t alignment) {
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+uint64_t fnv1a(uint64_t hash, const void* data, size_t bytes) {
+    const auto* byte = static_cast<const unsigned char*>(data);
+    for (size_t i = 0; i < bytes; ++i) {
+        hash = (hash ^ byte[i]) * FNV_PRIME;
+    }
+    return hash;
+}
+
+// Where the sections of a buffer start, relative to the buffer
+struct BufferLayout {
+    size_t exchanges;
+    size_t symbols;
+    size_t size;
+
+    BufferLayout(size_t max_symbols, size_t max_exchanges)
+        : exchanges(align_up(sizeof(CheckpointLayout::BufferHeader), CACHE_LINE)),
+          symbols(align_up(exchanges + max_exchanges * sizeof(CheckpointLayout::Name), CACHE_LINE)),
+          size(align_up(symbols + max_symbols * sizeof(CheckpointLayout::SymbolEntry), BUFFER_ALIGNMENT)) {}
+
+    CheckpointLayout::Name* exchange_names(CheckpointLayout::BufferHeader* buffer) const {
+        return reinterpret_cast<CheckpointLayout::Name*>(reinterpret_cast<unsigned char*>(buffer) + exchanges);
+    }
+
+    const CheckpointLayout::Name* exchange_names(const CheckpointLayout::BufferHeader* buffer) const {
+        return reinterpret_cast<const CheckpointLayout::Name*>(reinterpret_cast<const unsigned char*>(buffer) + exchanges);
+    }
+
+    CheckpointLayout::SymbolEntry* symbol_entries(CheckpointLayout::BufferHeader* buffer) const {
+        return reinterpret_cast<CheckpointLayout::SymbolEntry*>(reinterpret_cast<unsigned char*>(buffer) + symbols);
+    }
+
+    const CheckpointLayout::SymbolEntry* symbol_entries(const CheckpointLayout::BufferHeader* buffer) const {
+        return reinterpret_cast<const CheckpointLayout::SymbolEntry*>(reinterpret_cast<const unsigned char*>(buffer) +
+                                                                      symbols);
+    }
+};
+
+// Bytes of an entry that hold data: the name and tick size, plus the used snapshot rows
+size_t used_entry_bytes(const CheckpointLayout::SymbolEntry& entry) {
+    return offsetof(CheckpointLayout::SymbolEntry, snapshot) + (entry.has_book ? entry.snapshot.used_bytes() : 0);
+}
+
+// Checksum over everything but the generation and the checksum itself
+uint64_t buffer_checksum(const CheckpointLayout::BufferHeader* buffer, const BufferLayout& layout) {
+    uint64_t hash = fnv1a(FNV_OFFSET_BASIS, &buffer->sequence,
+                          sizeof(CheckpointLayout::BufferHeader) - offsetof(CheckpointLayout::BufferHeader, sequence));
+    hash = fnv1a(hash, layout.exchange_names(buffer), buffer->exchange_count * sizeof(CheckpointLayout::Name));
+    const CheckpointLayout::SymbolEntry* entries = layout.symbol_entries(buffer);
+    for (size_t i = 0; i < buffer->symbol_count; ++i) {
+        hash = fnv1a(hash, &entries[i], used_entry_bytes(entries[i]));
+    }
+    return hash;
+}
+
+// Whether a buffer holds a complete checkpoint
+bool buffer_valid(const CheckpointLayout::BufferHeader* buffer, const CheckpointLayout::Header& header,
+                  const BufferLayout& layout) {
+    if (buffer->generation == 0 || buffer->symbol_count > header.max_symbols ||
+        buffer->exchange_count > header.max_exchanges) {
+        return false;
+    }
+    const CheckpointLayout::Name* names = layout.exchange_names(buffer);
+    for (size_t i = 0; i < buffer->exchange_count; ++i) {
+        if (names[i].length > CHECKPOINT_MAX_NAME) {
+            return false;
+        }
+    }
+    const CheckpointLayout::SymbolEntry* entries = layout.symbol_entries(buffer);
+    for (size_t i = 0; i < buffer->symbol_count; ++i) {
+        if (entries[i].name.length > CHECKPOINT_MAX_NAME || entries[i].snapshot.bid_count > MAX_BOOK_DEPTH ||
+            entries[i].snapshot.ask_count > MAX_BOOK_DEPTH) {
+            return false;
+        }
+    }
+    return buffer_checksum(buffer, layout) == buffer->checksum;
+}
+
+// Whether a mapped file is a checkpoint file of this build with these capacities
+bool header_valid(const unsigned char* base, size_t size, size_t max_symbols, size_t max_exchanges) {
+    if (size < sizeof(CheckpointLayout::Header)) {
+        return false;
+    }
+    const auto& header = *reinterpret_cast<const CheckpointLayout::Header*>(base);
+    BufferLayout layout(header.max_symbols, header.max_exchanges);
+    size_t first = align_up(sizeof(CheckpointLayout::Header), BUFFER_ALIGNMENT);
+    return std::memcmp(header.magic, CheckpointLayout::MAGIC, sizeof(header.magic)) == 0 &&
+           header.version == CheckpointLayout::VERSION &&
+           header.entry_size == sizeof(CheckpointLayout::SymbolEntry) &&
+           (max_symbols == 0 || header.max_symbols == max_symbols) &&
+           (max_exchanges == 0 || header.max_exchanges == max_exchanges) &&
+           header.buffer_size == layout.size && header.buffer_offset[0] == first &&
+           header.buffer_offset[1] == first + layout.size && size == first + 2 * layout.size;
+}
+
+bool set_name(CheckpointLayout::Name& target, std::string_view name) {
+    if (name.size() > CHECKPOINT_MAX_NAME) {
+        return false;
+    }
+    target.length = static_cast<uint32_t>(name.size());
+    std::memcpy(target.text, name.data(), name.size());
+    target.text[name.size()] = '\0';
+    return true;
+}
+
+} // namespace
+
+// Open the file, keeping its checkpoints if the capacities match
+CheckpointWriter::CheckpointWriter(const std::string& path, size_t max_symbols, size_t max_exchanges, bool durable)
+    : path_(path), max_symbols_(max_symbols), max_exchanges_(max_exchanges), durable_(durable) {
+#if TRADING_CHECKPOINT_MMAP
+    BufferLayout layout(max_symbols_, max_exchanges_);
+    const size_t first = align_up(sizeof(CheckpointLayout::Header), BUFFER_ALIGNMENT);
+    size_ = first + 2 * layout.size;
+
+    int fd = ::open(path.c_str(), O_RDWR | O_CREAT, 0644);
+    if (fd < 0) {
+        throw std::runtime_error("Failed to create checkpoint file " + path);
+    }
+    struct stat info;
+    bool reuse = ::fstat(fd, &info) == 0 && static_cast<size_t>(info.st_size) == size_;
+    if (!reuse && (::ftruncate(fd, 0) != 0 || ::ftruncate(fd, static_cast<off_t>(size_)) != 0)) {
+        ::close(fd);
+        throw std::runtime_error("Failed to size checkpoint file " + path);
+    }
+    void* mapping = ::mmap(nullptr, size_, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);  // The mapping keeps the file open
+    if (mapping == MAP_FAILED) {
+        throw std::runtime_error("Failed to map checkpoint file " + path);
+    }
+    base_ = static_cast<unsigned char*>(mapping);
+
+    auto& header = *reinterpret_cast<CheckpointLayout::Header*>(base_);
+    reuse = reuse && header_valid(base_, size_, max_symbols_, max_exchanges_);
+    if (reuse) {
+        // Carry on from the newest checkpoint; generation g always lives in buffer g % 2
+        for (size_t i = 0; i < 2; ++i) {
+            if (buffer_valid(buffer(i), header, layout) && buffer(i)->generation % 2 == i) {
+                generation_ = std::max(generation_, buffer(i)->generation);
+            }
+        }
+    } else {
+        std::memset(base_, 0, size_);
+        std::memcpy(header.magic, CheckpointLayout::MAGIC, sizeof(header.magic));
+        header.version = CheckpointLayout::VERSION;
+        header.entry_size = static_cast<uint32_t>(sizeof(CheckpointLayout::SymbolEntry));
+        header.max_symbols = static_cast<uint32_t>(max_symbols_);
+        header.max_exchanges = static_cast<uint32_t>(max_exchanges_);
+        header.buffer_offset[0] = first;
+        header.buffer_offset[1] = first + layout.size;
+        header.buffer_size = layout.size;
+    }
+
+    TRADING_LOG_INFO("Week 3 optimization: Checkpointing books to {} ({} bytes, generation {})",
+                     path, size_, generation_);
+#else
+    (void)durable_;
+    throw std::runtime_error("Checkpoint files are not supported on this platform");
+#endif
+}
+
+// Unmap; everything written is already in the file
+CheckpointWriter::~CheckpointWriter() {
+#if TRADING_CHECKPOINT_MMAP
+    if (base_ != nullptr) {
+        ::munmap(base_, size_);
+    }
+#endif
+}
+
+// Invalidate the buffer we are about to overwrite
+void CheckpointWriter::begin() {
+    current_ = buffer((generation_ + 1) % 2);
+    current_->generation = 0;
+    // Keep the invalidation ahead of the rewrite, even for a crash mid-checkpoint
+    std::atomic_thread_fence(std::memory_order_release);
+    symbol_count_ = 0;
+    exchange_count_ = 0;
+}
+
+bool CheckpointWriter::add_exchange(ExchangeId exchange_id, std::string_view name) {
+    if (current_ == nullptr || exchange_id != exchange_count_ || exchange_id >= max_exchanges_) {
+        return false;
+    }
+    BufferLayout layout(max_symbols_, max_exchanges_);
+    if (!set_name(layout.exchange_names(current_)[exchange_id], name)) {
+        return false;
+    }
+    ++exchange_count_;
+    return true;
+}
+
+BookSnapshot* CheckpointWriter::add_symbol(SymbolId symbol_id, std::string_view name, Price tick_size, bool has_book) {
+    if (current_ == nullptr || symbol_id != symbol_count_ || symbol_id >= max_symbols_) {
+        return nullptr;
+    }
+    BufferLayout layout(max_symbols_, max_exchanges_);
+    CheckpointLayout::SymbolEntry& entry = layout.symbol_entries(current_)[symbol_id];
+    if (!set_name(entry.name, name)) {
+        return nullptr;
+    }
+    entry.has_book = has_book ? 1 : 0;
+    entry.tick_size = tick_size.raw();
+    ++symbol_count_;
+    return &entry.snapshot;
+}
+
+// Checksum, then publish the generation
+bool CheckpointWriter::commit(uint64_t sequence) {
+    if (current_ == nullptr) {
+        return false;
+    }
+    CheckpointLayout::BufferHeader* target = current_;
+    current_ = nullptr;
+
+    BufferLayout layout(max_symbols_, max_exchanges_);
+    target->sequence = sequence;
+    target->taken_at = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+    target->symbol_count = symbol_count_;
+    target->exchange_count = exchange_count_;
+    target->checksum = buffer_checksum(target, layout);
+#if TRADING_CHECKPOINT_MMAP
+    if (durable_ && ::msync(target, layout.size, MS_SYNC) != 0) {
+        TRADING_LOG_ERROR("Checkpoint sync to {} failed; keeping generation {}", path_, generation_);
+        return false;
+    }
+#endif
+
+    std::atomic_thread_fence(std::memory_order_release);
+    target->generation = generation_ + 1;
+#if TRADING_CHECKPOINT_MMAP
+    if (durable_ && ::msync(target, BUFFER_ALIGNMENT, MS_SYNC) != 0) {
+        TRADING_LOG_ERROR("Checkpoint sync to {} failed; keeping generation {}", path_, generation_);
+        return false;
+    }
+#endif
+    ++generation_;
+    return true;
+}
+
+CheckpointLayout::BufferHeader* CheckpointWriter::buffer(size_t index) const {
+    const auto& header = *reinterpret_cast<const CheckpointLayout::Header*>(base_);
+    return reinterpret_cast<CheckpointLayout::BufferHeader*>(base_ + header.buffer_offset[index]);
+}
+
+// Map the file and pick the newest buffer that checks out
+CheckpointReader::CheckpointReader(const std::string& path) {
+#if TRADING_CHECKPOINT_MMAP
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw std::runtime_error("Failed to open checkpoint file " + path);
+    }
+    struct stat info;
+    if (::fstat(fd, &info) != 0 || static_cast<size_t>(info.st_size) < sizeof(CheckpointLayout::Header)) {
+        ::close(fd);
+        throw std::runtime_error("Not a checkpoint file: " + path);
+    }
+    size_ = static_cast<size_t>(info.st_size);
+    void* mapping = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (mapping == MAP_FAILED) {
+        throw std::runtime_error("Failed to map checkpoint file " + path);
+    }
+    base_ = static_cast<const unsigned char*>(mapping);
+
+    if (!header_valid(base_, size_, 0, 0)) {
+        ::munmap(const_cast<unsigned char*>(base_), size_);
+        throw std::runtime_error("Not a checkpoint file of this build: " + path);
+    }
+    const auto& header = *reinterpret_cast<const CheckpointLayout::Header*>(base_);
+    BufferLayout layout(header.max_symbols, header.max_exchanges);
+    for (size_t i = 0; i < 2; ++i) {
+        const auto* candidate = reinterpret_cast<const CheckpointLayout::BufferHeader*>(base_ + header.buffer_offset[i]);
+        if (buffer_valid(candidate, header, layout) &&
+            (buffer_ == nullptr || candidate->generation > buffer_->generation)) {
+            buffer_ = candidate;
+        }
+    }
+    if (buffer_ == nullptr) {
+        ::munmap(const_cast<unsigned char*>(base_), size_);
+        throw std::runtime_error("No complete checkpoint in " + path);
+    }
+#else
+    (void)path;
+    throw std::runtime_error("Checkpoint files are not supported on this platform");
+#endif
+}
+
+CheckpointReader::~CheckpointReader() {
+#if TRADING_CHECKPOINT_MMAP
+    if (base_ != nullptr) {
+        ::munmap(const_cast<unsigned char*>(base_), size_);
+    }
+#endif
+}
+
+std::string_view CheckpointReader::exchange_name(ExchangeId exchange_id) const {
+    const auto& header = *reinterpret_cast<const CheckpointLayout::Header*>(base_);
+    const CheckpointLayout::Name& name =
+        BufferLayout(header.max_symbols, header.max_exchanges).exchange_names(buffer_)[exchange_id];
+    return std::string_view(name.text, name.length);
+}
+
+const CheckpointLayout::SymbolEntry& CheckpointReader::symbol(SymbolId symbol_id) const {
+    const auto& header = *reinterpret_cast<const CheckpointLayout::Header*>(base_);
+    return BufferLayout(header.max_symbols, header.max_exchanges).symbol_entries(buffer_)[symbol_id];
+}
+
+// Open the file and start the periodic checkpoints
+BookCheckpointer::BookCheckpointer(MarketDataHandler& handler, const std::string& path,
+                                   const CheckpointOptions& options)
+    : handler_(handler), options_(options),
+      writer_(path, handler.max_symbols(), MAX_EXCHANGES, options.durable) {
+    if (options_.interval.count() > 0) {
+        thread_ = std::thread(&BookCheckpointer::run, this);
+    }
+}
+
+BookCheckpointer::~BookCheckpointer() {
+    if (thread_.joinable()) {
+        {
+            std::lock_guard<std::mutex> lock(stop_mutex_);
+            stopping_ = true;
+        }
+        stop_cv_.notify_all();
+        thread_.join();
+    }
+    TRADING_LOG_INFO("Week 3 optimization: {} checkpoints written, {} skipped", checkpoints(), skipped());
+}
+
+// One checkpoint, serialized with the checkpoint thread
+bool BookCheckpointer::checkpoint_now() {
+    std::lock_guard<std::mutex> lock(writer_mutex_);
+    auto start = std::chrono::steady_clock::now();
+    bool written = handler_.write_checkpoint(writer_, options_.capture, options_.ingest_timeout);
+    auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start);
+    last_duration_ns_.store(elapsed.count(), std::memory_order_relaxed);
+    (written ? checkpoints_ : skipped_).fetch_add(1, std::memory_order_relaxed);
+    return written;
+}
+
+// Checkpoint thread: one checkpoint per interval until stopped
+void BookCheckpointer::run() {
+    set_current_thread_name("checkpoint");
+    std::unique_lock<std::mutex> lock(stop_mutex_);
+    while (!stop_cv_.wait_for(lock, options_.interval, [this] { return stopping_; })) {
+        lock.unlock();
+        checkpoint_now();
+        lock.lock();
+    }
+}
+
+} // namespace trading
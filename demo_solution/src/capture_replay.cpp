@@ -0,0 +1,334 @@
+#include "../include/capture_replay.hpp"
+#include "../include/logger.hpp"
+#include "../include/market_data_handler.hpp"
+#include "../include/spin_lock.hpp"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <thread>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define TRADING_CAPTURE_MMAP 1
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#else
+#define TRADING_CAPTURE_MMAP 0
+#endif
+
+namespace trading {
+
+namespace {
+
+// Below this, replay pacing spins instead of sleeping: sleeps overshoot by tens of microseconds
+constexpr auto REPLAY_SPIN_WINDOW = std::chrono::microseconds(100);
+
+// Wait for a replay deadline without oversleeping it
+void wait_until(std::chrono::steady_clock::time_point deadline) {
+    auto remaining = deadline - std::chrono::steady_clock::now();
+    if (remaining > REPLAY_SPIN_WINDOW) {
+        std::this_thread::sleep_for(remaining - REPLAY_SPIN_WINDOW);
+    }
+    while (std::chrono::steady_clock::now() < deadline) {
+        cpu_relax();
+    }
+}
+
+} // namespace
+
+// Create the capture file and buffer its header
+CaptureWriter::CaptureWriter(const std::string& path, size_t buffer_size)
+    : file_(std::fopen(path.c_str(), "wb")),
+      buffer_(std::max(buffer_size, CaptureLayout::HEADER_SIZE + CaptureLayout::RECORD_SIZE)),
+      used_(0), start_(std::chrono::steady_clock::now()), records_(0), failed_(false) {
+    if (file_ == nullptr) {
+        throw std::runtime_error("Failed to create capture file " + path);
+    }
+    // Records are buffered here; stdio buffering would only copy them twice
+    std::setvbuf(file_, nullptr, _IONBF, 0);
+
+    auto start_time = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::system_clock::now().time_since_epoch());
+    std::byte* header = buffer_.data();
+    std::memset(header, 0, CaptureLayout::HEADER_SIZE);
+    std::memcpy(header, CaptureLayout::MAGIC, sizeof(CaptureLayout::MAGIC));
+    store_little_endian<uint32_t>(header + 8, CaptureLayout::VERSION);
+    store_little_endian<uint32_t>(header + 12, CaptureLayout::HEADER_SIZE);
+    store_little_endian<int64_t>(header + 16, start_time.count());
+    used_ = CaptureLayout::HEADER_SIZE;
+
+    TRADING_LOG_INFO("Week 3 optimization: Capturing market data to {}", path);
+}
+
+// Flush and close
+CaptureWriter::~CaptureWriter() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    flush_locked();
+    std::fclose(file_);
+}
+
+// Record a batch received together
+void CaptureWriter::append(std::span<const MarketTick> ticks, std::chrono::steady_clock::time_point received) {
+    int64_t offset = std::max<int64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(received - start_).count(), 0);
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (const MarketTick& tick : ticks) {
+        if (buffer_.size() - used_ < CaptureLayout::RECORD_SIZE) {
+            flush_locked();
+        }
+        std::byte* record = buffer_.data() + used_;
+        store_little_endian<int64_t>(record, offset);
+        encode_market_update(tick, records_,
+                             std::span<std::byte>(record + CaptureLayout::OFFSET_SIZE, WireLayout::MARKET_UPDATE_SIZE));
+        used_ += CaptureLayout::RECORD_SIZE;
+        ++records_;
+    }
+}
+
+// Write out everything buffered
+void CaptureWriter::flush() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    flush_locked();
+    std::fflush(file_);
+}
+
+uint64_t CaptureWriter::records() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return records_;
+}
+
+bool CaptureWriter::failed() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return failed_;
+}
+
+// Write the buffer to the file
+void CaptureWriter::flush_locked() {
+    if (used_ == 0) {
+        return;
+    }
+    if (!failed_ && std::fwrite(buffer_.data(), 1, used_, file_) != used_) {
+        // Keep accepting records so the feed is never blocked, but say the file is incomplete
+        failed_ = true;
+        TRADING_LOG_ERROR("Capture write failed; records after #{} are lost", records_);
+    }
+    used_ = 0;
+}
+
+// Map the file and find its last complete record
+CaptureReader::CaptureReader(const std::string& path)
+    : data_(nullptr), size_(0), begin_(CaptureLayout::HEADER_SIZE), end_(0), record_count_(0),
+      duration_(0), start_time_(0), mapped_(false) {
+#if TRADING_CAPTURE_MMAP
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw std::runtime_error("Failed to open capture file " + path);
+    }
+    struct stat info;
+    if (::fstat(fd, &info) != 0 || static_cast<size_t>(info.st_size) < CaptureLayout::HEADER_SIZE) {
+        ::close(fd);
+        throw std::runtime_error("Not a capture file: " + path);
+    }
+    size_ = static_cast<size_t>(info.st_size);
+    void* mapping = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);  // The mapping keeps the file alive
+    if (mapping == MAP_FAILED) {
+        throw std::runtime_error("Failed to map capture file " + path);
+    }
+    // Replays read front to back: let the kernel read ahead aggressively
+    ::madvise(mapping, size_, MADV_SEQUENTIAL);
+    data_ = static_cast<const std::byte*>(mapping);
+    mapped_ = true;
+#else
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    if (!file) {
+        throw std::runtime_error("Failed to open capture file " + path);
+    }
+    fallback_.resize(static_cast<size_t>(file.tellg()));
+    file.seekg(0);
+    file.read(reinterpret_cast<char*>(fallback_.data()), static_cast<std::streamsize>(fallback_.size()));
+    data_ = fallback_.data();
+    size_ = fallback_.size();
+#endif
+
+    bool valid = size_ >= CaptureLayout::HEADER_SIZE
+        && std::memcmp(data_, CaptureLayout::MAGIC, sizeof(CaptureLayout::MAGIC)) == 0
+        && load_little_endian<uint32_t>(data_ + 8) == CaptureLayout::VERSION;
+    if (valid) {
+        begin_ = load_little_endian<uint32_t>(data_ + 12);
+        valid = begin_ >= CaptureLayout::HEADER_SIZE && begin_ <= size_;
+    }
+    if (!valid) {
+#if TRADING_CAPTURE_MMAP
+        ::munmap(const_cast<std::byte*>(data_), size_);
+#endif
+        throw std::runtime_error("Not a capture file: " + path);
+    }
+    start_time_ = std::chrono::nanoseconds(load_little_endian<int64_t>(data_ + 16));
+
+    // One pass up front validates every record, so next() only has to check the extent
+    size_t cursor = begin_;
+    Record record;
+    while (read_record(cursor, record, size_)) {
+        ++record_count_;
+        duration_ = record.offset;
+    }
+    end_ = cursor;
+    if (end_ != size_) {
+        TRADING_LOG_WARN("Capture {} ends in {} corrupt or truncated bytes after {} records",
+                         path, size_ - end_, record_count_);
+    }
+}
+
+// Unmap the file
+CaptureReader::~CaptureReader() {
+#if TRADING_CAPTURE_MMAP
+    if (mapped_) {
+        ::munmap(const_cast<std::byte*>(data_), size_);
+    }
+#endif
+}
+
+bool CaptureReader::next(size_t& cursor, Record& record) const {
+    return read_record(cursor, record, end_);
+}
+
+// Decode one record, skipping messages of other types
+bool CaptureReader::read_record(size_t& cursor, Record& record, size_t limit) const {
+    while (cursor <= limit && limit - cursor >= CaptureLayout::OFFSET_SIZE + WireLayout::HEADER_SIZE) {
+        const std::byte* message = data_ + cursor + CaptureLayout::OFFSET_SIZE;
+        uint16_t length = load_little_endian<uint16_t>(message + WireLayout::LENGTH);
+        auto version = static_cast<uint8_t>(message[WireLayout::VERSION]);
+        auto type = static_cast<WireMessageType>(message[WireLayout::TYPE]);
+
+        if (length < WireLayout::HEADER_SIZE || version != WIRE_VERSION
+            || limit - cursor - CaptureLayout::OFFSET_SIZE < length) {
+            return false;
+        }
+        size_t next = cursor + CaptureLayout::OFFSET_SIZE + length;
+        if (type != WireMessageType::MARKET_UPDATE) {
+            cursor = next;
+            continue;
+        }
+        if (length < WireLayout::MARKET_UPDATE_SIZE) {
+            return false;
+        }
+
+        record.offset = std::chrono::nanoseconds(load_little_endian<int64_t>(data_ + cursor));
+        record.update = MarketUpdateView(message);
+        cursor = next;
+        return true;
+    }
+    return false;
+}
+
+// Replay on the calling thread, or split by symbol across several
+ReplayResult CaptureReplayer::run(MarketDataHandler& handler, const ReplayOptions& options) const {
+    const size_t threads = std::max<size_t>(options.threads, 1);
+    TRADING_LOG_INFO("Week 3 optimization: Replaying {} captured updates on {} threads at speed {}",
+                     capture_.record_count(), threads, options.speed);
+
+    const ReplayStart first = find_start(options.from_sequence);
+    auto start = std::chrono::steady_clock::now();
+    ReplayResult result;
+    if (threads == 1) {
+        result = run_partition(handler, options, 0, first, start);
+    } else {
+        std::vector<ReplayResult> partials(threads);
+        std::vector<std::thread> workers;
+        for (size_t t = 0; t < threads; ++t) {
+            workers.emplace_back([&, t] { partials[t] = run_partition(handler, options, t, first, start); });
+        }
+        for (auto& worker : workers) {
+            worker.join();
+        }
+        for (const auto& partial : partials) {
+            result.updates += partial.updates;
+            result.max_lag = std::max(result.max_lag, partial.max_lag);
+        }
+    }
+    result.elapsed = std::chrono::steady_clock::now() - start;
+    return result;
+}
+
+// Skip the records a restored checkpoint already holds
+CaptureReplayer::ReplayStart CaptureReplayer::find_start(uint64_t from_sequence) const {
+    size_t cursor = capture_.begin();
+    if (from_sequence == 0) {
+        return ReplayStart{cursor, 0, std::chrono::nanoseconds(0)};
+    }
+    CaptureReader::Record record;
+    for (uint64_t index = 0;; ++index) {
+        size_t at = cursor;
+        if (!capture_.next(cursor, record)) {
+            // Everything is older than from_sequence: nothing to replay
+            return ReplayStart{cursor, index, std::chrono::nanoseconds(0)};
+        }
+        if (record.update.sequence() >= from_sequence) {
+            return ReplayStart{at, index, record.offset};
+        }
+    }
+}
+
+// Push one symbol partition, pacing each update against the shared start
+ReplayResult CaptureReplayer::run_partition(MarketDataHandler& handler, const ReplayOptions& options,
+                                            size_t partition, const ReplayStart& first,
+                                            std::chrono::steady_clock::time_point start) const {
+    const size_t threads = std::max<size_t>(options.threads, 1);
+    const size_t batch_size = std::max<size_t>(options.batch_size, 1);
+    const bool paced = options.speed > 0.0;
+    // Without jitter, updates are spread evenly over the captured duration
+    const double spacing = capture_.record_count() > 1
+        ? static_cast<double>(capture_.duration().count()) / static_cast<double>(capture_.record_count() - 1)
+        : 0.0;
+
+    ReplayResult result;
+    std::vector<MarketTick> batch;
+    batch.reserve(batch_size);
+    auto push = [&] {
+        handler.process_updates(std::span<const MarketTick>(batch));
+        result.updates += batch.size();
+        batch.clear();
+    };
+
+    size_t cursor = first.cursor;
+    CaptureReader::Record record;
+    for (uint64_t index = first.index; capture_.next(cursor, record); ++index) {
+        if (record.update.symbol_id() % threads != partition || record.update.sequence() < options.from_sequence) {
+            continue;
+        }
+
+        if (paced) {
+            double offset = options.preserve_jitter
+                ? static_cast<double>((record.offset - first.offset).count())
+                : spacing * static_cast<double>(index - first.index);
+            auto due = start + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                std::chrono::duration<double, std::nano>(offset / options.speed));
+            auto now = std::chrono::steady_clock::now();
+            if (now < due) {
+                // Everything batched so far is due: hand it over before waiting
+                if (!batch.empty()) {
+                    push();
+                }
+                wait_until(due);
+            } else {
+                result.max_lag = std::max(result.max_lag,
+                                          std::chrono::duration_cast<std::chrono::nanoseconds>(now - due));
+            }
+        }
+
+        batch.push_back(record.update.to_tick());
+        if (batch.size() >= batch_size) {
+            push();
+        }
+    }
+    if (!batch.empty()) {
+        push();
+    }
+    return result;
+}
+
+} // namespace trading
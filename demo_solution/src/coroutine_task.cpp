@@ -0,0 +1,59 @@
+#include "../include/coroutine_task.hpp"
+
+namespace trading {
+
+CoroutineFramePool& CoroutineFramePool::instance() {
+    static CoroutineFramePool pool;
+    return pool;
+}
+
+CoroutineFramePool::CoroutineFramePool() {
+    for (size_t i = 0; i < SIZE_CLASSES; ++i) {
+        classes_[i] = std::make_unique<week2::OrderBookAllocator>(TRADING_COROUTINE_FRAME_POOL_SIZE,
+                                                                  SMALLEST_FRAME << i);
+    }
+    TRADING_LOG_INFO("Week 3 optimization: Coroutine frames pooled in {} size classes up to {} bytes",
+                     SIZE_CLASSES, LARGEST_FRAME);
+}
+
+size_t CoroutineFramePool::size_class(size_t size) {
+    size_t index = 0;
+    while ((SMALLEST_FRAME << index) < size) {
+        ++index;
+    }
+    return index;
+}
+
+void* CoroutineFramePool::allocate(size_t size) {
+    if (size > LARGEST_FRAME) {
+        oversized_.fetch_add(1, std::memory_order_relaxed);
+        return ::operator new(size);
+    }
+    return classes_[size_class(size)]->allocate(size);
+}
+
+void CoroutineFramePool::deallocate(void* frame, size_t size) {
+    if (size > LARGEST_FRAME) {
+        ::operator delete(frame);
+        return;
+    }
+    classes_[size_class(size)]->deallocate(frame);
+}
+
+size_t CoroutineFramePool::allocations() const {
+    size_t count = oversized_.load(std::memory_order_relaxed);
+    for (const auto& size_class : classes_) {
+        count += size_class->get_allocation_count();
+    }
+    return count;
+}
+
+size_t CoroutineFramePool::fallbacks() const {
+    size_t count = oversized_.load(std::memory_order_relaxed);
+    for (const auto& size_class : classes_) {
+        count += size_class->get_fallback_count();
+    }
+    return count;
+}
+
+} // namespace trading
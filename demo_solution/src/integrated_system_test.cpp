@@ -1,30 +1,47 @@
+#include "../include/benchmark_harness.hpp"
+#include "../include/book_checkpoint.hpp"
+#include "../include/capture_replay.hpp"
+#include "../include/coroutine_task.hpp"
 #include "../include/market_data_handler.hpp"
 #include "../include/thread_pool.hpp"
 #include "../include/lock_free_queue.hpp"
+#include "../include/logger.hpp"
+#include "../include/mpmc_bounded_queue.hpp"
+#include "../include/shm_book.hpp"
+#include "../include/sorting.hpp"
+#include "../include/spsc_ring_buffer.hpp"
+#include "../include/strategy_signal.hpp"
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <future>
 #include <iostream>
 #include <iomanip>
+#include <limits>
 #include <vector>
 #include <string>
 #include <random>
 #include <chrono>
 #include <queue>
+#include <map>
 #include <mutex>
+#include <set>
+#include <span>
 #include <sstream>
 #include <atomic>
+#include <algorithm>
+#include <thread>
 
-using namespace trading;
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
 
-// Define week1 namespace for sorting algorithm
-namespace trading {
-namespace week1 {
-    template<typename Iterator, typename Compare>
-    void quick_sort(Iterator begin, Iterator end, Compare comp) {
-        // For demonstration purposes, we use std::sort as a placeholder
-        // In a real Week 1 implementation, this would be a custom implementation
-        std::sort(begin, end, comp);
-    }
-}
-}
+using namespace trading;
 
 /**
  * @brief Timer utility for performance benchmarking.
@@ -45,6 +62,40 @@ private:
     std::chrono::time_point<std::chrono::high_resolution_clock> start_;
 };
 
+/**
+ * @brief Pass/fail results of one verify_* check.
+ */
+class CheckList {
+public:
+    // Print one result; any failure fails the whole check
+    void check(bool condition, const std::string& what) {
+        std::cout << (condition ? "  [PASS] " : "  [FAIL] ") << what << std::endl;
+        passed_ = passed_ && condition;
+    }
+    
+    bool passed() const {
+        return passed_;
+    }
+    
+private:
+    bool passed_ = true;
+};
+
+/**
+ * @brief Poll a condition until it holds, for up to 10 seconds.
+ * 
+ * @param condition Callable returning bool
+ * @return true if the condition held before the deadline
+ */
+template<typename Condition>
+bool wait_for(Condition&& condition) {
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+    while (!condition() && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return condition();
+}
+
 /**
  * @brief Mock trading strategy for testing.
  * 
@@ -57,16 +108,19 @@ public:
         : name_(name), priority_(priority), use_week1_sorting_(use_week1_sorting),
           executions_(0), signals_generated_(0), total_execution_time_us_(0) {}
     
-    // Evaluate strategy on market update
-    std::vector<std::string> evaluate(const MarketUpdate& update) {
+    // Evaluate strategy on a tick, publishing its signals to the strategy's channel
+    size_t evaluate(const MarketTick& tick, uint64_t received_tsc, SignalChannel& output) {
         auto start = std::chrono::high_resolution_clock::now();
         
         // Simulate strategy computation time based on priority
         // Higher priority strategies are assumed to be more complex
         std::this_thread::sleep_for(std::chrono::milliseconds(priority_ * 2));
         
-        // Generate some mock signals
-        std::vector<std::string> signals;
+        // Generate some mock signals as POD records: no strings, no allocation
+        Signal signals[3];
+        size_t count = 1;
+        Side side = tick.bid_price > tick.ask_price ? Side::BID : Side::ASK;
+        Price mid = Price::from_raw((tick.bid_price.raw() + tick.ask_price.raw()) / 2);
         
         // Apply Week 1 sorting optimization if enabled
         if (use_week1_sorting_) {
@@ -74,23 +128,21 @@ public:
                       << name_ << std::endl;
             
             // Simulate signal generation with some randomness
-            int signal_count = 1 + (std::rand() % 3);
-            for (int i = 0; i < signal_count; ++i) {
-                std::stringstream ss;
-                ss << "SIGNAL:" << name_ << ":" << update.symbol 
-                   << ":" << (update.bid_price > update.ask_price ? "BUY" : "SELL")
-                   << "@" << std::fixed << std::setprecision(2) 
-                   << ((update.bid_price + update.ask_price) / 2.0);
-                signals.push_back(ss.str());
+            count = 1 + static_cast<size_t>(std::rand() % 3);
+            for (size_t i = 0; i < count; ++i) {
+                signals[i] = make_signal(tick, received_tsc, side, mid + Price::from_raw(static_cast<int64_t>(i) * 1000000),
+                                         static_cast<int32_t>(100 * (count - i)));
             }
+            week1::introsort(signals, signals + count, [](const Signal& a, const Signal& b) {
+                return a.price < b.price;
+            });
         } else {
             // Only generate one signal when not using optimized sorting
-            std::stringstream ss;
-            ss << "SIGNAL:" << name_ << ":" << update.symbol 
-               << ":" << (update.bid_price > update.ask_price ? "BUY" : "SELL")
-               << "@" << std::fixed << std::setprecision(2) 
-               << ((update.bid_price + update.ask_price) / 2.0);
-            signals.push_back(ss.str());
+            signals[0] = make_signal(tick, received_tsc, side, mid, 100);
+        }
+        
+        for (size_t i = 0; i < count; ++i) {
+            output.publish(signals[i]);
         }
         
         auto end = std::chrono::high_resolution_clock::now();
@@ -98,10 +150,10 @@ public:
         
         // Update stats
         executions_++;
-        signals_generated_ += signals.size();
+        signals_generated_ += count;
         total_execution_time_us_ += duration;
         
-        return signals;
+        return count;
     }
     
     // Print strategy statistics
@@ -121,6 +173,17 @@ public:
     int priority() const { return priority_; }
     
 private:
+    static Signal make_signal(const MarketTick& tick, uint64_t received_tsc, Side side, Price price, int32_t quantity) {
+        Signal signal;
+        signal.price = price;
+        signal.source_timestamp = tick.timestamp;
+        signal.received_tsc = received_tsc;
+        signal.symbol_id = tick.symbol_id;
+        signal.quantity = quantity;
+        signal.side = side;
+        return signal;
+    }
+    
     std::string name_;
     int priority_;
     bool use_week1_sorting_;
@@ -164,8 +227,8 @@ std::vector<MarketUpdate> generate_test_market_data(
         update.exchange = exchanges[exchange_dist(gen)];
         
         double mid_price = price_dist(gen);
-        update.bid_price = mid_price - 0.01;
-        update.ask_price = mid_price + 0.01;
+        update.bid_price = Price::from_double(mid_price - 0.01);
+        update.ask_price = Price::from_double(mid_price + 0.01);
         update.volume = volume_dist(gen);
         
         // Simulate timestamps with increasing values
@@ -283,6 +346,70 @@ void benchmark_queue_performance() {
     }
     
     std::cout << "Mutex-based queue: Total items dequeued: " << mutex_dequeued.load() << std::endl;
+    
+    // Head-to-head for the single-producer/single-consumer case, e.g. an
+    // exchange thread feeding one processing thread
+    std::cout << "\n--- 1 producer / 1 consumer: LockFreeQueue vs. SpscRingBuffer ---" << std::endl;
+    
+    {
+        trading::LockFreeQueue<int> spsc_lock_free_queue(false);
+        Timer timer("Lock-free queue 1P1C");
+        
+        std::thread producer([&spsc_lock_free_queue, &NUM_ITEMS]() {
+            for (int i = 0; i < NUM_ITEMS; ++i) {
+                spsc_lock_free_queue.enqueue(i);
+            }
+        });
+        
+        std::thread consumer([&spsc_lock_free_queue, &NUM_ITEMS]() {
+            int item;
+            int received = 0;
+            while (received < NUM_ITEMS) {
+                if (spsc_lock_free_queue.try_dequeue(item)) {
+                    ++received;
+                } else {
+                    std::this_thread::yield();
+                }
+            }
+        });
+        
+        producer.join();
+        consumer.join();
+        
+        std::cout << "Lock-free queue 1P1C: enqueued " << spsc_lock_free_queue.total_enqueued()
+                  << ", dequeued " << spsc_lock_free_queue.total_dequeued() << std::endl;
+    }
+    
+    {
+        auto ring = std::make_unique<trading::SpscRingBuffer<int, 1024>>();
+        Timer timer("SPSC ring buffer 1P1C");
+        
+        std::thread producer([&ring, &NUM_ITEMS]() {
+            for (int i = 0; i < NUM_ITEMS; ++i) {
+                while (!ring->try_push(i)) {
+                    std::this_thread::yield();
+                }
+            }
+        });
+        
+        std::thread consumer([&ring, &NUM_ITEMS]() {
+            int item;
+            int received = 0;
+            while (received < NUM_ITEMS) {
+                if (ring->try_pop(item)) {
+                    ++received;
+                } else {
+                    std::this_thread::yield();
+                }
+            }
+        });
+        
+        producer.join();
+        consumer.join();
+        
+        std::cout << "SPSC ring buffer 1P1C: enqueued " << ring->total_enqueued()
+                  << ", dequeued " << ring->total_dequeued() << std::endl;
+    }
 }
 
 /**
@@ -302,7 +429,7 @@ void benchmark_thread_pool_performance() {
     auto cpu_work = [WORK_SIZE](int task_id) {
         volatile int sum = 0;
         for (int i = 0; i < WORK_SIZE; ++i) {
-            sum += i * task_id;
+            sum = sum + i * task_id;
         }
         return sum;
     };
@@ -367,166 +494,2911 @@ void benchmark_thread_pool_performance() {
 }
 
 /**
- * @brief Integrated system test demonstrating all the optimizations.
+ * @brief Verify incremental order book maintenance.
+ * 
+ * Checks that repeated prices are merged into one level, that a zero
+ * volume deletes a level, that both sides stay sorted best-first and
+ * that the book never grows beyond its configured depth.
+ * 
+ * @return true if all checks passed
  */
-int main() {
-    std::cout << "=== Week 3 Integrated Trading System Test ===" << std::endl;
+bool verify_order_book_maintenance() {
+    std::cout << "\n=== CHECK: Incremental Order Book Maintenance ===\n" << std::endl;
     
-    // Step 1: Configure the trading system
-    std::cout << "\n=== STEP 1: Configuring Trading System ===\n" << std::endl;
+    const size_t DEPTH = 3;
+    trading::MarketDataHandler handler(4, DEPTH);
+    handler.subscribe("TEST", [](const trading::MarketUpdate&) {});
     
-    std::vector<std::string> symbols = {"AAPL", "MSFT", "GOOG", "AMZN", "META"};
-    std::vector<std::string> exchanges = {"NYSE", "NASDAQ", "IEX"};
+    auto make_update = [](double bid, double ask, int volume) {
+        trading::MarketUpdate update;
+        update.symbol = "TEST";
+        update.exchange = "NYSE";
+        update.bid_price = Price::from_double(bid);
+        update.ask_price = Price::from_double(ask);
+        update.volume = volume;
+        update.timestamp = std::chrono::nanoseconds(1);
+        return update;
+    };
     
-    // Initialize market data handler (Week 2 optimized memory management)
-    std::cout << "Week 2 optimization: Initializing market data handler with custom allocator" << std::endl;
-    trading::MarketDataHandler market_data_handler(100);  // Maximum 100 orders per symbol
+    CheckList checks;
     
-    // Add exchanges
-    for (const auto& exchange : exchanges) {
-        std::cout << "Adding exchange: " << exchange << std::endl;
-        market_data_handler.add_exchange(exchange);
-    }
+    // Same price twice must update the level, not add a second one
+    handler.process_update(make_update(100.00, 100.10, 100));
+    handler.process_update(make_update(100.00, 100.10, 250));
+    auto book = handler.get_order_book("TEST");
+    checks.check(book.bids.size() == 1 && book.bids[0].volume == 250, "repeated bid price merged");
+    checks.check(book.asks.size() == 1 && book.asks[0].volume == 250, "repeated ask price merged");
     
-    // Create thread pool for strategy evaluation (Week 3 optimization)
-    std::cout << "Week 3 optimization: Creating thread pool for strategy evaluation" << std::endl;
-    trading::ThreadPool strategy_thread_pool(std::thread::hardware_concurrency(), false); // non-verbose mode
+    // Insert better and worse levels beyond the configured depth
+    handler.process_update(make_update(99.98, 100.12, 10));
+    handler.process_update(make_update(100.02, 100.08, 20));
+    handler.process_update(make_update(99.99, 100.11, 30));
+    handler.process_update(make_update(99.90, 100.20, 40));
+    book = handler.get_order_book("TEST");
+    checks.check(book.bids.size() == DEPTH && book.asks.size() == DEPTH, "depth bounded to 3 levels");
+    checks.check(book.bids.size() == DEPTH && book.bids[0].price == Price::from_double(100.02) && book.bids[1].price == Price::from_double(100.00) &&
+                 book.bids[2].price == Price::from_double(99.99), "bids sorted descending");
+    checks.check(book.asks.size() == DEPTH && book.asks[0].price == Price::from_double(100.08) && book.asks[1].price == Price::from_double(100.10) &&
+                 book.asks[2].price == Price::from_double(100.11), "asks sorted ascending");
     
-    // Create strategies with different priorities
-    std::cout << "Creating trading strategies with different priorities:" << std::endl;
-    TradingStrategy strategy1("Fast Alpha Strategy", 3, 10);  // High priority, fast execution
-    std::cout << "  - " << strategy1.name() << " (Priority: " << strategy1.priority() << ")" << std::endl;
+    // Zero volume removes the level
+    handler.process_update(make_update(100.02, 100.08, 0));
+    book = handler.get_order_book("TEST");
+    checks.check(!book.bids.empty() && book.bids[0].price == Price::from_double(100.00), "zero volume deletes bid level");
+    checks.check(!book.asks.empty() && book.asks[0].price == Price::from_double(100.10), "zero volume deletes ask level");
     
-    TradingStrategy strategy2("ML-Based Strategy", 2, 50);  // Medium priority, slower execution
-    std::cout << "  - " << strategy2.name() << " (Priority: " << strategy2.priority() << ")" << std::endl;
+    // The ID-keyed tick path updates the same book and callbacks see the tick
+    handler.add_exchange("NYSE");
+    trading::SymbolId symbol_id = handler.symbol_id("TEST");
+    trading::ExchangeId exchange_id = handler.exchange_id("NYSE");
+    checks.check(symbol_id != trading::INVALID_SYMBOL_ID && exchange_id != trading::INVALID_EXCHANGE_ID,
+                 "symbol and exchange interned");
     
-    TradingStrategy strategy3("Long-Term Strategy", 1, 30);  // Low priority, medium execution
-    std::cout << "  - " << strategy3.name() << " (Priority: " << strategy3.priority() << ")" << std::endl;
+    trading::MarketTick received{};
+    handler.subscribe_ticks("TEST", [&received](const trading::MarketTick& tick) { received = tick; });
+    handler.process_update(trading::MarketTick{symbol_id, exchange_id, Price::from_double(100.05), Price::from_double(100.06), 70,
+                                               std::chrono::nanoseconds(2)});
+    book = handler.get_order_book(symbol_id);
+    checks.check(!book.bids.empty() && book.bids[0].price == Price::from_double(100.05) && book.bids[0].volume == 70,
+                 "tick updates book by symbol id");
+    checks.check(received.symbol_id == symbol_id && received.volume == 70, "tick callback invoked");
+    checks.check(handler.to_market_update(received).exchange == "NYSE", "tick converts back to named update");
     
-    // Create lock-free queue for trading signals (Week 3 optimization)
-    std::cout << "Week 3 optimization: Creating lock-free queue for trading signals" << std::endl;
-    trading::LockFreeQueue<std::string> signal_queue(false); // non-verbose mode
+    return checks.passed();
+}
+
+/**
+ * @brief Verify batched update processing against the per-update path.
+ * 
+ * A batch interleaving several symbols must leave every book exactly as
+ * feeding the same updates one at a time does, invoke callbacks in batch
+ * order, and count unknown symbols as dropped.
+ * 
+ * @return true if all checks passed
+ */
+bool verify_batch_processing() {
+    std::cout << "\n=== CHECK: Batched Update Processing ===\n" << std::endl;
     
-    // Step 2: Subscribe to market data
-    std::cout << "\n=== STEP 2: Subscribing to Market Data ===\n" << std::endl;
+    const std::vector<std::string> symbols = {"AAA", "BBB", "CCC"};
+    trading::MarketDataHandler sequential(4, 5);
+    trading::MarketDataHandler batched(4, 5);
     
+    std::vector<std::string> callback_order;
     for (const auto& symbol : symbols) {
-        for (const auto& exchange : exchanges) {
-            std::cout << "Subscribing to " << symbol << " on " << exchange << std::endl;
-            market_data_handler.subscribe(symbol, exchange);
-        }
+        sequential.subscribe(symbol, [](const trading::MarketUpdate&) {});
+        batched.subscribe(symbol, [&callback_order](const trading::MarketUpdate& update) {
+            callback_order.push_back(update.symbol);
+        });
     }
     
-    // Step 3: Run benchmarks to demonstrate optimizations
-    std::cout << "\n=== STEP 3: Running Performance Benchmarks ===\n" << std::endl;
+    std::vector<trading::MarketUpdate> updates;
+    for (int i = 0; i < 60; ++i) {
+        trading::MarketUpdate update;
+        update.symbol = symbols[(i * 7) % symbols.size()];
+        update.exchange = i % 2 == 0 ? "NYSE" : "NASDAQ";
+        update.bid_price = Price::from_double(100.00 - (i % 9) * 0.01);
+        update.ask_price = Price::from_double(100.10 + (i % 9) * 0.01);
+        update.volume = i % 5 == 0 ? 0 : 10 * i;
+        update.timestamp = std::chrono::nanoseconds(i + 1);
+        updates.push_back(update);
+    }
+    trading::MarketUpdate unknown = updates.front();
+    unknown.symbol = "ZZZ";
+    updates.push_back(unknown);
     
-    // Benchmark queue performance (Week 3 optimization)
-    benchmark_queue_performance();
+    for (const auto& update : updates) {
+        sequential.process_update(update);
+    }
+    batched.process_updates(std::span<const trading::MarketUpdate>(updates));
     
-    // Benchmark thread pool performance (Week 3 optimization)
-    benchmark_thread_pool_performance();
+    CheckList checks;
     
-    // Step 4: Generate market updates
-    std::cout << "\n=== STEP 4: Generating Market Updates ===\n" << std::endl;
+    auto same_levels = [](const std::vector<trading::OrderBookEntry>& a,
+                          const std::vector<trading::OrderBookEntry>& b) {
+        return std::equal(a.begin(), a.end(), b.begin(), b.end(),
+                          [](const trading::OrderBookEntry& x, const trading::OrderBookEntry& y) {
+                              return x.price == y.price && x.volume == y.volume;
+                          });
+    };
+    bool books_match = true;
+    for (const auto& symbol : symbols) {
+        auto expected = sequential.get_order_book(symbol);
+        auto actual = batched.get_order_book(symbol);
+        books_match = books_match && expected.timestamp == actual.timestamp &&
+                      same_levels(expected.bids, actual.bids) && same_levels(expected.asks, actual.asks);
+    }
+    checks.check(books_match, "batched books match sequential processing");
     
-    const int NUM_UPDATES = 100;
-    std::cout << "Generating " << NUM_UPDATES << " random market updates" << std::endl;
-    std::vector<trading::MarketUpdate> updates = generate_test_market_data(NUM_UPDATES, symbols, exchanges);
+    std::vector<std::string> expected_order;
+    for (size_t i = 0; i + 1 < updates.size(); ++i) {
+        expected_order.push_back(updates[i].symbol);
+    }
+    checks.check(callback_order == expected_order, "callbacks invoked in batch order");
+    checks.check(batched.exchange_id("NYSE") == trading::INVALID_EXCHANGE_ID &&
+                 sequential.exchange_id("NASDAQ") == trading::INVALID_EXCHANGE_ID,
+                 "exchange names in updates are not registered implicitly");
     
-    // Step 5: Process market updates
-    std::cout << "\n=== STEP 5: Processing Market Updates ===\n" << std::endl;
+    auto metrics = batched.get_metrics();
+    checks.check(metrics.total_updates_processed == updates.size() - 1 && metrics.total_updates_dropped == 1,
+                 "batch metrics count processed and dropped updates");
     
-    size_t signals_generated = 0;
+    // A callback that feeds the handler again must not disturb the outer batch
+    trading::MarketDataHandler reentrant(4, 5);
+    std::vector<std::string> outer_order;
+    bool fed_back = false;
+    int ccc_calls = 0;
+    auto record = [&outer_order](const trading::MarketUpdate& update) {
+        outer_order.push_back(update.symbol);
+    };
+    reentrant.subscribe("AAA", [&](const trading::MarketUpdate& update) {
+        record(update);
+        if (!fed_back) {
+            fed_back = true;
+            // Larger than the outer batch, so reused buffers would be overwritten
+            trading::MarketUpdate nested_update = update;
+            nested_update.symbol = "CCC";
+            std::vector<trading::MarketUpdate> nested(2 * updates.size(), nested_update);
+            reentrant.process_updates(std::span<const trading::MarketUpdate>(nested));
+            reentrant.process_update(nested_update);
+        }
+    });
+    reentrant.subscribe("BBB", record);
+    reentrant.subscribe("CCC", [&ccc_calls](const trading::MarketUpdate&) {
+        ++ccc_calls;
+    });
+    reentrant.process_updates(std::span<const trading::MarketUpdate>(updates));
+    std::vector<std::string> expected_outer;
+    for (size_t i = 0; i + 1 < updates.size(); ++i) {
+        if (updates[i].symbol != "CCC") {
+            expected_outer.push_back(updates[i].symbol);
+        }
+    }
+    int outer_ccc = static_cast<int>(updates.size() - 1 - expected_outer.size());
+    checks.check(outer_order == expected_outer && ccc_calls == outer_ccc + static_cast<int>(2 * updates.size()) + 1 &&
+                 reentrant.get_metrics().total_updates_processed == (updates.size() - 1) + (2 * updates.size() + 1),
+                 "callbacks may feed the handler again from inside a batch");
+    
+    return checks.passed();
+}
+
+/**
+ * @brief Verify the Week 2 slab allocator and its standard allocator adapter.
+ * 
+ * Order books must come out of the handler's slab, and a lock-free queue
+ * using week2::PoolAllocator must not touch the system allocator once the
+ * pool is sized for its working set.
+ * 
+ * @return true if all checks passed
+ */
+bool verify_pool_allocator() {
+    std::cout << "\n=== CHECK: Week 2 Slab Allocator ===\n" << std::endl;
+    
+    CheckList checks;
     
     {
-        Timer timer("Processing market updates");
+        trading::MarketDataHandler handler(8);
+        handler.subscribe("AAPL", [](const trading::MarketUpdate&) {});
+        handler.subscribe("MSFT", [](const trading::MarketUpdate&) {});
+        const auto& allocator = handler.order_book_allocator();
+        checks.check(allocator.get_allocation_count() == 2 && allocator.get_fallback_count() == 0,
+                     "order books allocated from the slab");
+    }
+    
+    // Room for the live nodes plus the retired ones awaiting a hazard scan
+    trading::week2::OrderBookAllocator pool(512, 64);
+    {
+        trading::LockFreeQueue<int, trading::week2::PoolAllocator<int>> queue(
+            false, trading::week2::PoolAllocator<int>(&pool));
         
-        for (const auto& update : updates) {
-            // Process update in market data handler
-            market_data_handler.process_update(update);
-            
-            // Evaluate strategies in parallel using thread pool
-            auto strategy1_future = strategy_thread_pool.submit(
-                strategy1.priority(),
-                [&strategy1, &update, &signal_queue]() {
-                    auto signals = strategy1.evaluate(update);
-                    for (const auto& signal : signals) {
-                        signal_queue.enqueue(signal);
-                    }
-                    return signals.size();
-                }
-            );
-            
-            auto strategy2_future = strategy_thread_pool.submit(
-                strategy2.priority(),
-                [&strategy2, &update, &signal_queue]() {
-                    auto signals = strategy2.evaluate(update);
-                    for (const auto& signal : signals) {
-                        signal_queue.enqueue(signal);
-                    }
-                    return signals.size();
-                }
-            );
-            
-            auto strategy3_future = strategy_thread_pool.submit(
-                strategy3.priority(),
-                [&strategy3, &update, &signal_queue]() {
-                    auto signals = strategy3.evaluate(update);
-                    for (const auto& signal : signals) {
-                        signal_queue.enqueue(signal);
-                    }
-                    return signals.size();
-                }
-            );
-            
-            // Wait for strategies to complete and count signals
-            signals_generated += strategy1_future.get();
-            signals_generated += strategy2_future.get();
-            signals_generated += strategy3_future.get();
+        for (int round = 0; round < 100; ++round) {
+            for (int i = 0; i < 50; ++i) {
+                queue.enqueue(i);
+            }
+            int value;
+            while (queue.try_dequeue(value)) {
+            }
         }
     }
     
-    // Step 6: Print results
-    std::cout << "\n=== STEP 6: Results ===\n" << std::endl;
+    checks.check(pool.get_allocation_count() > 0 && pool.get_fallback_count() == 0,
+                 "queue nodes drawn from the pool");
+    checks.check(pool.get_allocation_count() == pool.get_deallocation_count(), "every pooled block returned");
     
-    // Get metrics from market data handler
-    trading::MarketDataMetricsResult metrics = market_data_handler.get_metrics();
+    return checks.passed();
+}
+
+/**
+ * @brief Verify the exchange ingest pipeline.
+ * 
+ * Two simulated exchanges (one blocking, one busy-polling) feed the
+ * handler through FeedSources. Every tick must be either processed or
+ * counted as dropped, and each symbol must always be processed on the
+ * same book worker.
+ * 
+ * @return true if all checks passed
+ */
+bool verify_ingest_pipeline() {
+    std::cout << "\n=== CHECK: Exchange Ingest Pipeline ===\n" << std::endl;
     
-    std::cout << "Market updates processed: " << metrics.updates_processed
-              << " in " << metrics.processing_time_ms << " ms" << std::endl;
-    std::cout << "Updates dropped: " << metrics.updates_dropped << std::endl;
-    std::cout << "Trading signals generated: " << signals_generated << std::endl;
+    CheckList checks;
     
-    // Print strategy statistics
-    std::cout << "\nStrategy Statistics:" << std::endl;
-    strategy1.print_stats();
-    strategy2.print_stats();
-    strategy3.print_stats();
+    const std::vector<std::string> symbols = {"AAPL", "MSFT", "GOOG", "AMZN"};
+    const int TICKS_PER_EXCHANGE = 2000;
     
-    // Print thread pool statistics
-    std::cout << "\nThread Pool Statistics:" << std::endl;
-    std::cout << "Total tasks completed: " << strategy_thread_pool.total_tasks_completed() << std::endl;
+    trading::MarketDataHandler handler(8);
     
-    // Display order books for each symbol
-    std::cout << "\nOrder Books:" << std::endl;
+    auto blocking_feed = std::make_unique<trading::QueueFeedSource>(8192);
+    auto polling_feed = std::make_unique<trading::QueueFeedSource>(8192);
+    trading::QueueFeedSource* feeds[] = {blocking_feed.get(), polling_feed.get()};
+    handler.add_exchange("SIM_BLOCKING", std::move(blocking_feed), trading::FeedWaitMode::BLOCKING);
+    handler.add_exchange("SIM_POLLING", std::move(polling_feed), trading::FeedWaitMode::BUSY_POLL);
     
+    // Record which thread processes each symbol
+    std::mutex seen_mutex;
+    std::vector<std::set<std::thread::id>> threads_by_symbol(symbols.size());
+    std::atomic<size_t> ticks_seen(0);
     for (const auto& symbol : symbols) {
-        std::cout << "Symbol: " << symbol << std::endl;
+        handler.subscribe_ticks(symbol, [&](const trading::MarketTick& tick) {
+            {
+                std::lock_guard<std::mutex> lock(seen_mutex);
+                threads_by_symbol[tick.symbol_id].insert(std::this_thread::get_id());
+            }
+            ticks_seen.fetch_add(1, std::memory_order_relaxed);
+        });
+    }
+    
+    handler.start(2);
+    
+    size_t published = 0;
+    for (int i = 0; i < TICKS_PER_EXCHANGE; ++i) {
+        for (auto* feed : feeds) {
+            trading::MarketTick tick{};
+            tick.symbol_id = handler.symbol_id(symbols[i % symbols.size()]);
+            tick.bid_price = Price::from_double(100.0 + (i % 10) * 0.01);
+            tick.ask_price = Price::from_double(100.1 + (i % 10) * 0.01);
+            tick.volume = 100;
+            while (!feed->publish(tick)) {
+                std::this_thread::yield();
+            }
+            ++published;
+        }
+    }
+    
+    // Wait until everything published has been processed or shed
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+    while (std::chrono::steady_clock::now() < deadline) {
+        auto metrics = handler.get_metrics();
+        if (metrics.total_updates_processed + metrics.total_updates_dropped >= published) {
+            break;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    handler.stop();
+    
+    auto metrics = handler.get_metrics();
+    std::cout << "  Published " << published << ", processed " << metrics.total_updates_processed
+              << ", dropped on backpressure " << metrics.total_updates_dropped << std::endl;
+    
+    checks.check(metrics.total_updates_processed + metrics.total_updates_dropped == published,
+                 "every tick processed or counted as dropped");
+    checks.check(ticks_seen.load() == metrics.total_updates_processed, "a callback per processed tick");
+    
+    uint64_t queue_waits = 0;
+    for (const auto& [exchange, latency] : metrics.latency) {
+        queue_waits += latency.queue_wait.count;
+    }
+    checks.check(queue_waits == metrics.total_updates_processed, "queue wait recorded for every routed tick");
+    
+    bool single_writer = true;
+    for (const auto& seen : threads_by_symbol) {
+        single_writer = single_writer && seen.size() <= 1;
+    }
+    checks.check(single_writer, "each symbol processed on a single book worker");
+    checks.check(!handler.get_order_book("AAPL").bids.empty(), "book built from the feed");
+    
+    return checks.passed();
+}
+
+// Oversized callables must be rejected by post() at compile time
+struct OversizedCallable {
+    char state[trading::InplaceTask::BUFFER_SIZE + 1];
+    void operator()() {}
+};
+static_assert(!trading::InplaceTask::fits<OversizedCallable>, "InplaceTask must reject oversized callables");
+
+/**
+ * @brief Verify the work-stealing thread pool.
+ * 
+ * Checks that queued tasks still run most urgent priority first, that
+ * tasks spawned from inside a task (pushed onto the worker's own deque and
+ * stolen by idle workers) all run exactly once, and that post() stays
+ * inside the pool's task slab.
+ * 
+ * @return true if all checks passed
+ */
+bool verify_work_stealing_pool() {
+    std::cout << "\n=== CHECK: Work-Stealing Thread Pool ===\n" << std::endl;
+    
+    CheckList checks;
+    
+    {
+        // Hold the only worker while tasks of mixed priority queue up
+        trading::ThreadPool pool(1, false);
+        std::promise<void> release;
+        std::shared_future<void> gate = release.get_future().share();
+        auto blocker = pool.submit(3, [gate]() { gate.wait(); });
         
-        // Get top bids and asks
-        auto order_book = market_data_handler.get_order_book(symbol);
+        std::mutex order_mutex;
+        std::vector<int> order;
+        std::vector<std::future<void>> done;
+        for (int priority : {1, 3, 0, 2}) {
+            done.push_back(pool.submit(priority, [priority, &order, &order_mutex]() {
+                std::lock_guard<std::mutex> lock(order_mutex);
+                order.push_back(priority);
+            }));
+        }
+        release.set_value();
+        blocker.get();
+        for (auto& f : done) {
+            f.get();
+        }
+        checks.check(order == std::vector<int>({3, 2, 1, 0}), "queued tasks run highest priority first");
+    }
+    
+    {
+        const int NUM_CHILDREN = 2000;
+        trading::ThreadPool pool(4, false);
+        std::atomic<int> children_run(0);
         
-        std::cout << "  Top Bids:" << std::endl;
-        for (const auto& bid : order_book.bids) {
-            std::cout << "    " << bid.exchange << ": " << bid.price << " x " << bid.volume << std::endl;
+        auto parent = pool.submit(2, [&pool, &children_run, NUM_CHILDREN]() {
+            for (int i = 0; i < NUM_CHILDREN; ++i) {
+                pool.submit(1, [&children_run]() {
+                    children_run.fetch_add(1, std::memory_order_relaxed);
+                });
+            }
+        });
+        parent.get();
+        while (pool.active_tasks() > 0) {
+            std::this_thread::yield();
         }
         
-        std::cout << "  Top Asks:" << std::endl;
-        for (const auto& ask : order_book.asks) {
-            std::cout << "    " << ask.exchange << ": " << ask.price << " x " << ask.volume << std::endl;
+        checks.check(children_run.load() == NUM_CHILDREN, "tasks spawned inside a task all run once");
+        std::cout << "  Tasks stolen by idle workers: " << pool.total_tasks_stolen() << std::endl;
+    }
+    
+    {
+        // Fire-and-forget tasks live entirely in the pool's slab as long as
+        // the number in flight stays within it
+        const int NUM_ROUNDS = 10;
+        const int POSTS_PER_ROUND = 500;
+        trading::ThreadPool pool(2, false);
+        std::atomic<int> posts_run(0);
+        for (int round = 0; round < NUM_ROUNDS; ++round) {
+            for (int i = 0; i < POSTS_PER_ROUND; ++i) {
+                pool.post(i % 4, [&posts_run]() {
+                    posts_run.fetch_add(1, std::memory_order_relaxed);
+                });
+            }
+            while (pool.active_tasks() > 0) {
+                std::this_thread::yield();
+            }
         }
         
-        std::cout << std::endl;
+        auto moved_only = std::make_unique<int>(7);
+        auto result = pool.submit(1, [](std::unique_ptr<int> p, int extra) { return *p + extra; },
+                                  std::move(moved_only), 35);
+        
+        checks.check(posts_run.load() == NUM_ROUNDS * POSTS_PER_ROUND, "posted tasks all run");
+        checks.check(pool.task_allocator().get_fallback_count() == 0, "posted tasks never hit the system allocator");
+        checks.check(result.get() == 42, "submit binds move-only arguments and returns the result");
+    }
+    
+    return checks.passed();
+}
+
+/**
+ * @brief Push disjoint ranges through a queue with the bulk API from several threads.
+ * 
+ * @return true if every value arrived exactly once
+ */
+template<typename Queue>
+bool run_mpmc_exchange(Queue& queue, int num_producers, int num_consumers, int items_per_producer) {
+    constexpr int BATCH = 16;
+    const long long total = static_cast<long long>(num_producers) * items_per_producer;
+    std::atomic<long long> consumed(0);
+    std::atomic<long long> sum(0);
+    std::vector<std::thread> threads;
+    
+    for (int p = 0; p < num_producers; ++p) {
+        threads.emplace_back([&queue, p, items_per_producer]() {
+            int batch[BATCH];
+            int next = 0;
+            while (next < items_per_producer) {
+                int n = items_per_producer - next < BATCH ? items_per_producer - next : BATCH;
+                for (int i = 0; i < n; ++i) {
+                    batch[i] = p * items_per_producer + next + i;
+                }
+                int pushed = 0;
+                while (pushed < n) {
+                    pushed += static_cast<int>(queue.try_enqueue_bulk(batch + pushed, n - pushed));
+                    if (pushed < n) {
+                        std::this_thread::yield();
+                    }
+                }
+                next += n;
+            }
+        });
+    }
+    
+    for (int c = 0; c < num_consumers; ++c) {
+        threads.emplace_back([&queue, &consumed, &sum, total]() {
+            int batch[BATCH];
+            while (consumed.load() < total) {
+                size_t n = queue.try_dequeue_bulk(batch, BATCH);
+                long long local = 0;
+                for (size_t i = 0; i < n; ++i) {
+                    local += batch[i];
+                }
+                sum.fetch_add(local);
+                consumed.fetch_add(static_cast<long long>(n));
+                if (n == 0) {
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+    
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    
+    return consumed.load() == total && sum.load() == total * (total - 1) / 2 && queue.empty();
+}
+
+/**
+ * @brief Verify the concurrent queues under multiple producers and consumers.
+ * 
+ * Exercises hazard pointer reclamation in LockFreeQueue and lap handling
+ * in MpmcBoundedQueue, plus the bounded queue's full/FIFO behaviour.
+ * 
+ * @return true if all checks passed
+ */
+bool verify_concurrent_queues() {
+    std::cout << "\n=== CHECK: Concurrent Queues ===\n" << std::endl;
+    
+    CheckList checks;
+    
+    {
+        trading::LockFreeQueue<int> queue(false);
+        checks.check(run_mpmc_exchange(queue, 3, 3, 20000),
+                     "LockFreeQueue delivers every value exactly once (3P3C, bulk)");
+    }
+    
+    {
+        trading::MpmcBoundedQueue<int> queue(256);
+        checks.check(run_mpmc_exchange(queue, 3, 3, 20000),
+                     "MpmcBoundedQueue delivers every value exactly once (3P3C, bulk)");
+        
+        trading::MpmcBoundedQueue<int> small(4);
+        int items[6] = {1, 2, 3, 4, 5, 6};
+        int out[6] = {};
+        checks.check(small.capacity() == 4 && small.try_enqueue_bulk(items, 6) == 4 && !small.try_enqueue(7),
+                     "bounded queue reports full instead of growing");
+        checks.check(small.try_dequeue_bulk(out, 6) == 4 && out[0] == 1 && out[3] == 4 && small.empty(),
+                     "bulk dequeue preserves FIFO order");
+    }
+    
+    return checks.passed();
+}
+
+/**
+ * @brief Verify the latency histograms, rate counters and their merge in get_metrics().
+ * 
+ * Percentiles must land within the histogram's ~3% bucket error, shards
+ * recorded from several threads must merge, the windowed rate must count
+ * only the last second, and the handler must report book update and
+ * callback latencies per exchange.
+ * 
+ * @return true if all checks passed
+ */
+bool verify_latency_metrics() {
+    std::cout << "\n=== CHECK: Latency Histograms and Rates ===\n" << std::endl;
+    
+    CheckList checks;
+    auto within = [](double value, double expected, double tolerance) {
+        return value >= expected * (1.0 - tolerance) && value <= expected * (1.0 + tolerance);
+    };
+    
+    // Two threads, one histogram each, merged into one distribution of 1..100000 ns
+    trading::LatencyHistogram low;
+    trading::LatencyHistogram high;
+    std::thread low_writer([&low] {
+        for (uint64_t v = 1; v <= 50000; ++v) {
+            low.record(v);
+        }
+    });
+    std::thread high_writer([&high] {
+        for (uint64_t v = 50001; v <= 100000; ++v) {
+            high.record(v);
+        }
+    });
+    low_writer.join();
+    high_writer.join();
+    
+    trading::LatencySnapshot merged;
+    merged.merge(low);
+    merged.merge(high);
+    checks.check(merged.count() == 100000 && merged.min() == 1 && merged.max() == 100000,
+                 "merged histogram keeps count, min and max");
+    checks.check(within(static_cast<double>(merged.value_at_percentile(50.0)), 50000, 0.04) &&
+                 within(static_cast<double>(merged.value_at_percentile(99.0)), 99000, 0.04) &&
+                 within(static_cast<double>(merged.value_at_percentile(99.9)), 99900, 0.04),
+                 "p50/p99/p99.9 within bucket error");
+    checks.check(within(merged.mean(), 50000.5, 0.0001), "mean is exact");
+    
+    // 100 messages per 100 ms slot, recorded over 2 s of simulated time
+    trading::MessageRateCounter counter;
+    auto start = trading::MessageRateCounter::Clock::time_point(std::chrono::seconds(100));
+    for (int slot = 0; slot < 20; ++slot) {
+        counter.record(100, start + slot * trading::MessageRateCounter::SLOT_WIDTH);
+    }
+    double rate = counter.rate(start + 20 * trading::MessageRateCounter::SLOT_WIDTH - std::chrono::nanoseconds(1));
+    checks.check(within(rate, 1000.0, 0.02), "windowed rate counts only the last second");
+    
+    // Handler: every processed update lands in its exchange's histograms
+    trading::MarketDataHandler handler(4, 5);
+    handler.add_exchange("NYSE");
+    size_t callbacks = 0;
+    handler.subscribe("AAA", [&callbacks](const trading::MarketUpdate&) { ++callbacks; });
+    handler.subscribe("BBB", [](const trading::MarketUpdate&) {});
+    
+    std::vector<trading::MarketUpdate> updates;
+    for (int i = 0; i < 100; ++i) {
+        updates.push_back(trading::MarketUpdate{i % 2 == 0 ? "AAA" : "BBB", "NYSE", Price::from_double(100.0 + i * 0.01),
+                                                Price::from_double(100.5 + i * 0.01), 10, std::chrono::nanoseconds(i)});
+    }
+    handler.process_updates(std::span<const trading::MarketUpdate>(updates.data(), 64));
+    for (size_t i = 64; i < updates.size(); ++i) {
+        handler.process_update(updates[i]);
+    }
+    
+    auto metrics = handler.get_metrics();
+    const auto& latency = metrics.latency["NYSE"];
+    checks.check(latency.book_update.count == updates.size() && latency.callback.count == updates.size(),
+                 "book update and callback latency recorded per update");
+    checks.check(latency.book_update.p50_us <= latency.book_update.p99_us &&
+                 latency.book_update.p99_us <= latency.book_update.max_us && latency.book_update.max_us > 0.0,
+                 "percentiles ordered");
+    checks.check(metrics.throughput_mps["NYSE"] > 0.0 && metrics.avg_latency_us["NYSE"] > 0.0,
+                 "throughput and average latency reported");
+    
+    // More recording threads than cores: each gets its own shard, so no count is lost
+    trading::MarketDataHandler crowded(4, 5);
+    crowded.add_exchange("NYSE");
+    crowded.subscribe("AAA", [](const trading::MarketUpdate&) {});
+    const int WRITERS = 12;
+    const int UPDATES_PER_WRITER = 200;
+    std::vector<std::thread> writers;
+    for (int w = 0; w < WRITERS; ++w) {
+        writers.emplace_back([&crowded, &updates] {
+            for (int i = 0; i < UPDATES_PER_WRITER; ++i) {
+                crowded.process_update(updates[0]);
+            }
+        });
+    }
+    for (auto& writer : writers) {
+        writer.join();
+    }
+    auto crowded_metrics = crowded.get_metrics();
+    const double total = WRITERS * UPDATES_PER_WRITER;
+    // The rate window is between 0.9 and 1 s long, depending on where in its slot it ends
+    checks.check(crowded_metrics.latency["NYSE"].book_update.count == static_cast<uint64_t>(total) &&
+                 crowded_metrics.throughput_mps["NYSE"] >= total && crowded_metrics.throughput_mps["NYSE"] <= total / 0.9,
+                 "every thread's updates are counted (" + std::to_string(crowded_metrics.throughput_mps["NYSE"]) + "/s)");
+    
+    return checks.passed();
+}
+
+/**
+ * @brief Verify the asynchronous logger.
+ * 
+ * Records from several threads must all reach the sink, formatted and in
+ * per-thread order, once flush() returns. The runtime level must filter,
+ * and levels below TRADING_LOG_LEVEL must not even evaluate their
+ * arguments.
+ * 
+ * @return true if all checks passed
+ */
+bool verify_async_logging() {
+    std::cout << "\n=== CHECK: Asynchronous Logging ===\n" << std::endl;
+    
+    trading::Logger& logger = trading::Logger::instance();
+    logger.flush();
+    
+    std::mutex lines_mutex;
+    std::vector<std::string> lines;
+    logger.set_sink([&logger, &lines_mutex, &lines](trading::LogLevel, std::string_view line) {
+        if (line == "logtest flush from sink") {
+            logger.flush();  // Must not wait for the thread running the sink
+        }
+        std::lock_guard<std::mutex> lock(lines_mutex);
+        lines.emplace_back(line);
+    });
+    
+    const int THREADS = 3;
+    const int RECORDS_PER_THREAD = 200;
+    std::vector<std::thread> producers;
+    for (int t = 0; t < THREADS; ++t) {
+        producers.emplace_back([t] {
+            for (int i = 0; i < RECORDS_PER_THREAD; ++i) {
+                TRADING_LOG_INFO("logtest {} {} {} {}", t, i, 0.5, std::string("AAPL"));
+            }
+        });
+    }
+    for (auto& producer : producers) {
+        producer.join();
+    }
+    
+    logger.set_level(trading::LogLevel::WARN);
+    TRADING_LOG_INFO("logtest filtered");
+    logger.set_level(trading::LogLevel::INFO);
+    
+    const std::string long_path = "/tmp/" + std::string(trading::LogArg::STRING_CAPACITY, 'x') + ".bin";
+    TRADING_LOG_INFO("logtest path {}", std::string("/tmp/trading_checkpoint_test.bin"));
+    TRADING_LOG_INFO("logtest path {}", long_path);
+    
+    int evaluated = 0;
+    if constexpr (!trading::log_compiled_in(trading::LogLevel::TRACE)) {
+        TRADING_LOG_TRACE("logtest trace {}", ++evaluated);
+    }
+    
+    TRADING_LOG_INFO("logtest flush from sink");
+    logger.flush();
+    logger.set_sink(nullptr);
+    
+    CheckList checks;
+    
+    std::vector<int> next(THREADS, 0);
+    bool formatted = true;
+    bool ordered = true;
+    bool filtered = true;
+    size_t received = 0;
+    std::vector<std::string> paths;
+    bool sink_flushed = false;
+    for (const auto& line : lines) {
+        if (line.rfind("logtest", 0) != 0) {
+            continue;  // Lifecycle records from other components
+        }
+        if (line == "logtest flush from sink") {
+            sink_flushed = true;
+            continue;
+        }
+        if (line.rfind("logtest path ", 0) == 0) {
+            paths.push_back(line.substr(13));
+            continue;
+        }
+        if (line == "logtest filtered" || line.rfind("logtest trace", 0) == 0) {
+            filtered = false;
+            continue;
+        }
+        int t = -1;
+        int i = -1;
+        char symbol[8] = {};
+        if (std::sscanf(line.c_str(), "logtest %d %d 0.5 %7s", &t, &i, symbol) != 3 ||
+            t < 0 || t >= THREADS || std::string(symbol) != "AAPL") {
+            formatted = false;
+            continue;
+        }
+        ordered = ordered && i == next[t];
+        next[t] = i + 1;
+        ++received;
+    }
+    
+    checks.check(received + logger.dropped_records() == static_cast<size_t>(THREADS * RECORDS_PER_THREAD),
+                 "every record written or counted as dropped");
+    checks.check(formatted, "placeholders formatted");
+    checks.check(ordered, "records keep per-thread order");
+    checks.check(filtered, "runtime level filters records");
+    checks.check(evaluated == 0, "compiled-out levels skip argument evaluation");
+    checks.check(sink_flushed, "a sink may call flush() without deadlocking");
+    checks.check(paths.size() == 2 && paths[0] == "/tmp/trading_checkpoint_test.bin" &&
+                 paths[1].size() == trading::LogArg::STRING_CAPACITY - 1 &&
+                 paths[1].compare(paths[1].size() - 3, 3, "...") == 0 &&
+                 long_path.rfind(paths[1].substr(0, paths[1].size() - 3), 0) == 0,
+                 "paths fit whole, longer strings end in \"...\"");
+    
+    return checks.passed();
+}
+
+/**
+ * @brief Verify the instrumented locks.
+ * 
+ * Contention must only be counted when try_lock fails, the blocked time
+ * must be measured, and every exclusive hold must land in the hold-time
+ * histogram. The handler and thread pool must report their locks.
+ * 
+ * @return true if all checks passed
+ */
+bool verify_lock_instrumentation() {
+    std::cout << "\n=== CHECK: Lock Instrumentation ===\n" << std::endl;
+    
+    if constexpr (!trading::LOCK_INSTRUMENTATION) {
+        std::cout << "  (skipped: built with TRADING_LOCK_INSTRUMENTATION=0)" << std::endl;
+        return true;
+    }
+    
+    CheckList checks;
+    
+    trading::InstrumentedMutex uncontended;
+    for (int i = 0; i < 100; ++i) {
+        std::lock_guard<trading::InstrumentedMutex> lock(uncontended);
+    }
+    auto quiet = uncontended.stats().summarize("uncontended");
+    checks.check(quiet.acquisitions == 100 && quiet.contentions == 0 && quiet.wait_time_ns == 0,
+                 "uncontended acquisitions count no contention");
+    checks.check(quiet.hold_time.count == 100, "every exclusive hold recorded");
+    
+    // Hold the lock for 5 ms while a second thread blocks on it
+    trading::InstrumentedMutex contended;
+    std::atomic<bool> held{false};
+    std::thread holder([&contended, &held] {
+        std::lock_guard<trading::InstrumentedMutex> lock(contended);
+        held.store(true, std::memory_order_release);
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    });
+    while (!held.load(std::memory_order_acquire)) {
+        std::this_thread::yield();
+    }
+    {
+        std::lock_guard<trading::InstrumentedMutex> lock(contended);
+    }
+    holder.join();
+    bool acquired = contended.try_lock();
+    if (acquired) {
+        contended.unlock();
+    }
+    checks.check(acquired, "try_lock on a free lock succeeds");
+    auto busy = contended.stats().summarize("contended");
+    checks.check(busy.contentions == 1, "blocked acquisition counted as contention");
+    checks.check(busy.wait_time_ns >= 1000000, "blocked time measured");
+    checks.check(busy.hold_time.max_us >= 1000.0, "long hold shows in the hold-time distribution");
+    
+    trading::MarketDataHandler handler(4, 5);
+    handler.add_exchange("NYSE");
+    handler.subscribe("AAA", [](const trading::MarketUpdate&) {});
+    for (int i = 0; i < 10; ++i) {
+        handler.process_update(trading::MarketUpdate{"AAA", "NYSE", Price::from_double(100.0), Price::from_double(100.5), 10, std::chrono::nanoseconds(i)});
+    }
+    auto metrics = handler.get_metrics();
+    auto book_locks = std::find_if(metrics.locks.begin(), metrics.locks.end(),
+                                   [](const trading::LockStatsResult& lock) { return lock.name == "book_locks"; });
+    checks.check(book_locks != metrics.locks.end() && book_locks->acquisitions >= 10,
+                 "handler reports its book stripe locks");
+    
+    trading::ThreadPool pool(2, false);
+    pool.submit(0, [] { return 0; }).get();
+    checks.check(pool.queue_lock_stats().acquisitions > 0, "thread pool reports its queue lock");
+    
+    return checks.passed();
+}
+
+/**
+ * @brief Verify the lock-free book snapshots.
+ * 
+ * Snapshots and top_of_book() must match get_order_book(), and readers
+ * racing with a writer must never see a torn book.
+ * 
+ * @return true if all checks passed
+ */
+bool verify_book_snapshots() {
+    std::cout << "\n=== CHECK: Lock-Free Book Snapshots ===\n" << std::endl;
+    
+    CheckList checks;
+    
+    trading::MarketDataHandler handler(4, 5);
+    handler.add_exchange("NYSE");
+    handler.subscribe("AAA", [](const trading::MarketUpdate&) {});
+    handler.subscribe("BBB", [](const trading::MarketUpdate&) {});
+    trading::SymbolId aaa = handler.symbol_id("AAA");
+    trading::SymbolId bbb = handler.symbol_id("BBB");
+    
+    trading::BookSnapshot snapshot;
+    checks.check(handler.get_book_snapshot(bbb, snapshot) && snapshot.symbol_id == bbb && snapshot.rows() == 0,
+                 "subscribed book starts as an empty snapshot");
+    checks.check(!handler.get_book_snapshot(trading::SymbolId(3), snapshot) &&
+                 handler.top_of_book("ZZZ").symbol_id == trading::INVALID_SYMBOL_ID,
+                 "unknown symbols report no book");
+    
+    std::vector<trading::MarketUpdate> updates;
+    for (int i = 0; i < 8; ++i) {
+        updates.push_back(trading::MarketUpdate{"AAA", "NYSE", Price::from_double(100.0 - i * 0.5), Price::from_double(101.0 + i * 0.25), 10 + i,
+                                                std::chrono::nanoseconds(i)});
+    }
+    handler.process_updates(std::span<const trading::MarketUpdate>(updates.data(), 4));
+    for (size_t i = 4; i < updates.size(); ++i) {
+        handler.process_update(updates[i]);
+    }
+    
+    auto book = handler.get_order_book("AAA");
+    bool same = handler.get_book_snapshot(aaa, snapshot) && snapshot.bid_count == book.bids.size() &&
+                snapshot.ask_count == book.asks.size() && snapshot.timestamp == book.timestamp;
+    for (size_t i = 0; same && i < book.bids.size(); ++i) {
+        same = snapshot.bid(i).price == book.bids[i].price && snapshot.bid(i).volume == book.bids[i].volume;
+    }
+    for (size_t i = 0; same && i < book.asks.size(); ++i) {
+        same = snapshot.ask(i).price == book.asks[i].price && snapshot.ask(i).volume == book.asks[i].volume;
+    }
+    checks.check(same && snapshot.bid_count == 5, "snapshot matches get_order_book()");
+    
+    trading::TopOfBook top = handler.top_of_book("AAA");
+    checks.check(top.symbol_id == aaa && top.has_bid() && top.has_ask() && top.bid.price == Price::from_double(100.0) &&
+                 top.ask.price == Price::from_double(101.0) && top.timestamp == std::chrono::nanoseconds(7),
+                 "top_of_book() reads the best bid and ask");
+    
+    // One writer sets both sides and the timestamp to the same value per
+    // update; a torn read would show them disagreeing
+    std::atomic<bool> done{false};
+    std::atomic<uint64_t> torn{0};
+    std::atomic<uint64_t> reads{0};
+    std::vector<std::thread> readers;
+    for (int r = 0; r < 2; ++r) {
+        readers.emplace_back([&handler, &done, &torn, &reads, bbb, r] {
+            trading::BookSnapshot local;
+            while (!done.load(std::memory_order_acquire)) {
+                if (r == 0) {
+                    trading::TopOfBook top = handler.top_of_book(bbb);
+                    if (top.has_bid() && (top.bid.volume != top.ask.volume ||
+                                          top.timestamp.count() != top.bid.volume)) {
+                        torn.fetch_add(1, std::memory_order_relaxed);
+                    }
+                } else if (handler.get_book_snapshot(bbb, local) && local.bid_count > 0 &&
+                           (local.bid_count != 1 || local.ask_count != 1 ||
+                            local.bid(0).volume != local.ask(0).volume ||
+                            local.timestamp.count() != local.bid(0).volume)) {
+                    torn.fetch_add(1, std::memory_order_relaxed);
+                }
+                reads.fetch_add(1, std::memory_order_relaxed);
+            }
+        });
+    }
+    trading::ExchangeId nyse = handler.exchange_id("NYSE");
+    for (int v = 1; v <= 20000; ++v) {
+        handler.process_update(trading::MarketTick{bbb, nyse, Price::from_double(50.0), Price::from_double(50.5), v, std::chrono::nanoseconds(v)});
+    }
+    done.store(true, std::memory_order_release);
+    for (auto& reader : readers) {
+        reader.join();
+    }
+    checks.check(torn.load() == 0, "concurrent readers never see a torn snapshot (" +
+                                   std::to_string(reads.load()) + " reads)");
+    
+    return checks.passed();
+}
+
+/**
+ * @brief Verify ASYNC callback dispatch through per-symbol strands.
+ * 
+ * Callbacks of one symbol must run one at a time and in update order, off
+ * the updating thread, and a slow subscriber must not hold up updates.
+ * 
+ * @return true if all checks passed
+ */
+bool verify_async_callbacks() {
+    std::cout << "\n=== CHECK: Asynchronous Callback Strands ===\n" << std::endl;
+    
+    CheckList checks;
+    
+    trading::ThreadPool pool(3, false);
+    {
+        trading::MarketDataHandler no_pool(4, 5);
+        checks.check(!no_pool.subscribe("AAA", [](const trading::MarketUpdate&) {}, trading::CallbackDispatch::ASYNC),
+                     "ASYNC subscription needs a callback pool");
+    }
+    
+    trading::MarketDataHandler handler(8, 5);
+    checks.check(handler.set_callback_pool(pool) && !handler.set_callback_pool(pool), "callback pool is set once");
+    handler.add_exchange("NYSE");
+    
+    const std::vector<std::string> names = {"AAA", "BBB", "CCC", "DDD"};
+    const int UPDATES_PER_SYMBOL = 400;
+    std::vector<std::vector<int>> received(names.size());
+    std::vector<std::atomic<int>> active(names.size());
+    std::atomic<bool> overlapped{false};
+    std::atomic<bool> on_caller{false};
+    std::thread::id caller = std::this_thread::get_id();
+    for (size_t s = 0; s < names.size(); ++s) {
+        handler.subscribe_ticks(names[s], [&, s](const trading::MarketTick& tick) {
+            if (active[s].fetch_add(1) != 0) {
+                overlapped = true;
+            }
+            if (std::this_thread::get_id() == caller) {
+                on_caller = true;
+            }
+            received[s].push_back(tick.volume);
+            active[s].fetch_sub(1);
+        }, trading::CallbackDispatch::ASYNC);
+    }
+    size_t inline_calls = 0;
+    handler.subscribe("EEE", [&](const trading::MarketUpdate&) {
+        inline_calls += std::this_thread::get_id() == caller ? 1 : 0;
+    });
+    
+    // Interleave the symbols, half through single updates and half in batches
+    std::vector<trading::MarketUpdate> updates;
+    for (int v = 1; v <= UPDATES_PER_SYMBOL; ++v) {
+        for (const auto& name : names) {
+            updates.push_back(trading::MarketUpdate{name, "NYSE", Price::from_double(100.0), Price::from_double(100.5), v, std::chrono::nanoseconds(v)});
+        }
+        updates.push_back(trading::MarketUpdate{"EEE", "NYSE", Price::from_double(100.0), Price::from_double(100.5), v, std::chrono::nanoseconds(v)});
+    }
+    size_t half = updates.size() / 2;
+    for (size_t i = 0; i < half; ++i) {
+        handler.process_update(updates[i]);
+    }
+    for (size_t i = half; i < updates.size(); i += 50) {
+        size_t count = std::min<size_t>(50, updates.size() - i);
+        handler.process_updates(std::span<const trading::MarketUpdate>(updates.data() + i, count));
+    }
+    handler.flush_callbacks();
+    
+    bool in_order = true;
+    for (const auto& symbol_updates : received) {
+        in_order = in_order && symbol_updates.size() == static_cast<size_t>(UPDATES_PER_SYMBOL);
+        for (size_t i = 0; in_order && i < symbol_updates.size(); ++i) {
+            in_order = symbol_updates[i] == static_cast<int>(i) + 1;
+        }
+    }
+    checks.check(in_order, "every ASYNC callback runs, in update order per symbol");
+    checks.check(!overlapped.load(), "a symbol's callbacks never run concurrently");
+    checks.check(!on_caller.load(), "ASYNC callbacks run on the pool, not the updating thread");
+    checks.check(inline_calls == static_cast<size_t>(UPDATES_PER_SYMBOL), "INLINE callbacks still run on the caller");
+    checks.check(handler.get_metrics().total_callbacks_dropped == 0, "no callbacks dropped");
+    
+    // A subscriber that takes 1 ms per update must not slow the updates down
+    std::atomic<int> slow_calls{0};
+    handler.subscribe("SLOW", [&slow_calls](const trading::MarketUpdate&) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        slow_calls.fetch_add(1);
+    }, trading::CallbackDispatch::ASYNC);
+    const int SLOW_UPDATES = 50;
+    auto start = std::chrono::steady_clock::now();
+    for (int v = 1; v <= SLOW_UPDATES; ++v) {
+        handler.process_update(trading::MarketUpdate{"SLOW", "NYSE", Price::from_double(10.0), Price::from_double(10.5), v, std::chrono::nanoseconds(v)});
+    }
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    handler.flush_callbacks();
+    checks.check(elapsed < std::chrono::milliseconds(SLOW_UPDATES / 2) && slow_calls.load() == SLOW_UPDATES,
+                 "slow ASYNC subscriber does not stall the update thread");
+    
+    return checks.passed();
+}
+
+/**
+ * @brief Verify CONFLATED callback delivery.
+ * 
+ * While a conflated subscriber is busy, further updates of its symbol
+ * must collapse into the latest one and be counted; symbols that did not
+ * change must not be delivered again, and other subscriptions must still
+ * see every update.
+ * 
+ * @return true if all checks passed
+ */
+bool verify_conflation() {
+    std::cout << "\n=== CHECK: Conflated Delivery ===\n" << std::endl;
+    
+    CheckList checks;
+    
+    trading::ThreadPool pool(2, false);
+    trading::MarketDataHandler handler(8, 5);
+    handler.set_callback_pool(pool);
+    handler.add_exchange("NYSE");
+    
+    // The first AAA delivery blocks until released, so the updates behind it pile up
+    std::atomic<bool> started{false};
+    std::atomic<bool> release{false};
+    std::vector<int> aaa;
+    handler.subscribe_ticks("AAA", [&](const trading::MarketTick& tick) {
+        aaa.push_back(tick.volume);
+        if (aaa.size() == 1) {
+            started.store(true);
+            while (!release.load()) {
+                std::this_thread::yield();
+            }
+        }
+    }, trading::CallbackDispatch::CONFLATED);
+    std::atomic<int> bbb_calls{0};
+    handler.subscribe_ticks("BBB", [&bbb_calls](const trading::MarketTick&) { bbb_calls.fetch_add(1); },
+                            trading::CallbackDispatch::CONFLATED);
+    size_t ccc_calls = 0;
+    handler.subscribe_ticks("CCC", [&ccc_calls](const trading::MarketTick&) { ++ccc_calls; });
+    
+    auto update = [](const std::string& symbol, int volume) {
+        return trading::MarketUpdate{symbol, "NYSE", Price::from_double(100.0), Price::from_double(100.5), volume, std::chrono::nanoseconds(volume)};
+    };
+    handler.process_update(update("BBB", 1));
+    handler.process_update(update("AAA", 1));
+    while (!started.load()) {
+        std::this_thread::yield();
+    }
+    
+    const int BURST = 1000;
+    for (int v = 2; v <= BURST; ++v) {
+        handler.process_update(update("AAA", v));
+        handler.process_update(update("CCC", v));
+    }
+    release.store(true);
+    handler.flush_callbacks();
+    
+    auto metrics = handler.get_metrics();
+    checks.check(aaa.size() == 2 && aaa.back() == BURST, "burst collapses into the latest update");
+    checks.check(metrics.total_updates_conflated == static_cast<uint64_t>(BURST - 2),
+                 "conflated updates counted (" + std::to_string(metrics.total_updates_conflated) + ")");
+    checks.check(bbb_calls.load() == 1, "unchanged symbols are not delivered again");
+    checks.check(ccc_calls == static_cast<size_t>(BURST - 1), "INLINE subscriptions still see every update");
+    
+    // A batch delivers only each conflated symbol's last update
+    std::vector<trading::MarketUpdate> batch;
+    for (int v = 1; v <= 100; ++v) {
+        batch.push_back(update("BBB", v));
+    }
+    handler.process_updates(std::span<const trading::MarketUpdate>(batch));
+    handler.flush_callbacks();
+    checks.check(bbb_calls.load() == 2 && handler.get_metrics().total_updates_conflated == static_cast<uint64_t>(BURST - 2 + 99),
+                 "batched updates conflate within the batch");
+    
+    return checks.passed();
+}
+
+/**
+ * @brief Verify the binary wire format and its zero-copy decoder.
+ * 
+ * Encoded updates must decode to the same fields from unaligned buffers,
+ * unknown message types must be skipped, truncated and malformed input
+ * must be reported, and the handler must accept views and whole buffers.
+ * 
+ * @return true if all checks passed
+ */
+bool verify_wire_format() {
+    std::cout << "\n=== CHECK: Binary Wire Format ===\n" << std::endl;
+    
+    CheckList checks;
+    
+    trading::MarketDataHandler handler(4, 5);
+    handler.add_exchange("NYSE");
+    handler.subscribe("AAA", [](const trading::MarketUpdate&) {});
+    trading::SymbolId aaa = handler.symbol_id("AAA");
+    trading::ExchangeId nyse = handler.exchange_id("NYSE");
+    
+    // Start one byte in, so every field is misaligned
+    std::vector<std::byte> buffer(1 + 4 * trading::WireLayout::MARKET_UPDATE_SIZE + 8);
+    std::span<std::byte> out(buffer.data() + 1, buffer.size() - 1);
+    size_t written = 0;
+    for (int i = 0; i < 3; ++i) {
+        trading::MarketTick tick{aaa, nyse, Price::from_double(100.25 - i * 0.01), Price::from_double(100.26 + i * 0.01), 100 + i,
+                                 std::chrono::nanoseconds(1700000000000000000LL + i)};
+        written += trading::encode_market_update(tick, 10 + i, out.subspan(written));
+    }
+    checks.check(written == 3 * trading::WireLayout::MARKET_UPDATE_SIZE &&
+                 trading::encode_market_update(trading::MarketTick{}, 0, out.subspan(0, 47)) == 0,
+                 "fixed 48-byte messages, short buffers rejected");
+    
+    // An unknown message type followed by a 4th update cut off mid-message
+    std::byte* unknown = out.data() + written;
+    trading::store_little_endian<uint16_t>(unknown, 8);
+    unknown[2] = std::byte{trading::WIRE_VERSION};
+    unknown[3] = std::byte{0x7F};
+    written += 8;
+    trading::MarketTick last{aaa, nyse, Price::from_double(99.5), Price::from_double(100.5), 7, std::chrono::nanoseconds(5)};
+    trading::encode_market_update(last, 13, out.subspan(written));
+    std::span<const std::byte> received(out.data(), written + 20);
+    
+    trading::WireDecoder decoder(received);
+    trading::MarketUpdateView view;
+    std::vector<trading::MarketUpdateView> views;
+    trading::WireDecoder::Status status;
+    while ((status = decoder.next(view)) == trading::WireDecoder::Status::OK) {
+        views.push_back(view);
+    }
+    checks.check(views.size() == 3 && status == trading::WireDecoder::Status::END &&
+                 decoder.consumed() == written, "unknown types skipped, partial tail left unconsumed");
+    checks.check(views.size() == 3 && views[1].symbol_id() == aaa && views[1].exchange_id() == nyse &&
+                 views[1].bid_price() == Price::from_double(100.24) && views[1].ask_price() == Price::from_double(100.27) && views[1].volume() == 101 &&
+                 views[1].timestamp().count() == 1700000000000000001LL && views[1].sequence() == 11 &&
+                 views[1].bid_price_raw() == 10024000000LL,
+                 "views decode every field in place");
+    checks.check(views.size() == 3 && views[0].data() == out.data(), "views point into the receive buffer");
+    
+    std::vector<std::byte> bad(out.begin(), out.begin() + trading::WireLayout::MARKET_UPDATE_SIZE);
+    bad[trading::WireLayout::VERSION] = std::byte{trading::WIRE_VERSION + 1};
+    trading::WireDecoder bad_decoder(bad);
+    checks.check(bad_decoder.next(view) == trading::WireDecoder::Status::MALFORMED, "unknown versions rejected");
+    
+    // Handler: one view, then a whole buffer in one batch
+    handler.process_update(views[0]);
+    auto book = handler.get_order_book(aaa);
+    checks.check(book.bids.size() == 1 && book.bids[0].price == Price::from_double(100.25) && book.bids[0].volume == 100,
+                 "process_update() accepts a view");
+    size_t consumed = handler.process_messages(received);
+    book = handler.get_order_book(aaa);
+    checks.check(consumed == written && book.bids.size() == 3 && book.timestamp.count() == 1700000000000000002LL &&
+                 handler.get_metrics().total_updates_processed == 4,
+                 "process_messages() applies every complete message");
+    
+    return checks.passed();
+}
+
+/**
+ * @brief Verify capture files and their replay.
+ */
+bool verify_capture_replay() {
+    std::cout << "\n=== CHECK: Capture and Replay ===\n" << std::endl;
+    
+    CheckList checks;
+    
+    const std::vector<std::string> symbols = {"AAA", "BBB", "CCC", "DDD"};
+    const int TICKS = 400;
+    const std::string path = (std::filesystem::temp_directory_path() / "trading_capture_test.bin").string();
+    
+    // Same subscriptions in the same order, so symbol and exchange IDs match the capture's
+    auto make_handler = [&symbols](std::unique_ptr<trading::FeedSource> feed) {
+        auto handler = std::make_unique<trading::MarketDataHandler>(8);
+        handler->add_exchange("SIM", std::move(feed));
+        for (const auto& symbol : symbols) {
+            handler->subscribe(symbol, [](const trading::MarketUpdate&) {});
+        }
+        return handler;
+    };
+    auto same_level = [](const trading::OrderBookEntry& x, const trading::OrderBookEntry& y) {
+        return x.price == y.price && x.volume == y.volume;
+    };
+    auto same_books = [&symbols, &same_level](trading::MarketDataHandler& a, trading::MarketDataHandler& b) {
+        for (const auto& symbol : symbols) {
+            auto x = a.get_order_book(symbol);
+            auto y = b.get_order_book(symbol);
+            if (x.bids.size() != y.bids.size() || x.asks.size() != y.asks.size() || x.timestamp != y.timestamp) {
+                return false;
+            }
+            for (size_t i = 0; i < x.bids.size(); ++i) {
+                if (!same_level(x.bids[i], y.bids[i])) {
+                    return false;
+                }
+            }
+            for (size_t i = 0; i < x.asks.size(); ++i) {
+                if (!same_level(x.asks[i], y.asks[i])) {
+                    return false;
+                }
+            }
+        }
+        return true;
+    };
+    
+    // Record a live feed, with a few pauses so the capture has gaps to replay
+    auto feed = std::make_unique<trading::QueueFeedSource>(8192);
+    trading::QueueFeedSource* source = feed.get();
+    auto live = make_handler(std::move(feed));
+    {
+        trading::CaptureWriter writer(path, 4096);
+        checks.check(live->set_capture(&writer), "capture attached while stopped");
+        live->start(1);
+        checks.check(!live->set_capture(nullptr), "capture can't change while running");
+        
+        for (int i = 0; i < TICKS; ++i) {
+            trading::MarketTick tick{};
+            tick.symbol_id = live->symbol_id(symbols[i % symbols.size()]);
+            tick.bid_price = Price::from_double(100.0 + (i % 7) * 0.01);
+            tick.ask_price = Price::from_double(100.1 + (i % 5) * 0.01);
+            tick.volume = 100 + i;
+            tick.timestamp = std::chrono::nanoseconds(1000 + i);
+            while (!source->publish(tick)) {
+                std::this_thread::yield();
+            }
+            if (i % 100 == 99) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(3));
+            }
+        }
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+        while (live->get_metrics().total_updates_processed < static_cast<uint64_t>(TICKS) &&
+               std::chrono::steady_clock::now() < deadline) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        live->stop();
+        checks.check(writer.records() == static_cast<uint64_t>(TICKS) && !writer.failed(),
+                     "every received update recorded");
+    }
+    
+    bool replayed = false;
+    try {
+        trading::CaptureReader capture(path);
+        size_t cursor = capture.begin();
+        trading::CaptureReader::Record record;
+        uint64_t expected_sequence = 0;
+        bool ordered = true;
+        std::chrono::nanoseconds previous{0};
+        while (capture.next(cursor, record)) {
+            ordered = ordered && record.update.sequence() == expected_sequence++ &&
+                      record.offset >= previous && record.update.exchange_id() == live->exchange_id("SIM");
+            previous = record.offset;
+        }
+        checks.check(capture.record_count() == static_cast<size_t>(TICKS) && expected_sequence == TICKS && ordered,
+                     "records read back in order with sequence numbers and exchange IDs");
+        checks.check(capture.duration() >= std::chrono::milliseconds(9), "receive times keep the feed's gaps");
+        
+        trading::CaptureReplayer replayer(capture);
+        
+        auto flat = make_handler(nullptr);
+        auto result = replayer.run(*flat);
+        checks.check(result.updates == static_cast<uint64_t>(TICKS) && same_books(*live, *flat),
+                     "flat-out replay rebuilds the recorded books");
+        
+        trading::ReplayOptions options;
+        options.threads = 2;
+        auto parallel = make_handler(nullptr);
+        result = replayer.run(*parallel, options);
+        checks.check(result.updates == static_cast<uint64_t>(TICKS) && same_books(*live, *parallel),
+                     "two replay threads keep each symbol in order");
+        
+        options.threads = 1;
+        options.speed = 1.0;
+        auto recorded = make_handler(nullptr);
+        auto recorded_result = replayer.run(*recorded, options);
+        options.speed = 4.0;
+        auto fast = make_handler(nullptr);
+        auto fast_result = replayer.run(*fast, options);
+        std::cout << "  Captured " << capture.duration().count() / 1000 << " us, replayed in "
+                  << recorded_result.elapsed.count() / 1000 << " us at 1x and "
+                  << fast_result.elapsed.count() / 1000 << " us at 4x" << std::endl;
+        checks.check(recorded_result.elapsed >= capture.duration() && same_books(*live, *recorded),
+                     "recorded pace takes as long as the capture");
+        checks.check(fast_result.elapsed >= capture.duration() / 4 && fast_result.elapsed < recorded_result.elapsed,
+                     "4x speed replays faster, but no faster than a quarter of the capture");
+        
+        options.speed = 1.0;
+        options.preserve_jitter = false;
+        auto even = make_handler(nullptr);
+        auto even_result = replayer.run(*even, options);
+        checks.check(even_result.elapsed >= capture.duration() && same_books(*live, *even),
+                     "evenly spaced replay spans the same duration");
+        replayed = true;
+    } catch (const std::exception& e) {
+        std::cout << "  Replay failed: " << e.what() << std::endl;
+    }
+    checks.check(replayed, "capture mapped and replayed");
+    
+    // A crash mid-write leaves a partial record; reading stops before it
+    std::filesystem::resize_file(path, std::filesystem::file_size(path) - 10);
+    try {
+        trading::CaptureReader truncated(path);
+        checks.check(truncated.record_count() == static_cast<size_t>(TICKS - 1), "truncated tail ignored");
+    } catch (const std::exception&) {
+        checks.check(false, "truncated tail ignored");
+    }
+    
+    {
+        std::FILE* file = std::fopen(path.c_str(), "r+b");
+        std::fputc('X', file);
+        std::fclose(file);
+    }
+    bool rejected = false;
+    try {
+        trading::CaptureReader corrupt(path);
+    } catch (const std::runtime_error&) {
+        rejected = true;
+    }
+    checks.check(rejected, "files without a capture header rejected");
+    
+    std::filesystem::remove(path);
+    return checks.passed();
+}
+
+/**
+ * @brief Verify fixed-point prices and per-symbol tick sizes.
+ */
+bool verify_fixed_point_prices() {
+    std::cout << "\n=== CHECK: Fixed-Point Prices ===\n" << std::endl;
+    
+    CheckList checks;
+    
+    checks.check(Price::from_double(0.1 + 0.2) == Price::from_double(0.3) &&
+                 Price::from_double(100.10) - Price::from_double(100.00) == Price::from_raw(PRICE_SCALE / 10),
+                 "prices that differ in the last bit of a double are equal");
+    checks.check(sizeof(OrderBookEntry) == 16 && Price::from_double(99.99) < Price::from_double(100.0),
+                 "book levels are an 8-byte integer price plus volume");
+    
+    trading::MarketDataHandler handler(4, 5);
+    handler.subscribe("AAA", [](const trading::MarketUpdate&) {});
+    trading::SymbolId aaa = handler.symbol_id("AAA");
+    
+    checks.check(!handler.set_tick_size("ZZZ", Price::from_double(0.05)) &&
+                 !handler.set_tick_size("AAA", Price()) && handler.tick_size(aaa) == DEFAULT_TICK_SIZE,
+                 "tick size rejected for unknown symbols and non-positive ticks");
+    checks.check(handler.set_tick_size("AAA", Price::from_double(0.05)) &&
+                 handler.to_price(aaa, 100.07) == Price::from_double(100.05) &&
+                 handler.to_price(aaa, 100.08) == Price::from_double(100.10),
+                 "to_price() rounds onto the symbol's tick grid");
+    
+    // Two feeds quoting the same level, one with floating-point noise
+    handler.process_update(trading::MarketTick{aaa, 0, handler.to_price(aaa, 100.1), handler.to_price(aaa, 100.2),
+                                               10, std::chrono::nanoseconds(1)});
+    handler.process_update(trading::MarketTick{aaa, 0, handler.to_price(aaa, 100.10000000000001),
+                                               handler.to_price(aaa, 100.19999999999999), 20,
+                                               std::chrono::nanoseconds(2)});
+    auto book = handler.get_order_book(aaa);
+    checks.check(book.bids.size() == 1 && book.bids[0].volume == 20 && book.asks.size() == 1 &&
+                 book.bids[0].price.to_double() == 100.1,
+                 "noisy quotes of one level update it instead of adding a level");
+    
+    std::byte wire[trading::WireLayout::MARKET_UPDATE_SIZE];
+    trading::MarketTick tick{aaa, 0, Price::from_raw(10012345678LL), Price::from_raw(10012345679LL), 1,
+                             std::chrono::nanoseconds(3)};
+    trading::encode_market_update(tick, 0, wire);
+    trading::MarketUpdateView view(wire);
+    checks.check(view.bid_price() == tick.bid_price && view.ask_price_raw() == tick.ask_price.raw(),
+                 "wire prices are the raw fixed-point value");
+    
+    return checks.passed();
+}
+
+/**
+ * @brief Verify the Week 1 sorting kernels against std::sort and std::stable_sort.
+ */
+bool verify_sorting_kernels() {
+    std::cout << "\n=== CHECK: Sorting Kernels ===\n" << std::endl;
+    
+    CheckList checks;
+    
+    struct Quote {
+        int64_t price;
+        int64_t timestamp;
+        bool operator==(const Quote&) const = default;
+    };
+    auto by_price = [](const Quote& a, const Quote& b) { return a.price < b.price; };
+    auto by_price_time = [](const Quote& a, const Quote& b) {
+        return a.price != b.price ? a.price < b.price : a.timestamp < b.timestamp;
+    };
+    
+    // Shapes that break naive quicksorts: sorted, reversed, few distinct keys, organ pipe
+    std::mt19937 rng(7);
+    std::vector<std::pair<std::string, std::vector<Quote>>> datasets;
+    auto make = [&](const std::string& name, size_t size, auto price_of) {
+        std::vector<Quote> data(size);
+        for (size_t i = 0; i < size; ++i) {
+            data[i] = Quote{price_of(i), static_cast<int64_t>(rng() % 1000000)};
+        }
+        datasets.emplace_back(name, std::move(data));
+    };
+    const size_t N = 50000;
+    make("random", N, [&](size_t) { return static_cast<int64_t>(rng() % 100000) - 50000; });
+    make("sorted", N, [](size_t i) { return static_cast<int64_t>(i); });
+    make("reversed", N, [](size_t i) { return static_cast<int64_t>(N - i); });
+    make("few keys", N, [&](size_t) { return static_cast<int64_t>(rng() % 4); });
+    make("organ pipe", N, [](size_t i) { return static_cast<int64_t>(i < N / 2 ? i : N - i); });
+    make("70% sorted", N, [&](size_t i) { return i < N * 7 / 10 ? static_cast<int64_t>(i) : static_cast<int64_t>(rng() % N); });
+    make("tiny", 5, [&](size_t) { return static_cast<int64_t>(rng() % 10); });
+    
+    ThreadPool pool(4);
+    bool introsort_ok = true, merge_ok = true, radix_ok = true, parallel_ok = true;
+    std::vector<Quote> scratch;
+    for (const auto& [name, data] : datasets) {
+        auto expected = data;
+        std::sort(expected.begin(), expected.end(), by_price_time);
+        auto stable = data;
+        std::stable_sort(stable.begin(), stable.end(), by_price);
+        
+        auto sorted = data;
+        week1::introsort(sorted.begin(), sorted.end(), by_price_time);
+        bool this_ok = sorted == expected;
+        
+        sorted = data;
+        week1::merge_sort(sorted.begin(), sorted.end(), by_price, scratch);
+        bool merge_this = sorted == stable;
+        
+        // Stable LSD: secondary key first, then primary
+        sorted = data;
+        week1::radix_sort(sorted.begin(), sorted.end(), [](const Quote& q) { return week1::radix_key(q.timestamp); }, scratch);
+        week1::radix_sort(sorted.begin(), sorted.end(), [](const Quote& q) { return week1::radix_key(q.price); }, scratch);
+        bool radix_this = sorted == expected;
+        
+        sorted = data;
+        week1::parallel_sort(pool, sorted.begin(), sorted.end(), by_price_time);
+        bool parallel_this = sorted == expected;
+        
+        if (!(this_ok && merge_this && radix_this && parallel_this)) {
+            std::cout << "  Mismatch on " << name << " data" << std::endl;
+        }
+        introsort_ok = introsort_ok && this_ok;
+        merge_ok = merge_ok && merge_this;
+        radix_ok = radix_ok && radix_this;
+        parallel_ok = parallel_ok && parallel_this;
+    }
+    checks.check(introsort_ok, "introsort matches std::sort on every input shape");
+    checks.check(merge_ok, "merge_sort is stable and reuses one scratch buffer");
+    checks.check(radix_ok, "two stable radix passes order by price, then timestamp");
+    checks.check(parallel_ok, "parallel_sort matches std::sort");
+    
+    // Large enough to actually split across the pool
+    std::vector<int64_t> big(week1::PARALLEL_SORT_MIN_CHUNK * 8 + 3);
+    for (auto& value : big) {
+        value = static_cast<int64_t>(rng());
+    }
+    auto big_expected = big;
+    std::sort(big_expected.begin(), big_expected.end());
+    std::thread::id caller = std::this_thread::get_id();
+    std::atomic<bool> on_pool(false);
+    week1::parallel_sort(pool, big.begin(), big.end(), [caller, &on_pool](int64_t a, int64_t b) {
+        if (std::this_thread::get_id() != caller) {
+            on_pool.store(true, std::memory_order_relaxed);
+        }
+        return a < b;
+    });
+    checks.check(big == big_expected && on_pool.load(), "parallel_sort splits large ranges across the pool");
+    
+    return checks.passed();
+}
+
+/**
+ * @brief Verify the SIMD level search against a brute-force walk of the same levels.
+ */
+bool verify_level_search() {
+    std::cout << "\n=== CHECK: Level Search (" << LEVEL_SEARCH_ISA << ") ===\n" << std::endl;
+    
+    CheckList checks;
+    
+    // Random inserts and deletes on a narrow grid, so levels fill, collide and drop out
+    PriceLevelBook book(MAX_BOOK_DEPTH);
+    std::mt19937 rng(11);
+    const Price tick = Price::from_raw(PRICE_SCALE / 100);
+    bool find_ok = true, volume_ok = true, sorted_ok = true;
+    for (int step = 0; step < 20000; ++step) {
+        Price price = Price::from_double(100.0) + tick * static_cast<int64_t>(rng() % 80) - tick * 40;
+        int volume = rng() % 4 == 0 ? 0 : static_cast<int>(1 + rng() % 1000);
+        book.bids.apply(price, volume);
+        book.asks.apply(price, volume);
+    
+        Price query = Price::from_double(100.0) + tick * static_cast<int64_t>(rng() % 84) - tick * 42;
+        size_t bid_at = book.bids.size(), ask_at = book.asks.size();
+        int64_t bid_through = 0, ask_through = 0;
+        for (size_t i = 0; i < book.bids.size(); ++i) {
+            bid_at = book.bids.price(i) == query ? i : bid_at;
+            bid_through += book.bids.price(i) >= query ? book.bids.volume(i) : 0;
+            sorted_ok = sorted_ok && (i == 0 || book.bids.price(i - 1) > book.bids.price(i));
+        }
+        for (size_t i = 0; i < book.asks.size(); ++i) {
+            ask_at = book.asks.price(i) == query ? i : ask_at;
+            ask_through += book.asks.price(i) <= query ? book.asks.volume(i) : 0;
+            sorted_ok = sorted_ok && (i == 0 || book.asks.price(i - 1) < book.asks.price(i));
+        }
+        find_ok = find_ok && book.bids.find(query) == bid_at && book.asks.find(query) == ask_at;
+        volume_ok = volume_ok && book.bids.volume_through(query) == bid_through &&
+                    book.asks.volume_through(query) == ask_through;
+    }
+    checks.check(sorted_ok, "levels stay strictly sorted through inserts, deletes and drop-outs");
+    checks.check(find_ok, "find() matches a linear scan");
+    checks.check(volume_ok, "volume_through() matches a linear sum");
+    checks.check(book.bids.volume_through(Price::from_raw(std::numeric_limits<int64_t>::min())) ==
+                     book.bids.total_volume(MAX_BOOK_DEPTH),
+                 "volume_through() at the extreme price covers the whole side");
+    
+    // 200 @ 100.00 + 100 @ 99.97 against 100 @ 100.03 + 300 @ 100.07
+    PriceLevelBook small(5);
+    small.bids.apply(Price::from_double(100.00), 200);
+    small.bids.apply(Price::from_double(99.97), 100);
+    small.asks.apply(Price::from_double(100.03), 100);
+    small.asks.apply(Price::from_double(100.07), 300);
+    double bid_vwap = (100.00 * 200 + 99.97 * 100) / 300;
+    double ask_vwap = (100.03 * 100 + 100.07 * 300) / 400;
+    checks.check(std::abs(small.bids.vwap(5) - bid_vwap) < 1e-9 && std::abs(small.asks.vwap(1) - 100.03) < 1e-9,
+                 "vwap() over the best levels");
+    checks.check(std::abs(small.depth_weighted_mid(5) - (bid_vwap * 400 + ask_vwap * 300) / 700) < 1e-9,
+                 "depth_weighted_mid() weights each side by the other's depth");
+    small.asks.clear();
+    checks.check(small.depth_weighted_mid(5) == 0.0 && small.asks.find(Price::from_double(100.03)) == 0,
+                 "depth_weighted_mid() of a one-sided book is 0");
+    
+    return checks.passed();
+}
+
+/**
+ * @brief Verify the benchmark harness's repetition accounting and its JSON/CSV output.
+ */
+bool verify_benchmark_harness() {
+    std::cout << "\n=== CHECK: Benchmark Harness ===\n" << std::endl;
+    
+    CheckList checks;
+    
+    BenchmarkOptions options;
+    options.warmup = 2;
+    options.repetitions = 3;
+    BenchmarkHarness harness(options);
+    
+    int calls = 0;
+    const BenchmarkResult& result = harness.run("check", "samples", "a=1,b=\"2\"", [&](BenchmarkRun& run) {
+        ++calls;
+        run.start_timer();
+        for (uint64_t i = 1; i <= 100; ++i) {
+            run.record(i);
+        }
+        run.stop_timer();
+        return uint64_t{100 + static_cast<uint64_t>(calls)};
+    });
+    checks.check(calls == 5 && result.repetitions == 3, "warmup runs are discarded before the measured ones");
+    checks.check(result.operations == 104 && result.latency.count == 300, "operations are the median, samples of every repetition are kept");
+    checks.check(result.throughput_min <= result.throughput_median && result.throughput_median <= result.throughput_max &&
+                 result.throughput_min > 0.0, "throughput spread is ordered");
+    checks.check(result.latency.p50_us <= result.latency.p99_us && result.latency.p99_us <= result.latency.max_us,
+                 "latency percentiles are ordered");
+    
+    std::ostringstream json, csv;
+    harness.write_json(json);
+    harness.write_csv(csv);
+    checks.check(json.str().find("\"name\": \"samples\"") != std::string::npos &&
+                 json.str().find("\"params\": \"a=1,b=\\\"2\\\"\"") != std::string::npos &&
+                 json.str().find("\"p999\": ") != std::string::npos, "JSON has the result with its params escaped");
+    std::string rows = csv.str();
+    checks.check(std::count(rows.begin(), rows.end(), '\n') == 2 &&
+                 rows.find("check,samples,\"a=1,b=\"\"2\"\"\",3,104,") != std::string::npos,
+                 "CSV has a header and one quoted row");
+    
+    return checks.passed();
+}
+
+/**
+ * @brief Verify the order-level book: FIFO priority, O(1) operations and the L2 view it maintains.
+ */
+bool verify_order_level_book() {
+    std::cout << "\n=== CHECK: Order-Level Book ===\n" << std::endl;
+    
+    CheckList checks;
+    auto px = [](double price) { return Price::from_double(price); };
+    const std::chrono::nanoseconds t0(1000);
+    
+    week2::OrderBookAllocator pool(4096, OrderLevelBook::NODE_SIZE);
+    {
+        PriceLevelBook l2(3);
+        OrderLevelBook book(pool, &l2);
+        book.add(1, Side::BID, px(100.00), 100, t0);
+        book.add(2, Side::BID, px(100.00), 50, t0 + std::chrono::nanoseconds(1));
+        book.add(3, Side::BID, px(99.99), 70, t0);
+        book.add(4, Side::BID, px(99.98), 20, t0);
+        book.add(5, Side::BID, px(99.97), 10, t0);
+        book.add(6, Side::ASK, px(100.02), 40, t0);
+        const OrderLevel* top = book.best(Side::BID);
+        checks.check(top != nullptr && top->price == px(100.00) && top->volume == 150 && top->order_count == 2 &&
+                     top->head->id == 1 && top->tail->id == 2, "orders at one price queue oldest first");
+        checks.check(l2.bids.size() == 3 && l2.bids[0].volume == 150 && l2.bids[2].price == px(99.98) &&
+                     l2.asks.size() == 1 && l2.asks[0].volume == 40, "L2 book follows the order book to its depth");
+        checks.check(!book.add(1, Side::ASK, px(101.00), 10, t0) && !book.cancel(99) && !book.execute(99, 1),
+                     "duplicate IDs and unknown orders are rejected");
+        
+        book.execute(1, 40);
+        book.modify(1, px(100.00), 30, t0 + std::chrono::nanoseconds(5));
+        checks.check(top->head->id == 1 && top->volume == 80 && book.find(1)->quantity == 30,
+                     "partial fills and size-downs keep priority");
+        book.modify(1, px(100.00), 90, t0 + std::chrono::nanoseconds(6));
+        checks.check(top->head->id == 2 && top->tail->id == 1 && l2.bids[0].volume == 140,
+                     "a size-up moves the order to the back of its level");
+        
+        book.cancel(3);
+        checks.check(book.level(Side::BID, px(99.99)) == nullptr && l2.bids.size() == 3 &&
+                     l2.bids[1].price == px(99.98) && l2.bids[2].price == px(99.97),
+                     "an emptied level is removed and the next one moves up into the L2 depth");
+        book.modify(4, px(100.01), 20, t0);
+        book.execute(2, 50);
+        checks.check(book.best(Side::BID)->price == px(100.01) && book.best(Side::BID)->head->id == 4 &&
+                     l2.bids[0].price == px(100.01) && l2.bids[1].volume == 90 && book.order_count() == 4,
+                     "price modifies requeue at the new level, full fills remove the order");
+        
+        // Random adds, modifies, fills and cancels against a brute-force model
+        std::mt19937 rng(23);
+        struct Resting { Side side; Price price; int quantity; };
+        std::map<OrderId, Resting> model;
+        for (const auto& [id, side] : {std::pair{1, Side::BID}, {2, Side::BID}, {4, Side::BID},
+                                       {5, Side::BID}, {6, Side::ASK}}) {
+            if (const OrderNode* order = book.find(static_cast<OrderId>(id))) {
+                model[order->id] = Resting{side, order->price, order->quantity};
+            }
+        }
+        OrderId next_id = 100;
+        bool model_ok = true;
+        for (int step = 0; step < 20000 && model_ok; ++step) {
+            int op = static_cast<int>(rng() % 4);
+            Price price = px(100.0) + Price::from_raw(PRICE_SCALE / 100) * static_cast<int64_t>(rng() % 20) -
+                          Price::from_raw(PRICE_SCALE / 10);
+            int quantity = static_cast<int>(1 + rng() % 200);
+            if (op == 0 || model.empty()) {
+                Side side = rng() % 2 == 0 ? Side::BID : Side::ASK;
+                book.add(next_id, side, price, quantity, t0);
+                model[next_id++] = Resting{side, price, quantity};
+                continue;
+            }
+            auto it = std::next(model.begin(), static_cast<std::ptrdiff_t>(rng() % model.size()));
+            if (op == 1) {
+                book.modify(it->first, price, quantity, t0);
+                it->second.price = price;
+                it->second.quantity = quantity;
+            } else if (op == 2) {
+                book.execute(it->first, quantity);
+                it->second.quantity -= quantity;
+                if (it->second.quantity <= 0) {
+                    model.erase(it);
+                }
+            } else {
+                book.cancel(it->first);
+                model.erase(it);
+            }
+            
+            std::map<Price, int64_t, std::greater<Price>> bids;
+            std::map<Price, int64_t> asks;
+            for (const auto& [id, order] : model) {
+                (order.side == Side::BID ? bids[order.price] : asks[order.price]) += order.quantity;
+            }
+            model_ok = book.order_count() == model.size() && book.level_count(Side::BID) == bids.size() &&
+                       book.level_count(Side::ASK) == asks.size();
+            auto bid = bids.begin();
+            for (size_t i = 0; model_ok && i < l2.bids.size(); ++i, ++bid) {
+                model_ok = l2.bids[i].price == bid->first && l2.bids[i].volume == bid->second;
+            }
+            auto ask = asks.begin();
+            for (size_t i = 0; model_ok && i < l2.asks.size(); ++i, ++ask) {
+                model_ok = l2.asks[i].price == ask->first && l2.asks[i].volume == ask->second;
+            }
+            model_ok = model_ok && l2.bids.size() == std::min<size_t>(bids.size(), 3) &&
+                       l2.asks.size() == std::min<size_t>(asks.size(), 3);
+        }
+        checks.check(model_ok, "20000 random order events match a brute-force aggregation");
+        
+        OrderBookEntry levels[8];
+        size_t count = book.top_levels(Side::ASK, levels, 8);
+        checks.check(count == std::min<size_t>(book.level_count(Side::ASK), 8) &&
+                     (count < 2 || levels[0].price < levels[1].price), "top_levels() copies levels best first");
+    }
+    checks.check(pool.get_fallback_count() == 0 && pool.get_allocation_count() == pool.get_deallocation_count(),
+                 "orders, levels and index nodes all come from the pool and go back to it");
+    
+    // Through the handler: the L2 snapshot follows the order events
+    MarketDataHandler handler(4, 5);
+    handler.subscribe("L3SYM", [](const MarketUpdate&) {});
+    SymbolId id = handler.symbol_id("L3SYM");
+    auto event = [&](OrderEventType type, OrderId order_id, Side side, double price, int quantity) {
+        return handler.process_order(OrderEvent{id, 0, type, side, order_id, px(price), quantity, t0});
+    };
+    bool accepted = event(OrderEventType::ADD, 1, Side::BID, 99.5, 100) &&
+                    event(OrderEventType::ADD, 2, Side::BID, 99.5, 200) &&
+                    event(OrderEventType::ADD, 3, Side::ASK, 99.6, 300) &&
+                    event(OrderEventType::EXECUTE, 1, Side::BID, 0.0, 100);
+    bool rejected = !event(OrderEventType::CANCEL, 1, Side::BID, 0.0, 0) &&
+                    !handler.process_order(OrderEvent{INVALID_SYMBOL_ID, 0, OrderEventType::ADD, Side::BID, 9,
+                                                      px(1.0), 1, t0});
+    OrderBook l2 = handler.get_order_book("L3SYM");
+    checks.check(accepted && rejected && l2.bids.size() == 1 && l2.bids[0].volume == 200 && l2.asks.size() == 1 &&
+                 l2.asks[0].price == px(99.6) && handler.order_pool() != nullptr,
+                 "process_order() maintains the handler's L2 book and snapshots");
+    
+    return checks.passed();
+}
+
+/**
+ * @brief Verify thread placement: CPU lists, naming, pinning and busy-spinning pool workers.
+ */
+bool verify_thread_placement() {
+    std::cout << "\n=== CHECK: Thread Placement ===\n" << std::endl;
+    
+    CheckList checks;
+    
+    checks.check(parse_cpu_list("0-2,5,4") == std::vector<int>{0, 1, 2, 4, 5} && parse_cpu_list("").empty(),
+                 "CPU lists parse ranges and singles in ascending order");
+    checks.check(parse_cpu_list("3-1").empty() && parse_cpu_list("1,x").empty() && parse_cpu_list("2-").empty(),
+                 "malformed CPU lists are rejected");
+    
+    ThreadPlacement placement;
+    placement.cpus = {0, 0};
+    checks.check(placement.cpu_for(1) == 0 && ThreadPlacement{}.cpu_for(3) == -1, "threads cycle through the role's cores");
+    
+    int cpu0_node = numa_node_of_cpu(0);
+    std::cout << "  NUMA nodes: " << numa_node_count() << ", core 0 on node " << cpu0_node
+              << ", isolated cores: " << isolated_cpus().size() << std::endl;
+    checks.check(numa_node_count() >= 1 && (cpu0_node < 0 || !numa_node_cpus(cpu0_node).empty()),
+                 "NUMA topology is consistent");
+    
+    std::string name;
+    std::thread named([&name] {
+        set_current_thread_name("md-a-very-long-exchange-name");
+        name = current_thread_name();
+    });
+    named.join();
+    checks.check(name.empty() || name == std::string("md-a-very-long-exchange-name").substr(0, 15),
+                 "thread names are truncated to what the kernel keeps");
+    
+    // Binding can be refused (no NUMA, no CAP_SYS_NICE under a container); the slab must work either way
+    week2::OrderBookAllocator slab(64, 64);
+    bool bound = cpu0_node >= 0 && slab.bind_to_numa_node(cpu0_node);
+    void* block = slab.allocate(64);
+    std::memset(block, 0, 64);
+    slab.deallocate(block);
+    checks.check(!slab.bind_to_numa_node(static_cast<int>(numa_node_count())) && slab.get_fallback_count() == 0,
+                 std::string("slab binding ") + (bound ? "succeeded" : "was refused") + ", unknown nodes are rejected");
+    
+    placement.name = "strat";
+    placement.busy_spin = true;
+    std::vector<std::string> names(64);
+    std::atomic<int> misplaced(0);
+    {
+        ThreadPool pool(2, placement);
+        std::vector<std::future<void>> done;
+        for (size_t i = 0; i < names.size(); ++i) {
+            done.push_back(pool.submit(1, [&names, &misplaced, i] {
+                names[i] = current_thread_name();
+                if (current_cpu() >= 0 && current_cpu() != 0) {
+                    misplaced.fetch_add(1, std::memory_order_relaxed);
+                }
+            }));
+        }
+        for (auto& future : done) {
+            future.wait();
+        }
+        // Futures are ready before the worker counts the task as completed
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+        while (pool.total_tasks_completed() < names.size() && std::chrono::steady_clock::now() < deadline) {
+            std::this_thread::yield();
+        }
+        checks.check(pool.total_tasks_completed() == names.size(), "busy-spinning workers run every task");
+    }
+    bool strat_named = std::all_of(names.begin(), names.end(), [](const std::string& n) {
+        return n.empty() || n == "strat-0" || n == "strat-1";
+    });
+    checks.check(strat_named && misplaced.load() == 0, "pool workers are named after their role and run on their core");
+    
+    // Book workers and exchange threads take the handler's placement
+    MarketDataHandler handler(4);
+    auto feed = std::make_unique<QueueFeedSource>(64);
+    QueueFeedSource* source = feed.get();
+    handler.add_exchange("SIM", std::move(feed));
+    std::string worker_name;
+    std::atomic<bool> delivered(false);
+    handler.subscribe_ticks("AAPL", [&](const MarketTick&) {
+        if (!delivered.load()) {
+            worker_name = current_thread_name();
+            delivered.store(true);
+        }
+    });
+    MarketDataPlacement md_placement;
+    md_placement.book_workers.name = "mdbook";
+    md_placement.book_workers.cpus = {0};
+    md_placement.book_workers.busy_spin = true;
+    md_placement.book_workers.numa_node = cpu0_node;
+    md_placement.exchanges.busy_spin = true;
+    handler.start(1, md_placement);
+    MarketTick tick{};
+    tick.symbol_id = handler.symbol_id("AAPL");
+    tick.bid_price = Price::from_double(100.0);
+    tick.ask_price = Price::from_double(100.1);
+    tick.volume = 100;
+    source->publish(tick);
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (!delivered.load() && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    handler.stop();
+    checks.check(delivered.load() && (worker_name.empty() || worker_name == "mdbook-0"),
+                 "book workers are named from the handler's placement");
+    
+    return checks.passed();
+}
+
+/**
+ * @brief Verify the elastic thread pool: resize, drain on retirement, and queue-wait driven sizing.
+ */
+bool verify_elastic_pool() {
+    std::cout << "\n=== CHECK: Elastic Thread Pool ===\n" << std::endl;
+    
+    CheckList checks;
+    // Manual policy: the test drives adjust_thread_count() itself
+    PoolScalingPolicy manual;
+    manual.target_wait = std::chrono::microseconds(50);
+    manual.cooldown = std::chrono::milliseconds(0);
+    manual.interval = std::chrono::milliseconds(0);
+    {
+        ThreadPool pool(1, 3, manual);
+        pool.resize(10);
+        checks.check(pool.size() == 3 && pool.max_threads() == 3, "resize() clamps to max_threads");
+        pool.resize(1);
+        checks.check(wait_for([&] { return pool.get_stats().threads_retired == 2; }), "shrinking retires the extra workers");
+        
+        // Tasks spawned onto a worker's own deque survive that worker's retirement
+        pool.resize(3);
+        std::atomic<int> children(0);
+        std::atomic<bool> spawned(false);
+        pool.post(1, [&pool, &children, &spawned] {
+            for (int i = 0; i < 200; ++i) {
+                pool.post(1, [&children] { children.fetch_add(1, std::memory_order_relaxed); });
+            }
+            pool.resize(1);
+            spawned.store(true);
+        });
+        checks.check(wait_for([&] { return spawned.load() && children.load() == 200; }),
+                     "tasks left on retired workers' deques still run");
+        
+        // Every worker busy and work queued: grow one worker per adjustment, up to max
+        std::atomic<bool> release(false);
+        std::atomic<int> started(0);
+        auto blocker = [&release, &started] {
+            started.fetch_add(1);
+            while (!release.load()) {
+                std::this_thread::sleep_for(std::chrono::microseconds(100));
+            }
+        };
+        pool.post(1, blocker);
+        wait_for([&] { return started.load() == 1; });
+        pool.adjust_thread_count();
+        pool.post(1, blocker);
+        pool.post(1, blocker);
+        pool.post(1, blocker);
+        size_t largest = 1;
+        wait_for([&] {
+            pool.adjust_thread_count();
+            largest = std::max(largest, pool.size());
+            return started.load() == 3;
+        });
+        pool.adjust_thread_count();
+        checks.check(pool.size() == 3 && largest == 3 && started.load() == 3, "a starved pool grows to max_threads and no further");
+        
+        release.store(true);
+        checks.check(wait_for([&] { return pool.active_tasks() == 0; }), "blocked tasks finish");
+        
+        // Idle with no wait: retire one worker per cooldown, down to the initial size
+        wait_for([&] {
+            pool.adjust_thread_count();
+            return pool.size() == 1;
+        });
+        pool.adjust_thread_count();
+        pool.adjust_thread_count();
+        ThreadPoolStats stats = pool.get_stats();
+        uint64_t per_thread = 0;
+        for (uint64_t n : stats.tasks_per_thread) {
+            per_thread += n;
+        }
+        checks.check(stats.threads == 1 && per_thread == stats.tasks_completed && stats.tasks_per_thread.size() == 3,
+                     "an idle pool shrinks back to its initial size; per-worker counts add up");
+    }
+    
+    // Monitor thread: a burst grows the pool, the quiet afterwards shrinks it
+    PoolScalingPolicy automatic;
+    automatic.target_wait = std::chrono::microseconds(20);
+    automatic.cooldown = std::chrono::milliseconds(10);
+    automatic.interval = std::chrono::milliseconds(1);
+    {
+        ThreadPool pool(1, 4, automatic);
+        std::atomic<int> done(0);
+        std::atomic<size_t> largest(1);
+        for (int i = 0; i < 200; ++i) {
+            pool.post(2, [&pool, &done, &largest] {
+                std::this_thread::sleep_for(std::chrono::microseconds(500));
+                size_t size = pool.size();
+                size_t seen = largest.load();
+                while (size > seen && !largest.compare_exchange_weak(seen, size)) {
+                }
+                done.fetch_add(1);
+            });
+        }
+        checks.check(wait_for([&] { return done.load() == 200; }) && largest.load() > 1, "a burst grows the pool");
+        checks.check(wait_for([&] { return pool.size() == 1; }), "the pool shrinks back once the burst is over");
+        ThreadPoolStats stats = pool.get_stats();
+        std::cout << "  Grew to " << largest.load() << " threads, started " << stats.threads_started
+                  << ", retired " << stats.threads_retired << ", average queue wait "
+                  << std::fixed << std::setprecision(1) << stats.avg_wait_time_us << " us" << std::endl;
+    }
+    
+    return checks.passed();
+}
+
+/**
+ * @brief Verify the allocation-free signal path from strategies to execution.
+ *
+ * Signals are POD records in one ring per strategy. The execution stage
+ * must see each strategy's signals in order, full rings must count their
+ * drops, and text must only appear when a signal is formatted.
+ */
+bool verify_signal_path() {
+    std::cout << "\n=== CHECK: Strategy Signal Path ===\n" << std::endl;
+    
+    CheckList checks;
+    
+    checks.check(std::is_trivially_copyable_v<Signal> && sizeof(Signal) <= 48, "Signal is a small trivially copyable record");
+    
+    // Bulk pop takes what is there, in order, and no more
+    {
+        SpscRingBuffer<int, 8> ring;
+        for (int i = 0; i < 5; ++i) {
+            ring.try_push(i);
+        }
+        int values[8] = {};
+        size_t first = ring.try_pop_bulk(values, 3);
+        size_t second = ring.try_pop_bulk(values + 3, 8);
+        checks.check(first == 3 && second == 2 && values[0] == 0 && values[4] == 4 && ring.empty() &&
+                     ring.try_pop_bulk(values, 8) == 0, "try_pop_bulk drains in order across calls");
+    }
+    
+    MarketTick tick{0, 0, Price::from_double(100.00), Price::from_double(100.10), 500, std::chrono::nanoseconds(42)};
+    
+    // Each strategy's signals reach the handler in publish order, in batches
+    {
+        SignalRouter router;
+        SignalChannel& alpha = router.add_strategy(1);
+        SignalChannel& beta = router.add_strategy(2);
+        const size_t per_strategy = SIGNAL_BATCH_SIZE * 2 + 5;
+        std::thread producer_a([&] {
+            for (size_t i = 0; i < per_strategy; ++i) {
+                alpha.emit(tick, TscClock::now(), Side::BID, tick.bid_price, static_cast<int32_t>(i));
+            }
+        });
+        std::thread producer_b([&] {
+            for (size_t i = 0; i < per_strategy; ++i) {
+                beta.emit(tick, TscClock::now(), Side::ASK, tick.ask_price, static_cast<int32_t>(i));
+            }
+        });
+        producer_a.join();
+        producer_b.join();
+        
+        int32_t next[3] = {0, 0, 0};
+        bool in_order = true;
+        size_t largest_batch = 0;
+        size_t routed = router.drain([&](std::span<const Signal> batch) {
+            largest_batch = std::max(largest_batch, batch.size());
+            for (const Signal& signal : batch) {
+                in_order = in_order && signal.quantity == next[signal.strategy_id]++ &&
+                           signal.source_timestamp == tick.timestamp;
+            }
+        });
+        checks.check(routed == 2 * per_strategy && in_order, "every signal is handled, in order per strategy");
+        checks.check(largest_batch == SIGNAL_BATCH_SIZE, "execution takes signals in batches");
+        checks.check(router.tick_to_signal().count == 2 * per_strategy && router.tick_to_execution().count == routed,
+                     "tick-to-signal and tick-to-execution are recorded per signal");
+        checks.check(router.drain([](std::span<const Signal>) {}) == 0, "drained rings are empty");
+    }
+    
+    // A full ring drops and counts instead of blocking the strategy
+    {
+        SignalChannel channel(7);
+        size_t accepted = 0;
+        for (size_t i = 0; i < SIGNAL_RING_CAPACITY + 10; ++i) {
+            accepted += channel.emit(tick, TscClock::now(), Side::BID, tick.bid_price, 1) ? 1 : 0;
+        }
+        checks.check(accepted == SIGNAL_RING_CAPACITY && channel.dropped() == 10 &&
+                     channel.published() == SIGNAL_RING_CAPACITY + 10, "full ring counts dropped signals");
+        Signal taken[4];
+        checks.check(channel.take(taken, 4) == 4 && taken[0].strategy_id == 7, "taken signals carry their strategy");
+    }
+    
+    // Text only when asked for, exact to the tick
+    {
+        Signal signal;
+        signal.price = Price::from_double(100.05);
+        signal.quantity = 100;
+        signal.side = Side::BID;
+        std::string buy = format_signal(signal, "Alpha", "AAPL");
+        signal.side = Side::ASK;
+        signal.price = Price::from_double(189.125);
+        std::string sell = format_signal(signal, "Beta", "MSFT");
+        checks.check(buy == "SIGNAL:Alpha:AAPL:BUY 100@100.05", "format_signal: " + buy);
+        checks.check(sell == "SIGNAL:Beta:MSFT:SELL 100@189.125", "format_signal: " + sell);
+    }
+    
+    return checks.passed();
+}
+
+/**
+ * @brief Verify deadline-aware scheduling: EDF order, aging and stale tasks.
+ *
+ * Each scenario holds the pool's only worker in a blocker task while the
+ * tasks under test queue up, so the order they run in is the scheduler's.
+ */
+bool verify_deadline_scheduling() {
+    std::cout << "\n=== CHECK: Deadline-Aware Scheduling ===\n" << std::endl;
+    
+    CheckList checks;
+    
+    // Occupy the worker until release is set; returns once the blocker runs
+    auto block = [](ThreadPool& pool, std::promise<void>& release) {
+        std::promise<void> started;
+        std::shared_future<void> gate = release.get_future().share();
+        auto running = started.get_future();
+        pool.post(3, [gate, &started] {
+            started.set_value();
+            gate.wait();
+        });
+        running.wait();
+    };
+    const uint64_t now = TscClock::now();
+    
+    {
+        // Same band: earliest deadline first, then the plain task
+        ThreadPool pool(1);
+        std::promise<void> release;
+        block(pool, release);
+        std::mutex order_mutex;
+        std::vector<int> order;
+        std::vector<std::future<void>> done;
+        auto record = [&order, &order_mutex](int tag) {
+            return [tag, &order, &order_mutex] {
+                std::lock_guard<std::mutex> lock(order_mutex);
+                order.push_back(tag);
+            };
+        };
+        done.push_back(pool.submit(1, record(0)));
+        for (int seconds : {30, 10, 20}) {
+            done.push_back(pool.submit_with_deadline(1, TaskDeadline::within(std::chrono::seconds(seconds), now),
+                                                     record(seconds)));
+        }
+        done.push_back(pool.submit_with_deadline(2, TaskDeadline::within(std::chrono::seconds(60), now), record(2)));
+        release.set_value();
+        for (auto& f : done) {
+            f.get();
+        }
+        checks.check(order == std::vector<int>({2, 10, 20, 30, 0}),
+                     "higher band first, earliest deadline first within a band, plain tasks last");
+    }
+    
+    {
+        // A low-priority deadline task that waited long enough overtakes a high-priority one
+        ThreadPool pool(1);
+        pool.set_deadline_aging(std::chrono::microseconds(500));
+        std::promise<void> release;
+        block(pool, release);
+        std::atomic<int> first(-1);
+        auto low = pool.submit_with_deadline(0, TaskDeadline::within(std::chrono::seconds(10)), [&first] {
+            int expected = -1;
+            first.compare_exchange_strong(expected, 0);
+        });
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        auto high = pool.submit(3, [&first] {
+            int expected = -1;
+            first.compare_exchange_strong(expected, 3);
+        });
+        release.set_value();
+        low.get();
+        high.get();
+        checks.check(first.load() == 0 && pool.get_stats().aged_tasks == 1, "aging lifts a waiting task above newer high-priority work");
+    }
+    
+    {
+        ThreadPool pool(1);
+        pool.set_deadline_aging(std::chrono::microseconds(0));
+        std::promise<void> release;
+        block(pool, release);
+        std::atomic<int> first(-1);
+        auto low = pool.submit_with_deadline(0, TaskDeadline::within(std::chrono::seconds(10)), [&first] {
+            int expected = -1;
+            first.compare_exchange_strong(expected, 0);
+        });
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        auto high = pool.submit(3, [&first] {
+            int expected = -1;
+            first.compare_exchange_strong(expected, 3);
+        });
+        release.set_value();
+        low.get();
+        high.get();
+        checks.check(first.load() == 3, "without aging, bands stay strict");
+    }
+    
+    {
+        // Deadlines that pass in the queue: drop, or run with the stale flag
+        ThreadPool pool(1);
+        std::promise<void> release;
+        block(pool, release);
+        std::atomic<bool> dropped_ran(false);
+        std::atomic<bool> saw_stale(false);
+        std::atomic<bool> plain_stale(true);
+        auto dropped = pool.submit_with_deadline(2, TaskDeadline::within(std::chrono::milliseconds(1)),
+                                                 [&dropped_ran] { dropped_ran = true; });
+        auto flagged = pool.submit_with_deadline(
+            2, TaskDeadline::within(std::chrono::milliseconds(1), TscClock::now(), StaleAction::RUN_FLAGGED),
+            [&saw_stale] { saw_stale = ThreadPool::current_task_is_stale(); });
+        auto plain = pool.submit(2, [&plain_stale] { plain_stale = ThreadPool::current_task_is_stale(); });
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        release.set_value();
+        
+        // The later tasks finishing means the worker is done with the dropped one's state
+        flagged.get();
+        plain.get();
+        bool broken_promise = false;
+        try {
+            dropped.get();
+        } catch (const std::future_error& e) {
+            broken_promise = e.code() == std::future_errc::broken_promise;
+        }
+        ThreadPoolStats stats = pool.get_stats();
+        checks.check(broken_promise && !dropped_ran.load() && stats.stale_drops == 1,
+                     "stale task is dropped unrun and its future reports broken_promise");
+        checks.check(saw_stale.load() && !plain_stale.load() && stats.stale_runs == 1,
+                     "RUN_FLAGGED task runs and sees current_task_is_stale()");
+        checks.check(stats.deadline_tasks == 2 && stats.deadline_misses == 1, "deadline counters add up");
+    }
+    
+    {
+        // Started in time but finished late: a miss, not a stale drop
+        ThreadPool pool(1);
+        auto slow = pool.submit_with_deadline(1, TaskDeadline::within(std::chrono::milliseconds(50)), [] {
+            std::this_thread::sleep_for(std::chrono::milliseconds(60));
+            return ThreadPool::current_task_is_stale();
+        });
+        bool stale = slow.get();
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+        while (pool.get_stats().deadline_misses == 0 && std::chrono::steady_clock::now() < deadline) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        ThreadPoolStats stats = pool.get_stats();
+        checks.check(!stale && stats.deadline_misses == 1 && stats.stale_drops == 0, "task overrunning its deadline counts as a miss");
+    }
+    
+    return checks.passed();
+}
+
+Task<int> coroutine_add(int a, int b) {
+    co_return a + b;
+}
+
+Task<int> coroutine_sum_chain(int count) {
+    // Each await completes synchronously; with tail calls (optimized builds)
+    // symmetric transfer keeps the stack flat however long the loop
+    int sum = 0;
+    for (int i = 0; i < count; ++i) {
+        sum += co_await coroutine_add(i, 1) - i;
+    }
+    co_return sum;
+}
+
+Task<int> coroutine_throws() {
+    throw std::runtime_error("strategy failed");
+    co_return 0;
+}
+
+Task<void> coroutine_record_thread(std::thread::id& ran_on) {
+    ran_on = std::this_thread::get_id();
+    co_return;
+}
+
+Task<std::string> coroutine_worker_name(ThreadPool& pool) {
+    co_await pool.schedule(1);
+    co_return current_thread_name();
+}
+
+// A multi-step strategy: waits for a few updates of its symbol without holding a thread
+Task<void> coroutine_tick_strategy(MarketDataHandler& handler, SymbolId symbol_id, ThreadPool& pool,
+                                   int steps, std::atomic<int64_t>& volume, std::atomic<int>& finished) {
+    for (int step = 0; step < steps; ++step) {
+        MarketTick tick = co_await handler.next_tick(symbol_id, pool);
+        volume.fetch_add(tick.volume, std::memory_order_relaxed);
+    }
+    finished.fetch_add(1, std::memory_order_release);
+}
+
+Task<void> coroutine_drain_queue(AsyncQueue<int>& queue, ThreadPool& pool, int count, std::atomic<int64_t>& sum,
+                                 std::atomic<bool>& done) {
+    for (int i = 0; i < count; ++i) {
+        sum.fetch_add(co_await queue.pop(pool), std::memory_order_relaxed);
+    }
+    done.store(true, std::memory_order_release);
+}
+
+/**
+ * @brief Verify the coroutine executor: Task<T>, pool.schedule(), next_tick() and AsyncQueue.
+ */
+bool verify_coroutine_executor() {
+    std::cout << "\n=== CHECK: Coroutine Executor ===\n" << std::endl;
+    
+    CheckList checks;
+    checks.check(sync_wait(coroutine_add(2, 3)) == 5, "Task<int> returns its value");
+    checks.check(sync_wait(coroutine_sum_chain(1000)) == 1000, "a loop of synchronously completing awaits runs to the end");
+    bool rethrown = false;
+    try {
+        sync_wait(coroutine_throws());
+    } catch (const std::runtime_error& e) {
+        rethrown = std::string(e.what()) == "strategy failed";
+    }
+    checks.check(rethrown, "exceptions propagate to the awaiter");
+    
+    {
+        ThreadPlacement placement;
+        placement.name = "coro";
+        ThreadPool pool(1, placement);
+        checks.check(sync_wait(coroutine_worker_name(pool)) == "coro-0", "co_await pool.schedule() continues on a pool worker");
+    }
+    
+    {
+        // Far more strategies than threads, each suspended between updates
+        const int STRATEGIES = 200;
+        const int STEPS = 3;
+        MarketDataHandler handler(4);
+        handler.subscribe_ticks("CORO", [](const MarketTick&) {});
+        SymbolId symbol_id = handler.symbol_id("CORO");
+        ThreadPool pool(1);
+        std::atomic<int64_t> volume(0);
+        std::atomic<int> finished(0);
+        size_t frames_before = CoroutineFramePool::instance().allocations();
+        size_t fallbacks_before = CoroutineFramePool::instance().fallbacks();
+        for (int i = 0; i < STRATEGIES; ++i) {
+            spawn(pool, 1, coroutine_tick_strategy(handler, symbol_id, pool, STEPS, volume, finished));
+        }
+        
+        // Strategies re-register after each resumption, so keep the updates coming until all are done
+        MarketTick tick{symbol_id, 0, Price::from_double(100.00), Price::from_double(100.01), 1,
+                        std::chrono::nanoseconds(1)};
+        bool all_done = wait_for([&] {
+            handler.process_update(tick);
+            return finished.load(std::memory_order_acquire) == STRATEGIES;
+        });
+        checks.check(all_done && volume.load() == STRATEGIES * STEPS,
+                     std::to_string(STRATEGIES) + " coroutine strategies take " + std::to_string(STEPS) +
+                     " updates each on one worker");
+        checks.check(CoroutineFramePool::instance().allocations() - frames_before >= static_cast<size_t>(STRATEGIES) &&
+                     CoroutineFramePool::instance().fallbacks() == fallbacks_before,
+                     "coroutine frames come from the frame pool");
+        
+        MarketTick invalid = sync_wait([](MarketDataHandler& h, ThreadPool& p) -> Task<MarketTick> {
+            co_return co_await h.next_tick(INVALID_SYMBOL_ID - 1, p);
+        }(handler, pool));
+        checks.check(invalid.symbol_id == INVALID_SYMBOL_ID, "next_tick() on a symbol without a book resumes at once");
+    }
+    
+    {
+        // Consumer suspends on an empty queue and is resumed by each push
+        ThreadPool pool(1);
+        AsyncQueue<int> queue(16);
+        std::atomic<int64_t> sum(0);
+        std::atomic<bool> done(false);
+        spawn(pool, 1, coroutine_drain_queue(queue, pool, 100, sum, done));
+        bool suspended = wait_for([&] { return queue.waiting() == 1; });
+        for (int i = 1; i <= 100; ++i) {
+            // Bounded queue: push again once the consumer catches up
+            while (!queue.try_push(i)) {
+                std::this_thread::yield();
+            }
+        }
+        checks.check(suspended && wait_for([&] { return done.load(std::memory_order_acquire); }) &&
+                     sum.load() == 5050, "AsyncQueue::pop() suspends until a value is pushed");
+    }
+    
+    {
+        // A task spawned while its pool shuts down starts inline instead of terminating
+        std::thread::id spawner;
+        std::thread::id ran_on;
+        {
+            ThreadPool pool(1);
+            pool.post(1, [&pool, &spawner, &ran_on] {
+                // Wait for the destructor to stop the pool
+                for (;;) {
+                    try {
+                        pool.post(1, [] {});
+                    } catch (const std::runtime_error&) {
+                        break;
+                    }
+                    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                }
+                spawner = std::this_thread::get_id();
+                spawn(pool, 1, coroutine_record_thread(ran_on));
+            });
+        }
+        checks.check(ran_on != std::thread::id() && ran_on == spawner,
+                     "spawn() on a stopped pool runs the task on the calling thread");
+    }
+    
+    return checks.passed();
+}
+
+/**
+ * @brief Verify book publication through shared memory.
+ * 
+ * Readers map the segment separately from the publisher, as another
+ * process would, and must see the handler's books, its directory and the
+ * update notifications in order.
+ * 
+ * @return true if all checks passed
+ */
+bool verify_shm_book_publication() {
+    std::cout << "\n=== CHECK: Shared Memory Book Publication ===\n" << std::endl;
+    
+    CheckList checks;
+    
+    const std::string SEGMENT = "/trading_books_test";
+    auto publisher = std::make_unique<ShmBookPublisher>(SEGMENT, 8, 2, 16);
+    ShmBookReader books(SEGMENT);
+    ShmBookReader feed(SEGMENT, true);
+    checks.check(publisher->consumers() == 1 && books.max_symbols() == 8, "readers map the segment and claim a channel");
+    
+    MarketDataHandler handler(4, 5);
+    handler.add_exchange("NYSE");
+    handler.subscribe("AAA", [](const MarketUpdate&) {});
+    SymbolId aaa = handler.symbol_id("AAA");
+    handler.process_update(MarketUpdate{"AAA", "NYSE", Price::from_double(100.0), Price::from_double(100.5), 10,
+                                        std::chrono::nanoseconds(1)});
+    checks.check(books.find_symbol("AAA") == INVALID_SYMBOL_ID, "nothing is published before the publisher is set");
+    
+    handler.set_shm_publisher(publisher.get());
+    TopOfBook top = books.top_of_book(books.find_symbol("AAA"));
+    checks.check(books.find_symbol("AAA") == aaa && books.symbol_name(aaa) == "AAA" && top.has_bid() &&
+                 top.bid.price == Price::from_double(100.0) && top.ask.price == Price::from_double(100.5),
+                 "existing books are published when the publisher is set");
+    
+    handler.subscribe("BBB", [](const MarketUpdate&) {});
+    SymbolId bbb = handler.symbol_id("BBB");
+    for (int v = 2; v <= 6; ++v) {
+        handler.process_update(MarketUpdate{"AAA", "NYSE", Price::from_double(100.0 - v * 0.25), Price::from_double(100.5 + v * 0.25),
+                                            10 + v, std::chrono::nanoseconds(v)});
+    }
+    handler.process_update(MarketUpdate{"BBB", "NYSE", Price::from_double(50.0), Price::from_double(50.5), 7,
+                                        std::chrono::nanoseconds(7)});
+    
+    BookSnapshot local;
+    BookSnapshot shared;
+    checks.check(handler.get_book_snapshot(aaa, local) && books.read_snapshot(aaa, shared) && shared.bid_count == 5 &&
+                 std::memcmp(&local, &shared, local.used_bytes()) == 0,
+                 "depth read from shared memory matches the handler's snapshot");
+    checks.check(books.top_of_book(bbb).bid.volume == 7 && !books.read_snapshot(SymbolId(5), shared),
+                 "unpublished symbols report no book");
+    
+    std::vector<SymbolId> notified;
+    SymbolId updated;
+    while (feed.poll_update(updated)) {
+        notified.push_back(updated);
+    }
+    checks.check(notified == std::vector<SymbolId>{aaa, bbb, aaa, aaa, aaa, aaa, aaa, bbb} && feed.updates_dropped() == 0,
+                 "notifications arrive in update order");
+    
+    uint64_t version = books.version(bbb);
+    for (int v = 0; v < 20; ++v) {
+        handler.process_update(MarketTick{bbb, 0, Price::from_double(50.0), Price::from_double(50.5), 100 + v,
+                                          std::chrono::nanoseconds(100 + v)});
+    }
+    size_t pending = 0;
+    while (feed.poll_update(updated)) {
+        ++pending;
+    }
+    checks.check(books.version(bbb) > version && pending == 16 && feed.updates_dropped() == 4 &&
+                 publisher->notifications_dropped() == 4,
+                 "a full channel drops notifications and counts them, books stay current");
+    
+    bool unclaimed = false;
+    {
+        ShmBookReader second(SEGMENT, true);
+        try {
+            ShmBookReader third(SEGMENT, true);
+        } catch (const std::runtime_error&) {
+            unclaimed = publisher->consumers() == 2;
+        }
+    }
+    checks.check(unclaimed && publisher->consumers() == 1, "channels are exclusive and released on destruction");
+    
+    bool missing = false;
+    try {
+        ShmBookReader absent("/trading_books_test_absent");
+    } catch (const std::runtime_error&) {
+        missing = true;
+    }
+    checks.check(missing, "opening a segment that doesn't exist throws");
+    
+#if defined(__unix__) || defined(__APPLE__)
+    // Copy the segment under another name and damage the copy's header
+    const std::string FORGED = "/trading_books_test_forged";
+    auto forge = [&SEGMENT, &FORGED](auto&& damage) {
+        bool forged_ok = false;
+        ::shm_unlink(FORGED.c_str());
+        int source = ::shm_open(SEGMENT.c_str(), O_RDONLY, 0);
+        int forged = ::shm_open(FORGED.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+        struct stat info;
+        if (source >= 0 && forged >= 0 && ::fstat(source, &info) == 0 && ::ftruncate(forged, info.st_size) == 0) {
+            size_t size = static_cast<size_t>(info.st_size);
+            void* from = ::mmap(nullptr, size, PROT_READ, MAP_SHARED, source, 0);
+            void* to = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, forged, 0);
+            if (from != MAP_FAILED && to != MAP_FAILED) {
+                std::memcpy(to, from, size);
+                damage(*static_cast<ShmBookLayout::Header*>(to));
+                forged_ok = true;
+            }
+            if (from != MAP_FAILED) {
+                ::munmap(from, size);
+            }
+            if (to != MAP_FAILED) {
+                ::munmap(to, size);
+            }
+        }
+        if (source >= 0) {
+            ::close(source);
+        }
+        if (forged >= 0) {
+            ::close(forged);
+        }
+        return forged_ok;
+    };
+    auto forged_rejected = [&forge, &FORGED](auto&& damage) {
+        bool rejected = false;
+        if (forge(damage)) {
+            try {
+                ShmBookReader reader(FORGED);
+            } catch (const std::runtime_error&) {
+                rejected = true;
+            }
+        }
+        ::shm_unlink(FORGED.c_str());
+        return rejected;
+    };
+    checks.check(!forged_rejected([](ShmBookLayout::Header&) {}) &&
+                 forged_rejected([](ShmBookLayout::Header& header) { header.notify_capacity = 12; }) &&
+                 forged_rejected([](ShmBookLayout::Header& header) { header.notify_capacity = 0; }) &&
+                 forged_rejected([](ShmBookLayout::Header& header) { header.directory_offset = header.books_offset; }) &&
+                 forged_rejected([](ShmBookLayout::Header& header) { header.notify_capacity *= 2; }),
+                 "segments with damaged offsets or ring sizes are refused");
+    
+    // A second publisher must not take the name from a live one, only from one that exited
+    bool refused = false;
+    try {
+        ShmBookPublisher rival(SEGMENT, 8);
+    } catch (const std::runtime_error&) {
+        refused = true;
+    }
+    uint64_t before = books.version(bbb);
+    handler.process_update(MarketTick{bbb, 0, Price::from_double(40.0), Price::from_double(40.5), 5, std::chrono::nanoseconds(150)});
+    bool replaced = false;
+    // No process has a PID this large, so the forged segment's publisher is gone
+    if (forge([](ShmBookLayout::Header& header) { header.publisher_pid = std::numeric_limits<int32_t>::max(); })) {
+        try {
+            ShmBookPublisher successor(FORGED, 8);
+            replaced = true;
+        } catch (const std::runtime_error&) {
+        }
+    }
+    ::shm_unlink(FORGED.c_str());
+    checks.check(refused && books.version(bbb) > before && replaced,
+                 "a live publisher's segment is never replaced, a dead one's is");
+#endif
+    
+    handler.set_shm_publisher(nullptr);
+    version = books.version(bbb);
+    handler.process_update(MarketTick{bbb, 0, Price::from_double(50.0), Price::from_double(50.5), 1, std::chrono::nanoseconds(200)});
+    publisher.reset();
+    bool removed = false;
+    try {
+        ShmBookReader after(SEGMENT);
+    } catch (const std::runtime_error&) {
+        removed = true;
+    }
+    checks.check(books.version(bbb) == version && books.top_of_book(bbb).bid.volume == 119 && removed,
+                 "a detached publisher stops publishing and its segment is removed");
+    
+    return checks.passed();
+}
+
+/**
+ * @brief Verify book checkpoints and warm restart from them.
+ * 
+ * A restored checkpoint plus a replay of the capture from its sequence
+ * must rebuild exactly the books of the handler that was checkpointed.
+ * 
+ * @return true if all checks passed
+ */
+bool verify_book_checkpoint() {
+    std::cout << "\n=== CHECK: Book Checkpoints and Warm Restart ===\n" << std::endl;
+    
+    CheckList checks;
+    
+    const std::vector<std::string> symbols = {"AAA", "BBB", "CCC"};
+    const int TICKS = 600;
+    const auto temp = std::filesystem::temp_directory_path();
+    const std::string capture_path = (temp / "trading_checkpoint_capture.bin").string();
+    const std::string checkpoint_path = (temp / "trading_checkpoint_test.bin").string();
+    const std::string early_path = (temp / "trading_checkpoint_early.bin").string();
+    std::filesystem::remove(checkpoint_path);
+    
+    auto make_handler = [&symbols](std::unique_ptr<FeedSource> feed) {
+        auto handler = std::make_unique<MarketDataHandler>(8);
+        handler->add_exchange("SIM", std::move(feed));
+        for (const auto& symbol : symbols) {
+            handler->subscribe(symbol, [](const MarketUpdate&) {});
+        }
+        return handler;
+    };
+    auto same_books = [&symbols](MarketDataHandler& a, MarketDataHandler& b) {
+        for (const auto& symbol : symbols) {
+            BookSnapshot x;
+            BookSnapshot y;
+            if (!a.get_book_snapshot(a.symbol_id(symbol), x) || !b.get_book_snapshot(b.symbol_id(symbol), y) ||
+                x.bid_count != y.bid_count || x.ask_count != y.ask_count || x.timestamp != y.timestamp) {
+                return false;
+            }
+            for (size_t i = 0; i < x.rows(); ++i) {
+                if (x.bid(i).price != y.bid(i).price || x.bid(i).volume != y.bid(i).volume ||
+                    x.ask(i).price != y.ask(i).price || x.ask(i).volume != y.ask(i).volume) {
+                    return false;
+                }
+            }
+        }
+        return true;
+    };
+    
+    auto feed = std::make_unique<QueueFeedSource>(8192);
+    QueueFeedSource* source = feed.get();
+    auto live = make_handler(std::move(feed));
+    live->set_tick_size("BBB", Price::from_double(0.01));
+    auto publish = [&](int from, int to) {
+        for (int i = from; i < to; ++i) {
+            MarketTick tick{};
+            tick.symbol_id = live->symbol_id(symbols[i % symbols.size()]);
+            tick.bid_price = Price::from_double(100.0 + (i % 7) * 0.01);
+            tick.ask_price = Price::from_double(100.1 + (i % 5) * 0.01);
+            tick.volume = (i % 11 == 0) ? 0 : 100 + i;
+            tick.timestamp = std::chrono::nanoseconds(1000 + i);
+            while (!source->publish(tick)) {
+                std::this_thread::yield();
+            }
+        }
+    };
+    {
+        CaptureWriter writer(capture_path, 4096);
+        live->set_capture(&writer);
+        CheckpointOptions options;
+        options.interval = std::chrono::milliseconds(2);
+        options.capture = &writer;
+        BookCheckpointer checkpointer(*live, checkpoint_path, options);
+        live->start(2);
+        
+        publish(0, TICKS / 2);
+        wait_for([&] { return live->get_metrics().total_updates_processed >= static_cast<uint64_t>(TICKS / 2); });
+        checks.check(checkpointer.checkpoint_now(), "checkpoint taken while the feed is running");
+        std::filesystem::copy_file(checkpoint_path, early_path, std::filesystem::copy_options::overwrite_existing);
+        publish(TICKS / 2, TICKS);
+        bool periodic = wait_for([&] { return live->get_metrics().total_updates_processed >= static_cast<uint64_t>(TICKS) &&
+                                              checkpointer.checkpoints() >= 3; });
+        checks.check(periodic, "the checkpoint thread keeps taking checkpoints (" + std::to_string(checkpointer.checkpoints()) +
+                     ", last took " + std::to_string(checkpointer.last_duration().count() / 1000) + " us)");
+        live->stop();
+        checks.check(checkpointer.checkpoint_now() && checkpointer.skipped() == 0, "final checkpoint taken after stop()");
+    }
+    
+    try {
+        CaptureReader capture(capture_path);
+        CaptureReplayer replayer(capture);
+        
+        MarketDataHandler restored(8);
+        CheckpointInfo info;
+        bool rebuilt = restored.restore(checkpoint_path, &info);
+        std::cout << "  Restored " << info.books << " books in " << info.restore_time.count() / 1000 << " us" << std::endl;
+        checks.check(rebuilt && info.sequence == static_cast<uint64_t>(TICKS) && info.books == symbols.size() &&
+                     same_books(*live, restored), "restore() into an empty handler rebuilds every book");
+        checks.check(restored.exchange_id("SIM") == live->exchange_id("SIM") && restored.symbol_id("CCC") == live->symbol_id("CCC") &&
+                     restored.tick_size(restored.symbol_id("BBB")) == Price::from_double(0.01),
+                     "registries and tick sizes come back with their recorded IDs");
+        ReplayOptions resume;
+        resume.from_sequence = info.sequence;
+        checks.check(replayer.run(restored, resume).updates == 0, "nothing to replay after the last checkpoint");
+        
+        auto early = make_handler(nullptr);
+        CheckpointInfo early_info;
+        rebuilt = early->restore(early_path, &early_info);
+        resume.from_sequence = early_info.sequence;
+        ReplayResult result = replayer.run(*early, resume);
+        checks.check(rebuilt && early_info.sequence < static_cast<uint64_t>(TICKS) &&
+                     result.updates == TICKS - early_info.sequence && same_books(*live, *early),
+                     "an earlier checkpoint plus a replay from its sequence catches up (from #" +
+                     std::to_string(early_info.sequence) + ")");
+        
+        MarketDataHandler other(8);
+        other.subscribe("ZZZ", [](const MarketUpdate&) {});
+        checks.check(!other.restore(checkpoint_path) && !restored.restore(capture_path),
+                     "mismatched IDs and files that aren't checkpoints are refused");
+        restored.start(1);
+        checks.check(!restored.restore(checkpoint_path), "restore() is refused while running");
+        restored.stop();
+    } catch (const std::exception& e) {
+        checks.check(false, std::string("capture replayed after restore: ") + e.what());
+    }
+    
+    // Damage the newest checkpoint: readers fall back to the one before it
+    uint64_t newest = 0;
+    try {
+        newest = CheckpointReader(checkpoint_path).generation();
+        CheckpointLayout::Header header;
+        std::fstream file(checkpoint_path, std::ios::in | std::ios::out | std::ios::binary);
+        file.read(reinterpret_cast<char*>(&header), sizeof(header));
+        file.seekp(static_cast<std::streamoff>(header.buffer_offset[newest % 2] + 64 + offsetof(CheckpointLayout::Name, text)));
+        file.put('#');
+        file.close();
+        checks.check(CheckpointReader(checkpoint_path).generation() == newest - 1, "a damaged checkpoint falls back to the previous one");
+    } catch (const std::exception& e) {
+        checks.check(false, std::string("a damaged checkpoint falls back to the previous one: ") + e.what());
+    }
+    
+    std::filesystem::remove(capture_path);
+    std::filesystem::remove(checkpoint_path);
+    std::filesystem::remove(early_path);
+    return checks.passed();
+}
+
+/**
+ * @brief Integrated system test demonstrating all the optimizations.
+ */
+int main() {
+    std::cout << "=== Week 3 Integrated Trading System Test ===" << std::endl;
+    
+    // Step 1: Configure the trading system
+    std::cout << "\n=== STEP 1: Configuring Trading System ===\n" << std::endl;
+    
+    std::vector<std::string> symbols = {"AAPL", "MSFT", "GOOG", "AMZN", "META"};
+    std::vector<std::string> exchanges = {"NYSE", "NASDAQ", "IEX"};
+    
+    // Initialize market data handler (Week 2 optimized memory management)
+    std::cout << "Week 2 optimization: Initializing market data handler with custom allocator" << std::endl;
+    trading::MarketDataHandler market_data_handler(100);  // Maximum 100 orders per symbol
+    
+    // Add exchanges
+    for (const auto& exchange : exchanges) {
+        std::cout << "Adding exchange: " << exchange << std::endl;
+        market_data_handler.add_exchange(exchange);
+    }
+    
+    // Create thread pool for strategy evaluation (Week 3 optimization)
+    std::cout << "Week 3 optimization: Creating thread pool for strategy evaluation" << std::endl;
+    trading::ThreadPool strategy_thread_pool(std::thread::hardware_concurrency(), false); // non-verbose mode
+    
+    // Oldest tick a strategy may still start on. Generous, since the demo
+    // strategies sleep for milliseconds and may share a single core
+    constexpr auto STRATEGY_MAX_STALENESS = std::chrono::milliseconds(20);
+    
+    // Create strategies with different priorities
+    std::cout << "Creating trading strategies with different priorities:" << std::endl;
+    TradingStrategy strategy1("Fast Alpha Strategy", 3, 10);  // High priority, fast execution
+    std::cout << "  - " << strategy1.name() << " (Priority: " << strategy1.priority() << ")" << std::endl;
+    
+    TradingStrategy strategy2("ML-Based Strategy", 2, 50);  // Medium priority, slower execution
+    std::cout << "  - " << strategy2.name() << " (Priority: " << strategy2.priority() << ")" << std::endl;
+    
+    TradingStrategy strategy3("Long-Term Strategy", 1, 30);  // Low priority, medium execution
+    std::cout << "  - " << strategy3.name() << " (Priority: " << strategy3.priority() << ")" << std::endl;
+    
+    // One preallocated signal ring per strategy, drained by the execution stage (Week 3 optimization)
+    std::cout << "Week 3 optimization: Creating per-strategy signal rings for the execution stage" << std::endl;
+    trading::SignalRouter signal_router;
+    trading::SignalChannel& strategy1_signals = signal_router.add_strategy(1);
+    trading::SignalChannel& strategy2_signals = signal_router.add_strategy(2);
+    trading::SignalChannel& strategy3_signals = signal_router.add_strategy(3);
+    const TradingStrategy* strategies_by_id[] = {nullptr, &strategy1, &strategy2, &strategy3};
+    
+    // Step 2: Subscribe to market data
+    std::cout << "\n=== STEP 2: Subscribing to Market Data ===\n" << std::endl;
+    
+    std::atomic<size_t> callbacks_received(0);
+    
+    for (const auto& symbol : symbols) {
+        std::cout << "Subscribing to " << symbol << std::endl;
+        market_data_handler.subscribe(symbol, [&callbacks_received](const trading::MarketUpdate&) {
+            callbacks_received.fetch_add(1, std::memory_order_relaxed);
+        });
+    }
+    
+    // Step 3: Run benchmarks to demonstrate optimizations
+    std::cout << "\n=== STEP 3: Running Performance Benchmarks ===\n" << std::endl;
+    
+    // Benchmark queue performance (Week 3 optimization)
+    benchmark_queue_performance();
+    
+    // Benchmark thread pool performance (Week 3 optimization)
+    benchmark_thread_pool_performance();
+    
+    // Verify order book correctness before the timed run
+    bool checks_passed = verify_order_book_maintenance();
+    checks_passed = verify_batch_processing() && checks_passed;
+    checks_passed = verify_pool_allocator() && checks_passed;
+    checks_passed = verify_concurrent_queues() && checks_passed;
+    checks_passed = verify_work_stealing_pool() && checks_passed;
+    checks_passed = verify_ingest_pipeline() && checks_passed;
+    checks_passed = verify_latency_metrics() && checks_passed;
+    checks_passed = verify_async_logging() && checks_passed;
+    checks_passed = verify_lock_instrumentation() && checks_passed;
+    checks_passed = verify_book_snapshots() && checks_passed;
+    checks_passed = verify_async_callbacks() && checks_passed;
+    checks_passed = verify_conflation() && checks_passed;
+    checks_passed = verify_wire_format() && checks_passed;
+    checks_passed = verify_capture_replay() && checks_passed;
+    checks_passed = verify_fixed_point_prices() && checks_passed;
+    checks_passed = verify_sorting_kernels() && checks_passed;
+    checks_passed = verify_level_search() && checks_passed;
+    checks_passed = verify_benchmark_harness() && checks_passed;
+    checks_passed = verify_order_level_book() && checks_passed;
+    checks_passed = verify_thread_placement() && checks_passed;
+    checks_passed = verify_elastic_pool() && checks_passed;
+    checks_passed = verify_signal_path() && checks_passed;
+    checks_passed = verify_deadline_scheduling() && checks_passed;
+    checks_passed = verify_coroutine_executor() && checks_passed;
+    checks_passed = verify_shm_book_publication() && checks_passed;
+    checks_passed = verify_book_checkpoint() && checks_passed;
+    
+    // Step 4: Generate market updates
+    std::cout << "\n=== STEP 4: Generating Market Updates ===\n" << std::endl;
+    
+    const int NUM_UPDATES = 100;
+    std::cout << "Generating " << NUM_UPDATES << " random market updates" << std::endl;
+    std::vector<trading::MarketUpdate> updates = generate_test_market_data(NUM_UPDATES, symbols, exchanges);
+    
+    // Step 5: Process market updates
+    std::cout << "\n=== STEP 5: Processing Market Updates ===\n" << std::endl;
+    
+    size_t signals_generated = 0;
+    size_t signals_routed = 0;
+    size_t stale_evaluations = 0;
+    auto evaluation_result = [&stale_evaluations](std::future<size_t>& result) -> size_t {
+        try {
+            return result.get();
+        } catch (const std::future_error&) {
+            // Dropped by the pool: the tick was stale before the strategy could start
+            ++stale_evaluations;
+            return 0;
+        }
+    };
+    int64_t quantity_routed = 0;
+    trading::Signal last_signal;
+    
+    {
+        Timer timer("Processing market updates");
+        
+        for (const auto& update : updates) {
+            // The tick-to-signal latency starts when the update arrives
+            uint64_t received_tsc = TscClock::now();
+            
+            // Process update in market data handler
+            market_data_handler.process_update(update);
+            trading::MarketTick tick{market_data_handler.symbol_id(update.symbol),
+                                     market_data_handler.exchange_id(update.exchange),
+                                     update.bid_price, update.ask_price, update.volume, update.timestamp};
+            
+            // Evaluate strategies in parallel using thread pool; an evaluation
+            // that can't start before the tick goes stale is dropped
+            trading::TaskDeadline tick_deadline = trading::TaskDeadline::within(STRATEGY_MAX_STALENESS, received_tsc);
+            auto strategy1_future = strategy_thread_pool.submit_with_deadline(
+                strategy1.priority(), tick_deadline,
+                [&strategy1, &tick, received_tsc, &strategy1_signals]() {
+                    return strategy1.evaluate(tick, received_tsc, strategy1_signals);
+                }
+            );
+            
+            auto strategy2_future = strategy_thread_pool.submit_with_deadline(
+                strategy2.priority(), tick_deadline,
+                [&strategy2, &tick, received_tsc, &strategy2_signals]() {
+                    return strategy2.evaluate(tick, received_tsc, strategy2_signals);
+                }
+            );
+            
+            auto strategy3_future = strategy_thread_pool.submit_with_deadline(
+                strategy3.priority(), tick_deadline,
+                [&strategy3, &tick, received_tsc, &strategy3_signals]() {
+                    return strategy3.evaluate(tick, received_tsc, strategy3_signals);
+                }
+            );
+            
+            // Wait for strategies to complete and count signals
+            signals_generated += evaluation_result(strategy1_future);
+            signals_generated += evaluation_result(strategy2_future);
+            signals_generated += evaluation_result(strategy3_future);
+            
+            // Execution stage: take the signals in batches, as an order router would
+            signals_routed += signal_router.drain([&](std::span<const trading::Signal> batch) {
+                for (const trading::Signal& signal : batch) {
+                    quantity_routed += signal.quantity;
+                }
+                last_signal = batch.back();
+            });
+        }
+    }
+    
+    // Step 6: Print results
+    std::cout << "\n=== STEP 6: Results ===\n" << std::endl;
+    
+    // Get metrics from market data handler
+    trading::MarketDataMetricsResult metrics = market_data_handler.get_metrics();
+    
+    std::cout << "Market updates processed: " << metrics.total_updates_processed << std::endl;
+    std::cout << "Updates dropped: " << metrics.total_updates_dropped << std::endl;
+    for (const auto& exchange : exchanges) {
+        const auto& latency = metrics.latency[exchange];
+        std::cout << "  " << exchange << " book update latency: p50 " << latency.book_update.p50_us
+                  << " μs, p99 " << latency.book_update.p99_us << " μs, p99.9 " << latency.book_update.p999_us
+                  << " μs, max " << latency.book_update.max_us << " μs (" << latency.book_update.count
+                  << " updates, " << latency.throughput_mps << " msg/s)" << std::endl;
+    }
+    for (const auto& lock : metrics.locks) {
+        std::cout << "  Lock " << lock.name << ": " << lock.acquisitions << " acquisitions, "
+                  << lock.contentions << " contended, " << lock.wait_time_ns << " ns waiting, hold p99 "
+                  << lock.hold_time.p99_us << " μs" << std::endl;
+    }
+    std::cout << "Callbacks received: " << callbacks_received.load() << std::endl;
+    std::cout << "Trading signals generated: " << signals_generated << std::endl;
+    
+    // Every signal went through a strategy ring to the execution stage
+    size_t signals_dropped = 0;
+    for (const auto& channel : signal_router.channels()) {
+        signals_dropped += channel->dropped();
+    }
+    std::cout << "Trading signals routed: " << signals_routed << " (" << quantity_routed
+              << " shares, dropped on full ring: " << signals_dropped << ")" << std::endl;
+    if (signals_routed > 0) {
+        // Text only for the drop copy, after execution has seen the signal
+        std::string symbol;
+        for (const auto& update : updates) {
+            if (market_data_handler.symbol_id(update.symbol) == last_signal.symbol_id) {
+                symbol = update.symbol;
+                break;
+            }
+        }
+        std::cout << "Last signal routed: "
+                  << trading::format_signal(last_signal, strategies_by_id[last_signal.strategy_id]->name(), symbol)
+                  << std::endl;
+    }
+    trading::LatencySummary to_signal = signal_router.tick_to_signal();
+    trading::LatencySummary to_execution = signal_router.tick_to_execution();
+    std::cout << "Tick-to-signal latency: p50 " << to_signal.p50_us << " μs, p99 " << to_signal.p99_us
+              << " μs; tick-to-execution: p50 " << to_execution.p50_us << " μs, p99 " << to_execution.p99_us
+              << " μs (" << to_execution.count << " signals)" << std::endl;
+    if (signals_routed + signals_dropped != signals_generated) {
+        std::cout << "  [FAIL] every generated signal is routed or counted as dropped" << std::endl;
+        checks_passed = false;
+    }
+    
+    // Print strategy statistics
+    std::cout << "\nStrategy Statistics:" << std::endl;
+    strategy1.print_stats();
+    strategy2.print_stats();
+    strategy3.print_stats();
+    
+    // Print thread pool statistics
+    std::cout << "\nThread Pool Statistics:" << std::endl;
+    std::cout << "Total tasks completed: " << strategy_thread_pool.total_tasks_completed() << std::endl;
+    trading::ThreadPoolStats pool_stats = strategy_thread_pool.get_stats();
+    std::cout << "Evaluations dropped on stale ticks: " << stale_evaluations << " of " << pool_stats.deadline_tasks
+              << " (deadline misses: " << pool_stats.deadline_misses << ", aged: " << pool_stats.aged_tasks << ")"
+              << std::endl;
+    
+    // Display order books for each symbol
+    std::cout << "\nOrder Books:" << std::endl;
+    
+    for (const auto& symbol : symbols) {
+        std::cout << "Symbol: " << symbol << std::endl;
+        
+        // Get top bids and asks
+        auto order_book = market_data_handler.get_order_book(symbol);
+        
+        std::cout << "  Top Bids:" << std::endl;
+        for (const auto& bid : order_book.bids) {
+            std::cout << "    " << bid.price.to_double() << " x " << bid.volume << std::endl;
+        }
+        
+        std::cout << "  Top Asks:" << std::endl;
+        for (const auto& ask : order_book.asks) {
+            std::cout << "    " << ask.price.to_double() << " x " << ask.volume << std::endl;
+        }
+        
+        std::cout << std::endl;
+    }
+    
+    if (!checks_passed) {
+        std::cout << "Test FAILED: correctness checks did not pass" << std::endl;
+        return 1;
     }
     
     std::cout << "Test completed successfully!" << std::endl;
@@ -0,0 +1,206 @@
+#include "../include/logger.hpp"
+
+#include <algorithm>
+#include <cinttypes>
+#include <cstdio>
+
+// The macros and record capture live in the header; the per-thread rings,
+// the background writer and formatting are implemented here.
+
+namespace trading {
+
+namespace {
+
+// How long the writer sleeps between drains when nobody asks for a flush
+constexpr std::chrono::milliseconds WRITER_INTERVAL(1);
+
+const char* level_name(LogLevel level) {
+    switch (level) {
+        case LogLevel::TRACE: return "TRACE";
+        case LogLevel::DEBUG: return "DEBUG";
+        case LogLevel::INFO: return "INFO";
+        case LogLevel::WARN: return "WARN";
+        case LogLevel::ERROR: return "ERROR";
+        default: return "OFF";
+    }
+}
+
+void write_stdout(LogLevel level, std::string_view line) {
+    std::fprintf(stdout, "[%s] %.*s\n", level_name(level), static_cast<int>(line.size()), line.data());
+}
+
+} // namespace
+
+Logger& Logger::instance() {
+    static Logger logger;
+    return logger;
+}
+
+Logger::Logger()
+    : level_(LogLevel::INFO), dropped_records_(0),
+      sink_(write_stdout), sink_is_stdout_(true), flush_requested_(0), flush_completed_(0), stop_(false) {
+    writer_ = std::thread([this] {
+        writer_function();
+    });
+}
+
+Logger::~Logger() {
+    {
+        std::lock_guard<std::mutex> lock(writer_mutex_);
+        stop_ = true;
+    }
+    writer_condition_.notify_all();
+    writer_.join();
+}
+
+void Logger::set_sink(Sink sink) {
+    std::lock_guard<std::mutex> lock(sink_mutex_);
+    sink_is_stdout_ = !sink;
+    sink_ = sink ? std::move(sink) : Sink(write_stdout);
+}
+
+void Logger::flush() {
+    if (std::this_thread::get_id() == writer_.get_id()) {
+        // A sink flushing: the records are being written by this very thread
+        return;
+    }
+    std::unique_lock<std::mutex> lock(writer_mutex_);
+    uint64_t target = ++flush_requested_;
+    writer_condition_.notify_all();
+    writer_condition_.wait(lock, [this, target] {
+        return flush_completed_ >= target;
+    });
+}
+
+Logger::ThreadRing& Logger::thread_ring() {
+    // Holds this thread's ring; marks it retired on thread exit so the
+    // writer can free it once it is empty
+    struct Handle {
+        std::shared_ptr<ThreadRing> ring;
+
+        ~Handle() {
+            if (ring != nullptr) {
+                ring->retired.store(true, std::memory_order_release);
+            }
+        }
+    };
+    thread_local Handle handle;
+
+    if (handle.ring == nullptr) {
+        handle.ring = std::make_shared<ThreadRing>();
+        std::lock_guard<std::mutex> lock(rings_mutex_);
+        rings_.push_back(handle.ring);
+    }
+    return *handle.ring;
+}
+
+void Logger::submit(const LogRecord& record) {
+    if (!thread_ring().ring.try_push(record)) {
+        dropped_records_.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+void Logger::writer_function() {
+    std::vector<LogRecord> batch;
+    batch.reserve(LOG_RING_CAPACITY);
+
+    while (true) {
+        uint64_t requested;
+        bool stopping;
+        {
+            std::unique_lock<std::mutex> lock(writer_mutex_);
+            writer_condition_.wait_for(lock, WRITER_INTERVAL, [this] {
+                return stop_ || flush_requested_ > flush_completed_;
+            });
+            requested = flush_requested_;
+            stopping = stop_;
+        }
+
+        // Everything pushed before the flush request is visible now
+        drain(batch);
+
+        {
+            std::lock_guard<std::mutex> lock(writer_mutex_);
+            flush_completed_ = requested;
+        }
+        writer_condition_.notify_all();
+
+        if (stopping) {
+            break;
+        }
+    }
+}
+
+size_t Logger::drain(std::vector<LogRecord>& batch) {
+    batch.clear();
+
+    {
+        std::lock_guard<std::mutex> lock(rings_mutex_);
+        for (auto it = rings_.begin(); it != rings_.end();) {
+            ThreadRing& thread_ring = **it;
+
+            // Read the flag before draining: a retired ring gets no more pushes
+            bool retired = thread_ring.retired.load(std::memory_order_acquire);
+            LogRecord record;
+            while (thread_ring.ring.try_pop(record)) {
+                batch.push_back(record);
+            }
+            it = retired ? rings_.erase(it) : it + 1;
+        }
+    }
+
+    if (batch.empty()) {
+        return 0;
+    }
+
+    // Each ring is already in order; merge the threads by capture time
+    std::stable_sort(batch.begin(), batch.end(), [](const LogRecord& a, const LogRecord& b) {
+        return a.timestamp_ns < b.timestamp_ns;
+    });
+
+    // Not under writer_mutex_, so the sink may call back into the logger
+    std::lock_guard<std::mutex> lock(sink_mutex_);
+    for (const LogRecord& record : batch) {
+        sink_(record.format->level, format(record));
+    }
+    if (sink_is_stdout_) {
+        std::fflush(stdout);
+    }
+    return batch.size();
+}
+
+std::string Logger::format(const LogRecord& record) {
+    std::string line;
+    size_t next_arg = 0;
+    char number[32];
+
+    for (const char* p = record.format->text; *p != '\0'; ++p) {
+        if (p[0] != '{' || p[1] != '}' || next_arg >= record.arg_count) {
+            line.push_back(*p);
+            continue;
+        }
+
+        const LogArg& arg = record.args[next_arg++];
+        switch (arg.type) {
+            case LogArg::Type::INT:
+                std::snprintf(number, sizeof(number), "%" PRId64, arg.i);
+                line += number;
+                break;
+            case LogArg::Type::UINT:
+                std::snprintf(number, sizeof(number), "%" PRIu64, arg.u);
+                line += number;
+                break;
+            case LogArg::Type::DOUBLE:
+                std::snprintf(number, sizeof(number), "%g", arg.d);
+                line += number;
+                break;
+            case LogArg::Type::STRING:
+                line += arg.s;
+                break;
+        }
+        ++p;
+    }
+    return line;
+}
+
+} // namespace trading
@@ -1,293 +1,1129 @@
 #include "../include/market_data_handler.hpp"
+#include "../include/book_checkpoint.hpp"
+#include "../include/capture_replay.hpp"
+#include "../include/logger.hpp"
 #include "../include/order_book_allocator.hpp"
+#include "../include/shm_book.hpp"
 #include <algorithm>
 #include <thread>
 #include <mutex>
-#include <iostream>
-#include <iomanip>
-
-// Import Week 1 sorting algorithm (simulated)
-namespace week1 {
-    // This represents a custom optimized quick sort algorithm from Week 1
-    // In a real implementation, this would be a highly optimized sorting algorithm
-    // specialized for financial data with performance improvements like:
-    // - Pivot selection optimization for financial time series data
-    // - Early termination for nearly-sorted data (common in market updates)
-    // - Cache-friendly memory access patterns
-    template<typename Iterator, typename Compare>
-    void quick_sort(Iterator begin, Iterator end, Compare comp) {
-        // For demonstration purposes, we use std::sort as a placeholder
-        // In a real Week 1 implementation, this would be a custom implementation
-        std::sort(begin, end, comp);
-        
-        // In a real implementation, we would log performance metrics here:
-        // std::cout << "Week 1 sorting completed: " << (end - begin) << " elements" << std::endl;
-    }
-}
-
-// Import Week 2 memory management (simulated)
-namespace week2 {
-    // Simulated OrderBookAllocator from Week 2
-    // In a real implementation, this would be a specialized allocator with:
-    // - Fast allocation for fixed-size OrderBook objects
-    // - Memory pooling to reduce fragmentation
-    // - NUMA-aware allocation for multi-socket systems
-    // - Minimal lock contention for concurrent access
-    class OrderBookAllocator {
-    public:
-        OrderBookAllocator(size_t max_orders) : max_orders_(max_orders) {
-            std::cout << "Week 2 optimization: Initializing OrderBookAllocator with capacity for " 
-                      << max_orders << " orders" << std::endl;
-            // In a real implementation, we would pre-allocate memory pools here
-        }
-        
-        void* allocate(size_t size) {
-            // For demonstration purposes, we use operator new
-            // In a real Week 2 implementation, this would allocate from a memory pool
-            allocation_count_++;
-            total_allocated_ += size;
-            
-            // In a real implementation, we would use a custom memory pool
-            void* ptr = ::operator new(size);
-            
-            // Log allocation for demonstration purposes
-            std::cout << "Week 2 optimization: Allocated " << size << " bytes (total: " 
-                      << total_allocated_ << " bytes in " << allocation_count_ << " allocations)" << std::endl;
-            
-            return ptr;
-        }
-        
-        void deallocate(void* ptr) {
-            deallocation_count_++;
-            // For demonstration purposes, we use operator delete
-            // In a real Week 2 implementation, this would return memory to the pool
-            ::operator delete(ptr);
-            
-            // Log deallocation for demonstration purposes
-            std::cout << "Week 2 optimization: Deallocated memory (total deallocations: " 
-                      << deallocation_count_ << ")" << std::endl;
-        }
-        
-    private:
-        size_t max_orders_;
-        size_t allocation_count_ = 0;
-        size_t deallocation_count_ = 0;
-        size_t total_allocated_ = 0;
-    };
-}
 
 namespace trading {
 
+namespace {
+
+// Smallest power of two >= n (and at least 1), so shard selection is a mask
+size_t round_up_to_power_of_two(size_t n) {
+    size_t result = 1;
+    while (result < n) {
+        result <<= 1;
+    }
+    return result;
+}
+
+// Ticks pulled from a feed, or drained from one ingest ring, per iteration
+constexpr size_t INGEST_BATCH_SIZE = 64;
+
+// How long a blocking exchange thread waits before re-checking for stop()
+constexpr std::chrono::microseconds FEED_RECEIVE_TIMEOUT(1000);
+
+// Empty polls a book worker spins through before it starts sleeping
+constexpr int WORKER_IDLE_SPINS = 1024;
+
+// ASYNC callbacks one strand task runs before yielding the pool thread
+constexpr size_t STRAND_BATCH_SIZE = 64;
+
+// Per-thread scratch object, so steady-state batches don't allocate. A
+// callback that feeds the handler again runs a nested call, which gets a
+// fresh object instead of clearing the one the outer call is still using
+template<typename T>
+class ScratchLease {
+public:
+    ScratchLease() : scratch_(depth()++ == 0 ? &outer() : &nested_) {}
+    
+    ~ScratchLease() {
+        --depth();
+    }
+    
+    ScratchLease(const ScratchLease&) = delete;
+    ScratchLease& operator=(const ScratchLease&) = delete;
+    
+    T& operator*() const {
+        return *scratch_;
+    }
+    
+    T* operator->() const {
+        return scratch_;
+    }
+    
+private:
+    static int& depth() {
+        thread_local int calls = 0;
+        return calls;
+    }
+    
+    static T& outer() {
+        thread_local T scratch;
+        return scratch;
+    }
+    
+    T nested_;
+    T* scratch_;
+};
+
+} // namespace
+
+struct MarketDataHandler::BatchScratch {
+    std::vector<uint32_t> order;
+    std::vector<const MarketTickCallback*> callbacks;
+    std::vector<std::shared_ptr<const Subscription>> pinned;
+    std::vector<CallbackStrand*> strands;
+    std::vector<TickAwaiter*> waiters;
+};
+
 // Constructor
-MarketDataHandler::MarketDataHandler(size_t max_symbols) 
+MarketDataHandler::MarketDataHandler(size_t max_symbols, size_t book_depth,
+                                     size_t num_lock_shards) 
     : max_symbols_(max_symbols), 
+      book_depth_(std::clamp<size_t>(book_depth, 1, MAX_BOOK_DEPTH)),
       running_(false),
-      order_book_allocator_(std::make_shared<week2::OrderBookAllocator>(1000)) {
+      workers_running_(false),
+      symbols_(max_symbols),
+      exchanges_(MAX_EXCHANGES),
+      books_(max_symbols),
+      book_locks_(round_up_to_power_of_two(num_lock_shards)),
+      lock_shard_mask_(book_locks_.size() - 1),
+      conflated_symbols_(max_symbols),
+      order_book_allocator_(std::make_shared<week2::OrderBookAllocator>(
+          max_symbols, sizeof(PriceLevelBook))) {
     
-    std::cout << "Week 3 optimization: Creating thread-safe MarketDataHandler with capacity for " 
-              << max_symbols << " symbols" << std::endl;
+    TRADING_LOG_INFO("Week 3 optimization: Creating thread-safe MarketDataHandler with capacity for {} symbols",
+                     max_symbols);
     
-    // Pre-allocate maps to avoid reallocations during high-frequency trading
-    // This is an important optimization to minimize memory allocations during trading
-    order_books_.reserve(max_symbols);
-    callbacks_.reserve(max_symbols);
+    placement_.exchanges.name = "md";
+    placement_.book_workers.name = "book";
     
-    std::cout << "Week 3 optimization: Pre-allocated maps to avoid reallocations during trading" 
-              << std::endl;
+    // Books, callbacks and metrics are flat arrays indexed by interned ID,
+    // sized up front so they never reallocate during trading
+    TRADING_LOG_INFO("Week 3 optimization: Pre-allocated ID-indexed book slots to avoid reallocations during trading");
+    TRADING_LOG_INFO("Week 3 optimization: Striping order book locks across {} shards", book_locks_.size());
 }
 
 // Destructor
 MarketDataHandler::~MarketDataHandler() {
     stop();
-    std::cout << "MarketDataHandler destroyed with final metrics:" << std::endl;
+    
+    // Strand tasks still on the callback pool refer to this handler
+    flush_callbacks();
+    TRADING_LOG_INFO("MarketDataHandler destroyed with final metrics:");
     
     auto metrics = get_metrics();
-    std::cout << "  Total updates processed: " << metrics.total_updates_processed << std::endl;
-    std::cout << "  Total updates dropped: " << metrics.total_updates_dropped << std::endl;
-    std::cout << "  Lock contentions: " << metrics.lock_contentions << std::endl;
+    TRADING_LOG_INFO("  Total updates processed: {}", metrics.total_updates_processed);
+    TRADING_LOG_INFO("  Total updates dropped: {}", metrics.total_updates_dropped);
+    TRADING_LOG_INFO("  Lock contentions: {}", metrics.lock_contentions);
+    
+    // Return the books to the Week 2 allocators; order-level books first, they update their L2 book
+    for (auto& slot : books_) {
+        slot.orders.reset();
+    }
+    for (auto& slot : books_) {
+        PriceLevelBook* book = slot.book.load(std::memory_order_relaxed);
+        if (book != nullptr) {
+            book->~PriceLevelBook();
+            order_book_allocator_->deallocate(book);
+        }
+    }
 }
 
 // Add exchange
 bool MarketDataHandler::add_exchange(const std::string& exchange_name) {
+    return add_exchange_impl(exchange_name, nullptr, FeedWaitMode::BLOCKING);
+}
+
+// Add exchange with a feed
+bool MarketDataHandler::add_exchange(const std::string& exchange_name,
+                                     std::unique_ptr<FeedSource> source, FeedWaitMode wait_mode) {
+    return add_exchange_impl(exchange_name, std::move(source), wait_mode);
+}
+
+// Shared exchange registration
+bool MarketDataHandler::add_exchange_impl(const std::string& exchange_name,
+                                          std::unique_ptr<FeedSource> source,
+                                          FeedWaitMode wait_mode) {
     // Use lock guard for thread safety - Week 3 optimization
     // This ensures thread-safe access to the exchanges map
-    std::lock_guard<std::mutex> lock(exchanges_mutex_);
+    std::lock_guard<InstrumentedMutex> lock(exchanges_mutex_);
     
-    std::cout << "Week 3 optimization: Thread-safe exchange registration for " 
-              << exchange_name << std::endl;
+    TRADING_LOG_INFO("Week 3 optimization: Thread-safe exchange registration for {}", exchange_name);
     
     // Check if exchange already exists
-    if (exchange_threads_.find(exchange_name) != exchange_threads_.end()) {
+    if (exchange_feeds_.find(exchange_name) != exchange_feeds_.end()) {
+        return false;
+    }
+    
+    // Intern the name so ticks can refer to the exchange by ID
+    ExchangeId id = exchanges_.intern(exchange_name);
+    if (id == INVALID_EXCHANGE_ID) {
         return false;
     }
     
     // Add to known exchanges
-    exchange_threads_[exchange_name] = std::thread();
-    metrics_.avg_latency_us[exchange_name] = 0.0;
-    metrics_.throughput_mps[exchange_name] = 0.0;
+    ExchangeFeed& feed = exchange_feeds_[exchange_name];
+    feed.id = id;
+    feed.source = std::move(source);
+    feed.wait_mode = wait_mode;
     
     return true;
 }
 
 // Subscribe to market data
-bool MarketDataHandler::subscribe(const std::string& symbol, MarketDataCallback callback) {
-    // Use unique_lock for shared_mutex - Week 3 optimization
-    // This allows for concurrent reads but exclusive writes
-    std::unique_lock<std::shared_mutex> lock(books_mutex_);
+bool MarketDataHandler::subscribe(const std::string& symbol, MarketDataCallback callback,
+                                  CallbackDispatch dispatch) {
+    // Adapt the named callback to the tick path: names are resolved only
+    // for subscribers that ask for a MarketUpdate
+    auto subscription = std::make_shared<const Subscription>(Subscription{
+        [this, callback = std::move(callback)](const MarketTick& tick) {
+            callback(to_market_update(tick));
+        },
+        dispatch});
     
-    std::cout << "Week 3 optimization: Thread-safe subscription for symbol " 
-              << symbol << std::endl;
+    return subscribe_impl(symbol, std::move(subscription));
+}
+
+// Subscribe to ID-keyed market data
+bool MarketDataHandler::subscribe_ticks(const std::string& symbol, MarketTickCallback callback,
+                                        CallbackDispatch dispatch) {
+    return subscribe_impl(symbol, std::make_shared<const Subscription>(Subscription{std::move(callback), dispatch}));
+}
+
+// Set the pool for ASYNC callbacks
+bool MarketDataHandler::set_callback_pool(ThreadPool& pool, int priority) {
+    std::lock_guard<InstrumentedMutex> lock(books_mutex_);
+    if (callback_pool_ != nullptr) {
+        return false;
+    }
     
-    // Check if we have capacity
-    if (order_books_.size() >= max_symbols_) {
+    // Published to the tick path through books_mutex_ and the stripe lock
+    // taken by the first ASYNC subscribe()
+    callback_pool_ = &pool;
+    callback_priority_ = priority;
+    return true;
+}
+
+// Set the capture the exchange threads record to
+bool MarketDataHandler::set_capture(CaptureWriter* capture) {
+    std::lock_guard<InstrumentedMutex> lock(exchanges_mutex_);
+    if (running_) {
         return false;
     }
     
-    // Add to order books if not exists
-    if (order_books_.find(symbol) == order_books_.end()) {
-        OrderBook book;
-        book.symbol = symbol;
-        book.timestamp = std::chrono::nanoseconds(0);
-        
-        std::cout << "Week 2 optimization: Using custom allocator for OrderBook " 
-                  << symbol << std::endl;
-        
-        // Use the OrderBookAllocator from Week 2 to allocate memory
-        // This is a critical optimization from Week 2 that ensures efficient memory usage
-        void* memory = order_book_allocator_->allocate(sizeof(OrderBook));
-        OrderBook* new_book = new (memory) OrderBook(book);
-        
-        order_books_[symbol] = *new_book;
+    // Published to the exchange threads by std::thread's construction in start()
+    capture_ = capture;
+    return true;
+}
+
+// Publish the books into shared memory too
+void MarketDataHandler::set_shm_publisher(ShmBookPublisher* publisher) {
+    // Books are only created under books_mutex_, so none is missed below
+    std::lock_guard<InstrumentedMutex> lock(books_mutex_);
+    shm_publisher_.store(publisher, std::memory_order_relaxed);
+    
+    // Taking each stripe waits out publishes still using the previous
+    // publisher; the stripe also orders the new one before later publishes
+    for (size_t id = 0; id < symbols_.size(); ++id) {
+        std::lock_guard<InstrumentedSpinLock> guard(book_lock(static_cast<SymbolId>(id)));
+        PriceLevelBook* book = books_[id].book.load(std::memory_order_relaxed);
+        if (publisher != nullptr && book != nullptr) {
+            publish_snapshot(static_cast<SymbolId>(id), *book);
+        }
+    }
+}
+
+// Shared subscription logic
+bool MarketDataHandler::subscribe_impl(const std::string& symbol,
+                                       std::shared_ptr<const Subscription> subscription) {
+    // Serialize subscription changes - Week 3 optimization
+    // The tick path never takes this lock
+    std::lock_guard<InstrumentedMutex> lock(books_mutex_);
+    
+    TRADING_LOG_INFO("Week 3 optimization: Thread-safe subscription for symbol {}", symbol);
+    
+    bool async = subscription->dispatch == CallbackDispatch::ASYNC;
+    bool conflated = subscription->dispatch == CallbackDispatch::CONFLATED;
+    if ((async || conflated) && callback_pool_ == nullptr) {
+        TRADING_LOG_WARN("Pool-dispatched subscription for {} needs set_callback_pool() first", symbol);
+        return false;
+    }
+    
+    // Intern the symbol; fails if we are at capacity
+    SymbolId id = symbols_.intern(symbol);
+    if (id == INVALID_SYMBOL_ID) {
+        return false;
+    }
+    
+    BookSlot& slot = books_[id];
+    
+    // The strand and conflated state are created before the subscription
+    // that uses them is published
+    if (async && slot.strand == nullptr) {
+        slot.strand = std::make_unique<CallbackStrand>();
+    }
+    if (conflated && slot.conflated == nullptr) {
+        slot.conflated = std::make_unique<ConflatedState>();
     }
     
+    // Create the order book if not exists
+    PriceLevelBook* book = create_book(id, symbol);
+    
     // Register callback
-    callbacks_[symbol] = callback;
+    {
+        std::lock_guard<InstrumentedSpinLock> guard(book_lock(id));
+        slot.subscription.swap(subscription);
+        publish_snapshot(id, *book);
+    }
     
+    // Any previous callback is released here, outside the spinlock
     return true;
 }
 
+// Create a symbol's book on first use
+PriceLevelBook* MarketDataHandler::create_book(SymbolId symbol_id, const std::string& symbol) {
+    BookSlot& slot = books_[symbol_id];
+    PriceLevelBook* book = slot.book.load(std::memory_order_relaxed);
+    if (book == nullptr) {
+        TRADING_LOG_INFO("Week 2 optimization: Using custom allocator for OrderBook {}", symbol);
+        
+        // Construct the book directly in a block from the Week 2 slab
+        // The slab is sized for max_symbols books, so this never hits the system allocator
+        void* memory = order_book_allocator_->allocate(sizeof(PriceLevelBook));
+        book = new (memory) PriceLevelBook(book_depth_);
+        book->symbol = symbol;
+        
+        // Publish the fully constructed book to the tick path
+        slot.book.store(book, std::memory_order_release);
+    }
+    return book;
+}
+
 // Unsubscribe from market data
 bool MarketDataHandler::unsubscribe(const std::string& symbol) {
-    // Use unique_lock for shared_mutex - Week 3 optimization
-    std::unique_lock<std::shared_mutex> lock(books_mutex_);
+    std::lock_guard<InstrumentedMutex> lock(books_mutex_);
     
-    auto it = callbacks_.find(symbol);
-    if (it == callbacks_.end()) {
+    SymbolId id = symbols_.find(symbol);
+    if (id == INVALID_SYMBOL_ID) {
         return false;
     }
     
-    callbacks_.erase(it);
-    return true;
+    // Take the callback out under the stripe lock, destroy it outside
+    std::shared_ptr<const Subscription> subscription;
+    {
+        std::lock_guard<InstrumentedSpinLock> guard(book_lock(id));
+        subscription.swap(books_[id].subscription);
+    }
+    
+    return subscription != nullptr;
 }
 
 // Process market update
 void MarketDataHandler::process_update(const MarketUpdate& update) {
-    // Start performance measurement
-    auto start_time = std::chrono::high_resolution_clock::now();
+    // Resolve names to IDs - this is the only string hashing on this path
+    SymbolId symbol_id = symbols_.find(update.symbol);
+    if (symbol_id == INVALID_SYMBOL_ID) {
+        // No order book for this symbol
+        metrics_.total_updates_dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    
+    // Only add_exchange() registers exchanges; updates from unknown ones
+    // carry INVALID_EXCHANGE_ID and are left out of the per-exchange metrics
+    MarketTick tick;
+    tick.symbol_id = symbol_id;
+    tick.exchange_id = exchanges_.find(update.exchange);
+    tick.bid_price = update.bid_price;
+    tick.ask_price = update.ask_price;
+    tick.volume = update.volume;
+    tick.timestamp = update.timestamp;
     
-    // Use a reader-writer lock pattern - Week 3 optimization
-    // This allows multiple readers to access the order book concurrently
-    // but ensures exclusive access when updating
-    std::shared_lock<std::shared_mutex> read_lock(books_mutex_);
+    process_update(tick);
+}
+
+// Process ID-keyed market update
+void MarketDataHandler::process_update(const MarketTick& tick) {
+    // Start performance measurement
+    auto start_time = std::chrono::steady_clock::now();
     
-    auto book_it = order_books_.find(update.symbol);
-    if (book_it == order_books_.end()) {
+    // Direct array lookup by interned ID - Week 3 optimization
+    PriceLevelBook* book = tick.symbol_id < books_.size()
+        ? books_[tick.symbol_id].book.load(std::memory_order_acquire)
+        : nullptr;
+    if (book == nullptr) {
         // No order book for this symbol
         metrics_.total_updates_dropped.fetch_add(1, std::memory_order_relaxed);
         return;
     }
     
-    // Upgrade to write lock - Week 3 optimization
-    // This is a critical optimization that allows readers to continue
-    // reading until we actually need to write to the order book
-    read_lock.unlock();
-    std::unique_lock<std::shared_mutex> write_lock(books_mutex_);
+    BookSlot& slot = books_[tick.symbol_id];
+    std::shared_ptr<const Subscription> subscription;
+    bool newly_dirty = false;
+    TickAwaiter* waiters = nullptr;
     
-    // Check again after acquiring write lock
-    book_it = order_books_.find(update.symbol);
-    if (book_it == order_books_.end()) {
+    {
+        // Lock only the stripe that owns this symbol - Week 3 optimization
+        // Updates to symbols on other stripes proceed in parallel
+        std::lock_guard<InstrumentedSpinLock> guard(book_lock(tick.symbol_id));
+        
+        // Update timestamp
+        book->timestamp = tick.timestamp;
+        
+        // Merge the new levels into the book in place
+        // The sides stay sorted (bids descending, asks ascending) and bounded
+        // to book_depth_ levels, so there is no re-sort or truncation per tick
+        book->bids.apply(tick.bid_price, tick.volume);
+        book->asks.apply(tick.ask_price, tick.volume);
+        publish_snapshot(tick.symbol_id, *book);
+        
+        // Pin the callback so a concurrent unsubscribe can't destroy it;
+        // ASYNC callbacks are queued here so their strand sees book order
+        subscription = slot.subscription;
+        if (subscription != nullptr && subscription->dispatch == CallbackDispatch::ASYNC) {
+            enqueue_callback(slot, subscription, tick);
+        } else if (subscription != nullptr && subscription->dispatch == CallbackDispatch::CONFLATED) {
+            newly_dirty = conflate_update(slot, tick.symbol_id, tick, 0);
+        }
+        if (slot.tick_waiters != nullptr) {
+            waiters = take_tick_waiters(slot, tick);
+        }
+    }
+    auto book_done = std::chrono::steady_clock::now();
+    wake_tick_waiters(waiters);
+    
+    bool inline_callback = false;
+    if (subscription == nullptr) {
+        // No subscriber
+    } else if (subscription->dispatch == CallbackDispatch::ASYNC) {
+        schedule_strand(slot.strand.get());
+    } else if (subscription->dispatch == CallbackDispatch::CONFLATED) {
+        if (newly_dirty) {
+            schedule_conflation();
+        }
+    } else {
+        // Call the callback without holding the lock - Week 3 optimization
+        // This is critical for performance since callbacks might be slow
+        TRADING_LOG_TRACE("Week 3 optimization: Executing callback for {} without holding the lock",
+                          book->symbol);
+        subscription->callback(tick);
+        inline_callback = true;
+    }
+    
+    // Update metrics
+    auto end_time = inline_callback ? std::chrono::steady_clock::now() : book_done;
+    auto processing_time = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        end_time - start_time);
+    
+    record_latency(tick.exchange_id, 1, inline_callback ? 1 : 0, book_done - start_time,
+                   end_time - book_done, end_time);
+    metrics_.total_updates_processed.fetch_add(1, std::memory_order_relaxed);
+    
+    // Processing time for this update; compiled out unless TRADING_LOG_LEVEL is TRACE
+    TRADING_LOG_TRACE("Processed {} update in {} μs", book->symbol, processing_time.count() / 1000.0);
+}
+
+// Process an order-level message
+bool MarketDataHandler::process_order(const OrderEvent& event) {
+    auto start_time = std::chrono::steady_clock::now();
+    
+    PriceLevelBook* book = event.symbol_id < books_.size()
+        ? books_[event.symbol_id].book.load(std::memory_order_acquire)
+        : nullptr;
+    if (book == nullptr) {
         metrics_.total_updates_dropped.fetch_add(1, std::memory_order_relaxed);
-        return;
+        return false;
     }
     
-    // Update the order book
-    OrderBook& book = book_it->second;
+    // One pool for every symbol's orders, so idle handlers never reserve it
+    std::call_once(order_pool_once_, [this] {
+        order_pool_ = std::make_unique<week2::OrderBookAllocator>(TRADING_MAX_ORDERS, OrderLevelBook::NODE_SIZE);
+        order_pool_ready_.store(true, std::memory_order_seq_cst);
+        // Pairs with start(): one of the two sees the other's store and binds the pool
+        int node = book_numa_node_.load(std::memory_order_seq_cst);
+        if (node >= 0) {
+            order_pool_->bind_to_numa_node(node);
+        }
+    });
     
-    // Update timestamp
-    book.timestamp = update.timestamp;
+    BookSlot& slot = books_[event.symbol_id];
+    bool changed;
+    {
+        std::lock_guard<InstrumentedSpinLock> guard(book_lock(event.symbol_id));
+        if (slot.orders == nullptr) {
+            TRADING_LOG_INFO("Week 3 optimization: Tracking individual orders for {}", book->symbol);
+            slot.orders = std::make_unique<OrderLevelBook>(*order_pool_, book);
+        }
+        
+        // The order book updates the L2 levels it touches; nothing is re-sorted
+        changed = slot.orders->apply(event);
+        if (changed) {
+            book->timestamp = event.timestamp;
+            publish_snapshot(event.symbol_id, *book);
+        }
+    }
+    auto book_done = std::chrono::steady_clock::now();
+    
+    record_latency(event.exchange_id, 1, 0, book_done - start_time, std::chrono::nanoseconds(0), book_done);
+    metrics_.total_updates_processed.fetch_add(1, std::memory_order_relaxed);
+    return changed;
+}
+
+// Process a wire message in place
+void MarketDataHandler::process_update(const MarketUpdateView& view) {
+    process_update(view.to_tick());
+}
+
+// Process a buffer of wire messages
+size_t MarketDataHandler::process_messages(std::span<const std::byte> buffer) {
+    // Per-thread scratch buffer, so steady-state buffers don't allocate
+    ScratchLease<std::vector<MarketTick>> lease;
+    std::vector<MarketTick>& ticks = *lease;
+    ticks.clear();
     
-    // Update price levels
-    // In a real implementation, we would find the correct price level and update it
-    OrderBookEntry bid_entry{update.bid_price, update.volume};
-    OrderBookEntry ask_entry{update.ask_price, update.volume};
+    WireDecoder decoder(buffer);
+    MarketUpdateView view;
+    WireDecoder::Status status;
+    while ((status = decoder.next(view)) == WireDecoder::Status::OK) {
+        ticks.push_back(view.to_tick());
+    }
+    if (status == WireDecoder::Status::MALFORMED) {
+        TRADING_LOG_WARN("Malformed wire message at offset {}", decoder.consumed());
+    }
     
-    // Add entries if not found
-    book.bids.push_back(bid_entry);
-    book.asks.push_back(ask_entry);
+    process_updates(std::span<const MarketTick>(ticks));
+    return decoder.consumed();
+}
+
+// Process a batch of market updates
+void MarketDataHandler::process_updates(std::span<const MarketUpdate> updates) {
+    // Per-thread scratch buffer, so steady-state batches don't allocate
+    ScratchLease<std::vector<MarketTick>> lease;
+    std::vector<MarketTick>& ticks = *lease;
+    ticks.clear();
     
-    // Sort using Week 1 sorting algorithm
-    // This is a critical optimization from Week 1 that ensures
-    // efficient sorting of the order book entries
-    std::cout << "Week 1 optimization: Sorting order book for " << update.symbol << std::endl;
+    uint64_t dropped = 0;
+    for (const MarketUpdate& update : updates) {
+        SymbolId symbol_id = symbols_.find(update.symbol);
+        if (symbol_id == INVALID_SYMBOL_ID) {
+            ++dropped;
+            continue;
+        }
+        ticks.push_back(MarketTick{symbol_id, exchanges_.find(update.exchange), update.bid_price,
+                                   update.ask_price, update.volume, update.timestamp});
+    }
+    if (dropped > 0) {
+        metrics_.total_updates_dropped.fetch_add(dropped, std::memory_order_relaxed);
+    }
     
-    // Sort bids in descending order (best bid first)
-    week1::quick_sort(book.bids.begin(), book.bids.end(), 
-        [](const OrderBookEntry& a, const OrderBookEntry& b) { 
-            return a.price > b.price; // Descending for bids
-        });
+    process_updates(std::span<const MarketTick>(ticks));
+}
+
+// Process a batch of ID-keyed market updates
+void MarketDataHandler::process_updates(std::span<const MarketTick> ticks) {
+    if (ticks.empty()) {
+        return;
+    }
     
-    // Sort asks in ascending order (best ask first)
-    week1::quick_sort(book.asks.begin(), book.asks.end(), 
-        [](const OrderBookEntry& a, const OrderBookEntry& b) { 
-            return a.price < b.price; // Ascending for asks
-        });
+    // The clock is read three times per batch (start, books applied,
+    // callbacks done) instead of three times per update
+    auto start_time = std::chrono::steady_clock::now();
     
-    // Maintain limited size - optimization to avoid growing too large
-    const size_t MAX_LEVELS = 10;
-    if (book.bids.size() > MAX_LEVELS) {
-        book.bids.resize(MAX_LEVELS);
+    // Group the batch by symbol, keeping arrival order within each symbol
+    ScratchLease<BatchScratch> scratch;
+    std::vector<uint32_t>& order = scratch->order;
+    std::vector<const MarketTickCallback*>& callbacks = scratch->callbacks;
+    std::vector<std::shared_ptr<const Subscription>>& pinned = scratch->pinned;
+    std::vector<CallbackStrand*>& strands = scratch->strands;
+    std::vector<TickAwaiter*>& waiters = scratch->waiters;
+    order.resize(ticks.size());
+    callbacks.assign(ticks.size(), nullptr);
+    pinned.clear();
+    strands.clear();
+    waiters.clear();
+    bool conflation_pending = false;
+    for (uint32_t i = 0; i < order.size(); ++i) {
+        order[i] = i;
     }
-    if (book.asks.size() > MAX_LEVELS) {
-        book.asks.resize(MAX_LEVELS);
+    std::sort(order.begin(), order.end(), [&ticks](uint32_t a, uint32_t b) {
+        return ticks[a].symbol_id != ticks[b].symbol_id ? ticks[a].symbol_id < ticks[b].symbol_id
+                                                        : a < b;
+    });
+    
+    // Per-exchange update and callback counts, for attributing the batch's latency
+    uint32_t exchange_updates[MAX_EXCHANGES] = {};
+    uint32_t exchange_callbacks[MAX_EXCHANGES] = {};
+    
+    uint64_t processed = 0;
+    uint64_t dropped = 0;
+    for (size_t begin = 0; begin < order.size();) {
+        SymbolId symbol_id = ticks[order[begin]].symbol_id;
+        size_t end = begin + 1;
+        while (end < order.size() && ticks[order[end]].symbol_id == symbol_id) {
+            ++end;
+        }
+        
+        PriceLevelBook* book = symbol_id < books_.size()
+            ? books_[symbol_id].book.load(std::memory_order_acquire)
+            : nullptr;
+        if (book == nullptr) {
+            dropped += end - begin;
+            begin = end;
+            continue;
+        }
+        
+        BookSlot& slot = books_[symbol_id];
+        std::shared_ptr<const Subscription> subscription;
+        {
+            // One stripe acquisition for the symbol's whole group - Week 3 optimization
+            std::lock_guard<InstrumentedSpinLock> guard(book_lock(symbol_id));
+            for (size_t i = begin; i < end; ++i) {
+                const MarketTick& tick = ticks[order[i]];
+                book->timestamp = tick.timestamp;
+                book->bids.apply(tick.bid_price, tick.volume);
+                book->asks.apply(tick.ask_price, tick.volume);
+            }
+            // Readers see the group's final state; one snapshot write per group
+            publish_snapshot(symbol_id, *book);
+            subscription = slot.subscription;
+            if (subscription != nullptr && subscription->dispatch == CallbackDispatch::ASYNC) {
+                for (size_t i = begin; i < end; ++i) {
+                    enqueue_callback(slot, subscription, ticks[order[i]]);
+                }
+            } else if (subscription != nullptr && subscription->dispatch == CallbackDispatch::CONFLATED) {
+                // Only the group's last update can be delivered
+                conflation_pending = conflate_update(slot, symbol_id, ticks[order[end - 1]], end - begin - 1) ||
+                                     conflation_pending;
+            }
+            if (slot.tick_waiters != nullptr) {
+                waiters.push_back(take_tick_waiters(slot, ticks[order[end - 1]]));
+            }
+        }
+        
+        bool inline_callback = subscription != nullptr && subscription->dispatch == CallbackDispatch::INLINE;
+        for (size_t i = begin; i < end; ++i) {
+            ExchangeId exchange_id = ticks[order[i]].exchange_id;
+            if (exchange_id < MAX_EXCHANGES) {
+                ++exchange_updates[exchange_id];
+                exchange_callbacks[exchange_id] += inline_callback ? 1 : 0;
+            }
+        }
+        if (inline_callback) {
+            for (size_t i = begin; i < end; ++i) {
+                callbacks[order[i]] = &subscription->callback;
+            }
+            pinned.push_back(std::move(subscription));
+        } else if (subscription != nullptr && subscription->dispatch == CallbackDispatch::ASYNC) {
+            strands.push_back(slot.strand.get());
+        }
+        processed += end - begin;
+        begin = end;
     }
+    auto book_done = std::chrono::steady_clock::now();
     
-    // Release lock to call the callback - Week 3 optimization
-    // This is critical for performance since callbacks might be slow
-    // and we don't want to hold the lock while executing them
-    write_lock.unlock();
+    // Hand the ASYNC groups and waiting coroutines to their pools, then run the inline callbacks
+    for (CallbackStrand* strand : strands) {
+        schedule_strand(strand);
+    }
+    for (TickAwaiter* symbol_waiters : waiters) {
+        wake_tick_waiters(symbol_waiters);
+    }
+    if (conflation_pending) {
+        schedule_conflation();
+    }
     
-    // Call the callback if registered
-    auto callback_it = callbacks_.find(update.symbol);
-    if (callback_it != callbacks_.end()) {
-        std::cout << "Week 3 optimization: Executing callback for " 
-                  << update.symbol << " without holding the lock" << std::endl;
-        callback_it->second(update);
+    // Call the callbacks without holding any lock, in arrival order
+    TRADING_LOG_IF(!pinned.empty(), LogLevel::DEBUG,
+                   "Week 3 optimization: Executing callbacks for a batch of {} updates without holding the lock",
+                   ticks.size());
+    for (size_t i = 0; i < ticks.size(); ++i) {
+        if (callbacks[i] != nullptr) {
+            (*callbacks[i])(ticks[i]);
+        }
+    }
+    size_t callback_count = 0;
+    for (const auto* callback : callbacks) {
+        callback_count += callback != nullptr ? 1 : 0;
     }
+    pinned.clear();
     
-    // Update metrics
-    auto end_time = std::chrono::high_resolution_clock::now();
+    // Publish metrics once for the batch: each exchange records the batch's
+    // per-update averages, weighted by its number of updates
+    auto end_time = std::chrono::steady_clock::now();
     auto processing_time = std::chrono::duration_cast<std::chrono::nanoseconds>(
         end_time - start_time);
     
-    update_metrics(update.exchange, processing_time);
-    metrics_.total_updates_processed.fetch_add(1, std::memory_order_relaxed);
+    if (processed > 0) {
+        auto book_time = (book_done - start_time) / static_cast<int64_t>(processed);
+        auto callback_time = callback_count > 0
+            ? (end_time - book_done) / static_cast<int64_t>(callback_count)
+            : std::chrono::steady_clock::duration::zero();
+        for (size_t id = 0; id < MAX_EXCHANGES; ++id) {
+            if (exchange_updates[id] > 0) {
+                record_latency(static_cast<ExchangeId>(id), exchange_updates[id], exchange_callbacks[id],
+                               book_time, callback_time, end_time);
+            }
+        }
+        metrics_.total_updates_processed.fetch_add(processed, std::memory_order_relaxed);
+    }
+    if (dropped > 0) {
+        metrics_.total_updates_dropped.fetch_add(dropped, std::memory_order_relaxed);
+    }
     
-    // Print processing time for this update
-    std::cout << "Processed " << update.symbol << " update in " 
-              << processing_time.count() / 1000.0 << " μs" << std::endl;
+    TRADING_LOG_DEBUG("Processed batch of {} updates in {} μs", ticks.size(), processing_time.count() / 1000.0);
 }
 
 // Get order book
 OrderBook MarketDataHandler::get_order_book(const std::string& symbol) const {
-    // Use shared_lock for concurrent reads - Week 3 optimization
-    std::shared_lock<std::shared_mutex> lock(books_mutex_);
-    
-    auto it = order_books_.find(symbol);
-    if (it == order_books_.end()) {
+    return get_order_book(symbols_.find(symbol));
+}
+
+// Get order book by ID
+OrderBook MarketDataHandler::get_order_book(SymbolId symbol_id) const {
+    const PriceLevelBook* book = symbol_id < books_.size()
+        ? books_[symbol_id].book.load(std::memory_order_acquire)
+        : nullptr;
+    if (book == nullptr) {
         return OrderBook{};
     }
     
-    return it->second;
+    // Copy the published snapshot (no lock), then build the vectors
+    OrderBook result;
+    result.symbol = book->symbol; // Immutable after subscribe
+    
+    BookSnapshot snapshot;
+    books_[symbol_id].snapshot.load(snapshot, BookSnapshot::bytes_for_rows(book_depth_));
+    result.timestamp = snapshot.timestamp;
+    
+    // Levels are copied out best price first
+    result.bids.reserve(snapshot.bid_count);
+    for (size_t i = 0; i < snapshot.bid_count; ++i) {
+        result.bids.push_back(snapshot.bid(i));
+    }
+    result.asks.reserve(snapshot.ask_count);
+    for (size_t i = 0; i < snapshot.ask_count; ++i) {
+        result.asks.push_back(snapshot.ask(i));
+    }
+    
+    return result;
+}
+
+// Read a book's snapshot without locking
+bool MarketDataHandler::get_book_snapshot(SymbolId symbol_id, BookSnapshot& snapshot) const {
+    if (symbol_id >= books_.size() || books_[symbol_id].book.load(std::memory_order_acquire) == nullptr) {
+        return false;
+    }
+    
+    // Rows past book_depth_ are never written, so don't copy them
+    books_[symbol_id].snapshot.load(snapshot, BookSnapshot::bytes_for_rows(book_depth_));
+    return true;
+}
+
+// Read the best bid and ask without locking
+TopOfBook MarketDataHandler::top_of_book(SymbolId symbol_id) const {
+    if (symbol_id >= books_.size() || books_[symbol_id].book.load(std::memory_order_acquire) == nullptr) {
+        return TopOfBook{};
+    }
+    
+    BookSnapshot snapshot;
+    books_[symbol_id].snapshot.load(snapshot, BookSnapshot::bytes_for_rows(1));
+    return snapshot.top();
+}
+
+// Read the best bid and ask by name
+TopOfBook MarketDataHandler::top_of_book(const std::string& symbol) const {
+    return top_of_book(symbols_.find(symbol));
+}
+
+// Set a symbol's minimum price increment
+bool MarketDataHandler::set_tick_size(const std::string& symbol, Price tick_size) {
+    SymbolId symbol_id = symbols_.find(symbol);
+    if (symbol_id >= books_.size() || tick_size.raw() <= 0) {
+        return false;
+    }
+    
+    books_[symbol_id].tick_size.store(tick_size.raw(), std::memory_order_relaxed);
+    return true;
+}
+
+// Get a symbol's minimum price increment
+Price MarketDataHandler::tick_size(SymbolId symbol_id) const {
+    if (symbol_id >= books_.size()) {
+        return DEFAULT_TICK_SIZE;
+    }
+    return Price::from_raw(books_[symbol_id].tick_size.load(std::memory_order_relaxed));
+}
+
+// Queue an ASYNC callback on the symbol's strand
+void MarketDataHandler::enqueue_callback(const BookSlot& slot,
+                                         const std::shared_ptr<const Subscription>& subscription,
+                                         const MarketTick& tick) {
+    // Same policy as the ingest rings: never block the book update thread
+    if (!slot.strand->queue.emplace(CallbackStrand::Pending{subscription, tick})) {
+        metrics_.total_callbacks_dropped.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+// Schedule a strand's drain task unless one is already pending
+void MarketDataHandler::schedule_strand(CallbackStrand* strand) {
+    // acq_rel pairs with run_strand(): either the running drain sees our
+    // push after clearing the flag, or we see the flag cleared and post
+    if (strand->scheduled.exchange(true, std::memory_order_acq_rel)) {
+        return;
+    }
+    
+    pending_strands_.fetch_add(1, std::memory_order_acq_rel);
+    post_strand(strand);
+}
+
+// Post a strand's drain task; the strand is marked scheduled and counted as pending
+void MarketDataHandler::post_strand(CallbackStrand* strand) {
+    try {
+        callback_pool_->post(callback_priority_, [this, strand] { run_strand(strand); });
+    } catch (const std::runtime_error&) {
+        // The pool was stopped; the callbacks stay queued until the next schedule
+        TRADING_LOG_ERROR("Callback pool stopped, {} callbacks left queued", strand->queue.size());
+        strand->scheduled.store(false, std::memory_order_release);
+        pending_strands_.fetch_sub(1, std::memory_order_acq_rel);
+    }
+}
+
+// Run a batch of one strand's callbacks on the callback pool
+void MarketDataHandler::run_strand(CallbackStrand* strand) {
+    CallbackStrand::Pending pending;
+    size_t ran = 0;
+    while (ran < STRAND_BATCH_SIZE && strand->queue.try_pop(pending)) {
+        auto start = std::chrono::steady_clock::now();
+        pending.subscription->callback(pending.tick);
+        auto end = std::chrono::steady_clock::now();
+        if (pending.tick.exchange_id < MAX_EXCHANGES) {
+            metrics_shard().recorder(pending.tick.exchange_id).callback.record(
+                static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count()));
+        }
+        pending.subscription.reset();
+        ++ran;
+    }
+    
+    if (ran == STRAND_BATCH_SIZE && !strand->queue.empty()) {
+        // More work: requeue behind other tasks instead of hogging the thread
+        post_strand(strand);
+        return;
+    }
+    
+    // Done for now; a push that raced with clearing the flag reschedules here
+    strand->scheduled.exchange(false, std::memory_order_acq_rel);
+    if (!strand->queue.empty() && !strand->scheduled.exchange(true, std::memory_order_acq_rel)) {
+        post_strand(strand);
+        return;
+    }
+    pending_strands_.fetch_sub(1, std::memory_order_acq_rel);
+}
+
+// Store the latest update of a CONFLATED symbol
+bool MarketDataHandler::conflate_update(BookSlot& slot, SymbolId symbol_id, const MarketTick& tick,
+                                        uint64_t replaced) {
+    // The stripe makes this the only writer; the mark publishes the store
+    slot.conflated->latest.store(tick);
+    bool newly_dirty = conflated_symbols_.mark(symbol_id);
+    
+    // A symbol already dirty had an undelivered update, which this one replaces
+    replaced += newly_dirty ? 0 : 1;
+    if (replaced > 0) {
+        metrics_.total_updates_conflated.fetch_add(replaced, std::memory_order_relaxed);
+    }
+    return newly_dirty;
+}
+
+// Schedule the conflation task unless it is already pending
+void MarketDataHandler::schedule_conflation() {
+    // Same handshake as schedule_strand(), with the dirty set as the queue
+    if (conflation_scheduled_.exchange(true, std::memory_order_acq_rel)) {
+        return;
+    }
+    
+    pending_strands_.fetch_add(1, std::memory_order_acq_rel);
+    post_conflation();
+}
+
+// Post the conflation task
+void MarketDataHandler::post_conflation() {
+    try {
+        callback_pool_->post(callback_priority_, [this] { run_conflation(); });
+    } catch (const std::runtime_error&) {
+        TRADING_LOG_ERROR("Callback pool stopped, conflated updates left pending");
+        conflation_scheduled_.store(false, std::memory_order_release);
+        pending_strands_.fetch_sub(1, std::memory_order_acq_rel);
+    }
+}
+
+// Deliver the latest update of every symbol that changed since the last pass
+void MarketDataHandler::run_conflation() {
+    size_t delivered = 0;
+    conflated_symbols_.drain([this, &delivered](size_t id) {
+        BookSlot& slot = books_[id];
+        MarketTick tick;
+        uint64_t version = slot.conflated->latest.load(tick);
+        
+        // Marked again after the previous pass had already read this update
+        if (version == slot.conflated->delivered_version) {
+            return;
+        }
+        slot.conflated->delivered_version = version;
+        
+        // The subscription may have changed since the update was stored
+        std::shared_ptr<const Subscription> subscription;
+        {
+            std::lock_guard<InstrumentedSpinLock> guard(book_lock(static_cast<SymbolId>(id)));
+            subscription = slot.subscription;
+        }
+        if (subscription == nullptr || subscription->dispatch != CallbackDispatch::CONFLATED) {
+            return;
+        }
+        
+        auto start = std::chrono::steady_clock::now();
+        subscription->callback(tick);
+        auto end = std::chrono::steady_clock::now();
+        if (tick.exchange_id < MAX_EXCHANGES) {
+            metrics_shard().recorder(tick.exchange_id).callback.record(
+                static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count()));
+        }
+        ++delivered;
+    });
+    
+    TRADING_LOG_DEBUG("Delivered {} conflated updates", delivered);
+    
+    // Symbols marked while we were draining get another pass
+    conflation_scheduled_.exchange(false, std::memory_order_acq_rel);
+    if (!conflated_symbols_.empty() && !conflation_scheduled_.exchange(true, std::memory_order_acq_rel)) {
+        post_conflation();
+        return;
+    }
+    pending_strands_.fetch_sub(1, std::memory_order_acq_rel);
+}
+
+// Wait for the ASYNC callbacks queued so far
+void MarketDataHandler::flush_callbacks() {
+    while (pending_strands_.load(std::memory_order_acquire) != 0) {
+        std::this_thread::yield();
+    }
+}
+
+// Suspend a coroutine until its symbol's next update
+bool MarketDataHandler::TickAwaiter::await_suspend(std::coroutine_handle<> handle) {
+    handle_ = handle;
+    return handler_.add_tick_waiter(*this);
+}
+
+// Register a coroutine for its symbol's next update
+bool MarketDataHandler::add_tick_waiter(TickAwaiter& waiter) {
+    SymbolId symbol_id = waiter.requested_;
+    if (symbol_id >= books_.size() || books_[symbol_id].book.load(std::memory_order_acquire) == nullptr) {
+        return false;
+    }
+    BookSlot& slot = books_[symbol_id];
+    std::lock_guard<InstrumentedSpinLock> guard(book_lock(symbol_id));
+    waiter.next_ = slot.tick_waiters;
+    slot.tick_waiters = &waiter;
+    return true;
+}
+
+// Hand a tick to a symbol's waiters and detach them
+MarketDataHandler::TickAwaiter* MarketDataHandler::take_tick_waiters(BookSlot& slot, const MarketTick& tick) {
+    TickAwaiter* waiters = slot.tick_waiters;
+    slot.tick_waiters = nullptr;
+    for (TickAwaiter* waiter = waiters; waiter != nullptr; waiter = waiter->next_) {
+        waiter->tick_ = tick;
+    }
+    return waiters;
+}
+
+// Resume the detached waiters
+void MarketDataHandler::wake_tick_waiters(TickAwaiter* waiters) {
+    while (waiters != nullptr) {
+        // The awaiter lives in the coroutine frame, which may be gone once it resumes
+        TickAwaiter* next = waiters->next_;
+        resume_on(waiters->executor_, waiters->priority_, waiters->handle_);
+        waiters = next;
+    }
+}
+
+// Publish a book to the lock-free readers
+void MarketDataHandler::publish_snapshot(SymbolId symbol_id, const PriceLevelBook& book) {
+    // Only the used rows are written; readers ignore rows past the counts
+    BookSnapshot snapshot;
+    snapshot.capture(symbol_id, book);
+    books_[symbol_id].snapshot.store(snapshot, snapshot.used_bytes());
+    
+    ShmBookPublisher* publisher = shm_publisher_.load(std::memory_order_relaxed);
+    if (publisher != nullptr) {
+        publisher->publish(symbol_id, book.symbol, snapshot);
+    }
+}
+
+// Copy every book and both registries into a checkpoint
+bool MarketDataHandler::write_checkpoint(CheckpointWriter& writer, const CaptureWriter* capture,
+                                         std::chrono::milliseconds ingest_timeout) {
+    // Sequence first: every update recorded below it is already in an
+    // ingest ring, since exchange threads push before they record
+    uint64_t sequence = capture != nullptr ? capture->records() : 0;
+    if (!wait_for_ingest(std::chrono::steady_clock::now() + ingest_timeout)) {
+        TRADING_LOG_WARN("Checkpoint skipped: book workers still behind after {} ms", ingest_timeout.count());
+        return false;
+    }
+    
+    writer.begin();
+    size_t exchange_count = exchanges_.size();
+    for (size_t id = 0; id < exchange_count; ++id) {
+        if (!writer.add_exchange(static_cast<ExchangeId>(id), exchanges_.name(static_cast<ExchangeId>(id)))) {
+            TRADING_LOG_WARN("Checkpoint skipped: exchange {} doesn't fit", exchanges_.name(static_cast<ExchangeId>(id)));
+            return false;
+        }
+    }
+    
+    // Lock-free copies: a book updated meanwhile is caught up by the replay
+    size_t symbol_count = symbols_.size();
+    for (size_t id = 0; id < symbol_count; ++id) {
+        auto symbol_id = static_cast<SymbolId>(id);
+        const BookSlot& slot = books_[id];
+        bool has_book = slot.book.load(std::memory_order_acquire) != nullptr;
+        BookSnapshot* snapshot = writer.add_symbol(symbol_id, symbols_.name(symbol_id), tick_size(symbol_id), has_book);
+        if (snapshot == nullptr) {
+            TRADING_LOG_WARN("Checkpoint skipped: symbol {} doesn't fit", symbols_.name(symbol_id));
+            return false;
+        }
+        if (has_book) {
+            slot.snapshot.load(*snapshot, BookSnapshot::bytes_for_rows(book_depth_));
+        }
+    }
+    return writer.commit(sequence);
+}
+
+// Wait for every ingest ring's worker to catch up with what was pushed so far
+bool MarketDataHandler::wait_for_ingest(std::chrono::steady_clock::time_point deadline) {
+    std::lock_guard<InstrumentedMutex> lock(exchanges_mutex_);
+    if (!running_) {
+        // stop() drained the rings
+        return true;
+    }
+    for (auto& [exchange, feed] : exchange_feeds_) {
+        for (auto& ring : feed.queues) {
+            uint64_t target = ring->queue.total_enqueued();
+            while (ring->applied.load(std::memory_order_acquire) < target) {
+                if (std::chrono::steady_clock::now() >= deadline) {
+                    return false;
+                }
+                std::this_thread::yield();
+            }
+        }
+    }
+    return true;
+}
+
+// Rebuild the books from a checkpoint
+bool MarketDataHandler::restore(const std::string& path, CheckpointInfo* info) {
+    auto start = std::chrono::steady_clock::now();
+    std::lock_guard<InstrumentedMutex> exchanges_lock(exchanges_mutex_);
+    if (running_) {
+        TRADING_LOG_WARN("Can't restore {} while running", path);
+        return false;
+    }
+    
+    std::unique_ptr<CheckpointReader> checkpoint;
+    try {
+        checkpoint = std::make_unique<CheckpointReader>(path);
+    } catch (const std::exception& e) {
+        TRADING_LOG_ERROR("Can't restore books: {}", e.what());
+        return false;
+    }
+    
+    std::lock_guard<InstrumentedMutex> books_lock(books_mutex_);
+    
+    // Replayed ticks carry the recorded IDs, so every name must get its recorded ID back
+    bool compatible = checkpoint->exchange_count() <= MAX_EXCHANGES && checkpoint->symbol_count() <= max_symbols_;
+    for (size_t id = 0; compatible && id < checkpoint->exchange_count(); ++id) {
+        ExchangeId existing = exchanges_.find(std::string(checkpoint->exchange_name(static_cast<ExchangeId>(id))));
+        compatible = existing == id || (existing == INVALID_EXCHANGE_ID && id >= exchanges_.size());
+    }
+    for (size_t id = 0; compatible && id < checkpoint->symbol_count(); ++id) {
+        const CheckpointLayout::Name& name = checkpoint->symbol(static_cast<SymbolId>(id)).name;
+        SymbolId existing = symbols_.find(std::string(name.text, name.length));
+        compatible = existing == id || (existing == INVALID_SYMBOL_ID && id >= symbols_.size());
+    }
+    if (!compatible) {
+        TRADING_LOG_ERROR("Can't restore {}: its symbol or exchange IDs differ from this handler's", path);
+        return false;
+    }
+    
+    for (size_t id = 0; id < checkpoint->exchange_count(); ++id) {
+        exchanges_.intern(std::string(checkpoint->exchange_name(static_cast<ExchangeId>(id))));
+    }
+    size_t books = 0;
+    for (size_t id = 0; id < checkpoint->symbol_count(); ++id) {
+        auto symbol_id = static_cast<SymbolId>(id);
+        const CheckpointLayout::SymbolEntry& entry = checkpoint->symbol(symbol_id);
+        std::string symbol(entry.name.text, entry.name.length);
+        symbols_.intern(symbol);
+        if (entry.tick_size > 0) {
+            books_[id].tick_size.store(entry.tick_size, std::memory_order_relaxed);
+        }
+        if (!entry.has_book) {
+            continue;
+        }
+        
+        PriceLevelBook* book = create_book(symbol_id, symbol);
+        const BookSnapshot& snapshot = entry.snapshot;
+        std::lock_guard<InstrumentedSpinLock> guard(book_lock(symbol_id));
+        book->bids.clear();
+        book->asks.clear();
+        for (size_t i = 0; i < snapshot.bid_count; ++i) {
+            book->bids.apply(snapshot.bid(i).price, snapshot.bid(i).volume);
+        }
+        for (size_t i = 0; i < snapshot.ask_count; ++i) {
+            book->asks.apply(snapshot.ask(i).price, snapshot.ask(i).volume);
+        }
+        book->timestamp = snapshot.timestamp;
+        publish_snapshot(symbol_id, *book);
+        ++books;
+    }
+    
+    auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start);
+    TRADING_LOG_INFO("Week 3 optimization: Restored {} books (checkpoint generation {}, sequence {}) in {} us",
+                     books, checkpoint->generation(), checkpoint->sequence(), elapsed.count() / 1000);
+    if (info != nullptr) {
+        info->generation = checkpoint->generation();
+        info->sequence = checkpoint->sequence();
+        info->books = books;
+        info->taken_at = checkpoint->taken_at();
+        info->restore_time = elapsed;
+    }
+    return true;
+}
+
+// Symbol ID lookup
+SymbolId MarketDataHandler::symbol_id(const std::string& symbol) const {
+    return symbols_.find(symbol);
+}
+
+// Exchange ID lookup
+ExchangeId MarketDataHandler::exchange_id(const std::string& exchange_name) const {
+    return exchanges_.find(exchange_name);
+}
+
+// Convert a tick back to a named update
+MarketUpdate MarketDataHandler::to_market_update(const MarketTick& tick) const {
+    MarketUpdate update;
+    update.symbol = symbols_.name(tick.symbol_id);
+    update.exchange = exchanges_.name(tick.exchange_id);
+    update.bid_price = tick.bid_price;
+    update.ask_price = tick.ask_price;
+    update.volume = tick.volume;
+    update.timestamp = tick.timestamp;
+    return update;
 }
 
 // Get metrics
@@ -296,109 +1132,334 @@ MarketDataMetricsResult MarketDataHandler::get_metrics() const {
     MarketDataMetricsResult result;
     result.total_updates_processed = metrics_.total_updates_processed.load(std::memory_order_relaxed);
     result.total_updates_dropped = metrics_.total_updates_dropped.load(std::memory_order_relaxed);
-    result.lock_contentions = metrics_.lock_contentions.load(std::memory_order_relaxed);
-    result.lock_wait_time_ns = metrics_.lock_wait_time_ns.load(std::memory_order_relaxed);
+    result.total_callbacks_dropped = metrics_.total_callbacks_dropped.load(std::memory_order_relaxed);
+    result.total_updates_conflated = metrics_.total_updates_conflated.load(std::memory_order_relaxed);
+    
+    // Measured lock contention - Week 3 optimization
+    std::vector<const LockStats*> stripes;
+    for (const auto& shard : book_locks_) {
+        stripes.push_back(&shard.lock.stats());
+    }
+    result.locks.push_back(LockStats::summarize("book_locks", stripes));
+    result.locks.push_back(books_mutex_.stats().summarize("books_mutex"));
+    result.locks.push_back(exchanges_mutex_.stats().summarize("exchanges_mutex"));
+    result.locks.push_back(symbols_.lock_stats().summarize("symbol_registry"));
+    result.locks.push_back(exchanges_.lock_stats().summarize("exchange_registry"));
+    for (const auto& lock : result.locks) {
+        result.lock_contentions += lock.contentions;
+        result.lock_wait_time_ns += lock.wait_time_ns;
+    }
     
-    // Copy the maps - need lock for non-atomic members
+    // Merge every shard's histograms per exchange and translate IDs back to names
+    auto now = std::chrono::steady_clock::now();
+    std::vector<const MetricsShard*> shards;
     {
-        std::lock_guard<std::mutex> lock(metrics_mutex_);
-        result.avg_latency_us = metrics_.avg_latency_us;
-        result.throughput_mps = metrics_.throughput_mps;
+        std::lock_guard<std::mutex> lock(metrics_.shards_mutex);
+        for (const auto& shard : metrics_.shards) {
+            shards.push_back(shard.get());
+        }
+    }
+    size_t exchange_count = exchanges_.size() < MAX_EXCHANGES ? exchanges_.size() : MAX_EXCHANGES;
+    for (size_t id = 0; id < exchange_count; ++id) {
+        LatencySnapshot queue_wait;
+        LatencySnapshot book_update;
+        LatencySnapshot callback;
+        ExchangeLatencyStats stats;
+        for (const MetricsShard* shard : shards) {
+            const ExchangeLatencyRecorder* recorder = shard->exchanges[id].load(std::memory_order_acquire);
+            if (recorder != nullptr) {
+                queue_wait.merge(recorder->queue_wait);
+                book_update.merge(recorder->book_update);
+                callback.merge(recorder->callback);
+                stats.throughput_mps += recorder->messages.rate(now);
+            }
+        }
+        stats.queue_wait = queue_wait.summary();
+        stats.book_update = book_update.summary();
+        stats.callback = callback.summary();
+        
+        const std::string& name = exchanges_.name(static_cast<ExchangeId>(id));
+        result.avg_latency_us[name] = (book_update.mean() + callback.mean()) / 1000.0;
+        result.throughput_mps[name] = stats.throughput_mps;
+        result.latency[name] = stats;
     }
     
     return result;
 }
 
 // Start processing
-void MarketDataHandler::start() {
-    std::lock_guard<std::mutex> lock(exchanges_mutex_);
+void MarketDataHandler::start(size_t num_book_workers) {
+    std::lock_guard<InstrumentedMutex> lock(exchanges_mutex_);
+    start_locked(num_book_workers);
+}
+
+// Start processing with placed threads
+void MarketDataHandler::start(size_t num_book_workers, const MarketDataPlacement& placement) {
+    std::lock_guard<InstrumentedMutex> lock(exchanges_mutex_);
+    if (running_) {
+        return;
+    }
+    
+    placement_ = placement;
+    if (placement_.exchanges.name.empty()) {
+        placement_.exchanges.name = "md";
+    }
+    if (placement_.book_workers.name.empty()) {
+        placement_.book_workers.name = "book";
+    }
+    
+    // Week 3 optimization: keep the books on the node of the workers that write them
+    int node = placement_.book_workers.numa_node;
+    book_numa_node_.store(node, std::memory_order_seq_cst);
+    if (node >= 0) {
+        bool bound = order_book_allocator_->bind_to_numa_node(node);
+        if (order_pool_ready_.load(std::memory_order_seq_cst)) {
+            bound = order_pool_->bind_to_numa_node(node) && bound;
+        }
+        if (!bound) {
+            TRADING_LOG_WARN("Could not bind the order books to NUMA node {}", node);
+        }
+    }
     
+    start_locked(num_book_workers);
+}
+
+// Start the threads; the caller holds exchanges_mutex_
+void MarketDataHandler::start_locked(size_t num_book_workers) {
     if (running_) {
         return;
     }
     
+    num_book_workers = std::max<size_t>(num_book_workers, 1);
+    
+    // One SPSC ring per (exchange, worker) pair: the exchange thread is the
+    // only producer and the worker the only consumer - Week 3 optimization
+    std::vector<std::vector<IngestRing*>> worker_queues(num_book_workers);
+    for (auto& [exchange, feed] : exchange_feeds_) {
+        feed.queues.clear();
+        if (feed.source == nullptr) {
+            continue;
+        }
+        for (size_t w = 0; w < num_book_workers; ++w) {
+            feed.queues.emplace_back(new IngestRing());
+            worker_queues[w].push_back(feed.queues.back().get());
+        }
+    }
+    
     running_ = true;
+    workers_running_ = true;
+    
+    TRADING_LOG_INFO("Week 3 optimization: Starting {} book workers with symbol affinity", num_book_workers);
+    for (size_t w = 0; w < num_book_workers; ++w) {
+        book_workers_.emplace_back(&MarketDataHandler::book_worker_func, this, w,
+                                   std::move(worker_queues[w]));
+    }
     
     // Start a thread for each exchange - Week 3 optimization
-    std::cout << "Week 3 optimization: Starting exchange threads for parallel processing" << std::endl;
+    TRADING_LOG_INFO("Week 3 optimization: Starting exchange threads for parallel processing");
     
-    for (auto& [exchange, thread] : exchange_threads_) {
-        if (thread.joinable()) {
+    for (auto& [exchange, feed] : exchange_feeds_) {
+        if (feed.thread.joinable()) {
             continue;
         }
         
-        thread = std::thread(&MarketDataHandler::exchange_thread_func, this, exchange);
+        feed.thread = std::thread(&MarketDataHandler::exchange_thread_func, this, &feed);
     }
 }
 
 // Stop processing
 void MarketDataHandler::stop() {
-    {
-        std::lock_guard<std::mutex> lock(exchanges_mutex_);
-        if (!running_) {
-            return;
-        }
-        
-        running_ = false;
+    std::lock_guard<InstrumentedMutex> lock(exchanges_mutex_);
+    if (!running_) {
+        return;
     }
     
+    running_ = false;
+    
     // Wait for all threads to complete - Week 3 optimization
-    std::cout << "Week 3 optimization: Gracefully stopping all exchange threads" << std::endl;
+    TRADING_LOG_INFO("Week 3 optimization: Gracefully stopping all exchange threads");
     
-    for (auto& [exchange, thread] : exchange_threads_) {
-        if (thread.joinable()) {
-            thread.join();
+    for (auto& [exchange, feed] : exchange_feeds_) {
+        if (feed.thread.joinable()) {
+            feed.thread.join();
         }
     }
+    
+    // No more producers: let the workers drain their rings and exit
+    workers_running_ = false;
+    for (auto& worker : book_workers_) {
+        worker.join();
+    }
+    book_workers_.clear();
 }
 
 // Exchange thread function
-void MarketDataHandler::exchange_thread_func(const std::string& exchange_name) {
-    std::cout << "Week 3 optimization: Exchange thread started for " << exchange_name << std::endl;
+void MarketDataHandler::exchange_thread_func(ExchangeFeed* feed) {
+    const std::string& exchange_name = exchanges_.name(feed->id);
+    const ThreadPlacement& placement = placement_.exchanges;
+    if (!place_current_thread(placement, feed->id, placement.name + "-" + exchange_name)) {
+        TRADING_LOG_WARN("Could not pin the exchange thread for {} to core {}", exchange_name,
+                         placement.cpu_for(feed->id));
+    }
+    TRADING_LOG_INFO("Week 3 optimization: Exchange thread started for {}", exchange_name);
+    
+    if (feed->source == nullptr) {
+        // No feed attached: updates for this exchange arrive through process_update()
+        while (running_.load(std::memory_order_acquire)) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        }
+        TRADING_LOG_INFO("Week 3 optimization: Exchange thread stopped for {}", exchange_name);
+        return;
+    }
     
-    // Avoid unused parameter warning
-    static_cast<void>(exchange_name);
+    const size_t num_workers = feed->queues.size();
+    const FeedWaitMode wait_mode = placement.busy_spin ? FeedWaitMode::BUSY_POLL : feed->wait_mode;
+    MarketTick batch[INGEST_BATCH_SIZE];
     
-    while (running_) {
-        // In a real implementation, this would receive data from the exchange
-        // For demo purposes, we just sleep
-        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    while (running_.load(std::memory_order_acquire)) {
+        size_t count = wait_mode == FeedWaitMode::BUSY_POLL
+            ? feed->source->poll(batch, INGEST_BATCH_SIZE)
+            : feed->source->receive(batch, INGEST_BATCH_SIZE, FEED_RECEIVE_TIMEOUT);
+        
+        if (count == 0) {
+            if (wait_mode == FeedWaitMode::BUSY_POLL) {
+                cpu_relax();
+            }
+            continue;
+        }
+        
+        // Route by symbol so each book has exactly one writing worker
+        // One timestamp per received batch feeds the queue wait histogram
+        auto enqueued = std::chrono::steady_clock::now();
+        uint64_t dropped = 0;
+        for (size_t i = 0; i < count; ++i) {
+            MarketTick& tick = batch[i];
+            tick.exchange_id = feed->id;
+            if (!feed->queues[tick.symbol_id % num_workers]->queue.try_push(QueuedTick{tick, enqueued})) {
+                // Backpressure: the worker is behind, shed the tick rather than block the feed
+                ++dropped;
+            }
+        }
+        if (capture_ != nullptr) {
+            capture_->append(std::span<const MarketTick>(batch, count), enqueued);
+        }
+        if (dropped > 0) {
+            metrics_.total_updates_dropped.fetch_add(dropped, std::memory_order_relaxed);
+        }
     }
     
-    std::cout << "Week 3 optimization: Exchange thread stopped for " << exchange_name << std::endl;
+    TRADING_LOG_INFO("Week 3 optimization: Exchange thread stopped for {}", exchange_name);
 }
 
-// Update metrics
-void MarketDataHandler::update_metrics(const std::string& exchange, 
-                                     std::chrono::nanoseconds processing_time) {
-    std::lock_guard<std::mutex> lock(metrics_mutex_);
-    
-    // Update average latency (simple moving average)
-    double current_latency = metrics_.avg_latency_us[exchange];
-    double new_latency = processing_time.count() / 1000.0; // ns to us
+// Book worker function
+void MarketDataHandler::book_worker_func(size_t index, std::vector<IngestRing*> queues) {
+    const ThreadPlacement& placement = placement_.book_workers;
+    if (!place_current_thread(placement, index, placement.name + "-" + std::to_string(index))) {
+        TRADING_LOG_WARN("Could not pin book worker {} to core {}", index, placement.cpu_for(index));
+    }
+    int idle_spins = 0;
     
-    if (current_latency == 0.0) {
-        metrics_.avg_latency_us[exchange] = new_latency;
-    } else {
-        metrics_.avg_latency_us[exchange] = current_latency * 0.9 + new_latency * 0.1;
+    while (true) {
+        // Read the flag before draining, so nothing pushed before stop() is missed
+        bool stopping = !workers_running_.load(std::memory_order_acquire);
+        
+        size_t handled = 0;
+        QueuedTick queued;
+        MarketTick batch[INGEST_BATCH_SIZE];
+        for (IngestRing* ring : queues) {
+            // Bounded batch per ring keeps one busy exchange from starving the others
+            // Ticks pushed together share a timestamp, so record their wait as one run
+            auto now = std::chrono::steady_clock::now();
+            size_t count = 0;
+            size_t run = 0;
+            auto run_enqueued = now;
+            while (count < INGEST_BATCH_SIZE && ring->queue.try_pop(queued)) {
+                if (run > 0 && queued.enqueued != run_enqueued) {
+                    record_queue_wait(batch[count - 1].exchange_id, run, now - run_enqueued);
+                    run = 0;
+                }
+                run_enqueued = queued.enqueued;
+                ++run;
+                batch[count++] = queued.tick;
+            }
+            if (count > 0) {
+                record_queue_wait(batch[count - 1].exchange_id, run, now - run_enqueued);
+                process_updates(std::span<const MarketTick>(batch, count));
+                // Release: a checkpoint that sees the count also sees the books
+                ring->applied.store(ring->applied.load(std::memory_order_relaxed) + count,
+                                    std::memory_order_release);
+                handled += count;
+            }
+        }
+        
+        if (handled > 0) {
+            idle_spins = 0;
+            continue;
+        }
+        if (stopping) {
+            break;
+        }
+        
+        // Spin briefly for latency, then back off to save the core unless it is ours to burn
+        if (placement.busy_spin || ++idle_spins < WORKER_IDLE_SPINS) {
+            cpu_relax();
+        } else {
+            std::this_thread::sleep_for(std::chrono::microseconds(50));
+        }
+    }
+}
+
+// Calling thread's metrics shard
+MetricsShard& MarketDataHandler::metrics_shard() const {
+    // Shards this thread has registered, newest handler last; a thread
+    // records into only a few handlers, so the scan is short
+    struct Registration {
+        uint64_t instance_id;
+        MetricsShard* shard;
+    };
+    thread_local std::vector<Registration> registered;
+    for (auto it = registered.rbegin(); it != registered.rend(); ++it) {
+        if (it->instance_id == metrics_.instance_id) {
+            return *it->shard;
+        }
     }
     
-    // Update throughput (messages per second)
-    // In a real implementation, we would track throughput over time
-    metrics_.throughput_mps[exchange] = 10.0; // Placeholder
+    // First record of this thread: it gets a shard of its own, off the tick path from now on
+    auto shard = std::make_unique<MetricsShard>();
+    MetricsShard* created = shard.get();
+    {
+        std::lock_guard<std::mutex> lock(metrics_.shards_mutex);
+        metrics_.shards.push_back(std::move(shard));
+    }
+    registered.push_back(Registration{metrics_.instance_id, created});
+    return *created;
+}
+
+// Record update latencies
+void MarketDataHandler::record_latency(ExchangeId exchange_id, uint64_t count, uint64_t callbacks,
+                                       std::chrono::nanoseconds book_time,
+                                       std::chrono::nanoseconds callback_time,
+                                       std::chrono::steady_clock::time_point now) {
+    if (exchange_id >= MAX_EXCHANGES) {
+        return;
+    }
     
-    // Update lock contention metrics - Week 3 optimization
-    // This tracks when threads are waiting for locks, which can indicate
-    // potential performance bottlenecks
-    if (processing_time > std::chrono::microseconds(100)) {
-        metrics_.lock_contentions.fetch_add(1, std::memory_order_relaxed);
-        metrics_.lock_wait_time_ns.fetch_add(
-            processing_time.count() / 2, std::memory_order_relaxed);
-        
-        std::cout << "Week 3 optimization: Detected potential lock contention with " 
-                  << processing_time.count() / 1000.0 << " μs processing time for " 
-                  << exchange << std::endl;
+    // No lock: relaxed adds into this thread's own histograms
+    ExchangeLatencyRecorder& recorder = metrics_shard().recorder(exchange_id);
+    recorder.book_update.record(static_cast<uint64_t>(book_time.count()), count);
+    if (callbacks > 0) {
+        recorder.callback.record(static_cast<uint64_t>(callback_time.count()), callbacks);
+    }
+    recorder.messages.record(count, now);
+}
+
+// Record how long ticks waited in an ingest ring
+void MarketDataHandler::record_queue_wait(ExchangeId exchange_id, uint64_t count,
+                                          std::chrono::nanoseconds wait_time) {
+    if (exchange_id >= MAX_EXCHANGES) {
+        return;
     }
+    metrics_shard().recorder(exchange_id).queue_wait.record(static_cast<uint64_t>(wait_time.count()), count);
 }
 
-} // namespace trading 
\ No newline at end of file
+} // namespace trading
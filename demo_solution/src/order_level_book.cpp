@@ -0,0 +1,236 @@
+#include "../include/order_level_book.hpp"
+#include "../include/logger.hpp"
+#include <iterator>
+#include <limits>
+#include <new>
+
+namespace trading {
+
+static_assert(sizeof(OrderNode) <= OrderLevelBook::NODE_SIZE, "Order nodes must fit a pool block");
+static_assert(sizeof(OrderLevel) <= OrderLevelBook::NODE_SIZE, "Levels must fit a pool block");
+
+namespace {
+
+// Level volumes are int64; the L2 book keeps int volumes
+int clamp_volume(int64_t volume) {
+    return static_cast<int>(std::clamp<int64_t>(volume, 0, std::numeric_limits<int>::max()));
+}
+
+} // namespace
+
+OrderLevelBook::OrderLevelBook(week2::OrderBookAllocator& pool, PriceLevelBook* l2, size_t expected_orders)
+    : pool_(pool), l2_(l2), orders_(expected_orders), bids_(pool), asks_(pool) {
+    if (pool.block_size() < NODE_SIZE) {
+        TRADING_LOG_WARN("Order pool blocks of {} bytes are smaller than {}; order nodes will use the heap",
+                         pool.block_size(), NODE_SIZE);
+    }
+}
+
+OrderLevelBook::~OrderLevelBook() {
+    // The attached L2 book may already be gone: free the nodes without syncing it
+    orders_.for_each([this](OrderNode* order) { pool_.deallocate(order); });
+    bids_.by_price.for_each([this](OrderLevel* level) { pool_.deallocate(level); });
+    asks_.by_price.for_each([this](OrderLevel* level) { pool_.deallocate(level); });
+}
+
+bool OrderLevelBook::add(OrderId id, Side side, Price price, int quantity, std::chrono::nanoseconds timestamp) {
+    if (quantity <= 0 || orders_.find(id) != nullptr) {
+        return false;
+    }
+    auto* order = new (pool_.allocate(sizeof(OrderNode)))
+        OrderNode{id, price, timestamp, nullptr, nullptr, nullptr, quantity, side};
+    orders_.insert(id, order);
+    link(order);
+    return true;
+}
+
+bool OrderLevelBook::modify(OrderId id, Price price, int quantity, std::chrono::nanoseconds timestamp) {
+    OrderNode* order = orders_.find(id);
+    if (order == nullptr) {
+        return false;
+    }
+    if (quantity <= 0) {
+        return cancel(id);
+    }
+
+    if (price == order->price && quantity <= order->quantity) {
+        // Size-down in place: the order keeps its place in the queue
+        OrderLevel* level = order->level;
+        level->volume -= order->quantity - quantity;
+        order->quantity = quantity;
+        if (order->side == Side::BID) {
+            sync_level<Side::BID>(bids_, level->price, level->volume);
+        } else {
+            sync_level<Side::ASK>(asks_, level->price, level->volume);
+        }
+        return true;
+    }
+
+    // Any other change loses priority: requeue at the back of the new level
+    unlink(order);
+    order->price = price;
+    order->quantity = quantity;
+    order->timestamp = timestamp;
+    link(order);
+    return true;
+}
+
+bool OrderLevelBook::cancel(OrderId id) {
+    OrderNode* order = orders_.erase(id);
+    if (order == nullptr) {
+        return false;
+    }
+    unlink(order);
+    pool_.deallocate(order);
+    return true;
+}
+
+bool OrderLevelBook::execute(OrderId id, int quantity) {
+    OrderNode* order = quantity > 0 ? orders_.find(id) : nullptr;
+    if (order == nullptr) {
+        return false;
+    }
+    if (quantity >= order->quantity) {
+        return cancel(id);
+    }
+
+    // Partial fill: the remainder keeps its priority
+    OrderLevel* level = order->level;
+    level->volume -= quantity;
+    order->quantity -= quantity;
+    if (order->side == Side::BID) {
+        sync_level<Side::BID>(bids_, level->price, level->volume);
+    } else {
+        sync_level<Side::ASK>(asks_, level->price, level->volume);
+    }
+    return true;
+}
+
+bool OrderLevelBook::apply(const OrderEvent& event) {
+    switch (event.type) {
+        case OrderEventType::ADD:
+            return add(event.order_id, event.side, event.price, event.quantity, event.timestamp);
+        case OrderEventType::MODIFY:
+            return modify(event.order_id, event.price, event.quantity, event.timestamp);
+        case OrderEventType::CANCEL:
+            return cancel(event.order_id);
+        case OrderEventType::EXECUTE:
+            return execute(event.order_id, event.quantity);
+    }
+    return false;
+}
+
+void OrderLevelBook::clear() {
+    orders_.for_each([this](OrderNode* order) { pool_.deallocate(order); });
+    bids_.by_price.for_each([this](OrderLevel* level) { pool_.deallocate(level); });
+    asks_.by_price.for_each([this](OrderLevel* level) { pool_.deallocate(level); });
+    orders_.clear();
+    bids_.by_price.clear();
+    asks_.by_price.clear();
+    bids_.levels.clear();
+    asks_.levels.clear();
+    if (l2_ != nullptr) {
+        l2_->bids.clear();
+        l2_->asks.clear();
+    }
+}
+
+size_t OrderLevelBook::top_levels(Side side, OrderBookEntry* levels, size_t max_levels) const {
+    size_t count = 0;
+    auto copy = [&](const auto& index) {
+        for (auto it = index.levels.begin(); it != index.levels.end() && count < max_levels; ++it) {
+            levels[count++] = OrderBookEntry{it->first, clamp_volume(it->second->volume)};
+        }
+    };
+    if (side == Side::BID) {
+        copy(bids_);
+    } else {
+        copy(asks_);
+    }
+    return count;
+}
+
+void OrderLevelBook::link(OrderNode* order) {
+    if (order->side == Side::BID) {
+        link<Side::BID>(bids_, order);
+    } else {
+        link<Side::ASK>(asks_, order);
+    }
+}
+
+void OrderLevelBook::unlink(OrderNode* order) {
+    if (order->side == Side::BID) {
+        unlink<Side::BID>(bids_, order);
+    } else {
+        unlink<Side::ASK>(asks_, order);
+    }
+}
+
+// Append to the back of the level's FIFO, creating the level on first use
+template<Side S, typename Index>
+void OrderLevelBook::link(Index& index, OrderNode* order) {
+    OrderLevel* level = index.by_price.find(key(order->price));
+    if (level == nullptr) {
+        level = new (pool_.allocate(sizeof(OrderLevel))) OrderLevel{order->price, 0, 0, nullptr, nullptr};
+        index.by_price.insert(key(order->price), level);
+        index.levels.emplace(order->price, level);
+    }
+
+    order->level = level;
+    order->prev = level->tail;
+    order->next = nullptr;
+    if (level->tail != nullptr) {
+        level->tail->next = order;
+    } else {
+        level->head = order;
+    }
+    level->tail = order;
+    ++level->order_count;
+    level->volume += order->quantity;
+    sync_level<S>(index, level->price, level->volume);
+}
+
+// Unlink from the FIFO; the last order out removes the level
+template<Side S, typename Index>
+void OrderLevelBook::unlink(Index& index, OrderNode* order) {
+    OrderLevel* level = order->level;
+    (order->prev != nullptr ? order->prev->next : level->head) = order->next;
+    (order->next != nullptr ? order->next->prev : level->tail) = order->prev;
+    order->prev = order->next = nullptr;
+    order->level = nullptr;
+    --level->order_count;
+    level->volume -= order->quantity;
+
+    Price price = level->price;
+    int64_t volume = level->volume;
+    if (level->order_count == 0) {
+        index.by_price.erase(key(price));
+        index.levels.erase(price);
+        pool_.deallocate(level);
+        volume = 0;
+    }
+    sync_level<S>(index, price, volume);
+}
+
+template<Side S, typename Index>
+void OrderLevelBook::sync_level(Index& index, Price price, int64_t volume) {
+    if (l2_ == nullptr) {
+        return;
+    }
+    auto& side = [this]() -> PriceLevelSide<S>& {
+        if constexpr (S == Side::BID) {
+            return l2_->bids;
+        } else {
+            return l2_->asks;
+        }
+    }();
+
+    bool retained = side.apply(price, clamp_volume(volume));
+    // A retained level went away: the next level of the full book moves up into the L2 depth
+    if (volume <= 0 && retained && side.size() < side.depth() && index.levels.size() > side.size()) {
+        auto next = std::next(index.levels.begin(), static_cast<std::ptrdiff_t>(side.size()));
+        side.apply(next->first, clamp_volume(next->second->volume));
+    }
+}
+
+} // namespace trading
@@ -0,0 +1,437 @@
+#include "../include/shm_book.hpp"
+#include "../include/logger.hpp"
+#include <cerrno>
+#include <cstring>
+#include <new>
+#include <stdexcept>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define TRADING_SHM_BOOKS 1
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#else
+#define TRADING_SHM_BOOKS 0
+#endif
+
+namespace trading {
+
+namespace {
+
+constexpr size_t CACHE_LINE = 64;
+
+size_t align_up(size_t value, size_t alignment) {
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+size_t round_up_to_power_of_two(size_t value) {
+    size_t result = 2;
+    while (result < value) {
+        result <<= 1;
+    }
+    return result;
+}
+
+// POSIX names start with a single '/'
+std::string segment_name(const std::string& name) {
+    return !name.empty() && name.front() == '/' ? name : "/" + name;
+}
+
+// The cells follow their channel, on the next cache line
+ShmBookLayout::Cell* channel_cells(ShmBookLayout::Channel* channel) {
+    return reinterpret_cast<ShmBookLayout::Cell*>(reinterpret_cast<unsigned char*>(channel) +
+                                                  align_up(sizeof(ShmBookLayout::Channel), CACHE_LINE));
+}
+
+// Producer side: claim a cell by CAS, since several book workers may push
+void push_notification(ShmBookLayout::Channel* channel, size_t mask, SymbolId symbol_id) {
+    ShmBookLayout::Cell* cells = channel_cells(channel);
+    uint64_t position = channel->tail.load(std::memory_order_relaxed);
+    for (;;) {
+        ShmBookLayout::Cell& cell = cells[position & mask];
+        uint64_t sequence = cell.sequence.load(std::memory_order_acquire);
+        auto difference = static_cast<int64_t>(sequence - position);
+        if (difference == 0) {
+            if (channel->tail.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                cell.symbol_id.store(symbol_id, std::memory_order_relaxed);
+                cell.sequence.store(position + 1, std::memory_order_release);
+                return;
+            }
+        } else if (difference < 0) {
+            // Full: the consumer is behind, it resyncs from the books
+            channel->dropped.fetch_add(1, std::memory_order_relaxed);
+            return;
+        } else {
+            position = channel->tail.load(std::memory_order_relaxed);
+        }
+    }
+}
+
+#if TRADING_SHM_BOOKS
+// PID of the live publisher of an existing segment, 0 if there is none or it has died
+int32_t live_publisher(const std::string& path) {
+    int fd = ::shm_open(path.c_str(), O_RDONLY, 0);
+    if (fd < 0) {
+        return 0;
+    }
+    struct stat info;
+    void* mapping = MAP_FAILED;
+    if (::fstat(fd, &info) == 0 && static_cast<size_t>(info.st_size) >= sizeof(ShmBookLayout::Header)) {
+        mapping = ::mmap(nullptr, sizeof(ShmBookLayout::Header), PROT_READ, MAP_SHARED, fd, 0);
+    }
+    ::close(fd);
+    if (mapping == MAP_FAILED) {
+        return 0;
+    }
+    const auto& header = *static_cast<const ShmBookLayout::Header*>(mapping);
+    int32_t pid = std::memcmp(header.magic, ShmBookLayout::MAGIC, sizeof(header.magic)) == 0 ? header.publisher_pid : 0;
+    ::munmap(mapping, sizeof(ShmBookLayout::Header));
+    // Same test as for a channel's owner: only ESRCH proves the process is gone
+    return pid > 0 && (::kill(pid, 0) == 0 || errno != ESRCH) ? pid : 0;
+}
+#endif
+
+} // namespace
+
+// Create, size and lay out the segment
+ShmBookPublisher::ShmBookPublisher(const std::string& name, size_t max_symbols,
+                                   size_t max_consumers, size_t notify_capacity)
+    : name_(segment_name(name)), max_symbols_(max_symbols), max_consumers_(max_consumers),
+      notify_mask_(round_up_to_power_of_two(notify_capacity) - 1),
+      channel_stride_(align_up(align_up(sizeof(ShmBookLayout::Channel), CACHE_LINE) +
+                               (notify_mask_ + 1) * sizeof(ShmBookLayout::Cell), CACHE_LINE)) {
+    if (max_symbols == 0 || max_symbols >= INVALID_SYMBOL_ID) {
+        throw std::invalid_argument("Shared memory segment needs between 1 and INVALID_SYMBOL_ID symbols");
+    }
+#if TRADING_SHM_BOOKS
+    const size_t page = static_cast<size_t>(::sysconf(_SC_PAGESIZE));
+    const size_t directory_offset = align_up(sizeof(ShmBookLayout::Header), CACHE_LINE);
+    const size_t books_offset =
+        align_up(directory_offset + max_symbols_ * sizeof(ShmBookLayout::SymbolEntry), alignof(SeqLock<BookSnapshot>));
+    // Readers map the channels on their own, writable, so they start on a page
+    const size_t channels_offset = align_up(books_offset + max_symbols_ * sizeof(SeqLock<BookSnapshot>), page);
+    size_ = channels_offset + max_consumers_ * channel_stride_;
+
+    // Replace a segment left behind by a publisher that didn't shut down,
+    // but never take the name away from one that is still running
+    if (int32_t owner = live_publisher(name_)) {
+        throw std::runtime_error("Shared memory segment " + name_ + " is in use by publisher process " +
+                                 std::to_string(owner));
+    }
+    ::shm_unlink(name_.c_str());
+    int fd = ::shm_open(name_.c_str(), O_CREAT | O_EXCL | O_RDWR, 0660);
+    if (fd < 0) {
+        throw std::runtime_error("Failed to create shared memory segment " + name_ + ": " + std::strerror(errno));
+    }
+    // ftruncate() zero-fills: every entry starts unpublished
+    void* mapping = MAP_FAILED;
+    if (::ftruncate(fd, static_cast<off_t>(size_)) == 0) {
+        mapping = ::mmap(nullptr, size_, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    }
+    int error = errno;
+    ::close(fd);  // The mapping keeps the segment alive
+    if (mapping == MAP_FAILED) {
+        ::shm_unlink(name_.c_str());
+        throw std::runtime_error("Failed to map shared memory segment " + name_ + ": " + std::strerror(error));
+    }
+    base_ = static_cast<unsigned char*>(mapping);
+
+    directory_ = reinterpret_cast<ShmBookLayout::SymbolEntry*>(base_ + directory_offset);
+    books_ = reinterpret_cast<SeqLock<BookSnapshot>*>(base_ + books_offset);
+    channels_ = base_ + channels_offset;
+    for (size_t i = 0; i < max_symbols_; ++i) {
+        new (&directory_[i]) ShmBookLayout::SymbolEntry{};
+        new (&books_[i]) SeqLock<BookSnapshot>();
+    }
+    for (size_t i = 0; i < max_consumers_; ++i) {
+        auto* consumer = new (channel(i)) ShmBookLayout::Channel{};
+        ShmBookLayout::Cell* cells = channel_cells(consumer);
+        for (size_t position = 0; position <= notify_mask_; ++position) {
+            new (&cells[position]) ShmBookLayout::Cell{};
+            cells[position].sequence.store(position, std::memory_order_relaxed);
+        }
+    }
+
+    auto* header = new (base_) ShmBookLayout::Header{};
+    std::memcpy(header->magic, ShmBookLayout::MAGIC, sizeof(header->magic));
+    header->version = ShmBookLayout::VERSION;
+    header->slot_size = static_cast<uint32_t>(sizeof(SeqLock<BookSnapshot>));
+    header->max_symbols = static_cast<uint32_t>(max_symbols_);
+    header->max_consumers = static_cast<uint32_t>(max_consumers_);
+    header->notify_capacity = static_cast<uint32_t>(notify_mask_ + 1);
+    header->publisher_pid = static_cast<int32_t>(::getpid());
+    header->directory_offset = directory_offset;
+    header->books_offset = books_offset;
+    header->channels_offset = channels_offset;
+    header->channel_stride = channel_stride_;
+    header->total_size = size_;
+    // Readers check this before trusting anything else in the segment
+    header->ready.store(1, std::memory_order_release);
+
+    TRADING_LOG_INFO("Week 3 optimization: Publishing up to {} books in shared memory segment {} ({} bytes)",
+                     max_symbols_, name_, size_);
+#else
+    (void)max_consumers;
+    (void)notify_capacity;
+    throw std::runtime_error("Shared memory segments are not supported on this platform");
+#endif
+}
+
+// Unmap and remove the segment
+ShmBookPublisher::~ShmBookPublisher() {
+#if TRADING_SHM_BOOKS
+    if (base_ != nullptr) {
+        TRADING_LOG_INFO("Shared memory segment {}: {} notifications dropped", name_, notifications_dropped());
+        ::munmap(base_, size_);
+        ::shm_unlink(name_.c_str());
+    }
+#endif
+}
+
+// Write one book; the caller serializes calls per symbol
+bool ShmBookPublisher::publish(SymbolId symbol_id, std::string_view symbol, const BookSnapshot& snapshot) {
+    if (symbol_id >= max_symbols_) {
+        return false;
+    }
+
+    ShmBookLayout::SymbolEntry& entry = directory_[symbol_id];
+    if (entry.length.load(std::memory_order_relaxed) == 0) {
+        if (symbol.empty() || symbol.size() > SHM_MAX_SYMBOL_NAME) {
+            return false;
+        }
+        std::memcpy(entry.name, symbol.data(), symbol.size());
+        entry.name[symbol.size()] = '\0';
+        // Book first: a reader that finds the name also finds the book
+        books_[symbol_id].store(snapshot, snapshot.used_bytes());
+        entry.length.store(static_cast<uint32_t>(symbol.size()), std::memory_order_release);
+    } else {
+        books_[symbol_id].store(snapshot, snapshot.used_bytes());
+    }
+
+    for (size_t i = 0; i < max_consumers_; ++i) {
+        ShmBookLayout::Channel* consumer = channel(i);
+        if (consumer->owner_pid.load(std::memory_order_relaxed) != 0) {
+            push_notification(consumer, notify_mask_, symbol_id);
+        }
+    }
+    return true;
+}
+
+// Count the claimed channels
+size_t ShmBookPublisher::consumers() const {
+    size_t count = 0;
+    for (size_t i = 0; i < max_consumers_; ++i) {
+        if (channel(i)->owner_pid.load(std::memory_order_relaxed) != 0) {
+            ++count;
+        }
+    }
+    return count;
+}
+
+// Sum the drops over every channel
+uint64_t ShmBookPublisher::notifications_dropped() const {
+    uint64_t dropped = 0;
+    for (size_t i = 0; i < max_consumers_; ++i) {
+        dropped += channel(i)->dropped.load(std::memory_order_relaxed);
+    }
+    return dropped;
+}
+
+ShmBookLayout::Channel* ShmBookPublisher::channel(size_t index) const {
+    return reinterpret_cast<ShmBookLayout::Channel*>(channels_ + index * channel_stride_);
+}
+
+// Map the segment, check it was built by a compatible publisher
+ShmBookReader::ShmBookReader(const std::string& name, bool notifications) {
+#if TRADING_SHM_BOOKS
+    std::string path = segment_name(name);
+    int fd = ::shm_open(path.c_str(), notifications ? O_RDWR : O_RDONLY, 0);
+    if (fd < 0) {
+        throw std::runtime_error("Failed to open shared memory segment " + path + ": " + std::strerror(errno));
+    }
+    struct stat info;
+    if (::fstat(fd, &info) != 0 || static_cast<size_t>(info.st_size) < sizeof(ShmBookLayout::Header)) {
+        ::close(fd);
+        throw std::runtime_error("Not a book segment: " + path);
+    }
+    size_ = static_cast<size_t>(info.st_size);
+    void* mapping = ::mmap(nullptr, size_, PROT_READ, MAP_SHARED, fd, 0);
+    if (mapping == MAP_FAILED) {
+        ::close(fd);
+        throw std::runtime_error("Failed to map shared memory segment " + path);
+    }
+    base_ = static_cast<const unsigned char*>(mapping);
+
+    const auto& header = *reinterpret_cast<const ShmBookLayout::Header*>(base_);
+    // Every section must lie inside the mapping, and each channel must hold its ring
+    bool valid = header.ready.load(std::memory_order_acquire) == 1 &&
+                 std::memcmp(header.magic, ShmBookLayout::MAGIC, sizeof(header.magic)) == 0 &&
+                 header.version == ShmBookLayout::VERSION &&
+                 header.slot_size == sizeof(SeqLock<BookSnapshot>) && header.total_size == size_ &&
+                 header.directory_offset >= sizeof(ShmBookLayout::Header) &&
+                 header.directory_offset + header.max_symbols * sizeof(ShmBookLayout::SymbolEntry) <= header.books_offset &&
+                 header.books_offset + header.max_symbols * sizeof(SeqLock<BookSnapshot>) <= header.channels_offset &&
+                 header.channels_offset + header.max_consumers * header.channel_stride <= size_ &&
+                 header.notify_capacity != 0 && (header.notify_capacity & (header.notify_capacity - 1)) == 0 &&
+                 align_up(sizeof(ShmBookLayout::Channel), CACHE_LINE) +
+                     header.notify_capacity * sizeof(ShmBookLayout::Cell) <= header.channel_stride;
+    if (!valid) {
+        ::close(fd);
+        unmap();
+        throw std::runtime_error("Not a book segment of this build: " + path);
+    }
+    max_symbols_ = header.max_symbols;
+    notify_mask_ = header.notify_capacity - 1;
+    directory_ = reinterpret_cast<const ShmBookLayout::SymbolEntry*>(base_ + header.directory_offset);
+    books_ = reinterpret_cast<const SeqLock<BookSnapshot>*>(base_ + header.books_offset);
+
+    if (notifications) {
+        // Only the channels are writable
+        channels_size_ = size_ - header.channels_offset;
+        void* channels = channels_size_ == 0 ? MAP_FAILED
+                                               : ::mmap(nullptr, channels_size_, PROT_READ | PROT_WRITE, MAP_SHARED,
+                                                        fd, static_cast<off_t>(header.channels_offset));
+        if (channels == MAP_FAILED) {
+            channels_size_ = 0;
+        } else {
+            channels_ = static_cast<unsigned char*>(channels);
+        }
+    }
+    ::close(fd);
+
+    if (notifications && !claim_channel(header)) {
+        unmap();
+        throw std::runtime_error("No free notification channel in shared memory segment " + path);
+    }
+#else
+    (void)name;
+    (void)notifications;
+    throw std::runtime_error("Shared memory segments are not supported on this platform");
+#endif
+}
+
+// Release the channel and unmap
+ShmBookReader::~ShmBookReader() {
+    unmap();
+}
+
+// Linear scan of the directory
+SymbolId ShmBookReader::find_symbol(std::string_view symbol) const {
+    for (size_t id = 0; id < max_symbols_; ++id) {
+        if (symbol_name(static_cast<SymbolId>(id)) == symbol) {
+            return static_cast<SymbolId>(id);
+        }
+    }
+    return INVALID_SYMBOL_ID;
+}
+
+// The name lives in the mapping, written once before its length
+std::string_view ShmBookReader::symbol_name(SymbolId symbol_id) const {
+    const ShmBookLayout::SymbolEntry* published = entry(symbol_id);
+    if (published == nullptr) {
+        return {};
+    }
+    return std::string_view(published->name, published->length.load(std::memory_order_relaxed));
+}
+
+// Copy a whole book out of its seqlock
+bool ShmBookReader::read_snapshot(SymbolId symbol_id, BookSnapshot& snapshot) const {
+    if (entry(symbol_id) == nullptr) {
+        return false;
+    }
+    books_[symbol_id].load(snapshot);
+    return true;
+}
+
+// Copy just the header and the first row
+TopOfBook ShmBookReader::top_of_book(SymbolId symbol_id) const {
+    if (entry(symbol_id) == nullptr) {
+        return TopOfBook{};
+    }
+    BookSnapshot snapshot;
+    books_[symbol_id].load(snapshot, BookSnapshot::bytes_for_rows(1));
+    return snapshot.top();
+}
+
+// Seqlock sequence of a book
+uint64_t ShmBookReader::version(SymbolId symbol_id) const {
+    return symbol_id < max_symbols_ ? books_[symbol_id].version() : 0;
+}
+
+// Consumer side of our channel
+bool ShmBookReader::poll_update(SymbolId& symbol_id) {
+    if (channel_ == nullptr) {
+        return false;
+    }
+    ShmBookLayout::Cell* cells = channel_cells(channel_);
+    uint64_t position = channel_->head.load(std::memory_order_relaxed);
+    ShmBookLayout::Cell& cell = cells[position & notify_mask_];
+    if (cell.sequence.load(std::memory_order_acquire) != position + 1) {
+        return false;
+    }
+    symbol_id = cell.symbol_id.load(std::memory_order_relaxed);
+    // Hand the cell back to producers one lap ahead
+    cell.sequence.store(position + notify_mask_ + 1, std::memory_order_release);
+    channel_->head.store(position + 1, std::memory_order_relaxed);
+    return true;
+}
+
+// Drops since we claimed the channel
+uint64_t ShmBookReader::updates_dropped() const {
+    return channel_ == nullptr ? 0 : channel_->dropped.load(std::memory_order_relaxed) - dropped_base_;
+}
+
+const ShmBookLayout::SymbolEntry* ShmBookReader::entry(SymbolId symbol_id) const {
+    if (symbol_id >= max_symbols_ || directory_[symbol_id].length.load(std::memory_order_acquire) == 0) {
+        return nullptr;
+    }
+    return &directory_[symbol_id];
+}
+
+// Take a free channel, or one whose owner died without releasing it
+bool ShmBookReader::claim_channel(const ShmBookLayout::Header& header) {
+#if TRADING_SHM_BOOKS
+    if (channels_ == nullptr) {
+        return false;
+    }
+    const auto self = static_cast<int32_t>(::getpid());
+    for (size_t i = 0; i < header.max_consumers; ++i) {
+        auto* candidate = reinterpret_cast<ShmBookLayout::Channel*>(channels_ + i * header.channel_stride);
+        int32_t owner = candidate->owner_pid.load(std::memory_order_relaxed);
+        bool free = owner == 0 || (::kill(owner, 0) != 0 && errno == ESRCH);
+        if (free && candidate->owner_pid.compare_exchange_strong(owner, self, std::memory_order_acquire)) {
+            channel_ = candidate;
+            // Discard what was left for the previous owner
+            SymbolId stale;
+            while (poll_update(stale)) {
+            }
+            dropped_base_ = channel_->dropped.load(std::memory_order_relaxed);
+            return true;
+        }
+    }
+#else
+    (void)header;
+#endif
+    return false;
+}
+
+void ShmBookReader::unmap() {
+#if TRADING_SHM_BOOKS
+    if (channel_ != nullptr) {
+        channel_->owner_pid.store(0, std::memory_order_release);
+        channel_ = nullptr;
+    }
+    if (channels_ != nullptr) {
+        ::munmap(channels_, channels_size_);
+        channels_ = nullptr;
+    }
+    if (base_ != nullptr) {
+        ::munmap(const_cast<unsigned char*>(base_), size_);
+        base_ = nullptr;
+    }
+#endif
+}
+
+} // namespace trading
@@ -0,0 +1,42 @@
+#include "../include/strategy_signal.hpp"
+#include <cinttypes>
+#include <cstdio>
+
+namespace trading {
+
+namespace {
+
+// Exact decimal text of a fixed-point price, at least two decimals, no locale
+void append_price(std::string& out, Price price) {
+    int64_t raw = price.raw();
+    uint64_t magnitude = raw < 0 ? 0 - static_cast<uint64_t>(raw) : static_cast<uint64_t>(raw);
+    uint64_t units = magnitude / static_cast<uint64_t>(PRICE_SCALE);
+    uint64_t fraction = magnitude % static_cast<uint64_t>(PRICE_SCALE);
+
+    char digits[32];
+    int length = std::snprintf(digits, sizeof(digits), "%s%" PRIu64 ".%08" PRIu64,
+                               raw < 0 ? "-" : "", units, fraction);
+    // Trim trailing zeros down to cents
+    int decimals = 8;
+    while (decimals > 2 && digits[length - 1] == '0') {
+        --length;
+        --decimals;
+    }
+    out.append(digits, static_cast<size_t>(length));
+}
+
+} // namespace
+
+std::string format_signal(const Signal& signal, std::string_view strategy, std::string_view symbol) {
+    std::string text = "SIGNAL:";
+    text.append(strategy);
+    text += ':';
+    text.append(symbol);
+    text += signal.side == Side::BID ? ":BUY " : ":SELL ";
+    text += std::to_string(signal.quantity);
+    text += '@';
+    append_price(text, signal.price);
+    return text;
+}
+
+} // namespace trading
@@ -0,0 +1,169 @@
+#include "../include/thread_placement.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <fstream>
+#include <sstream>
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace trading {
+
+namespace {
+
+// Linux caps thread names at 16 bytes including the terminator
+constexpr size_t MAX_THREAD_NAME = 15;
+
+// Nodes the mbind() mask can address
+constexpr int MAX_NUMA_NODES = 1024;
+
+// From <linux/mempolicy.h>, which not every toolchain ships
+constexpr int MPOL_BIND_MODE = 2;
+constexpr unsigned MPOL_MF_MOVE_FLAG = 1u << 1;
+
+// First line of a sysfs file, empty if it can't be read
+std::string read_sysfs_line(const std::string& path) {
+    std::ifstream file(path);
+    std::string line;
+    std::getline(file, line);
+    return line;
+}
+
+} // namespace
+
+bool pin_current_thread(int cpu) {
+#if defined(__linux__)
+    if (cpu < 0 || cpu >= CPU_SETSIZE) {
+        return false;
+    }
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+#else
+    (void)cpu;
+    return false;
+#endif
+}
+
+bool set_current_thread_name(const std::string& name) {
+#if defined(__linux__)
+    std::string truncated = name.substr(0, MAX_THREAD_NAME);
+    return pthread_setname_np(pthread_self(), truncated.c_str()) == 0;
+#else
+    (void)name;
+    return false;
+#endif
+}
+
+std::string current_thread_name() {
+#if defined(__linux__)
+    char name[MAX_THREAD_NAME + 1] = {};
+    if (pthread_getname_np(pthread_self(), name, sizeof(name)) == 0) {
+        return name;
+    }
+#endif
+    return {};
+}
+
+bool place_current_thread(const ThreadPlacement& placement, size_t thread_index, const std::string& name) {
+    set_current_thread_name(name);
+    int cpu = placement.cpu_for(thread_index);
+    return cpu < 0 || pin_current_thread(cpu);
+}
+
+int current_cpu() {
+#if defined(__linux__)
+    return sched_getcpu();
+#else
+    return -1;
+#endif
+}
+
+std::vector<int> parse_cpu_list(const std::string& list) {
+    std::vector<int> cpus;
+    std::stringstream ranges(list);
+    std::string range;
+    while (std::getline(ranges, range, ',')) {
+        if (range.empty() || range.find_first_not_of("0123456789-\n ") != std::string::npos) {
+            return {};
+        }
+        int first = 0;
+        int last = 0;
+        char dash = 0;
+        std::stringstream parser(range);
+        if (!(parser >> first) || first < 0) {
+            return {};
+        }
+        last = first;
+        if (parser >> dash && (dash != '-' || !(parser >> last) || last < first)) {
+            return {};
+        }
+        for (int cpu = first; cpu <= last; ++cpu) {
+            cpus.push_back(cpu);
+        }
+    }
+    std::sort(cpus.begin(), cpus.end());
+    cpus.erase(std::unique(cpus.begin(), cpus.end()), cpus.end());
+    return cpus;
+}
+
+std::vector<int> isolated_cpus() {
+    return parse_cpu_list(read_sysfs_line("/sys/devices/system/cpu/isolated"));
+}
+
+size_t numa_node_count() {
+    std::vector<int> nodes = parse_cpu_list(read_sysfs_line("/sys/devices/system/node/online"));
+    return nodes.empty() ? 1 : static_cast<size_t>(nodes.back()) + 1;
+}
+
+int numa_node_of_cpu(int cpu) {
+    if (cpu < 0) {
+        return -1;
+    }
+    for (int node = 0; node < static_cast<int>(numa_node_count()); ++node) {
+        std::vector<int> cpus = numa_node_cpus(node);
+        if (std::binary_search(cpus.begin(), cpus.end(), cpu)) {
+            return node;
+        }
+    }
+    return -1;
+}
+
+std::vector<int> numa_node_cpus(int node) {
+    if (node < 0) {
+        return {};
+    }
+    return parse_cpu_list(read_sysfs_line("/sys/devices/system/node/node" + std::to_string(node) + "/cpulist"));
+}
+
+bool bind_memory_to_numa_node(void* address, size_t bytes, int node) {
+#if defined(__linux__) && defined(SYS_mbind)
+    if (address == nullptr || bytes == 0 || node < 0 || node >= MAX_NUMA_NODES ||
+        static_cast<size_t>(node) >= numa_node_count()) {
+        return false;
+    }
+
+    // mbind() works on whole pages
+    const uintptr_t page = static_cast<uintptr_t>(sysconf(_SC_PAGESIZE));
+    uintptr_t begin = reinterpret_cast<uintptr_t>(address) & ~(page - 1);
+    uintptr_t end = (reinterpret_cast<uintptr_t>(address) + bytes + page - 1) & ~(page - 1);
+
+    constexpr size_t MASK_BITS = 8 * sizeof(unsigned long);
+    unsigned long mask[MAX_NUMA_NODES / MASK_BITS] = {};
+    mask[static_cast<size_t>(node) / MASK_BITS] = 1ul << (static_cast<size_t>(node) % MASK_BITS);
+    return syscall(SYS_mbind, begin, end - begin, MPOL_BIND_MODE, mask,
+                   static_cast<unsigned long>(MAX_NUMA_NODES), MPOL_MF_MOVE_FLAG) == 0;
+#else
+    (void)address;
+    (void)bytes;
+    (void)node;
+    return false;
+#endif
+}
+
+} // namespace trading
@@ -1,13 +1,516 @@
 #include "../include/thread_pool.hpp"
+#include <algorithm>
 
-// This file is intentionally minimal, as the thread pool implementation
-// is primarily in the header file to support template functions.
-// In a real implementation, this file would contain non-template functions
-// and additional performance optimizations.
+// The templated post() and submit() live in the header; the scheduling machinery
+// (injection, local deques, stealing and sleeping) is implemented here.
 
 namespace trading {
 
-// Empty implementation as most functionality is in the header
-// due to the template-based design
+thread_local ThreadPool* ThreadPool::current_pool_ = nullptr;
+thread_local size_t ThreadPool::current_worker_ = 0;
+thread_local bool ThreadPool::current_task_stale_ = false;
 
-} // namespace trading 
\ No newline at end of file
+namespace {
+
+// Min-heap order for std::push_heap/pop_heap: earliest deadline on top
+bool later_deadline(const ThreadPool::Task* a, const ThreadPool::Task* b) {
+    return a->deadline > b->deadline;
+}
+
+// Heap room reserved per band so deadline submits don't allocate
+constexpr size_t DEADLINE_QUEUE_RESERVE = 256;
+
+} // namespace
+
+ThreadPool::ThreadPool(size_t num_threads, bool verbose_logging, size_t task_pool_size)
+    : ThreadPool(num_threads, ThreadPlacement{}, verbose_logging, task_pool_size) {}
+
+ThreadPool::ThreadPool(size_t num_threads, ThreadPlacement placement, bool verbose_logging,
+                       size_t task_pool_size)
+    : ThreadPool(num_threads, num_threads, PoolScalingPolicy{}, std::move(placement), verbose_logging,
+                 task_pool_size) {}
+
+ThreadPool::ThreadPool(size_t initial_threads, size_t max_threads, const PoolScalingPolicy& policy,
+                       ThreadPlacement placement, bool verbose_logging, size_t task_pool_size)
+    : task_allocator_(task_pool_size, sizeof(Task)),
+      deadline_queued_(0), aging_ticks_(0),
+      placement_(std::move(placement)),
+      policy_(policy), min_threads_(initial_threads), target_threads_(initial_threads),
+      slots_used_(initial_threads), threads_started_(0), threads_retired_(0),
+      stop_(false), queued_tasks_(0), sleeping_workers_(0),
+      active_tasks_(0), total_tasks_completed_(0), total_tasks_stolen_(0),
+      deadline_tasks_(0), deadline_misses_(0), stale_drops_(0), stale_runs_(0), aged_tasks_(0),
+      verbose_logging_(verbose_logging) {
+
+    max_threads = std::max(max_threads, initial_threads);
+    TRADING_LOG_INFO("Week 3 optimization: Creating work-stealing thread pool with {} threads", initial_threads);
+
+    if (placement_.name.empty()) {
+        placement_.name = "pool";
+    }
+    // Bind before the slab is first touched by the queues below
+    if (placement_.numa_node >= 0 && !task_allocator_.bind_to_numa_node(placement_.numa_node)) {
+        TRADING_LOG_WARN("Could not bind the thread pool's task slab to NUMA node {}", placement_.numa_node);
+    }
+
+    for (auto& queue : injection_) {
+        queue.reset(new InjectionQueue(false, week2::PoolAllocator<Task*>(&task_allocator_)));
+    }
+    for (auto& queue : deadline_queues_) {
+        queue.reserve(DEADLINE_QUEUE_RESERVE);
+    }
+    set_deadline_aging(DEFAULT_AGING_STEP);
+
+    // Create every worker slot's deques before any thread can try to steal from them
+    for (size_t i = 0; i < max_threads; ++i) {
+        workers_.emplace_back(new Worker());
+        workers_.back()->retired = true;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(scaling_mutex_);
+        for (size_t i = 0; i < initial_threads; ++i) {
+            start_worker(i);
+        }
+    }
+
+    if (max_threads > initial_threads && policy_.interval.count() > 0) {
+        TRADING_LOG_INFO("Week 3 optimization: Thread pool may grow to {} threads above {} us of queue wait",
+                         max_threads, policy_.target_wait.count());
+        monitor_ = std::thread(&ThreadPool::monitor_function, this);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<InstrumentedMutex> lock(queue_mutex_);
+        stop_.store(true, std::memory_order_release);
+    }
+
+    condition_.notify_all();
+    if (monitor_.joinable()) {
+        {
+            std::lock_guard<std::mutex> lock(monitor_mutex_);
+        }
+        monitor_condition_.notify_all();
+        monitor_.join();
+    }
+
+    TRADING_LOG_INFO("Week 3 optimization: Stopping thread pool, joining all threads");
+    for (auto& worker : workers_) {
+        if (worker->thread.joinable()) {
+            worker->thread.join();
+        }
+    }
+
+    TRADING_LOG_INFO("Thread pool completed {} tasks in total ({} stolen)",
+                     total_tasks_completed_.load(), total_tasks_stolen_.load());
+    if (deadline_tasks_.load() > 0) {
+        TRADING_LOG_INFO("Week 3 optimization: {} deadline tasks, {} dropped stale, {} run stale, {} missed their deadline",
+                         deadline_tasks_.load(), stale_drops_.load(), stale_runs_.load(), deadline_misses_.load());
+    }
+}
+
+void ThreadPool::set_deadline_aging(std::chrono::microseconds step) {
+    double ns = std::chrono::duration<double, std::nano>(std::max(step, std::chrono::microseconds(0))).count();
+    aging_ticks_.store(static_cast<uint64_t>(ns / TscClock::ns_per_tick()), std::memory_order_relaxed);
+}
+
+void ThreadPool::resize(size_t new_size) {
+    std::lock_guard<std::mutex> lock(scaling_mutex_);
+    resize_locked(new_size);
+}
+
+void ThreadPool::resize_locked(size_t new_size) {
+    if (workers_.empty()) {
+        return;
+    }
+    new_size = std::clamp<size_t>(new_size, 1, workers_.size());
+    size_t current = target_threads_.load(std::memory_order_relaxed);
+    if (new_size == current) {
+        return;
+    }
+
+    target_threads_.store(new_size, std::memory_order_release);
+    if (new_size > current) {
+        // A worker that saw the old size but hasn't retired yet just keeps going
+        for (size_t id = current; id < new_size; ++id) {
+            if (workers_[id]->retired) {
+                start_worker(id);
+            }
+        }
+        slots_used_.store(std::max(slots_used_.load(std::memory_order_relaxed), new_size),
+                          std::memory_order_release);
+    } else {
+        // Sleeping workers above the new size must wake up to retire
+        {
+            std::lock_guard<InstrumentedMutex> lock(queue_mutex_);
+        }
+        condition_.notify_all();
+    }
+
+    TRADING_LOG_INFO("Week 3 optimization: Resized thread pool from {} to {} threads", current, new_size);
+}
+
+void ThreadPool::start_worker(size_t id) {
+    Worker& worker = *workers_[id];
+    // The slot's previous thread has retired; it may still be draining its deques
+    if (worker.thread.joinable()) {
+        worker.thread.join();
+    }
+    worker.retired = false;
+    threads_started_.fetch_add(1, std::memory_order_relaxed);
+    worker.thread = std::thread([this, id] {
+        worker_function(id);
+    });
+}
+
+bool ThreadPool::try_retire(size_t id) {
+    Worker& self = *workers_[id];
+    {
+        std::lock_guard<std::mutex> lock(scaling_mutex_);
+        if (id < target_threads_.load(std::memory_order_relaxed)) {
+            return false;
+        }
+        self.retired = true;
+    }
+    threads_retired_.fetch_add(1, std::memory_order_relaxed);
+
+    // Hand what is left on our deques to the remaining workers; the tasks stay counted in queued_tasks_
+    bool moved = false;
+    Task* task = nullptr;
+    for (size_t band = 0; band < PRIORITY_BANDS; ++band) {
+        while (self.deques[band].pop(task)) {
+            injection_[band]->enqueue(task);
+            moved = true;
+        }
+    }
+    if (moved && sleeping_workers_.load(std::memory_order_seq_cst) > 0) {
+        {
+            std::lock_guard<InstrumentedMutex> lock(queue_mutex_);
+        }
+        condition_.notify_all();
+    }
+
+    TRADING_LOG_IF(verbose_logging_, LogLevel::DEBUG, "Week 3 optimization: Thread pool worker {} retired", id);
+    return true;
+}
+
+void ThreadPool::adjust_thread_count() {
+    std::lock_guard<std::mutex> lock(scaling_mutex_);
+
+    // Average queue wait of the tasks picked up since the last call
+    uint64_t wait_ticks = 0;
+    uint64_t tasks_run = 0;
+    for (size_t i = 0; i < slots_used_.load(std::memory_order_acquire); ++i) {
+        wait_ticks += workers_[i]->wait_ticks.load(std::memory_order_relaxed);
+        tasks_run += workers_[i]->tasks_run.load(std::memory_order_relaxed);
+    }
+    uint64_t picked_up = tasks_run - last_tasks_run_;
+    double wait_ns = picked_up == 0 ? 0.0
+        : static_cast<double>(wait_ticks - last_wait_ticks_) * TscClock::ns_per_tick() / static_cast<double>(picked_up);
+    last_wait_ticks_ = wait_ticks;
+    last_tasks_run_ = tasks_run;
+
+    const double target_ns = std::chrono::duration<double, std::nano>(policy_.target_wait).count();
+    size_t current = target_threads_.load(std::memory_order_relaxed);
+    bool backlog = queued_tasks_.load(std::memory_order_seq_cst) > 0;
+    bool idle = sleeping_workers_.load(std::memory_order_seq_cst) > 0;
+
+    // Work is queued and nobody is free: grow if it waited too long, or if
+    // nothing was picked up at all because every worker is stuck in a long task
+    if (backlog && !idle && (wait_ns > target_ns || picked_up == 0)) {
+        idle_since_ = {};
+        if (current < workers_.size()) {
+            resize_locked(current + 1);
+        }
+        return;
+    }
+
+    // Well under target with a worker parked: retire one per cooldown
+    if (wait_ns >= target_ns / 4 || !idle || current <= min_threads_) {
+        idle_since_ = {};
+        return;
+    }
+    auto now = std::chrono::steady_clock::now();
+    if (idle_since_ == std::chrono::steady_clock::time_point{}) {
+        idle_since_ = now;
+    } else if (now - idle_since_ >= policy_.cooldown) {
+        resize_locked(current - 1);
+        idle_since_ = now;
+    }
+}
+
+ThreadPoolStats ThreadPool::get_stats() const {
+    ThreadPoolStats stats;
+    stats.threads = target_threads_.load(std::memory_order_acquire);
+    stats.max_threads = workers_.size();
+    stats.tasks_completed = total_tasks_completed_.load(std::memory_order_relaxed);
+    stats.tasks_stolen = total_tasks_stolen_.load(std::memory_order_relaxed);
+    stats.threads_started = threads_started_.load(std::memory_order_relaxed);
+    stats.threads_retired = threads_retired_.load(std::memory_order_relaxed);
+    stats.deadline_tasks = deadline_tasks_.load(std::memory_order_relaxed);
+    stats.deadline_misses = deadline_misses_.load(std::memory_order_relaxed);
+    stats.stale_drops = stale_drops_.load(std::memory_order_relaxed);
+    stats.stale_runs = stale_runs_.load(std::memory_order_relaxed);
+    stats.aged_tasks = aged_tasks_.load(std::memory_order_relaxed);
+
+    uint64_t wait_ticks = 0;
+    uint64_t tasks_run = 0;
+    for (size_t i = 0; i < slots_used_.load(std::memory_order_acquire); ++i) {
+        uint64_t run = workers_[i]->tasks_run.load(std::memory_order_relaxed);
+        stats.tasks_per_thread.push_back(run);
+        tasks_run += run;
+        wait_ticks += workers_[i]->wait_ticks.load(std::memory_order_relaxed);
+    }
+    if (tasks_run > 0) {
+        stats.avg_wait_time_us = static_cast<double>(wait_ticks) * TscClock::ns_per_tick() /
+                                 static_cast<double>(tasks_run) / 1000.0;
+    }
+    return stats;
+}
+
+void ThreadPool::monitor_function() {
+    set_current_thread_name(placement_.name + "-ctl");
+    std::unique_lock<std::mutex> lock(monitor_mutex_);
+    while (!monitor_condition_.wait_for(lock, policy_.interval,
+                                        [this] { return stop_.load(std::memory_order_acquire); })) {
+        lock.unlock();
+        adjust_thread_count();
+        lock.lock();
+    }
+}
+
+ThreadPool::Task* ThreadPool::new_task(int priority, InplaceTask&& func, const TaskDeadline& deadline) {
+    void* block = task_allocator_.allocate(sizeof(Task));
+    return new (block) Task{priority, std::move(func), 0, deadline.tsc, deadline.on_stale};
+}
+
+void ThreadPool::delete_task(Task* task) {
+    task->~Task();
+    task_allocator_.deallocate(task);
+}
+
+void ThreadPool::schedule_task(Task* task) {
+    size_t band = priority_band(task->priority);
+    task->enqueued = TscClock::now();
+    active_tasks_.fetch_add(1, std::memory_order_relaxed);
+
+    if (task->deadline != 0) {
+        // Deadline tasks are ordered by deadline, wherever they come from
+        {
+            std::lock_guard<InstrumentedSpinLock> lock(deadline_lock_);
+            deadline_queues_[band].push_back(task);
+            std::push_heap(deadline_queues_[band].begin(), deadline_queues_[band].end(), later_deadline);
+        }
+        deadline_queued_.fetch_add(1, std::memory_order_release);
+        deadline_tasks_.fetch_add(1, std::memory_order_relaxed);
+    } else if (current_pool_ == this) {
+        // Spawned from inside a task: keep it local to this worker
+        workers_[current_worker_]->deques[band].push(task);
+    } else {
+        injection_[band]->enqueue(task);
+    }
+
+    // Pairs with the sleeping_workers_ increment in worker_function: either
+    // the worker sees the new task or we see the sleeper and wake it
+    queued_tasks_.fetch_add(1, std::memory_order_seq_cst);
+    if (sleeping_workers_.load(std::memory_order_seq_cst) > 0) {
+        {
+            std::lock_guard<InstrumentedMutex> lock(queue_mutex_);
+        }
+        condition_.notify_one();
+    }
+}
+
+void ThreadPool::worker_function(size_t id) {
+    current_pool_ = this;
+    current_worker_ = id;
+
+    if (!place_current_thread(placement_, id, placement_.name + "-" + std::to_string(id))) {
+        TRADING_LOG_WARN("Could not pin thread pool worker {} to core {}", id, placement_.cpu_for(id));
+    }
+
+    TRADING_LOG_IF(verbose_logging_, LogLevel::DEBUG, "Week 3 optimization: Thread pool worker {} started", id);
+
+    Worker& self = *workers_[id];
+
+    while (true) {
+        // Above the target size: leave once the current task is done
+        if (id >= target_threads_.load(std::memory_order_relaxed) && try_retire(id)) {
+            break;
+        }
+
+        Task* task = find_task(id);
+
+        if (task == nullptr && placement_.busy_spin) {
+            // Spinning workers never count as sleeping, so schedule_task() skips the wake-up
+            if (stop_.load(std::memory_order_acquire) &&
+                queued_tasks_.load(std::memory_order_seq_cst) == 0) {
+                break;
+            }
+            cpu_relax();
+            continue;
+        }
+
+        if (task == nullptr) {
+            std::unique_lock<InstrumentedMutex> lock(queue_mutex_);
+
+            // Wait for a task or stop signal
+            sleeping_workers_.fetch_add(1, std::memory_order_seq_cst);
+            condition_.wait(lock, [this, id] {
+                return stop_.load(std::memory_order_acquire) ||
+                       queued_tasks_.load(std::memory_order_seq_cst) > 0 ||
+                       id >= target_threads_.load(std::memory_order_acquire);
+            });
+            sleeping_workers_.fetch_sub(1, std::memory_order_relaxed);
+
+            // If stopping and no tasks, exit
+            if (stop_.load(std::memory_order_acquire) &&
+                queued_tasks_.load(std::memory_order_seq_cst) == 0) {
+                TRADING_LOG_IF(verbose_logging_, LogLevel::DEBUG,
+                               "Week 3 optimization: Thread pool worker {} stopping", id);
+                break;
+            }
+            continue;
+        }
+
+        queued_tasks_.fetch_sub(1, std::memory_order_relaxed);
+
+        // Single writer per slot: plain load and store, no locked add
+        uint64_t picked_up = TscClock::now();
+        uint64_t waited = picked_up - task->enqueued;
+        self.wait_ticks.store(self.wait_ticks.load(std::memory_order_relaxed) + waited, std::memory_order_relaxed);
+        self.tasks_run.store(self.tasks_run.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+
+        // Too late to start: the data the task was meant to act on is gone
+        bool stale = task->deadline != 0 && picked_up > task->deadline;
+        if (stale && task->on_stale == StaleAction::DROP) {
+            TRADING_LOG_IF(verbose_logging_, LogLevel::DEBUG,
+                           "Week 3 optimization: Thread pool worker {} dropped a stale task with priority {}",
+                           id, task->priority);
+            // Destroying an unrun packaged_task breaks its promise, which tells the submitter
+            delete_task(task);
+            stale_drops_.fetch_add(1, std::memory_order_relaxed);
+            active_tasks_.fetch_sub(1, std::memory_order_relaxed);
+            continue;
+        }
+        if (stale) {
+            stale_runs_.fetch_add(1, std::memory_order_relaxed);
+        }
+        uint64_t deadline = task->deadline;
+
+        // Execute the task
+        TRADING_LOG_IF(verbose_logging_, LogLevel::DEBUG,
+                       "Week 3 optimization: Thread pool worker {} executing task with priority {}",
+                       id, task->priority);
+
+        current_task_stale_ = stale;
+        task->func();
+        current_task_stale_ = false;
+        delete_task(task);
+        if (deadline != 0 && TscClock::now() > deadline) {
+            deadline_misses_.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        // Update counters
+        active_tasks_.fetch_sub(1, std::memory_order_relaxed);
+        total_tasks_completed_.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    current_pool_ = nullptr;
+}
+
+ThreadPool::Task* ThreadPool::find_task(size_t id) {
+    Worker& self = *workers_[id];
+    Task* task = nullptr;
+    size_t urgent_band = deadline_band();
+
+    for (size_t band = PRIORITY_BANDS; band-- > 0;) {
+        // A band's deadline tasks go first: a plain task has no deadline at all
+        if (band == urgent_band && (task = pop_deadline_task()) != nullptr) {
+            return task;
+        }
+        // Own work first (LIFO, still cache-hot), then external submits,
+        // then other workers' oldest tasks
+        if (self.deques[band].pop(task) || injection_[band]->try_dequeue(task)) {
+            return task;
+        }
+        task = try_steal_task(id, band);
+        if (task != nullptr) {
+            return task;
+        }
+    }
+    return nullptr;
+}
+
+size_t ThreadPool::best_deadline_queue(uint64_t now, size_t& effective_band) const {
+    uint64_t aging = aging_ticks_.load(std::memory_order_relaxed);
+    size_t best = PRIORITY_BANDS;
+    effective_band = 0;
+    for (size_t band = PRIORITY_BANDS; band-- > 0;) {
+        if (deadline_queues_[band].empty()) {
+            continue;
+        }
+        const Task* head = deadline_queues_[band].front();
+        size_t effective = band;
+        if (aging > 0 && now > head->enqueued) {
+            uint64_t steps = (now - head->enqueued) / aging;
+            effective = steps >= PRIORITY_BANDS - band ? PRIORITY_BANDS - 1 : band + static_cast<size_t>(steps);
+        }
+        if (best == PRIORITY_BANDS || effective > effective_band ||
+            (effective == effective_band && head->deadline < deadline_queues_[best].front()->deadline)) {
+            best = band;
+            effective_band = effective;
+        }
+    }
+    return best;
+}
+
+size_t ThreadPool::deadline_band() {
+    if (deadline_queued_.load(std::memory_order_acquire) == 0) {
+        return PRIORITY_BANDS;
+    }
+    std::lock_guard<InstrumentedSpinLock> lock(deadline_lock_);
+    size_t effective_band = 0;
+    return best_deadline_queue(TscClock::now(), effective_band) == PRIORITY_BANDS ? PRIORITY_BANDS : effective_band;
+}
+
+ThreadPool::Task* ThreadPool::pop_deadline_task() {
+    if (deadline_queued_.load(std::memory_order_acquire) == 0) {
+        return nullptr;
+    }
+    std::lock_guard<InstrumentedSpinLock> lock(deadline_lock_);
+    size_t effective_band = 0;
+    size_t band = best_deadline_queue(TscClock::now(), effective_band);
+    if (band == PRIORITY_BANDS) {
+        return nullptr;
+    }
+    std::vector<Task*>& queue = deadline_queues_[band];
+    std::pop_heap(queue.begin(), queue.end(), later_deadline);
+    Task* task = queue.back();
+    queue.pop_back();
+    deadline_queued_.fetch_sub(1, std::memory_order_relaxed);
+    if (effective_band > band) {
+        aged_tasks_.fetch_add(1, std::memory_order_relaxed);
+    }
+    return task;
+}
+
+ThreadPool::Task* ThreadPool::try_steal_task(size_t thief, size_t band) {
+    // Retired slots past the high-water mark never held work
+    size_t count = slots_used_.load(std::memory_order_acquire);
+    Task* task = nullptr;
+
+    // Start at the next worker so thieves spread over different victims
+    for (size_t i = 1; i < count; ++i) {
+        Worker& victim = *workers_[(thief + i) % count];
+        if (victim.deques[band].steal(task)) {
+            total_tasks_stolen_.fetch_add(1, std::memory_order_relaxed);
+            return task;
+        }
+    }
+    return nullptr;
+}
+
+} // namespace trading
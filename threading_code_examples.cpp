@@ -20,6 +20,8 @@
 #include <algorithm>
 #include <random>
 
+#include "demo_solution/include/latency_histogram.hpp"
+
 using namespace std;
 using namespace std::chrono;
 
@@ -607,51 +609,38 @@ void market_data_pipeline_example() {
 /**
  * Example 8: Real-time Latency Monitoring
  * Demonstrates measuring and monitoring thread execution latency
+ *
+ * Samples go into a lock-free log-linear histogram (the one the demo
+ * solution's MarketDataHandler uses), so recording never takes a lock or
+ * grows a vector, and percentiles come from the buckets instead of sorting
+ * every sample.
  */
 class LatencyMonitor {
 private:
-    mutex mtx;
-    vector<microseconds> latencies;
+    trading::LatencyHistogram histogram;
     
 public:
     void record_latency(microseconds latency) {
-        lock_guard<mutex> lock(mtx);
-        latencies.push_back(latency);
+        histogram.record(static_cast<uint64_t>(duration_cast<nanoseconds>(latency).count()));
     }
     
     void print_stats() {
-        lock_guard<mutex> lock(mtx);
+        trading::LatencySnapshot snapshot = histogram.snapshot();
         
-        if (latencies.empty()) {
+        if (snapshot.count() == 0) {
             cout << "No latency measurements recorded\n";
             return;
         }
         
-        // Calculate statistics
-        sort(latencies.begin(), latencies.end());
-        
-        auto min_latency = latencies.front();
-        auto max_latency = latencies.back();
-        
-        microseconds sum(0);
-        for (const auto& lat : latencies) {
-            sum += lat;
-        }
-        
-        auto avg_latency = microseconds(sum.count() / latencies.size());
-        auto median_latency = latencies[latencies.size() / 2];
-        
-        // 99th percentile
-        auto p99_latency = latencies[static_cast<size_t>(latencies.size() * 0.99)];
-        
         // Print statistics
         cout << "\nLatency Statistics:\n";
-        cout << "Min: " << min_latency.count() << " μs\n";
-        cout << "Avg: " << avg_latency.count() << " μs\n";
-        cout << "Median: " << median_latency.count() << " μs\n";
-        cout << "Max: " << max_latency.count() << " μs\n";
-        cout << "99th percentile: " << p99_latency.count() << " μs\n";
-        cout << "Total measurements: " << latencies.size() << "\n";
+        cout << "Min: " << snapshot.min() / 1000 << " μs\n";
+        cout << "Avg: " << static_cast<uint64_t>(snapshot.mean()) / 1000 << " μs\n";
+        cout << "Median: " << snapshot.value_at_percentile(50.0) / 1000 << " μs\n";
+        cout << "Max: " << snapshot.max() / 1000 << " μs\n";
+        cout << "99th percentile: " << snapshot.value_at_percentile(99.0) / 1000 << " μs\n";
+        cout << "99.9th percentile: " << snapshot.value_at_percentile(99.9) / 1000 << " μs\n";
+        cout << "Total measurements: " << snapshot.count() << "\n";
     }
 };
 